@@ -785,3 +785,13 @@ function( AddExecutableTest test_name sources libraries include_dirs )
 		add_test( NAME "${test_name}-tsan" COMMAND "${test_name}-tsan" WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR} )
 	endif()
 endfunction()
+
+# a micro-benchmark from test/ ( see test/bench.h ), registered to run with --verify
+function( AddBenchTest test_name target sources include_dirs libraries )
+	add_executable( "${target}" ${sources} )
+	target_include_directories( "${target}" PUBLIC ${CMAKE_SOURCE_DIR}/test ${include_dirs} )
+	if( NOT "" STREQUAL "${libraries}" )
+		target_link_libraries( "${target}" ${libraries} )
+	endif()
+	add_test( NAME ${test_name} COMMAND ${target} --verify )
+endfunction()
@@ -35,12 +35,23 @@
 #include <ngs-vdb/FragmentBlobIterator.hpp>
 #include <ngs-vdb/VdbReferenceIterator.hpp>
 
+#include <vector>
+
 namespace ncbi
 {
     namespace ngs
     {
         namespace vdb
         {
+            /* FragmentBlobRange
+            *  rows of the SEQUENCE table for getFragmentBlobs
+            */
+            struct FragmentBlobRange
+            {
+                int64_t first_row;
+                uint64_t row_count;
+            };
+
             class VdbReadCollection : protected :: ngs :: ReadCollection
             {
             public:
@@ -49,6 +60,20 @@ namespace ncbi
 
                 FragmentBlobIterator getFragmentBlobs() const;
 
+                /* getFragmentBlobs
+                *  iterates the blobs starting in rows [ first_row, first_row + row_count );
+                *  the rows of a blob starting before first_row are left to the range
+                *  it starts in, so iterators on adjoining ranges do not overlap
+                */
+                FragmentBlobIterator getFragmentBlobs ( int64_t first_row, uint64_t row_count ) const;
+
+                /* getFragmentBlobRanges
+                *  splits the SEQUENCE table into at most "parts" ranges with about
+                *  the same number of rows, starting at blob boundaries, to be read
+                *  in parallel with getFragmentBlobs ( first_row, row_count )
+                */
+                std :: vector < FragmentBlobRange > getFragmentBlobRanges ( uint32_t parts ) const;
+
                 /* getReferences
                 *  returns an iterator of all References used
                 *  iterator will be empty if no Reads are aligned
@@ -81,3 +81,49 @@ VdbReadCollection :: getFragmentBlobs() const
     THROW_ON_FAIL ( NGS_FragmentBlobIteratorRelease ( iter, ctx ) );
     return ret;
 }
+
+FragmentBlobIterator
+VdbReadCollection :: getFragmentBlobs ( int64_t first_row, uint64_t row_count ) const
+{
+    HYBRID_FUNC_ENTRY ( rcSRA, rcArc, rcAccessing );
+
+    THROW_ON_FAIL ( struct NGS_FragmentBlobIterator* iter = NGS_ReadCollectionGetFragmentBlobs ( reinterpret_cast<VdbReadCollectionItf*>(self) -> Self() , ctx ) );
+    ON_FAIL ( NGS_FragmentBlobIteratorSetRange ( iter, ctx, first_row, row_count ) )
+    {
+        :: ngs :: ErrBlock err;
+        NGS_ErrBlockThrow ( & err, ctx );
+        NGS_FragmentBlobIteratorRelease ( iter, ctx );
+        err . Throw ();
+    }
+    FragmentBlobIterator ret ( iter );
+    THROW_ON_FAIL ( NGS_FragmentBlobIteratorRelease ( iter, ctx ) );
+    return ret;
+}
+
+std :: vector < FragmentBlobRange >
+VdbReadCollection :: getFragmentBlobRanges ( uint32_t parts ) const
+{
+    HYBRID_FUNC_ENTRY ( rcSRA, rcArc, rcAccessing );
+
+    std :: vector < int64_t > first_rows ( parts > 0 ? parts : 1 );
+    std :: vector < uint64_t > row_counts ( first_rows . size () );
+    std :: vector < FragmentBlobRange > ret;
+
+    THROW_ON_FAIL ( struct NGS_FragmentBlobIterator* iter = NGS_ReadCollectionGetFragmentBlobs ( reinterpret_cast<VdbReadCollectionItf*>(self) -> Self() , ctx ) );
+    uint32_t count;
+    ON_FAIL ( count = NGS_FragmentBlobIteratorSplitRange ( iter, ctx, (uint32_t) first_rows . size (), first_rows . data (), row_counts . data () ) )
+    {
+        :: ngs :: ErrBlock err;
+        NGS_ErrBlockThrow ( & err, ctx );
+        NGS_FragmentBlobIteratorRelease ( iter, ctx );
+        err . Throw ();
+    }
+    THROW_ON_FAIL ( NGS_FragmentBlobIteratorRelease ( iter, ctx ) );
+
+    for ( uint32_t i = 0; i < count; ++ i )
+    {
+        FragmentBlobRange range = { first_rows [ i ], row_counts [ i ] };
+        ret . push_back ( range );
+    }
+    return ret;
+}
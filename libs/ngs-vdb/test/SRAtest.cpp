@@ -30,6 +30,8 @@
 
 #include "ngsfixture.hpp"
 
+#include <vector>
+
 using namespace std;
 using namespace ncbi::NK;
 
@@ -235,6 +237,81 @@ FIXTURE_TEST_CASE(SRA_ReadIterator_Range, SRAFixture)
     REQUIRE( ! readIt . nextRead () );
 }
 
+class ReadBatchBuffers
+{
+public:
+    ReadBatchBuffers ( uint32_t max_reads, uint64_t seq_capacity, uint64_t names_capacity )
+    :   seq_offsets ( max_reads ), seq_lengths ( max_reads ),
+        name_offsets ( max_reads ), name_lengths ( max_reads ),
+        bases ( seq_capacity ), quals ( seq_capacity ), names ( names_capacity )
+    {
+        batch . seq_offsets = & seq_offsets [ 0 ];
+        batch . seq_lengths = & seq_lengths [ 0 ];
+        batch . name_offsets = & name_offsets [ 0 ];
+        batch . name_lengths = & name_lengths [ 0 ];
+        batch . bases = & bases [ 0 ];
+        batch . quals = & quals [ 0 ];
+        batch . names = & names [ 0 ];
+        batch . seq_capacity = seq_capacity;
+        batch . names_capacity = names_capacity;
+        batch . max_reads = max_reads;
+    }
+
+    ngs :: String Bases ( uint32_t i ) const { return ngs :: String ( & bases [ seq_offsets [ i ] ], seq_lengths [ i ] ); }
+    ngs :: String Quals ( uint32_t i ) const { return ngs :: String ( & quals [ seq_offsets [ i ] ], seq_lengths [ i ] ); }
+    ngs :: String Name ( uint32_t i ) const { return ngs :: String ( & names [ name_offsets [ i ] ], name_lengths [ i ] ); }
+
+    ngs :: ReadBatch batch;
+    std :: vector < uint64_t > seq_offsets;
+    std :: vector < uint32_t > seq_lengths;
+    std :: vector < uint64_t > name_offsets;
+    std :: vector < uint32_t > name_lengths;
+    std :: vector < char > bases;
+    std :: vector < char > quals;
+    std :: vector < char > names;
+};
+
+FIXTURE_TEST_CASE(SRA_ReadIterator_Batch, SRAFixture)
+{
+    ngs :: ReadIterator batchIt = open ( SRA_Accession ) . getReadRange ( 10, 5 );
+    ngs :: ReadIterator readIt = open ( SRA_Accession ) . getReadRange ( 10, 5 );
+    ReadBatchBuffers buf ( 3, 100000, 1000 );
+
+    uint32_t total = 0;
+    while ( uint32_t count = batchIt . nextReadBatch ( buf . batch ) )
+    {
+        REQUIRE_GE ( ( uint32_t ) 3, count );
+        for ( uint32_t i = 0; i < count; ++ i )
+        {
+            REQUIRE( readIt . nextRead () );
+            REQUIRE_EQ( readIt . getReadBases () . toString (), buf . Bases ( i ) );
+            REQUIRE_EQ( readIt . getReadQualities () . toString (), buf . Quals ( i ) );
+            REQUIRE_EQ( readIt . getReadName () . toString (), buf . Name ( i ) );
+        }
+        total += count;
+    }
+    REQUIRE_EQ( ( uint32_t ) 5, total );
+    REQUIRE( ! readIt . nextRead () );
+}
+
+FIXTURE_TEST_CASE(SRA_ReadIterator_Batch_Full, SRAFixture)
+{   // a read that does not fit is returned by the next call
+    ngs :: ReadIterator readIt = open ( SRA_Accession ) . getReadRange ( 10, 5 );
+    uint64_t len10 = getRead ( ngs :: String ( SRA_Accession ) + ".R.10" ) . getReadBases () . size ();
+    ReadBatchBuffers buf ( 5, len10, 1000 );
+
+    REQUIRE_EQ( ( uint32_t ) 1, readIt . nextReadBatch ( buf . batch ) );
+    REQUIRE( readIt . nextRead () );
+    REQUIRE_EQ( ngs :: String ( SRA_Accession ) + ".R.11", readIt . getReadId() . toString () );
+}
+
+FIXTURE_TEST_CASE(SRA_ReadIterator_Batch_TooSmall, SRAFixture)
+{
+    ngs :: ReadIterator readIt = open ( SRA_Accession ) . getReadRange ( 10, 5 );
+    ReadBatchBuffers buf ( 5, 1, 1000 );
+    REQUIRE_THROW ( readIt . nextReadBatch ( buf . batch ) );
+}
+
 /////TODO: Read
 //TODO: error cases
 
@@ -562,6 +562,156 @@ FIXTURE_TEST_CASE ( NGS_FragmentBlobIterator_IteratorRetreats, BlobIteratorFixtu
     EXIT;
 }
 
+FIXTURE_TEST_CASE ( NGS_FragmentBlobIterator_SetRange_Empty, BlobIteratorFixture )
+{
+    ENTRY;
+    MakeIterator ( "./data/SparseFragmentBlobs" );
+
+    NGS_FragmentBlobIteratorSetRange ( m_blobIt, m_ctx, 100, 10 );
+    REQUIRE ( ! FAILED () );
+    REQUIRE ( ! NGS_FragmentBlobIteratorHasMore ( m_blobIt, m_ctx ) );
+
+    EXIT;
+}
+
+FIXTURE_TEST_CASE ( NGS_FragmentBlobIterator_SetRange_Sparse, BlobIteratorFixture )
+{   // the next non-NULL row ( 10 ) is past the end of the range
+    ENTRY;
+    MakeIterator ( "./data/SparseFragmentBlobs" );
+
+    NGS_FragmentBlobIteratorSetRange ( m_blobIt, m_ctx, 1, 5 );
+    REQUIRE ( ! FAILED () );
+    {
+        struct NGS_FragmentBlob* blob = NGS_FragmentBlobIteratorNext ( m_blobIt, m_ctx );
+        REQUIRE_NOT_NULL ( blob );
+        int64_t first = 0;
+        uint64_t count = 0;
+        NGS_FragmentBlobRowRange ( blob, m_ctx, & first, & count );
+        REQUIRE_EQ ( (int64_t)1, first );
+        REQUIRE_EQ ( (uint64_t)1, count );
+        NGS_FragmentBlobRelease ( blob, ctx );
+    }
+    REQUIRE_NULL ( NGS_FragmentBlobIteratorNext ( m_blobIt, m_ctx ) );
+    REQUIRE ( ! FAILED () );
+    REQUIRE ( ! NGS_FragmentBlobIteratorHasMore ( m_blobIt, m_ctx ) );
+
+    EXIT;
+}
+
+FIXTURE_TEST_CASE ( NGS_FragmentBlobIterator_SetRange_BadFirstRow, BlobIteratorFixture )
+{
+    ENTRY;
+    MakeIterator ( SRA_Accession );
+
+    NGS_FragmentBlobIteratorSetRange ( m_blobIt, m_ctx, 0, 10 );
+    REQUIRE_FAILED ();
+
+    EXIT;
+}
+
+FIXTURE_TEST_CASE ( NGS_FragmentBlobIterator_SplitRange, BlobIteratorFixture )
+{   // the ranges read one after another give the same blobs as the whole table
+    ENTRY;
+    const char* acc = "SRR833251";
+    const VDatabase *db = openDB( acc );
+    REQUIRE_RC ( VDatabaseOpenTableRead ( db, & m_tbl, "SEQUENCE" ) );
+    REQUIRE_RC ( VDatabaseRelease ( db ) );
+
+    NGS_String* run = NGS_StringMake ( m_ctx, acc, string_size ( acc ) );
+    m_blobIt = NGS_FragmentBlobIteratorMake ( m_ctx, run, m_tbl );
+
+    const uint32_t Parts = 4;
+    int64_t first_rows [ Parts ];
+    uint64_t row_counts [ Parts ];
+    uint32_t count = NGS_FragmentBlobIteratorSplitRange ( m_blobIt, m_ctx, Parts, first_rows, row_counts );
+    REQUIRE ( ! FAILED () );
+    REQUIRE_LT ( (uint32_t)1, count );
+    REQUIRE_GE ( Parts, count );
+    REQUIRE_EQ ( (int64_t)1, first_rows [ 0 ] );
+
+    int64_t rowId = 1;
+    for ( uint32_t i = 0; i < count; ++ i )
+    {
+        REQUIRE_EQ ( rowId, first_rows [ i ] );
+
+        struct NGS_FragmentBlobIterator* rangeIt = NGS_FragmentBlobIteratorMake ( m_ctx, run, m_tbl );
+        NGS_FragmentBlobIteratorSetRange ( rangeIt, m_ctx, first_rows [ i ], row_counts [ i ] );
+        REQUIRE ( ! FAILED () );
+        while ( true )
+        {
+            struct NGS_FragmentBlob* blob = NGS_FragmentBlobIteratorNext ( rangeIt, m_ctx );
+            if ( blob == 0 )
+            {
+                break;
+            }
+            int64_t first = 0;
+            uint64_t rows = 0;
+            NGS_FragmentBlobRowRange ( blob, m_ctx, & first, & rows );
+            REQUIRE_EQ ( rowId, first );
+            NGS_FragmentBlobRelease ( blob, ctx );
+            rowId = first + rows;
+        }
+        NGS_FragmentBlobIteratorRelease ( rangeIt, m_ctx );
+        REQUIRE_EQ ( first_rows [ i ] + (int64_t) row_counts [ i ], rowId );
+    }
+    NGS_StringRelease ( run, m_ctx );
+
+    EXIT;
+}
+
+FIXTURE_TEST_CASE ( NGS_FragmentBlobIterator_SplitRange_Sparse, BlobIteratorFixture )
+{   // every blob comes from the range it starts in, rows 1 and 10 once each
+    ENTRY;
+    const char* acc = "./data/SparseFragmentBlobs";
+    m_tbl = openTable( acc );
+
+    NGS_String* run = NGS_StringMake ( m_ctx, acc, string_size ( acc ) );
+    m_blobIt = NGS_FragmentBlobIteratorMake ( m_ctx, run, m_tbl );
+
+    const uint32_t Parts = 4;
+    int64_t first_rows [ Parts ];
+    uint64_t row_counts [ Parts ];
+    uint32_t count = NGS_FragmentBlobIteratorSplitRange ( m_blobIt, m_ctx, Parts, first_rows, row_counts );
+    REQUIRE ( ! FAILED () );
+    REQUIRE_LE ( (uint32_t)1, count );
+    REQUIRE_GE ( Parts, count );
+
+    int64_t rowId = 1;
+    uint32_t blobs = 0;
+    for ( uint32_t i = 0; i < count; ++ i )
+    {
+        REQUIRE_EQ ( rowId, first_rows [ i ] );
+        rowId = first_rows [ i ] + (int64_t) row_counts [ i ];
+
+        struct NGS_FragmentBlobIterator* rangeIt = NGS_FragmentBlobIteratorMake ( m_ctx, run, m_tbl );
+        NGS_FragmentBlobIteratorSetRange ( rangeIt, m_ctx, first_rows [ i ], row_counts [ i ] );
+        REQUIRE ( ! FAILED () );
+        while ( true )
+        {
+            struct NGS_FragmentBlob* blob = NGS_FragmentBlobIteratorNext ( rangeIt, m_ctx );
+            if ( blob == 0 )
+            {
+                break;
+            }
+            int64_t first = 0;
+            uint64_t rows = 0;
+            NGS_FragmentBlobRowRange ( blob, m_ctx, & first, & rows );
+            REQUIRE_LE ( first_rows [ i ], first );
+            REQUIRE_GT ( rowId, first );
+            REQUIRE_EQ ( blobs == 0 ? (int64_t)1 : (int64_t)10, first );
+            NGS_FragmentBlobRelease ( blob, ctx );
+            ++ blobs;
+        }
+        REQUIRE ( ! FAILED () );
+        NGS_FragmentBlobIteratorRelease ( rangeIt, m_ctx );
+    }
+    REQUIRE_EQ ( (int64_t)11, rowId );
+    REQUIRE_EQ ( (uint32_t)2, blobs );
+    NGS_StringRelease ( run, m_ctx );
+
+    EXIT;
+}
+
 //////////////////////////////////////////// Main
 
 extern "C"
@@ -371,6 +371,34 @@ TEST_CASE ( VdbReadCollection_GetFragmentBlobs )
     //TODO: Verify
 }
 
+TEST_CASE ( VdbReadCollection_GetFragmentBlobRanges )
+{
+    VdbReadCollection coll ( NGS_VDB :: openVdbReadCollection ( SRA_Accession ) );
+    std :: vector < FragmentBlobRange > ranges = coll . getFragmentBlobRanges ( 3 );
+    REQUIRE_LT ( (size_t)0, ranges . size () );
+    REQUIRE_GE ( (size_t)3, ranges . size () );
+    REQUIRE_EQ ( (int64_t)1, ranges [ 0 ] . first_row );
+    for ( size_t i = 1; i < ranges . size (); ++ i )
+    {
+        REQUIRE_EQ ( ranges [ i - 1 ] . first_row + (int64_t) ranges [ i - 1 ] . row_count, ranges [ i ] . first_row );
+    }
+}
+
+TEST_CASE ( VdbReadCollection_GetFragmentBlobs_Range )
+{
+    VdbReadCollection coll ( NGS_VDB :: openVdbReadCollection ( SRA_Accession ) );
+    std :: vector < FragmentBlobRange > ranges = coll . getFragmentBlobRanges ( 3 );
+    REQUIRE_LT ( (size_t)1, ranges . size () );
+
+    FragmentBlobIterator blobIt = coll . getFragmentBlobs ( ranges [ 1 ] . first_row, ranges [ 1 ] . row_count );
+    REQUIRE ( blobIt . hasMore () );
+    FragmentBlob blob = blobIt . nextBlob ();
+    int64_t first;
+    uint64_t count;
+    blob . GetRowRange ( & first, & count );
+    REQUIRE_EQ ( ranges [ 1 ] . first_row, first );
+}
+
 /// ReferenceBlob
 
 class ReferenceBlobFixture : public KfcFixture
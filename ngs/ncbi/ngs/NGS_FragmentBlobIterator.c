@@ -103,6 +103,114 @@ NGS_FragmentBlobIteratorMake ( ctx_t ctx, const NGS_String* run, const struct VT
     return NULL;
 }
 
+/* the rows of the READ blob containing "row"
+ */
+static
+bool
+NGS_FragmentBlobIteratorBlobRange ( const NGS_FragmentBlobIterator * self, ctx_t ctx, int64_t row, int64_t * first, int64_t * last )
+{
+    rc_t rc = VCursorPageIdRange ( NGS_CursorGetVCursor ( self -> curs ),
+                                   NGS_CursorGetColumnIndex ( self -> curs, ctx, seq_READ ),
+                                   row,
+                                   first,
+                                   last );
+    return rc == 0 && * first <= row && row <= * last;
+}
+
+/* SetRange
+ *  limit the iteration to the rows [ first_row, first_row + row_count )
+ */
+void
+NGS_FragmentBlobIteratorSetRange ( NGS_FragmentBlobIterator * self, ctx_t ctx, int64_t first_row, uint64_t row_count )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcBlob, rcAccessing );
+
+    if ( self == NULL )
+    {
+        INTERNAL_ERROR ( xcSelfNull, "NULL FragmentBlobIterator accessed" );
+    }
+    else if ( first_row < 1 )
+    {
+        USER_ERROR ( xcParamOutOfBounds, "first_row = %li", first_row );
+    }
+    else
+    {
+        int64_t const table_last = NGS_CursorGetRowCount ( self -> curs, ctx );
+        int64_t first;
+        int64_t last;
+
+        self -> next_row = first_row;
+        if ( first_row > table_last )
+        {
+            self -> last_row = first_row - 1;
+        }
+        else if ( row_count > (uint64_t) ( table_last - first_row ) )
+        {
+            self -> last_row = table_last;
+        }
+        else
+        {
+            self -> last_row = first_row + (int64_t) row_count - 1;
+        }
+
+        /* the rows before the start of the next blob belong to the range that blob starts in */
+        if ( self -> next_row <= self -> last_row &&
+             NGS_FragmentBlobIteratorBlobRange ( self, ctx, first_row, & first, & last ) &&
+             first < first_row )
+        {
+            self -> next_row = last + 1;
+        }
+    }
+}
+
+/* SplitRange
+ *  split the rows left to iterate into at most "parts" ranges starting at READ blobs
+ */
+uint32_t
+NGS_FragmentBlobIteratorSplitRange ( const NGS_FragmentBlobIterator * self, ctx_t ctx, uint32_t parts, int64_t * first_rows, uint64_t * row_counts )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcBlob, rcAccessing );
+
+    if ( self == NULL )
+    {
+        INTERNAL_ERROR ( xcSelfNull, "NULL FragmentBlobIterator accessed" );
+    }
+    else if ( parts == 0 || first_rows == NULL || row_counts == NULL )
+    {
+        INTERNAL_ERROR ( xcParamNull, "no room for the ranges" );
+    }
+    else if ( self -> next_row <= self -> last_row )
+    {
+        uint64_t const total = self -> last_row - self -> next_row + 1;
+        uint32_t count = 0;
+        uint32_t i;
+
+        first_rows [ count ++ ] = self -> next_row;
+        for ( i = 1; i < parts && (uint64_t) i < total; ++ i )
+        {   /* move each split point back to the start of its blob, drop it if that is taken */
+            int64_t const row = self -> next_row + (int64_t) ( total * i / parts );
+            int64_t first = row;
+            int64_t last = row;
+            if ( ! NGS_FragmentBlobIteratorBlobRange ( self, ctx, row, & first, & last ) )
+            {
+                first = row;
+            }
+            if ( first > first_rows [ count - 1 ] )
+            {
+                first_rows [ count ++ ] = first;
+            }
+        }
+        for ( i = 0; i + 1 < count; ++ i )
+        {
+            row_counts [ i ] = first_rows [ i + 1 ] - first_rows [ i ];
+        }
+        row_counts [ count - 1 ] = self -> last_row - first_rows [ count - 1 ] + 1;
+        return count;
+    }
+
+    return 0;
+}
+
 /* Release
  *  release reference
  */
@@ -167,17 +275,20 @@ NGS_FragmentBlobIteratorNext ( NGS_FragmentBlobIterator * self, ctx_t ctx )
                                                self -> next_row,
                                                & nextRow );
         if ( rc == 0 )
-        {
-            TRY ( NGS_FragmentBlob* ret = NGS_FragmentBlobMake ( ctx, self -> run, self -> curs, nextRow ) )
+        {   /* the next non-NULL row may lie past the end of the range */
+            if ( nextRow <= self -> last_row )
             {
-                int64_t first;
-                uint64_t count;
-                TRY ( NGS_FragmentBlobRowRange ( ret, ctx, & first, & count ) )
+                TRY ( NGS_FragmentBlob* ret = NGS_FragmentBlobMake ( ctx, self -> run, self -> curs, nextRow ) )
                 {
-                    self -> next_row = first + count;
-                    return ret;
+                    int64_t first;
+                    uint64_t count;
+                    TRY ( NGS_FragmentBlobRowRange ( ret, ctx, & first, & count ) )
+                    {
+                        self -> next_row = first + count;
+                        return ret;
+                    }
+                    NGS_FragmentBlobRelease ( ret, ctx );
                 }
-                NGS_FragmentBlobRelease ( ret, ctx );
             }
         }
         else if ( GetRCState ( rc ) != rcNotFound )
@@ -51,6 +51,22 @@ struct NGS_FragmentBlob;
  */
 NGS_FragmentBlobIterator* NGS_FragmentBlobIteratorMake ( ctx_t ctx, const struct NGS_String* run, const struct VTable* sequence );
 
+/* SetRange
+ *  limit the iteration to the rows [ first_row, first_row + row_count )
+ *  rows of a READ blob that starts before "first_row" are left to the range
+ *  that blob starts in, so iterators on adjoining ranges do not overlap;
+ *  to be called before the first Next
+ */
+void NGS_FragmentBlobIteratorSetRange ( NGS_FragmentBlobIterator * self, ctx_t ctx, int64_t first_row, uint64_t row_count );
+
+/* SplitRange
+ *  split the rows left to iterate into at most "parts" ranges with about
+ *  the same number of rows, each one starting where a READ blob starts
+ *  "first_rows" and "row_counts" [ OUT ] receive the ranges, at least "parts" elements each
+ *  returns the number of ranges, 0 if there are no rows
+ */
+uint32_t NGS_FragmentBlobIteratorSplitRange ( const NGS_FragmentBlobIterator * self, ctx_t ctx, uint32_t parts, int64_t * first_rows, uint64_t * row_counts );
+
 /* Release
  *  release reference
  */
@@ -48,6 +48,7 @@
 #include <sysalloc.h>
 
 #include <stddef.h>
+#include <string.h>
 #include <assert.h>
 
 /*--------------------------------------------------------------------------
@@ -165,6 +166,18 @@ static bool ITF_Read_v1_next ( NGS_Read_v1 * self, NGS_ErrBlock_v1 * err )
     return ret;
 }
 
+static uint32_t ITF_Read_v1_next_batch ( NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, NGS_ReadBatch_v1 * batch )
+{
+    HYBRID_FUNC_ENTRY ( rcSRA, rcRefcount, rcAccessing );
+    ON_FAIL ( uint32_t ret = NGS_ReadIteratorNextBatch ( Self ( self ), ctx, batch ) )
+    {
+        NGS_ErrBlockThrow ( err, ctx );
+    }
+
+    CLEAR ();
+    return ret;
+}
+
 #undef Self
 
 
@@ -173,7 +186,7 @@ NGS_Read_v1_vt ITF_Read_vt =
     {
         "NGS_Read",
         "NGS_Read_v1",
-        1,
+        2,
         & ITF_Fragment_vt . dad
     },
 
@@ -187,7 +200,10 @@ NGS_Read_v1_vt ITF_Read_vt =
     ITF_Read_v1_next,
 
     /* 1.1 */
-    ITF_Read_v1_frag_is_aligned
+    ITF_Read_v1_frag_is_aligned,
+
+    /* 1.2 */
+    ITF_Read_v1_next_batch
 };
 
 /*--------------------------------------------------------------------------
@@ -327,6 +343,12 @@ bool NGS_ReadIteratorNext ( NGS_Read * self, ctx_t ctx )
         FUNC_ENTRY ( ctx, rcSRA, rcDatabase, rcAccessing );
         INTERNAL_ERROR ( xcSelfNull, "failed to advance read iterator" );
     }
+    else if ( self -> batch_pending )
+    {
+        /* the current read has not been returned yet */
+        self -> batch_pending = false;
+        return true;
+    }
     else
     {
         return VT ( self, next ) ( self, ctx );
@@ -350,12 +372,134 @@ uint64_t NGS_ReadIteratorGetCount ( const NGS_Read * self, ctx_t ctx )
     return 0;
 }
 
+uint32_t NGS_ReadIteratorNextBatch ( NGS_Read * self, ctx_t ctx, NGS_ReadBatch_v1 * batch )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcDatabase, rcAccessing );
+
+    uint32_t count = 0;
+
+    if ( self == NULL )
+    {
+        INTERNAL_ERROR ( xcSelfNull, "failed to get read batch" );
+        return 0;
+    }
+    if ( batch == NULL )
+    {
+        USER_ERROR ( xcParamNull, "bad read batch" );
+        return 0;
+    }
+    if ( ( ( batch -> bases != NULL || batch -> quals != NULL ) && ( batch -> seq_offsets == NULL || batch -> seq_lengths == NULL ) ) ||
+         ( batch -> names != NULL && ( batch -> name_offsets == NULL || batch -> name_lengths == NULL ) ) )
+    {
+        USER_ERROR ( xcParamNull, "read batch is missing offset or length arrays" );
+        return 0;
+    }
+
+    batch -> seq_size = 0;
+    batch -> names_size = 0;
+
+    while ( count < batch -> max_reads )
+    {
+        NGS_String * bases = NULL;
+        NGS_String * quals = NULL;
+        NGS_String * name = NULL;
+        bool full = false;
+
+        bool more = NGS_ReadIteratorNext ( self, ctx );
+        if ( FAILED () || ! more )
+        {
+            break;
+        }
+
+        if ( batch -> bases != NULL )
+        {
+            bases = NGS_ReadGetReadSequence ( self, ctx, 0, ( uint64_t ) -1 );
+        }
+        if ( ! FAILED () && batch -> quals != NULL )
+        {
+            quals = NGS_ReadGetReadQualities ( self, ctx, 0, ( uint64_t ) -1 );
+        }
+        if ( ! FAILED () && batch -> names != NULL )
+        {
+            name = NGS_ReadGetReadName ( self, ctx );
+        }
+
+        if ( ! FAILED () )
+        {
+            size_t bases_len = bases == NULL ? 0 : NGS_StringSize ( bases, ctx );
+            size_t quals_len = quals == NULL ? 0 : NGS_StringSize ( quals, ctx );
+            size_t name_len = name == NULL ? 0 : NGS_StringSize ( name, ctx );
+            size_t seq_len = bases_len > quals_len ? bases_len : quals_len;
+
+            if ( batch -> seq_size + seq_len > batch -> seq_capacity ||
+                 batch -> names_size + name_len > batch -> names_capacity )
+            {
+                /* hand this read out first on the next call */
+                self -> batch_pending = true;
+                if ( count == 0 )
+                {
+                    USER_ERROR ( xcParamOutOfBounds, "read of %lu bases and a %lu byte name does not fit into the read batch",
+                                 ( uint64_t ) seq_len, ( uint64_t ) name_len );
+                }
+                full = true;
+            }
+            else
+            {
+                if ( bases != NULL )
+                {
+                    memmove ( batch -> bases + batch -> seq_size, NGS_StringData ( bases, ctx ), bases_len );
+                }
+                if ( quals != NULL )
+                {
+                    memmove ( batch -> quals + batch -> seq_size, NGS_StringData ( quals, ctx ), quals_len );
+                }
+                if ( batch -> seq_offsets != NULL )
+                {
+                    batch -> seq_offsets [ count ] = batch -> seq_size;
+                    batch -> seq_lengths [ count ] = ( uint32_t ) seq_len;
+                    batch -> seq_size += seq_len;
+                }
+                if ( name != NULL )
+                {
+                    memmove ( batch -> names + batch -> names_size, NGS_StringData ( name, ctx ), name_len );
+                    batch -> name_offsets [ count ] = batch -> names_size;
+                    batch -> name_lengths [ count ] = ( uint32_t ) name_len;
+                    batch -> names_size += name_len;
+                }
+                ++ count;
+            }
+        }
+
+        if ( bases != NULL )
+        {
+            NGS_StringRelease ( bases, ctx );
+        }
+        if ( quals != NULL )
+        {
+            NGS_StringRelease ( quals, ctx );
+        }
+        if ( name != NULL )
+        {
+            NGS_StringRelease ( name, ctx );
+        }
+
+        if ( FAILED () || full )
+        {
+            break;
+        }
+    }
+
+    return count;
+}
+
 void NGS_ReadInit ( ctx_t ctx, NGS_Read * read, const NGS_Read_vt * vt, const char *clsname, const char *instname )
 {
     FUNC_ENTRY ( ctx, rcSRA, rcRow, rcConstructing );
 
     TRY ( NGS_FragmentInit ( ctx, & read -> dad, & ITF_Read_vt . dad, & vt -> dad, clsname, instname ) )
     {
+        read -> batch_pending = false;
+
         assert ( vt -> get_id != NULL );
         assert ( vt -> get_name != NULL );
         assert ( vt -> get_read_group != NULL );
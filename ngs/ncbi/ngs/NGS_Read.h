@@ -49,6 +49,7 @@ struct String;
 struct VCursor;
 struct NGS_String;
 struct NGS_Read_v1_vt;
+struct NGS_ReadBatch_v1;
 extern struct NGS_Read_v1_vt ITF_Read_vt;
 
 /*--------------------------------------------------------------------------
@@ -141,6 +142,14 @@ bool NGS_ReadIteratorNext ( NGS_Read * self, ctx_t ctx );
  */
 uint64_t NGS_ReadIteratorGetCount ( const NGS_Read * self, ctx_t ctx );
 
+/* NextBatch
+ *  advance over up to "batch -> max_reads" reads, copying their
+ *  bases, qualities and names into the caller's buffers
+ *  returns the number of reads copied
+ *  a read that does not fit is kept for the following call
+ */
+uint32_t NGS_ReadIteratorNextBatch ( NGS_Read * self, ctx_t ctx, struct NGS_ReadBatch_v1 * batch );
+
 
 /*--------------------------------------------------------------------------
  * implementation details
@@ -148,6 +157,10 @@ uint64_t NGS_ReadIteratorGetCount ( const NGS_Read * self, ctx_t ctx );
 struct NGS_Read
 {
     NGS_Fragment dad;
+
+    /* the current read was left over by NextBatch,
+       the next call to Next stays on it */
+    bool batch_pending;
 };
 
 typedef struct NGS_Read_vt NGS_Read_vt;
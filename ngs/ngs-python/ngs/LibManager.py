@@ -362,6 +362,7 @@ class LibManager:
         self.bind_sdk("PY_NGS_ReadGetReadQualities", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
 
         self.bind_sdk("PY_NGS_ReadIteratorNext",     [c_void_p, POINTER(c_int), POINTER(c_void_p)])
+        self.bind_sdk("PY_NGS_ReadIteratorNextBatch",[c_void_p, c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
 
         # Reference
 
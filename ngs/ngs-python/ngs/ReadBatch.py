@@ -0,0 +1,163 @@
+# ===========================================================================
+# 
+#                            PUBLIC DOMAIN NOTICE
+#               National Center for Biotechnology Information
+# 
+#  This software/database is a "United States Government Work" under the
+#  terms of the United States Copyright Act.  It was written as part of
+#  the author's official duties as a United States Government employee and
+#  thus cannot be copyrighted.  This software/database is freely available
+#  to the public for use. The National Library of Medicine and the U.S.
+#  Government have not placed any restriction on its use or reproduction.
+# 
+#  Although all reasonable efforts have been taken to ensure the accuracy
+#  and reliability of the software and data, the NLM and the U.S.
+#  Government do not and cannot warrant the performance or results that
+#  may be obtained by using this software or data. The NLM and the U.S.
+#  Government disclaim all warranties, express or implied, including
+#  warranties of performance, merchantability or fitness for any particular
+#  purpose.
+# 
+#  Please cite the author in any work or product based on this material.
+# 
+# ===========================================================================
+# 
+# 
+
+from ctypes import Structure, POINTER, c_char, c_void_p, c_uint32, c_uint64, addressof
+
+class NGS_ReadBatch_v1(Structure):
+    """Mirrors NGS_ReadBatch_v1 from <ngs/itf/ReadItf.h>"""
+    _fields_ = [
+        ("seq_offsets",    POINTER(c_uint64)),
+        ("seq_lengths",    POINTER(c_uint32)),
+        ("name_offsets",   POINTER(c_uint64)),
+        ("name_lengths",   POINTER(c_uint32)),
+        ("bases",          c_void_p),
+        ("quals",          c_void_p),
+        ("names",          c_void_p),
+        ("seq_capacity",   c_uint64),
+        ("names_capacity", c_uint64),
+        ("seq_size",       c_uint64),
+        ("names_size",     c_uint64),
+        ("max_reads",      c_uint32),
+    ]
+
+# ReadBatch
+# reusable buffers filled by ReadIterator.nextReadBatch
+#
+# the data are exposed as memoryviews over the buffers, without copying;
+# they are valid until the next call to nextReadBatch.
+# bases and qualities of read i are
+#   batch.bases[batch.seq_offsets[i]:batch.seq_offsets[i] + batch.seq_lengths[i]]
+#   batch.qualities[...same range...]
+# and its name is
+#   batch.names[batch.name_offsets[i]:batch.name_offsets[i] + batch.name_lengths[i]]
+# the views can be handed to numpy.frombuffer and the like as they are.
+
+class ReadBatch:
+    def __init__(self, max_reads=4096, seq_capacity=None, names_capacity=None, bases=True, qualities=True, names=True):
+        """
+        :param: max_reads is the largest number of Reads returned by one call
+        :param: seq_capacity is the size in bytes of each of the bases and qualities buffers,
+                by default 256 per Read
+        :param: names_capacity is the size in bytes of the names buffer, by default 64 per Read
+        :param: bases, qualities, names select the data to retrieve
+        :remarks: a Read longer than the buffers raises ErrorMsg from nextReadBatch
+        """
+        if seq_capacity is None:
+            seq_capacity = max_reads * 256
+        if names_capacity is None:
+            names_capacity = max_reads * 64
+
+        self.count = 0
+        self.itf = NGS_ReadBatch_v1()
+        self.itf.max_reads = max_reads
+
+        self._seq_offsets = (c_uint64 * max_reads)()
+        self._seq_lengths = (c_uint32 * max_reads)()
+        self.itf.seq_offsets = self._seq_offsets
+        self.itf.seq_lengths = self._seq_lengths
+        self.itf.seq_capacity = seq_capacity
+        self._bases = self._bytes(seq_capacity if bases else 0)
+        self._quals = self._bytes(seq_capacity if qualities else 0)
+        self.itf.bases = self._pointer(self._bases)
+        self.itf.quals = self._pointer(self._quals)
+
+        self._name_offsets = (c_uint64 * max_reads)()
+        self._name_lengths = (c_uint32 * max_reads)()
+        self._names = self._bytes(names_capacity if names else 0)
+        self.itf.name_offsets = self._name_offsets
+        self.itf.name_lengths = self._name_lengths
+        self.itf.names = self._pointer(self._names)
+        self.itf.names_capacity = names_capacity
+
+    @staticmethod
+    def _bytes(size):
+        if size == 0:
+            return None
+        return bytearray(size)
+
+    @staticmethod
+    def _pointer(buf):
+        if buf is None:
+            return None
+        return addressof((c_char * len(buf)).from_buffer(buf))
+
+    @staticmethod
+    def _view(buf, size):
+        if buf is None:
+            return None
+        return memoryview(buf)[:size]
+
+    def __len__(self):
+        return self.count
+
+    # ----------------------------------------------------------------------
+    # zero-copy views
+
+    @property
+    def bases(self):
+        return self._view(self._bases, self.itf.seq_size)
+
+    @property
+    def qualities(self):
+        return self._view(self._quals, self.itf.seq_size)
+
+    @property
+    def names(self):
+        return self._view(self._names, self.itf.names_size)
+
+    @property
+    def seq_offsets(self):
+        return memoryview(self._seq_offsets).cast('B').cast('Q')[:self.count]
+
+    @property
+    def seq_lengths(self):
+        return memoryview(self._seq_lengths).cast('B').cast('I')[:self.count]
+
+    @property
+    def name_offsets(self):
+        return memoryview(self._name_offsets).cast('B').cast('Q')[:self.count]
+
+    @property
+    def name_lengths(self):
+        return memoryview(self._name_lengths).cast('B').cast('I')[:self.count]
+
+    # ----------------------------------------------------------------------
+    # per-Read access, copies
+
+    def getReadBases(self, i):
+        return self._slice(self._bases, self._seq_offsets, self._seq_lengths, i)
+
+    def getReadQualities(self, i):
+        return self._slice(self._quals, self._seq_offsets, self._seq_lengths, i)
+
+    def getReadName(self, i):
+        return self._slice(self._names, self._name_offsets, self._name_lengths, i)
+
+    def _slice(self, buf, offsets, lengths, i):
+        if i < 0 or i >= self.count:
+            raise IndexError("read index out of range")
+        start = offsets[i]
+        return buf[start:start + lengths[i]].decode()
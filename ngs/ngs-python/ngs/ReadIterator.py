@@ -24,10 +24,10 @@
 # 
 # 
 
-from ctypes import c_int
+from ctypes import byref, c_int, c_uint32
 
 from . import NGS
-from .String import getNGSValue
+from .String import NGS_RawString, getNGSValue
 from .Read import Read
 
 # ReadIterator
@@ -40,4 +40,24 @@ class ReadIterator(Read):
         :returns: false if no more Reads are available.
         :throws: ErrorMsg if more Reads should be available, but could not be accessed.
         """
-        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReadIteratorNext, c_int))
\ No newline at end of file
+        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReadIteratorNext, c_int))
+
+    def nextReadBatch(self, batch):
+        """Advance over up to batch.itf.max_reads Reads, copying their bases,
+        qualities and names into the buffers of a ReadBatch
+        stops early when the next Read does not fit; it starts the following batch
+        a following nextRead moves to the Read after the batch
+        :param: batch is a ReadBatch, reused from call to call
+        :returns: number of Reads in the batch, 0 if no more Reads are available.
+        :throws: ErrorMsg if a single Read does not fit into the batch buffers,
+                 or if more Reads should be available, but could not be accessed.
+        """
+        ret = c_uint32()
+        ngs_str_err = NGS_RawString()
+        try:
+            res = NGS.lib_manager.PY_NGS_ReadIteratorNextBatch(self.ref, byref(batch.itf), byref(ret), byref(ngs_str_err.ref))
+        finally:
+            ngs_str_err.close()
+
+        batch.count = ret.value
+        return batch.count
@@ -30,6 +30,7 @@
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/ReadItf.h>
+#include <ngs/ReadBatch.hpp>
 
 namespace ngs
 {
@@ -265,4 +266,46 @@ namespace ngs
         return ret;
     }
 
+    uint32_t ReadItf :: nextReadBatch ( ReadBatch & batch )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Read_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Read_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.2
+        if ( vt -> dad . minor_version < 2 )
+            throw ErrorMsg ( "the Read interface provided by this NGS engine is too old to support this message" );
+
+        // convert to the C descriptor
+        NGS_ReadBatch_v1 itf;
+        itf . seq_offsets = batch . seq_offsets;
+        itf . seq_lengths = batch . seq_lengths;
+        itf . name_offsets = batch . name_offsets;
+        itf . name_lengths = batch . name_lengths;
+        itf . bases = batch . bases;
+        itf . quals = batch . quals;
+        itf . names = batch . names;
+        itf . seq_capacity = batch . seq_capacity;
+        itf . names_capacity = batch . names_capacity;
+        itf . seq_size = 0;
+        itf . names_size = 0;
+        itf . max_reads = batch . max_reads;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> next_batch != 0 );
+        uint32_t ret  = ( * vt -> next_batch ) ( self, & err, & itf );
+
+        // check for errors
+        err . Check ();
+
+        batch . seq_size = itf . seq_size;
+        batch . names_size = itf . names_size;
+
+        return ret;
+    }
+
 } // namespace ngs
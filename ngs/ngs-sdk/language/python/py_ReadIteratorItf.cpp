@@ -28,6 +28,8 @@
 #include "py_ErrorMsg.hpp"
 
 #include <ngs/itf/ReadItf.hpp>
+#include <ngs/itf/ReadItf.h>
+#include <ngs/ReadBatch.hpp>
 
 PY_RES_TYPE PY_NGS_ReadIteratorNext ( void* pRef, int* pRet, void** ppNGSStrError )
 {
@@ -54,3 +56,42 @@ PY_RES_TYPE PY_NGS_ReadIteratorNext ( void* pRef, int* pRet, void** ppNGSStrErro
     return ret;
 }
 
+PY_RES_TYPE PY_NGS_ReadIteratorNextBatch ( void* pRef, void* pBatch, uint32_t* pRet, void** ppNGSStrError )
+{
+    PY_RES_TYPE ret = PY_RES_ERROR;
+    try
+    {
+        assert(pBatch != NULL);
+        NGS_ReadBatch_v1* itf = (NGS_ReadBatch_v1*) pBatch;
+        ngs::ReadBatch batch;
+        batch.seq_offsets = itf->seq_offsets;
+        batch.seq_lengths = itf->seq_lengths;
+        batch.name_offsets = itf->name_offsets;
+        batch.name_lengths = itf->name_lengths;
+        batch.bases = itf->bases;
+        batch.quals = itf->quals;
+        batch.names = itf->names;
+        batch.seq_capacity = itf->seq_capacity;
+        batch.names_capacity = itf->names_capacity;
+        batch.max_reads = itf->max_reads;
+        uint32_t res = CheckedCast< ngs::ReadItf* >(pRef) -> nextReadBatch( batch );
+        itf->seq_size = batch.seq_size;
+        itf->names_size = batch.names_size;
+        assert(pRet != NULL);
+        *pRet = res;
+        ret = PY_RES_OK;
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( std::exception & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( ... )
+    {
+        ret = ExceptionHandler ( ppNGSStrError );
+    }
+    return ret;
+}
@@ -33,6 +33,7 @@ extern "C" {
 #include "py_ngs_defs.h"
 
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadIteratorNext(void* pRef, int* pRet, void** ppNGSStrError);
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReadIteratorNextBatch(void* pRef, void* pBatch, uint32_t* pRet, void** ppNGSStrError);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,88 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_read_batch_
+#define _hpp_ngs_read_batch_
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace ngs
+{
+
+    /*======================================================================
+     * ReadBatch
+     *  describes caller-owned buffers filled by ReadIterator :: nextReadBatch
+     *
+     *  bases and qualities of read "i" are at "bases + seq_offsets [ i ]"
+     *  and "quals + seq_offsets [ i ]", "seq_lengths [ i ]" bytes each;
+     *  its name is at "names + name_offsets [ i ]", "name_lengths [ i ]" bytes.
+     *  nothing is NUL-terminated.
+     *
+     *  any of "bases", "quals" and "names" may be NULL to skip that data;
+     *  the matching offset and length arrays must hold "max_reads" entries
+     *  when their data are requested.
+     */
+    class ReadBatch
+    {
+    public:
+
+        /* per-read arrays */
+        uint64_t * seq_offsets;
+        uint32_t * seq_lengths;
+        uint64_t * name_offsets;
+        uint32_t * name_lengths;
+
+        /* packed data; "bases" and "quals" are each "seq_capacity" bytes */
+        char * bases;
+        char * quals;
+        char * names;
+        uint64_t seq_capacity;
+        uint64_t names_capacity;
+
+        /* filled in: bytes used in each of "bases"/"quals" and in "names" */
+        uint64_t seq_size;
+        uint64_t names_size;
+
+        uint32_t max_reads;
+
+    public:
+
+        // C++ support
+        ReadBatch ()
+            : seq_offsets ( NULL ), seq_lengths ( NULL )
+            , name_offsets ( NULL ), name_lengths ( NULL )
+            , bases ( NULL ), quals ( NULL ), names ( NULL )
+            , seq_capacity ( 0 ), names_capacity ( 0 )
+            , seq_size ( 0 ), names_size ( 0 )
+            , max_reads ( 0 )
+        {
+        }
+    };
+
+} // namespace ngs
+
+#endif // _hpp_ngs_read_batch_
@@ -31,6 +31,10 @@
 #include <ngs/Read.hpp>
 #endif
 
+#ifndef _hpp_ngs_read_batch_
+#include <ngs/ReadBatch.hpp>
+#endif
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -51,6 +55,19 @@ namespace ngs
         bool nextRead ()
             NGS_THROWS ( ErrorMsg );
 
+        /* nextReadBatch
+         *  advance over up to "batch . max_reads" Reads,
+         *  copying their bases, qualities and names into the batch buffers
+         *  returns the number of Reads copied, 0 if no more Reads are available.
+         *  stops early when the next Read does not fit into the buffers;
+         *  that Read becomes the first one of the following batch.
+         *  a following nextRead () moves to the Read after the batch;
+         *  the Read accessors are not meaningful until then.
+         *  throws exception if a single Read does not fit into empty buffers.
+         */
+        uint32_t nextReadBatch ( ReadBatch & batch )
+            NGS_THROWS ( ErrorMsg );
+
     public:
 
         // C++ support
@@ -47,6 +47,11 @@ namespace ngs
         NGS_THROWS ( ErrorMsg )
     { return self -> nextRead (); }
 
+    inline
+    uint32_t ReadIterator :: nextReadBatch ( ReadBatch & batch )
+        NGS_THROWS ( ErrorMsg )
+    { return self -> nextReadBatch ( batch ); }
+
 
 #undef self
 
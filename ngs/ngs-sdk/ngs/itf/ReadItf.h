@@ -35,6 +35,43 @@
 extern "C" {
 #endif
 
+/*--------------------------------------------------------------------------
+ * NGS_ReadBatch_v1
+ *  caller-owned buffers filled by NGS_Read_v1_vt . next_batch
+ *
+ *  bases and qualities of read "i" are at "bases + seq_offsets [ i ]"
+ *  and "quals + seq_offsets [ i ]", "seq_lengths [ i ]" bytes each;
+ *  its name is at "names + name_offsets [ i ]", "name_lengths [ i ]" bytes.
+ *  nothing is NUL-terminated.
+ *
+ *  any of "bases", "quals" and "names" may be NULL to skip that data;
+ *  the matching offset and length arrays must hold "max_reads" entries
+ *  when their data are requested.
+ */
+typedef struct NGS_ReadBatch_v1 NGS_ReadBatch_v1;
+struct NGS_ReadBatch_v1
+{
+    /* per-read arrays */
+    uint64_t * seq_offsets;
+    uint32_t * seq_lengths;
+    uint64_t * name_offsets;
+    uint32_t * name_lengths;
+
+    /* packed data; "bases" and "quals" are each "seq_capacity" bytes */
+    char * bases;
+    char * quals;
+    char * names;
+    uint64_t seq_capacity;
+    uint64_t names_capacity;
+
+    /* filled in: bytes used in each of "bases"/"quals" and in "names" */
+    uint64_t seq_size;
+    uint64_t names_size;
+
+    uint32_t max_reads;
+};
+
+
 /*--------------------------------------------------------------------------
  * NGS_Read_v1
  */
@@ -61,6 +98,9 @@ struct NGS_Read_v1_vt
     /* 1.1 */
     bool ( CC * frag_is_aligned ) ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, uint32_t fragIdx );
 
+    /* 1.2 */
+    uint32_t ( CC * next_batch ) ( NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, NGS_ReadBatch_v1 * batch );
+
 };
 
 
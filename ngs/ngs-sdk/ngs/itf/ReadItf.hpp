@@ -40,6 +40,7 @@ namespace ngs
      * forwards
      */
     class StringItf;
+    class ReadBatch;
 
     /*----------------------------------------------------------------------
      * ReadItf
@@ -74,6 +75,8 @@ namespace ngs
             NGS_THROWS ( ErrorMsg );
         bool nextRead ()
             NGS_THROWS ( ErrorMsg );
+        uint32_t nextReadBatch ( ReadBatch & batch )
+            NGS_THROWS ( ErrorMsg );
     };
 
 } // namespace ngs
@@ -0,0 +1,141 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_test_bench_
+#define _h_test_bench_
+
+/* Common driver of the micro-benchmarks under test/
+ *
+ * Every bench is run as
+ *  bench-<name> [--verify] [<count>] [<threads>]
+ * It times the current code against the one it replaced and compares
+ * their results; a difference is an error ( exit code 1 ). With --verify
+ * only the comparison is done, on a smaller input: this is how the benches
+ * are registered as tests ( see AddBenchTest in build/env.cmake ).
+ * A bad command line is exit code 2, running out of memory exit code 3.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if WINDOWS
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined __GNUC__
+#define BENCH_UNUSED __attribute__ ( ( unused ) )
+#else
+#define BENCH_UNUSED
+#endif
+
+typedef struct BenchArgs BenchArgs;
+struct BenchArgs
+{
+    size_t count;
+    unsigned threads;
+    bool verify_only;
+};
+
+/* BenchArgsInit
+ *  parses the command line, exits with the usage on error
+ *
+ *  "count_name" names the count in the usage, "threads" is 0 if the bench
+ *  is single-threaded ( <threads> is then not accepted )
+ *
+ *  "count" and "verify_count" are the default count of a timed and of a
+ *  --verify run, "threads" the default number of threads
+ */
+static BENCH_UNUSED
+void BenchArgsInit ( BenchArgs *self, int argc, char *argv [],
+    char const *count_name, size_t count, size_t verify_count, unsigned threads )
+{
+    int positional = 0;
+    int arg;
+
+    memset ( self, 0, sizeof * self );
+    for ( arg = 1; arg < argc; ++ arg )
+    {
+        char *end;
+        unsigned long const value = strtoul ( argv [ arg ], & end, 10 );
+
+        if ( strcmp ( argv [ arg ], "--verify" ) == 0 )
+            self -> verify_only = true;
+        else if ( * end != 0 || value == 0 || positional >= ( threads != 0 ? 2 : 1 ) )
+            break;
+        else if ( positional ++ == 0 )
+            self -> count = value;
+        else
+            self -> threads = ( unsigned ) value;
+    }
+    if ( arg < argc )
+    {
+        fprintf ( stderr, "usage: %s [--verify] [<%s>]%s\n", argv [ 0 ], count_name,
+            threads != 0 ? " [<threads>]" : "" );
+        exit ( 2 );
+    }
+    if ( self -> count == 0 )
+        self -> count = self -> verify_only ? verify_count : count;
+    if ( self -> threads == 0 )
+        self -> threads = threads;
+}
+
+/* BenchNow
+ *  monotonic wall-clock time in seconds
+ */
+static BENCH_UNUSED
+double BenchNow ( void )
+{
+#if WINDOWS
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter ( & now );
+    QueryPerformanceFrequency ( & freq );
+    return ( double ) now . QuadPart / ( double ) freq . QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC, & ts );
+    return ts . tv_sec + ts . tv_nsec * 1e-9;
+#endif
+}
+
+/* BenchAlloc
+ *  malloc that exits on failure
+ */
+static BENCH_UNUSED
+void *BenchAlloc ( size_t size )
+{
+    void *result = malloc ( size );
+    if ( result == NULL )
+    {
+        fprintf ( stderr, "out of memory\n" );
+        exit ( 3 );
+    }
+    return result;
+}
+
+#endif /* _h_test_bench_ */
@@ -0,0 +1,58 @@
+#!/bin/bash
+#------------------------------------------------------------------------------------------
+#
+#   benchmark: cell-by-cell against blob-at-a-time column reads ( --blob-reads )
+#
+#   usage: bench-blob-reads.sh [ accession ... ]
+#
+#   every accession is dumped in the given modes twice, once per read-path,
+#   the outputs have to be identical, the wall-clock time of both runs is reported
+#
+#------------------------------------------------------------------------------------------
+
+TOOL="${TOOL:-fasterq-dump}"
+THREADS="${THREADS:-6}"
+MODES=( "--split-3" "--split-spot" "--fasta-unsorted" )
+
+if [ $# -eq 0 ]; then
+    # a flat table and a cSRA accession
+    set -- SRR000001 SRR341578
+fi
+
+WORKDIR=`mktemp -d bench-blob-reads.XXXXXX`
+trap "rm -rf $WORKDIR" EXIT
+
+function elapsed {
+    local START=`date +%s.%N`
+    eval "$1" > /dev/null 2>&1
+    local RES=$?
+    local END=`date +%s.%N`
+    if [ $RES -ne 0 ]; then
+        echo "failed: $1" >&2
+        exit 3
+    fi
+    echo "$END - $START" | bc
+}
+
+function digest {
+    cat $1/* | md5sum | cut -d ' ' -f 1
+}
+
+for ACC in "$@"; do
+    for MODE in "${MODES[@]}"; do
+        CELLS="$WORKDIR/cells"
+        BLOBS="$WORKDIR/blobs"
+        rm -rf $CELLS $BLOBS
+        mkdir -p $CELLS $BLOBS
+
+        T_CELLS=`elapsed "$TOOL $ACC $MODE -e $THREADS -O $CELLS -t $WORKDIR -f"`
+        T_BLOBS=`elapsed "$TOOL $ACC $MODE -e $THREADS -O $BLOBS -t $WORKDIR -f --blob-reads"`
+
+        if [ "`digest $CELLS`" != "`digest $BLOBS`" ]; then
+            echo "$ACC $MODE : output differs between the read-paths"
+            exit 3
+        fi
+        printf "%-12s %-18s cells %8.2fs  blobs %8.2fs  x%.2f\n" \
+            $ACC $MODE $T_CELLS $T_BLOBS `echo "$T_CELLS / $T_BLOBS" | bc -l`
+    done
+done
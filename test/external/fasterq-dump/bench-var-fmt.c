@@ -0,0 +1,308 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* Synopsis: micro-benchmark of the fasterq-dump defline formatting
+ * Usage:
+ *  bench-var-fmt [--verify] [<spots>]
+ *
+ * Every spot is formatted into a complete FASTQ/FASTA record, the way the
+ * flex-printer does it, with the default deflines and with a custom one:
+ *  - a reference that walks the template for every spot and prints the
+ *    numbers with snprintf ( the way the formats used to be applied )
+ *  - the compiled var_fmt, with the accession folded into the literals
+ * Any difference in the output is an error.
+ */
+
+#include "var_fmt.h"
+#include "dflt_defline.h"
+#include "bench.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the same indices the flex-printer uses */
+enum { sdi_acc = 0, sdi_sn, sdi_sg, sdi_rd1, sdi_rd2, sdi_qa, sdi_count };
+enum { idi_si = 0, idi_ri, idi_rl, idi_count };
+
+typedef struct Spot {
+    String name;
+    String group;
+    String read;
+    String qual;
+    uint64_t row_id;
+    uint32_t read_id;
+} Spot;
+
+typedef struct Case {
+    char const *name;
+    char const *seq_defline;
+    char const *qual_defline;   /* NULL for FASTA */
+    bool with_name;
+} Case;
+
+static char const *accession = "SRR1234567";
+static uint32_t seed = 12345;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) & 0xFFFFFF;
+}
+
+static void makeString(String *const dst, char *const text, size_t const len)
+{
+    StringInit(dst, text, len, (uint32_t)len);
+}
+
+static Spot *makeSpots(size_t const count, bool const with_name)
+{
+    static char const bases[] = "ACGT";
+    Spot *const spots = BenchAlloc(count * sizeof spots[0]);
+    size_t i;
+
+    for (i = 0; i < count; ++i) {
+        Spot *const s = &spots[i];
+        uint32_t const len = 36 + rnd() % 116;
+        char *const read = BenchAlloc(len);
+        char *const qual = BenchAlloc(len);
+        char *const name = BenchAlloc(64);
+        char *const group = BenchAlloc(16);
+        uint32_t j;
+        int n;
+
+        for (j = 0; j < len; ++j) {
+            read[j] = bases[rnd() % 4];
+            qual[j] = (char)(33 + 2 + rnd() % 39);
+        }
+        makeString(&s->read, read, len);
+        makeString(&s->qual, qual, len);
+        n = with_name ? snprintf(name, 64, "HWI-ST%u:%u:%u:%u:%u", 100 + rnd() % 900, 1 + rnd() % 8,
+                                 1101 + rnd() % 100, rnd() % 20000, rnd() % 200000) : 0;
+        makeString(&s->name, name, n);
+        n = snprintf(group, 16, "LIB%u", rnd() % 4);
+        makeString(&s->group, group, n);
+        s->row_id = 1 + i * 3 + rnd() % 3;
+        s->read_id = 1 + rnd() % 2;
+    }
+    return spots;
+}
+
+static void freeSpots(Spot *const spots, size_t const count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i) {
+        free((void *)spots[i].read.addr);
+        free((void *)spots[i].qual.addr);
+        free((void *)spots[i].name.addr);
+        free((void *)spots[i].group.addr);
+    }
+    free(spots);
+}
+
+static void makeTemplate(char *const dst, size_t const size, Case const *const c)
+{
+    if (c->qual_defline == NULL)
+        snprintf(dst, size, "%s\n$RD1\n", c->seq_defline);
+    else
+        snprintf(dst, size, "%s\n$RD1\n%s\n$QA\n", c->seq_defline, c->qual_defline);
+}
+
+/* the reference: look at every character of the template for every spot */
+static size_t appendText(char *const dst, size_t const pos, char const *const src, size_t const len)
+{
+    memmove(dst + pos, src, len);
+    return pos + len;
+}
+
+static size_t appendNumber(char *const dst, size_t const pos, uint64_t const value)
+{
+    return pos + snprintf(dst + pos, 21, "%lu", (unsigned long)value);
+}
+
+static size_t reference(char *const dst, char const *const tmpl, Spot const *const s)
+{
+    char const *p = tmpl;
+    size_t pos = 0;
+
+    while (*p) {
+        if (p[0] == '$') {
+            if (strncmp(p, "$ac", 3) == 0) { pos = appendText(dst, pos, accession, strlen(accession)); p += 3; continue; }
+            if (strncmp(p, "$sn", 3) == 0) {
+                pos = s->name.len > 0 ? appendText(dst, pos, s->name.addr, s->name.len) : appendNumber(dst, pos, s->row_id);
+                p += 3;
+                continue;
+            }
+            if (strncmp(p, "$sg", 3) == 0) { pos = appendText(dst, pos, s->group.addr, s->group.len); p += 3; continue; }
+            if (strncmp(p, "$si", 3) == 0) { pos = appendNumber(dst, pos, s->row_id); p += 3; continue; }
+            if (strncmp(p, "$ri", 3) == 0) { pos = appendNumber(dst, pos, s->read_id); p += 3; continue; }
+            if (strncmp(p, "$rl", 3) == 0) { pos = appendNumber(dst, pos, s->read.len); p += 3; continue; }
+            if (strncmp(p, "$RD1", 4) == 0) { pos = appendText(dst, pos, s->read.addr, s->read.len); p += 4; continue; }
+            if (strncmp(p, "$QA", 3) == 0) { pos = appendText(dst, pos, s->qual.addr, s->qual.len); p += 3; continue; }
+        }
+        dst[pos++] = *p++;
+    }
+    return pos;
+}
+
+static struct var_fmt_t *compile(char const *const tmpl)
+{
+    struct var_desc_list_t *const vdl = create_var_desc_list();
+    struct var_fmt_t *fmt = NULL;
+
+    if (vdl != NULL) {
+        String acc;
+
+        var_desc_list_add_str(vdl, "$ac", sdi_acc, 0xFF);
+        var_desc_list_add_str(vdl, "$sn", sdi_sn, idi_si);
+        var_desc_list_add_str(vdl, "$sg", sdi_sg, 0xFF);
+        var_desc_list_add_str(vdl, "$RD1", sdi_rd1, 0xFF);
+        var_desc_list_add_str(vdl, "$RD2", sdi_rd2, 0xFF);
+        var_desc_list_add_str(vdl, "$QA", sdi_qa, 0xFF);
+        var_desc_list_add_int(vdl, "$si", idi_si);
+        var_desc_list_add_int(vdl, "$ri", idi_ri);
+        var_desc_list_add_int(vdl, "$rl", idi_rl);
+
+        fmt = create_var_fmt_str(tmpl, vdl);
+        StringInitCString(&acc, accession);
+        var_fmt_set_const_str(fmt, sdi_acc, &acc);
+        release_var_desc_list(vdl);
+    }
+    return fmt;
+}
+
+static SBuffer_t *compiled(struct var_fmt_t *const fmt, Spot const *const s)
+{
+    String const *str_args[sdi_count];
+    uint64_t int_args[idi_count];
+
+    str_args[sdi_acc] = NULL;   /* folded into the format */
+    str_args[sdi_sn] = &s->name;
+    str_args[sdi_sg] = &s->group;
+    str_args[sdi_rd1] = &s->read;
+    str_args[sdi_rd2] = NULL;
+    str_args[sdi_qa] = &s->qual;
+    int_args[idi_si] = s->row_id;
+    int_args[idi_ri] = s->read_id;
+    int_args[idi_rl] = s->read.len;
+    return var_fmt_to_buffer(fmt, str_args, sdi_count, int_args, idi_count);
+}
+
+static size_t runCase(Case const *const c, Spot const *const spots, size_t const count, bool const verifyOnly)
+{
+    char tmpl[1024];
+    char *const out = BenchAlloc(4096);
+    struct var_fmt_t *const fmt = (makeTemplate(tmpl, sizeof tmpl, c), compile(tmpl));
+    size_t errors = 0;
+    size_t bytes = 0;
+    size_t i;
+
+    if (fmt == NULL) {
+        fprintf(stderr, "%s: cannot compile '%s'\n", c->name, tmpl);
+        exit(3);
+    }
+    for (i = 0; i < count; ++i) {
+        size_t const len = reference(out, tmpl, &spots[i]);
+        SBuffer_t const *const t = compiled(fmt, &spots[i]);
+
+        bytes += len;
+        if (t == NULL || t->S.len != len || memcmp(t->S.addr, out, len) != 0) {
+            if (errors++ < 10)
+                fprintf(stderr, "%s: spot %zu differs:\n%.*s---\n%.*s", c->name, i
+                        , (int)len, out, t ? (int)t->S.len : 0, t ? t->S.addr : "");
+        }
+    }
+    if (!verifyOnly) {
+        double start = BenchNow();
+        double refTime, fmtTime;
+        size_t sink = 0;
+
+        for (i = 0; i < count; ++i)
+            sink += reference(out, tmpl, &spots[i]);
+        refTime = BenchNow() - start;
+
+        start = BenchNow();
+        for (i = 0; i < count; ++i)
+            sink += compiled(fmt, &spots[i])->S.len;
+        fmtTime = BenchNow() - start;
+
+        printf("%-28s %8zu spots, %6.1f MB: template %7.1f ns/spot, compiled %7.1f ns/spot, x%.1f%s\n"
+               , c->name, count, bytes / 1e6
+               , refTime * 1e9 / count, fmtTime * 1e9 / count, refTime / fmtTime
+               , sink == 2 * bytes ? "" : " (size mismatch)");
+    }
+    release_var_fmt(fmt);
+    free(out);
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchArgs args;
+    size_t errors = 0;
+    Case cases[4];
+    Spot *named;
+    Spot *unnamed;
+    int i;
+
+    BenchArgsInit(&args, argc, argv, "spots", 1000000, 100000, 0);
+
+    cases[0].name = "default fastq, name";
+    cases[0].seq_defline = dflt_seq_defline(true, true, false, false);
+    cases[0].qual_defline = dflt_qual_defline(true, true, false);
+    cases[0].with_name = true;
+
+    cases[1].name = "default fastq split, no name";
+    cases[1].seq_defline = dflt_seq_defline(false, false, true, false);
+    cases[1].qual_defline = dflt_qual_defline(false, false, true);
+    cases[1].with_name = false;
+
+    cases[2].name = "default fasta, name";
+    cases[2].seq_defline = dflt_seq_defline(true, true, false, true);
+    cases[2].qual_defline = NULL;
+    cases[2].with_name = true;
+
+    cases[3].name = "custom fastq";
+    cases[3].seq_defline = "@$sn/$ri spot=$si group=$sg len=$rl";
+    cases[3].qual_defline = "+$ac:$si";
+    cases[3].with_name = true;
+
+    named = makeSpots(args.count, true);
+    unnamed = makeSpots(args.count, false);
+    for (i = 0; i < 4; ++i)
+        errors += runCase(&cases[i], cases[i].with_name ? named : unnamed, args.count, args.verify_only);
+    freeSpots(named, args.count);
+    freeSpots(unnamed, args.count);
+
+    if (errors) {
+        fprintf(stderr, "%zu spots differ between the template and the compiled format\n", errors);
+        return 1;
+    }
+    printf("template and compiled format agree\n");
+    return 0;
+}
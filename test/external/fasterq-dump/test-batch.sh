@@ -0,0 +1,49 @@
+#!/bin/bash
+#------------------------------------------------------------------------------------------
+#
+#   test: several accessions in one invocation ( batch mode )
+#
+#   usage: test-batch.sh <bin-dir> <tool-name>
+#
+#   local fixtures, a flat table and a cSRA database, are dumped one by one
+#   and then together in one batch sharing the thread budget;
+#   both ways have to produce the same, byte-identical files
+#
+#------------------------------------------------------------------------------------------
+
+BINDIR=$1
+TOOL="$BINDIR/$2"
+FIXTURES=( "../vdb-validate/db/SRR053990" "../vdb-validate/db/sdc_seq_cmp_read_len_fixed.csra" )
+MODES=( "--split-3" "--split-spot" )
+
+if [ ! -x "$TOOL" ]; then
+    echo "$TOOL not found"
+    exit 1
+fi
+
+WORKDIR=`mktemp -d test-batch.XXXXXX`
+trap "rm -rf $WORKDIR" EXIT
+
+for MODE in "${MODES[@]}"; do
+    SINGLE="$WORKDIR/single"
+    BATCH="$WORKDIR/batch"
+    rm -rf $SINGLE $BATCH
+    mkdir -p $SINGLE $BATCH
+
+    for ACC in "${FIXTURES[@]}"; do
+        $TOOL $ACC $MODE -e 4 -O $SINGLE -t $WORKDIR -f > /dev/null 2>&1 || { echo "$ACC $MODE : failed" ; exit 3 ; }
+    done
+
+    for CONCURRENT in 1 2; do
+        rm -rf $BATCH/*
+        $TOOL "${FIXTURES[@]}" $MODE -e 4 --concurrent $CONCURRENT -O $BATCH -t $WORKDIR -f > /dev/null 2>&1 \
+            || { echo "batch $MODE --concurrent $CONCURRENT : failed" ; exit 3 ; }
+
+        if ! diff -r $SINGLE $BATCH > /dev/null ; then
+            echo "batch $MODE --concurrent $CONCURRENT : output differs from single runs"
+            diff -rq $SINGLE $BATCH
+            exit 3
+        fi
+        echo "batch $MODE --concurrent $CONCURRENT : identical"
+    done
+done
@@ -0,0 +1,46 @@
+#!/bin/bash
+#------------------------------------------------------------------------------------------
+#
+#   test: cell-by-cell against blob-at-a-time column reads ( --blob-reads )
+#
+#   usage: test-blob-reads.sh <bin-dir> <tool-name>
+#
+#   local fixtures, a flat table and a cSRA database, are dumped in several
+#   modes twice, once per read-path; the outputs have to be byte-identical
+#
+#------------------------------------------------------------------------------------------
+
+BINDIR=$1
+TOOL="$BINDIR/$2"
+FIXTURES=( "../vdb-validate/db/SRR053990" "../vdb-validate/db/sdc_seq_cmp_read_len_fixed.csra" )
+MODES=( "--split-3" "--split-spot" "--concatenate-reads" "--fasta-unsorted" )
+
+if [ ! -x "$TOOL" ]; then
+    echo "$TOOL not found"
+    exit 1
+fi
+
+WORKDIR=`mktemp -d test-blob-reads.XXXXXX`
+trap "rm -rf $WORKDIR" EXIT
+
+for ACC in "${FIXTURES[@]}"; do
+    for MODE in "${MODES[@]}"; do
+        CELLS="$WORKDIR/cells"
+        BLOBS="$WORKDIR/blobs"
+        rm -rf $CELLS $BLOBS
+        mkdir -p $CELLS $BLOBS
+
+        $TOOL $ACC $MODE -e 4 -O $CELLS -t $WORKDIR -f > /dev/null 2>&1 || { echo "$ACC $MODE : failed" ; exit 3 ; }
+        $TOOL $ACC $MODE -e 4 -O $BLOBS -t $WORKDIR -f --blob-reads > /dev/null 2>&1 || { echo "$ACC $MODE --blob-reads : failed" ; exit 3 ; }
+
+        if ! diff -r $CELLS $BLOBS > /dev/null ; then
+            echo "$ACC $MODE : output differs between the read-paths"
+            exit 3
+        fi
+        if [ -z "`ls $CELLS`" ]; then
+            echo "$ACC $MODE : no output"
+            exit 3
+        fi
+        echo "$ACC $MODE : identical"
+    done
+done
@@ -5,6 +5,7 @@ from ngs.ReadCollection import ReadCollection
 from ngs.ReferenceSequence import ReferenceSequence
 from ngs.Alignment import Alignment
 from ngs.Read import Read
+from ngs.ReadBatch import ReadBatch
 
 PrimaryOnly           = "SRR1063272"
 WithSecondary         = "SRR833251"
@@ -123,6 +124,55 @@ class Tests(unittest.TestCase):
         self.assertTrue(readIt.nextRead())
         self.assertEqual(PrimaryOnly + ".R.2", readIt.getReadId())
 
+# ReadIterator.nextReadBatch
+
+    def test_ReadIterator_nextReadBatch(self):
+        batchIt = NGS.openReadCollection(PrimaryOnly).getReadRange(10, 5)
+        readIt = NGS.openReadCollection(PrimaryOnly).getReadRange(10, 5)
+        batch = ReadBatch(3)
+        total = 0
+        count = batchIt.nextReadBatch(batch)
+        while count > 0:
+            self.assertTrue(count <= 3)
+            self.assertEqual(count, len(batch))
+            for i in range(count):
+                self.assertTrue(readIt.nextRead())
+                self.assertEqual(readIt.getReadBases(), batch.getReadBases(i))
+                self.assertEqual(readIt.getReadQualities(), batch.getReadQualities(i))
+                self.assertEqual(readIt.getReadName(), batch.getReadName(i))
+            total += count
+            count = batchIt.nextReadBatch(batch)
+        self.assertEqual(5, total)
+        self.assertFalse(readIt.nextRead())
+
+    def test_ReadIterator_nextReadBatch_views(self):
+        readIt = NGS.openReadCollection(PrimaryOnly).getReadRange(10, 2)
+        read = getRead(PrimaryOnly + ".R.11")
+        batch = ReadBatch(2, names=False)
+        self.assertEqual(2, readIt.nextReadBatch(batch))
+        start = batch.seq_offsets[1]
+        end = start + batch.seq_lengths[1]
+        self.assertEqual(read.getReadBases(), bytes(batch.bases[start:end]).decode())
+        self.assertEqual(read.getReadQualities(), bytes(batch.qualities[start:end]).decode())
+        self.assertEqual(None, batch.names)
+
+    def test_ReadIterator_nextReadBatch_Full(self):
+        # a read that does not fit is returned by the next call
+        readIt = NGS.openReadCollection(PrimaryOnly).getReadRange(10, 5)
+        len10 = len(getRead(PrimaryOnly + ".R.10").getReadBases())
+        batch = ReadBatch(5, seq_capacity=len10)
+        self.assertEqual(1, readIt.nextReadBatch(batch))
+        self.assertTrue(readIt.nextRead())
+        self.assertEqual(PrimaryOnly + ".R.11", readIt.getReadId())
+
+    def test_ReadIterator_nextReadBatch_TooSmall(self):
+        readIt = NGS.openReadCollection(PrimaryOnly).getReadRange(10, 5)
+        try:
+            readIt.nextReadBatch(ReadBatch(5, seq_capacity=1))
+            self.fail()
+        except ErrorMsg:
+            pass
+
 
 # Read
 
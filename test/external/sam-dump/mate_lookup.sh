@@ -0,0 +1,133 @@
+#!/usr/bin/env bash
+
+# the goal of this test is to verify that sam-dump produces the same SAM-output
+# for primary alignments, regardless if the mates are resolved the usual way
+# or via precomputed lookup-files ( --mate-lookup ), every column is compared
+# with the sam-cmp-tool; the exception are the flags of unpaired aligned reads,
+# these follow the SAM-spec with --mate-lookup and are checked against it
+#
+# the test also uses the sam-factory-tool to produce a random cSRA-object
+# to be used in this test ( no dependecies on production-runs ! )
+#
+# the test also depends on the bam-load-tool and kar-tool to produce a cSRA-object
+#
+
+set -e
+
+source ./check_bin_tools.sh $1 $2
+
+SAMCMP="${TESTBINDIR}/sam-cmp"
+if [[ ! -x "$SAMCMP" ]]; then
+    echo "$SAMCMP - executable not found"
+    exit 3
+fi
+
+print_verbose "testing sam-dump with and without --mate-lookup"
+print_verbose "-------------------------------------------"
+
+#------------------------------------------------------------
+#produce a random sam-file
+
+RNDSAM="rnd_ml_sam.SAM"
+RNDREF="rnd_ml_ref.fasta"
+rm -f "$RNDSAM" "$RNDREF"
+
+#pairs on the same reference, pairs on 2 different references, half-aligned pairs
+#and unpaired aligned reads ( every name of a repeat is used only once )
+{
+    echo "r:type=random,name=R1,length=6000"
+    echo "r:type=random,name=R2,length=4000"
+    echo "ref-out:$RNDREF"
+    echo "sam-out:$RNDSAM"
+    for i in $(seq 1 20); do
+        echo "p:name=SAME$i,ref=R1"
+        echo "p:name=SAME$i,ref=R1,reverse=true"
+        echo "p:name=CROSS$i,ref=R1"
+        echo "p:name=CROSS$i,ref=R2"
+        echo "p:name=HALF$i,ref=R2"
+        echo "u:name=HALF$i,len=44"
+    done
+    echo "p:name=SINGLE,repeat=20"
+    echo "p:name=SINGLE_REV,ref=R2,reverse=true,repeat=20"
+} | $SAMFACTORY
+
+if [[ ! -f "$RNDSAM" || ! -f "$RNDREF" ]]; then
+    echo "random SAM-file or reference not produced"
+    exit 3
+fi
+
+print_verbose "random SAM-file produced!"
+
+RNDCSRA="rnd_ml_csra"
+source ./sam_to_csra.sh $RNDSAM $RNDREF $RNDCSRA
+rm $RNDSAM $RNDREF
+
+#------------------------------------------------------------
+#run sam-dump both ways
+LOOKUP_DIR="mate_lookup_tmp"
+rm -rf "$LOOKUP_DIR"
+mkdir "$LOOKUP_DIR"
+
+$SAMDUMP -1 -n $RNDCSRA > sam_dump_plain.SAM
+$SAMDUMP -1 -n --mate-lookup $LOOKUP_DIR $RNDCSRA > sam_dump_lookup.SAM
+
+#same alignments in the same order
+if ! diff <( cut -f1 sam_dump_plain.SAM ) <( cut -f1 sam_dump_lookup.SAM ) > /dev/null ; then
+    echo "sam-dump writes different alignments or a different order with --mate-lookup"
+    diff <( cut -f1 sam_dump_plain.SAM ) <( cut -f1 sam_dump_lookup.SAM ) | head -n 20
+    exit 3
+fi
+
+#the unpaired aligned reads get their flags from the SAM-spec with --mate-lookup:
+#no 0x1, 0x8, 0x40 or 0x80 for them, their other columns have to match
+grep "^SINGLE" sam_dump_plain.SAM > single_plain.SAM || true
+grep "^SINGLE" sam_dump_lookup.SAM > single_lookup.SAM || true
+grep -v "^SINGLE" sam_dump_plain.SAM > paired_plain.SAM || true
+grep -v "^SINGLE" sam_dump_lookup.SAM > paired_lookup.SAM || true
+
+if [[ $(wc -l < single_lookup.SAM) -ne 40 ]]; then
+    echo "unpaired aligned reads missing in the output of sam-dump --mate-lookup"
+    exit 3
+fi
+BAD_FLAGS=$(awk -F'\t' 'function bit( f, b ) { return int( f / b ) % 2 }
+    bit( $2, 1 ) || bit( $2, 8 ) || bit( $2, 64 ) || bit( $2, 128 ) || ( $1 ~ /REV/ ) != bit( $2, 16 )' single_lookup.SAM)
+if [[ -n "$BAD_FLAGS" ]]; then
+    echo "wrong flags for unpaired aligned reads with --mate-lookup:"
+    echo "$BAD_FLAGS" | head -n 10
+    exit 3
+fi
+
+#compare every column, including the optional fields, with sam-cmp
+function compare_columns {
+    local FIRST_COL=$1
+    local SAM_A=$2
+    local SAM_B=$3
+    local MAX_COL=$(awk -F'\t' '{ if ( NF > m ) m = NF } END { print m - 1 }' $SAM_A $SAM_B)
+    for COL in $(seq $FIRST_COL $MAX_COL); do
+        if ! $SAMCMP $SAM_A $SAM_B $COL 0 0 1 > sam_cmp.txt ; then
+            echo "column #$COL differs with --mate-lookup ( $SAM_A / $SAM_B )"
+            cat sam_cmp.txt
+            exit 3
+        fi
+        if grep -q "not-found" sam_cmp.txt ; then
+            echo "column #$COL missing with --mate-lookup ( $SAM_A / $SAM_B )"
+            cat sam_cmp.txt
+            exit 3
+        fi
+    done
+}
+
+compare_columns 1 paired_plain.SAM paired_lookup.SAM
+compare_columns 2 single_plain.SAM single_lookup.SAM
+
+#the lookup-files have to be removed by sam-dump
+if [[ -n "$(ls -A $LOOKUP_DIR)" ]]; then
+    echo "lookup-files not removed from $LOOKUP_DIR"
+    exit 3
+fi
+
+rm -rf sam_dump_plain.SAM sam_dump_lookup.SAM single_plain.SAM single_lookup.SAM \
+       paired_plain.SAM paired_lookup.SAM sam_cmp.txt "$LOOKUP_DIR" "$RNDCSRA"
+
+print_verbose "success!"
+print_verbose -e "--------\n"
@@ -0,0 +1,59 @@
+#!/bin/bash
+#------------------------------------------------------------------------------------------
+#
+#   benchmark: csv against the arrow-format ( -f arrow )
+#
+#   usage: bench-arrow.sh [ accession ... ]
+#
+#   every accession is dumped with the same columns in both formats,
+#   the wall-clock time and the size of the output is reported;
+#   if python3 with pyarrow is available, the arrow-stream is read back
+#   and its row-count compared with the number of csv-lines
+#
+#------------------------------------------------------------------------------------------
+
+TOOL="${TOOL:-vdb-dump}"
+COLUMNS="${COLUMNS:-READ,QUALITY,READ_LEN,READ_START}"
+
+if [ $# -eq 0 ]; then
+    set -- SRR000001
+fi
+
+WORKDIR=`mktemp -d bench-arrow.XXXXXX`
+trap "rm -rf $WORKDIR" EXIT
+
+function elapsed {
+    local START=`date +%s.%N`
+    eval "$1" 2> /dev/null
+    local RES=$?
+    local END=`date +%s.%N`
+    if [ $RES -ne 0 ]; then
+        echo "failed: $1" >&2
+        exit 3
+    fi
+    echo "$END - $START" | bc
+}
+
+VALIDATE=0
+if python3 -c "import pyarrow" > /dev/null 2>&1; then
+    VALIDATE=1
+fi
+
+for ACC in "$@"; do
+    CSV="$WORKDIR/$ACC.csv"
+    ARROW="$WORKDIR/$ACC.arrow"
+
+    T_CSV=`elapsed "$TOOL $ACC -C $COLUMNS -f csv > $CSV"`
+    T_ARROW=`elapsed "$TOOL $ACC -C $COLUMNS -f arrow > $ARROW"`
+
+    if [ $VALIDATE -eq 1 ]; then
+        ROWS=`python3 -c "import pyarrow.ipc as i; print( i.open_stream( open( '$ARROW', 'rb' ) ).read_all().num_rows )"`
+        LINES=`wc -l < $CSV`
+        if [ "$ROWS" != "$LINES" ]; then
+            echo "$ACC : arrow has $ROWS rows, csv has $LINES lines"
+            exit 3
+        fi
+    fi
+    printf "%-12s csv %8.2fs %12d bytes  arrow %8.2fs %12d bytes  x%.2f\n" \
+        $ACC $T_CSV `stat -c %s $CSV` $T_ARROW `stat -c %s $ARROW` `echo "$T_CSV / $T_ARROW" | bc -l`
+done
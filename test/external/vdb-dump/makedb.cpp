@@ -29,6 +29,7 @@
 */
 
 #include <fstream>
+#include <cstring>
 
 #include <vdb/manager.h>
 #include <vdb/schema.h>
@@ -196,6 +197,72 @@ NestedDatabase()
     return 0;
 }
 
+/* a plain table for the arrow-format: ascii, a list of I32 and a list of bool per row */
+rc_t
+ArrowTable()
+{
+    const string ScratchDir         = "./data/";
+    const string DefaultSchemaText  =
+        "table arrow_table #1.0.0\n"
+        "{\n"
+        " column ascii NAME;\n"
+        " column I32 COUNTS;\n"
+        " column bool FLAGS;\n"
+        "};\n"
+    ;
+    const string DefaultTable       = "arrow_table";
+
+    const char *    names[]     = { "alpha", "", "gamma", "d", "epsilon" };
+    const int32_t   counts[]    = { 1, 2, 3, -4, 2147483647, -2147483647 - 1, 0, 5 };
+    const uint32_t  counts_len[]= { 3, 0, 1, 2, 2 };
+    const uint8_t   flags[]     = { 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 0 };
+    const uint32_t  flags_len[] = { 3, 0, 9, 1, 2 };
+
+    VDBManager* mgr;
+    CHECK_RC ( VDBManagerMakeUpdate ( & mgr, NULL ) );
+    VSchema* schema;
+    CHECK_RC ( VDBManagerMakeSchema ( mgr, & schema ) );
+    CHECK_RC ( VSchemaParseText ( schema, NULL, DefaultSchemaText.c_str(), DefaultSchemaText.size() ) );
+
+    VTable *tab;
+    CHECK_RC ( VDBManagerCreateTable ( mgr,
+                                       & tab,
+                                       schema,
+                                       DefaultTable . c_str(),
+                                       kcmInit + kcmMD5,
+                                       "%s",
+                                       ( ScratchDir + "ArrowTable" ) . c_str() ) );
+    VCursor *curs;
+    CHECK_RC ( VTableCreateCursorWrite ( tab, & curs, kcmInsert ) ) ;
+    uint32_t name_idx, counts_idx, flags_idx;
+    CHECK_RC ( VCursorAddColumn ( curs, & name_idx, "NAME" ) );
+    CHECK_RC ( VCursorAddColumn ( curs, & counts_idx, "COUNTS" ) );
+    CHECK_RC ( VCursorAddColumn ( curs, & flags_idx, "FLAGS" ) );
+    CHECK_RC ( VCursorOpen ( curs ) );
+
+    const int32_t * count = counts;
+    const uint8_t * flag = flags;
+    for ( uint32_t i = 0; i < sizeof names / sizeof names[ 0 ]; ++i )
+    {
+        CHECK_RC ( VCursorSetRowId ( curs, i + 1 ) );
+        CHECK_RC ( VCursorOpenRow ( curs ) );
+        CHECK_RC ( VCursorWrite ( curs, name_idx, 8, names[ i ], 0, strlen( names[ i ] ) ) );
+        CHECK_RC ( VCursorWrite ( curs, counts_idx, 32, count, 0, counts_len[ i ] ) );
+        CHECK_RC ( VCursorWrite ( curs, flags_idx, 8, flag, 0, flags_len[ i ] ) );
+        CHECK_RC ( VCursorCommitRow ( curs ) );
+        CHECK_RC ( VCursorCloseRow ( curs ) );
+        count += counts_len[ i ];
+        flag += flags_len[ i ];
+    }
+    CHECK_RC ( VCursorCommit ( curs ) );
+
+    CHECK_RC ( VCursorRelease ( curs ) );
+    CHECK_RC ( VTableRelease ( tab ) );
+    CHECK_RC ( VSchemaRelease ( schema ) );
+    CHECK_RC ( VDBManagerRelease ( mgr ) );
+    return 0;
+}
+
 //////////////////////////////////////////// Main
 extern "C"
 {
@@ -223,7 +290,8 @@ rc_t CC KMain ( int argc, char *argv [] )
 {
     KConfigDisableUserSettings();
 
-    return NestedDatabase();
+    CHECK_RC ( NestedDatabase() );
+    return ArrowTable();
 }
 
 }
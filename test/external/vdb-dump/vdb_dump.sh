@@ -51,6 +51,29 @@ if [ "$res" != "0" ];
 	then echo "${vdb_dump_binary} 2.2 FAILED, res=$res output=$output" && exit 1;
 fi
 
+echo arrow format
+# the expected streams are little-endian, they can be read back with:
+#   python3 -c "import pyarrow.ipc as i; print( i.open_stream( open( 'expected/3.0.arrow', 'rb' ) ).read_all() )"
+ARROW_COLUMNS="-C NAME,COUNTS,FLAGS"
+output=$(${bin_dir}/${vdb_dump_binary} data/ArrowTable ${ARROW_COLUMNS} -f arrow > actual/3.0.arrow && cmp expected/3.0.arrow actual/3.0.arrow)
+res=$?
+if [ "$res" != "0" ];
+	then echo "${vdb_dump_binary} 3.0 FAILED, res=$res output=$output" && exit 1;
+fi
+
+output=$(${bin_dir}/${vdb_dump_binary} data/ArrowTable ${ARROW_COLUMNS} -f arrow -I > actual/3.1.arrow && cmp expected/3.1.arrow actual/3.1.arrow)
+res=$?
+if [ "$res" != "0" ];
+	then echo "${vdb_dump_binary} 3.1 FAILED, res=$res output=$output" && exit 1;
+fi
+
+# 5 rows in batches of 2 rows: the bool-bits and offsets restart in every batch
+output=$(${bin_dir}/${vdb_dump_binary} data/ArrowTable ${ARROW_COLUMNS} -f arrow --arrow-batch 2 > actual/3.2.arrow && cmp expected/3.2.arrow actual/3.2.arrow)
+res=$?
+if [ "$res" != "0" ];
+	then echo "${vdb_dump_binary} 3.2 FAILED, res=$res output=$output" && exit 1;
+fi
+
 rm -rf actual
 rm -rf data
 ./test_buffer_insufficient.sh ${bin_dir}/${vdb_dump_binary} VDB-3937.kar
@@ -6,7 +6,7 @@ tool_binary=$3
 
 echo "testing ${tool_binary}"
 
-rm -rf CSRA_file.cache
+rm -rf CSRA_file.cache CSRA_file.cache.mt
 echo "vdb/schema/paths = \"${VDB_INCDIR}\"" > tmp.kfg
 output=$(VDB_CONFIG=`pwd` ${DIRTOTEST}/${tool_binary} \
                            -t 10 --min-cache-count 1 CSRA_file CSRA_file.cache)
@@ -16,5 +16,21 @@ if [ "$res" != "0" ];
 fi
 ${DIRTOTEST}/vdb-validate CSRA_file.cache/ 2>&1 \
 | grep --quiet "is consistent" || exit 1
-rm tmp.kfg
-rm -rf CSRA_file.cache
+
+# the parallel builder has to produce the same cache as the sequential one
+output=$(VDB_CONFIG=`pwd` ${DIRTOTEST}/${tool_binary} \
+                           -t 10 --min-cache-count 1 --threads 4 CSRA_file CSRA_file.cache.mt)
+res=$?
+if [ "$res" != "0" ];
+	then echo "${tool_binary} --threads 4 FAILED, res=$res output=$output" && exit 1;
+fi
+${DIRTOTEST}/vdb-validate CSRA_file.cache.mt/ 2>&1 \
+| grep --quiet "is consistent" || exit 1
+VDB_CONFIG=`pwd` ${DIRTOTEST}/vdb-dump CSRA_file.cache > cache.txt || exit 1
+VDB_CONFIG=`pwd` ${DIRTOTEST}/vdb-dump CSRA_file.cache.mt > cache.mt.txt || exit 1
+if ! cmp -s cache.txt cache.mt.txt ; then
+	echo "${tool_binary} --threads 4 produced a different cache" && exit 1;
+fi
+
+rm tmp.kfg cache.txt cache.mt.txt
+rm -rf CSRA_file.cache CSRA_file.cache.mt
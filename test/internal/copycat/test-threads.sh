@@ -0,0 +1,20 @@
+#!/bin/bash
+
+bin_dir=$1
+tool_binary=$2
+FILE="1.xml"
+
+echo "testing ${tool_binary} catalog with md5 threads"
+mkdir -p actual/inline actual/threads
+rm -rf actual/inline/${FILE} actual/threads/${FILE}
+
+${bin_dir}/${tool_binary} --threads 0 input/${FILE} actual/inline/ > actual/inline.xml || exit 1
+${bin_dir}/${tool_binary} --threads 4 input/${FILE} actual/threads/ > actual/threads.xml || exit 1
+
+output=$(diff actual/inline.xml actual/threads.xml)
+res=$?
+if [ "$res" != "0" ];
+	then echo "${tool_binary} catalog differs with md5 threads, res=${res} output=${output}" && exit 1;
+fi
+
+echo "${tool_binary} catalog with md5 threads succeeded"
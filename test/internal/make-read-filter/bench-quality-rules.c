@@ -0,0 +1,213 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* Synopsis: micro-benchmark of the make-read-filter quality rules
+ * Usage:
+ *  bench-quality-rules [--verify] [<reads-per-profile>]
+ *
+ * The reads are generated to follow the quality profiles seen in the archive:
+ *  - binned (NovaSeq/HiSeq X): only the values 2, 12, 23, 37
+ *  - decaying (HiSeq 2000, GA II): full range, quality falling along the read
+ *  - low-quality tails: good reads ending in a run of Q2 ("B" tails)
+ *  - short reads, length <= 16, to exercise the scalar tail of the SIMD scan
+ * Every read is evaluated with the scalar and the SIMD scan; any disagreement
+ * is an error.
+ */
+
+#include "quality-rules.h"
+#include "bench.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct Reads {
+    char const *name;
+    uint8_t *qual;
+    uint32_t *len;
+    size_t *start;
+    size_t count;
+    size_t bases;
+} Reads;
+
+static uint32_t seed = 12345;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) & 0xFFFFFF;
+}
+
+static void binned(uint8_t *const qual, uint32_t const len)
+{
+    /* a good NovaSeq read: mostly 37, a few 23 and 12, Q2 at the end when the read fails */
+    bool const failing = rnd() % 10 == 0;
+    uint32_t const failAt = failing ? rnd() % len : len;
+    uint32_t i;
+
+    for (i = 0; i < len; ++i) {
+        uint32_t const r = rnd() % 100;
+        qual[i] = i >= failAt ? 2 : r < 85 ? 37 : r < 95 ? 23 : r < 99 ? 12 : 2;
+    }
+}
+
+static void decaying(uint8_t *const qual, uint32_t const len)
+{
+    /* starts around Q38, loses about 20 points over the read, noisy */
+    int const loss = 10 + (int)(rnd() % 25);
+    uint32_t i;
+
+    for (i = 0; i < len; ++i) {
+        int q = 38 - (int)(loss * i / len) + (int)(rnd() % 9) - 4;
+        qual[i] = q < 2 ? 2 : q > 41 ? 41 : q;
+    }
+}
+
+static void tailed(uint8_t *const qual, uint32_t const len)
+{
+    uint32_t const tail = rnd() % (len / 2 + 1);
+    uint32_t i;
+
+    decaying(qual, len);
+    for (i = len - tail; i < len; ++i)
+        qual[i] = 2;
+    if (rnd() % 4 == 0) {
+        uint32_t const head = rnd() % 16;
+        for (i = 0; i < head && i < len; ++i)
+            qual[i] = 2 + rnd() % 18;
+    }
+}
+
+static void makeReads(Reads *const reads, char const *const name, size_t const count, uint32_t const minLen, uint32_t const maxLen, void (*const profile)(uint8_t *, uint32_t))
+{
+    size_t i;
+    size_t bases = 0;
+
+    reads->name = name;
+    reads->count = count;
+    reads->len = BenchAlloc(count * sizeof(reads->len[0]));
+    reads->start = BenchAlloc(count * sizeof(reads->start[0]));
+    for (i = 0; i < count; ++i) {
+        reads->len[i] = minLen + rnd() % (maxLen - minLen + 1);
+        reads->start[i] = bases;
+        bases += reads->len[i];
+    }
+    reads->bases = bases;
+    reads->qual = BenchAlloc(bases);
+    for (i = 0; i < count; ++i)
+        profile(reads->qual + reads->start[i], reads->len[i]);
+}
+
+static void freeReads(Reads *const reads)
+{
+    free(reads->qual);
+    free(reads->start);
+    free(reads->len);
+}
+
+static size_t verify(Reads const *const reads)
+{
+    size_t errors = 0;
+    size_t i;
+
+    for (i = 0; i < reads->count; ++i) {
+        uint8_t const *const qual = reads->qual + reads->start[i];
+        uint32_t const len = reads->len[i];
+        QualityScan scalar;
+        QualityScan simd;
+
+        scanQualityScalar(&scalar, len, qual);
+        scanQuality(&simd, len, qual);
+        if (   scalar.under != simd.under
+            || scalar.firstgood != simd.firstgood
+            || scalar.lastgood != simd.lastgood
+            || applyRules(len, &scalar) != applyRules(len, &simd))
+        {
+            if (errors++ < 10)
+                fprintf(stderr, "%s: read %zu (length %u): scalar %u/%u/%u, simd %u/%u/%u\n"
+                        , reads->name, i, len
+                        , scalar.under, scalar.firstgood, scalar.lastgood
+                        , simd.under, simd.firstgood, simd.lastgood);
+        }
+    }
+    return errors;
+}
+
+static double timeIt(Reads const *const reads, void (*const scan)(QualityScan *, uint32_t, uint8_t const *), unsigned *const filtered)
+{
+    double const start = BenchNow();
+    unsigned count = 0;
+    size_t i;
+
+    for (i = 0; i < reads->count; ++i) {
+        uint32_t const len = reads->len[i];
+        QualityScan result;
+
+        scan(&result, len, reads->qual + reads->start[i]);
+        if (applyRules(len, &result) != keep)
+            ++count;
+    }
+    *filtered = count;
+    return BenchNow() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchArgs args;
+    size_t errors = 0;
+    Reads reads[4];
+    int i;
+
+    BenchArgsInit(&args, argc, argv, "reads-per-profile", 1000000, 100000, 0);
+
+    makeReads(&reads[0], "binned 151", args.count, 151, 151, binned);
+    makeReads(&reads[1], "decaying 36-101", args.count, 36, 101, decaying);
+    makeReads(&reads[2], "low-quality tails 250", args.count, 250, 250, tailed);
+    makeReads(&reads[3], "short 1-16", args.count, 1, 16, tailed);
+
+    printf("SIMD scan: %s\n", QUALITY_RULES_SSE2 ? "SSE2" : "none (scalar)");
+    for (i = 0; i < 4; ++i) {
+        errors += verify(&reads[i]);
+        if (!args.verify_only) {
+            unsigned scalarFiltered = 0;
+            unsigned simdFiltered = 0;
+            double const scalarTime = timeIt(&reads[i], scanQualityScalar, &scalarFiltered);
+            double const simdTime = timeIt(&reads[i], scanQuality, &simdFiltered);
+            double const gb = reads[i].bases / 1e9;
+
+            printf("%-22s %8zu reads, %5.1f%% filtered: scalar %6.2f GB/s, simd %6.2f GB/s, x%.1f\n"
+                   , reads[i].name, reads[i].count, 100.0 * scalarFiltered / reads[i].count
+                   , gb / scalarTime, gb / simdTime, scalarTime / simdTime);
+        }
+        freeReads(&reads[i]);
+    }
+    if (errors) {
+        fprintf(stderr, "%zu reads differ between the scalar and SIMD scans\n", errors);
+        return 1;
+    }
+    printf("scalar and SIMD scans agree\n");
+    return 0;
+}
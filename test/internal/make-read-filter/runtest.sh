@@ -17,3 +17,13 @@ ${BINDIR}/kdbmeta${BIN_SUFFIX} -u ${WORKDIR}/test-data -T SEQUENCE STATS READ_FI
 diff expected ${WORKDIR}/actual || exit 5
 diff expected.stats ${WORKDIR}/actual.stats || exit 6
 rm -rf ${WORKDIR}/test-data
+
+# the same with worker threads must give the same result;
+# small batches make the workers run through many of them and wrap the ring of slots
+${BINDIR}/kar${BIN_SUFFIX} -d ${WORKDIR}/test-data -x test-data.kar || exit 11
+${BINDIR}/make-read-filter${BIN_SUFFIX} --temp ${WORKDIR} --threads 4 --batch-rows 3 ${WORKDIR}/test-data || exit 12
+${BINDIR}/vdb-dump${BIN_SUFFIX} ${WORKDIR}/test-data >${WORKDIR}/actual || exit 13
+${BINDIR}/kdbmeta${BIN_SUFFIX} -u ${WORKDIR}/test-data -T SEQUENCE STATS READ_FILTER_CHANGES >${WORKDIR}/actual.stats || exit 14
+diff expected ${WORKDIR}/actual || exit 15
+diff expected.stats ${WORKDIR}/actual.stats || exit 16
+rm -rf ${WORKDIR}/test-data
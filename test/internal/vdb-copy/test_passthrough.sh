@@ -0,0 +1,47 @@
+#!/bin/bash
+
+BINDIR=$1
+WORKDIR=$2
+BIN_SUFFIX=$3
+
+SRC=${WORKDIR}/vdb-copy-src
+A1=${WORKDIR}/vdb-copy-cellwise
+A2=${WORKDIR}/vdb-copy-passthrough
+FLT=${WORKDIR}/vdb-copy-redact-spots
+
+rm -rf ${SRC} ${A1} ${A2} ${FLT}
+${BINDIR}/kar -d ${SRC} -x ../make-read-filter/test-data.kar || exit 1
+${BINDIR}/vdb-copy${BIN_SUFFIX} ${SRC} ${A1} || exit 2
+${BINDIR}/vdb-copy${BIN_SUFFIX} ${SRC} ${A2} --passthrough || exit 3
+${BINDIR}/vdb-diff ${A1} ${A2}
+RESULT="$?"
+rm -rf ${A1} ${A2}
+
+# with redacted rows --passthrough has to fall back to the cell-wise copy:
+# nothing of the redacted spots may be copied as it is
+if [ $RESULT -eq 0 ]; then
+    printf "1\n3\n" > ${FLT}
+    ${BINDIR}/read-filter-redact -F${FLT} ${SRC} > /dev/null 2>&1 || exit 4
+    ${BINDIR}/vdb-copy${BIN_SUFFIX} ${SRC} ${A1} || exit 5
+    ${BINDIR}/vdb-copy${BIN_SUFFIX} ${SRC} ${A2} --passthrough || exit 6
+    ${BINDIR}/vdb-diff ${A1} ${A2}
+    RESULT="$?"
+    if [ $RESULT -eq 0 ]; then
+        # the redacted spot is really redacted in the copy
+        ORIG=`${BINDIR}/vdb-dump ${SRC} -T SEQUENCE -R 3 -C READ -f tab`
+        COPY=`${BINDIR}/vdb-dump ${A2} -T SEQUENCE -R 3 -C READ -f tab`
+        if [ "$ORIG" = "$COPY" ]; then
+            echo "spot #3 is not redacted in the passthrough-copy"
+            RESULT=1
+        fi
+    fi
+fi
+rm -rf ${SRC} ${A1} ${A2} ${FLT}
+
+if [ $RESULT -eq 0 ]; then
+    echo "test (blob-passthrough copy) passed for $BINDIR/vdb-copy${BIN_SUFFIX}"
+else
+    echo "test (blob-passthrough copy) failed for $BINDIR/vdb-copy${BIN_SUFFIX}"
+fi
+
+exit $RESULT
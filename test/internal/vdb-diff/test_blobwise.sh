@@ -0,0 +1,26 @@
+#!/bin/sh
+BINDIR=$1
+ACCESSION=$2
+vdb_diff=$3
+
+rm -rf A1 A2 A3
+$BINDIR/vdb-copy $ACCESSION A1 -R 1-10
+$BINDIR/vdb-copy $ACCESSION A2 -R 1-10
+$BINDIR/vdb-copy $ACCESSION A3 -R 1,3-11
+
+$BINDIR/${vdb_diff} A1 A2 --blob-by-blob --threads 2
+RESULT_SAME="$?"
+$BINDIR/${vdb_diff} A1 A3 --blob-by-blob --threads 2
+RESULT_DIFF="$?"
+rm -rf A1 A2 A3
+
+if [ $RESULT_SAME -ne 0 ]; then
+    echo "test (blob-by-blob, compare identical objects) failed for $BINDIR/vdb-diff"
+    exit 3
+fi
+if [ $RESULT_DIFF -eq 0 ]; then
+    echo "test (blob-by-blob, compare NOT identical objects) failed for $BINDIR/vdb-diff"
+    exit 3
+fi
+echo "test (blob-by-blob) passed for $BINDIR/vdb-diff"
+exit 0
@@ -0,0 +1,265 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* Synopsis: throughput benchmark of the SAM record parsing in bam-load
+ * Usage:
+ *  bench-sam-parse [--verify] [<records>] [<threads>]
+ *
+ * A synthetic SAM file is written to $TMPDIR: 24 references, 150bp reads
+ * in pairs, mostly mapped with simple CIGARs, a few unmapped and clipped,
+ * NM/MD/AS/RG tags. It is read
+ *  - line by line with BAM_FileRead3, as bam-load did for SAM
+ *  - in batches with BAM_FileReadRecords, with BAM_FileDecodeRecord run
+ *    over each batch on <threads> threads, as bam-load does now
+ * The parsed records of both have to be the same, in the same order; any
+ * difference is an error.
+ */
+
+#include <klib/rc.h>
+#include <klib/data-buffer.h>
+#include <kfs/file.h>
+
+#include "bam.h"
+#include "bam-alignment.h"
+#include "bench.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BATCH_BYTES (4u * 1024u * 1024u)
+#define READ_LEN 150
+
+static uint32_t seed = 12345;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) & 0xFFFFFF;
+}
+
+static void makeSAM(FILE *const fp, size_t const count)
+{
+    static char const bases[] = "ACGT";
+    char seq[READ_LEN + 1];
+    char qual[READ_LEN + 1];
+    size_t i;
+    int j;
+
+    fprintf(fp, "@HD\tVN:1.6\tSO:unsorted\n");
+    for (j = 1; j <= 24; ++j)
+        fprintf(fp, "@SQ\tSN:chr%d\tLN:%u\n", j, 250000000u - j * 5000000u);
+    fprintf(fp, "@RG\tID:rg1\tSM:sample\tPL:ILLUMINA\n");
+
+    seq[READ_LEN] = qual[READ_LEN] = '\0';
+    for (i = 0; i < count; ++i) {
+        unsigned const ref = 1 + rnd() % 24;
+        unsigned const pos = 1 + rnd() % 200000000;
+        unsigned const kind = rnd() % 100;
+        bool const second = (i & 1) != 0;
+        unsigned const flag = 1 | 2 | (second ? 128 : 64) | (rnd() % 2 ? 16 : 32);
+
+        for (j = 0; j < READ_LEN; ++j) {
+            seq[j] = bases[rnd() % 4];
+            qual[j] = '#' + (j < READ_LEN - 10 ? 30 + rnd() % 8 : 2 + rnd() % 30);
+        }
+        fprintf(fp, "r%zu\t", i / 2);
+        if (kind < 3)
+            fprintf(fp, "%u\t*\t0\t0\t*\t*\t0\t0", (flag & ~2u) | 4);
+        else if (kind < 15)
+            fprintf(fp, "%u\tchr%u\t%u\t%u\t%uS%uM\t=\t%u\t%d", flag, ref, pos, rnd() % 60, 20u, READ_LEN - 20, pos + 300, second ? -450 : 450);
+        else if (kind < 25)
+            fprintf(fp, "%u\tchr%u\t%u\t%u\t70M2I%uM\t=\t%u\t%d", flag, ref, pos, rnd() % 60, READ_LEN - 72, pos + 300, second ? -450 : 450);
+        else
+            fprintf(fp, "%u\tchr%u\t%u\t60\t%uM\t=\t%u\t%d", flag, ref, pos, READ_LEN, pos + 300, second ? -450 : 450);
+        /* some lines end in CR-LF, both readers have to take them as LF */
+        fprintf(fp, "\t%s\t%s\tNM:i:%u\tMD:Z:%u%c%u\tAS:i:%u\tRG:Z:rg1%s", seq, qual, rnd() % 4, 40 + rnd() % 60, bases[rnd() % 4], 49u, 100 + rnd() % 50, i % 5 == 4 ? "\r\n" : "\n");
+    }
+}
+
+/* FNV-1a over the parsed records in order */
+static uint64_t hashRecord(uint64_t hash, BAM_Alignment const *const rec)
+{
+    uint8_t const *const data = (uint8_t const *)rec->data;
+    unsigned i;
+
+    for (i = 0; i < rec->datasize; ++i)
+        hash = (hash ^ data[i]) * 1099511628211u;
+    return hash;
+}
+
+static rc_t readSerial(char const *const path, uint64_t *const hash, size_t *const records)
+{
+    BAM_File const *bam = NULL;
+    rc_t rc = BAM_FileMake(&bam, NULL, NULL, "%s", path);
+
+    *hash = 14695981039346656037u;
+    *records = 0;
+    if (rc == 0) {
+        BAM_Alignment const *rec = NULL;
+
+        while ((rc = BAM_FileRead3(bam, &rec)) == 0) {
+            *hash = hashRecord(*hash, rec);
+            ++*records;
+            BAM_AlignmentRelease(rec);
+        }
+        BAM_FileRelease(bam);
+        if (GetRCObject(rc) == rcRow && GetRCState(rc) == rcNotFound)
+            rc = 0;
+    }
+    return rc;
+}
+
+typedef struct Batch {
+    BAM_File const *bam;
+    uint8_t const **record;
+    BAM_Alignment const **result;
+    rc_t *rc;
+    unsigned count;
+    unsigned threads;
+    unsigned thread;
+} Batch;
+
+static void *decodeSlice(void *const arg)
+{
+    Batch const *const self = arg;
+    unsigned i;
+
+    for (i = self->thread; i < self->count; i += self->threads)
+        self->rc[i] = BAM_FileDecodeRecord(self->bam, self->record[i], false, &self->result[i]);
+    return NULL;
+}
+
+static rc_t readBatched(char const *const path, unsigned const threads, uint64_t *const hash, size_t *const records)
+{
+    BAM_File const *bam = NULL;
+    KDataBuffer buffer;
+    rc_t rc = BAM_FileMake(&bam, NULL, NULL, "%s", path);
+
+    *hash = 14695981039346656037u;
+    *records = 0;
+    if (rc) return rc;
+    rc = KDataBufferMakeBytes(&buffer, 0);
+    while (rc == 0) {
+        unsigned count = 0;
+        rc_t const rc_read = BAM_FileReadRecords(bam, &buffer, BATCH_BYTES, &count);
+        uint8_t const **const record = malloc(count * sizeof(record[0]) + 1);
+        BAM_Alignment const **const result = calloc(count + 1, sizeof(result[0]));
+        rc_t *const rcs = calloc(count + 1, sizeof(rcs[0]));
+        Batch *const slice = calloc(threads, sizeof(slice[0]));
+        pthread_t *const tid = calloc(threads, sizeof(tid[0]));
+        uint8_t const *p = buffer.base;
+        unsigned i;
+
+        if (record == NULL || result == NULL || rcs == NULL || slice == NULL || tid == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(3);
+        }
+        for (i = 0; i < count; ++i) {
+            record[i] = p;
+            /* the top bit of the length marks SAM text */
+            p += 4 + (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)(p[3] & 0x7F) << 24));
+        }
+        for (i = 0; i < threads; ++i) {
+            Batch const init = { bam, record, result, rcs, count, threads, i };
+            slice[i] = init;
+            pthread_create(&tid[i], NULL, decodeSlice, &slice[i]);
+        }
+        for (i = 0; i < threads; ++i)
+            pthread_join(tid[i], NULL);
+        for (i = 0; i < count; ++i) {
+            if (rc == 0 && rcs[i] != 0)
+                rc = rcs[i];
+            if (rc == 0) {
+                *hash = hashRecord(*hash, result[i]);
+                ++*records;
+            }
+            BAM_AlignmentRelease(result[i]);
+        }
+        free(tid); free(slice); free(rcs); free(result); free(record);
+        if (rc == 0)
+            rc = rc_read;
+    }
+    KDataBufferWhack(&buffer);
+    BAM_FileRelease(bam);
+    if (GetRCObject(rc) == rcRow && GetRCState(rc) == rcNotFound)
+        rc = 0;
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchArgs args;
+    size_t count;
+    unsigned threads;
+    char const *const tmpdir = getenv("TMPDIR");
+    char path[4096];
+    uint64_t serialHash, batchedHash;
+    size_t serialRecords, batchedRecords;
+    double start, serialTime, batchedTime, mb;
+    rc_t rc;
+    int fd;
+    FILE *fp;
+
+    BenchArgsInit(&args, argc, argv, "records", 2000000, 20000, 4);
+    count = args.count;
+    threads = args.threads;
+
+    snprintf(path, sizeof(path), "%s/bench-sam-parse.XXXXXX", tmpdir ? tmpdir : "/tmp");
+    fd = mkstemp(path);
+    if (fd < 0 || (fp = fdopen(fd, "w")) == NULL) {
+        fprintf(stderr, "can't create %s\n", path);
+        return 3;
+    }
+    makeSAM(fp, count);
+    mb = ftell(fp) / 1e6;
+    fclose(fp);
+
+    start = BenchNow();
+    rc = readSerial(path, &serialHash, &serialRecords);
+    serialTime = BenchNow() - start;
+    if (rc == 0) {
+        start = BenchNow();
+        rc = readBatched(path, threads, &batchedHash, &batchedRecords);
+        batchedTime = BenchNow() - start;
+    }
+    unlink(path);
+    if (rc) {
+        fprintf(stderr, "reading the SAM file failed: rc = %u\n", (unsigned)rc);
+        return 3;
+    }
+    if (!args.verify_only)
+        printf("%zu records, %.1f MB: line by line %6.1f MB/s, batches on %u threads %6.1f MB/s, x%.2f\n"
+               , serialRecords, mb, mb / serialTime, threads, mb / batchedTime, serialTime / batchedTime);
+    if (serialRecords != count || batchedRecords != serialRecords || batchedHash != serialHash) {
+        fprintf(stderr, "the parsed records differ: %zu records line by line, %zu in batches\n", serialRecords, batchedRecords);
+        return 1;
+    }
+    printf("line by line and batched parsing agree\n");
+    return 0;
+}
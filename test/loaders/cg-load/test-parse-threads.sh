@@ -0,0 +1,52 @@
+#!/bin/bash
+# cg-load --parse-threads N has to produce the same database as the serial load
+
+VDB_INCDIR=$1
+DIRTOTEST=$2
+
+WORKDIR=`mktemp -d ${TMPDIR:-/tmp}/cg-load-parse-threads.XXXXXX`
+trap "rm -rf $WORKDIR" EXIT
+
+echo "vdb/schema/paths = \"${VDB_INCDIR}\"" > $WORKDIR/tmp.kfg
+
+# synthetic reads files, one reads group per slide/lane;
+# more records than a parse batch holds, no mappings: both halves unmapped
+mkdir -p $WORKDIR/MAP
+for GROUP in 1 2 3; do
+	awk -v slide=GS0000${GROUP}-FS3 -v lane=L0${GROUP} -v seed=${GROUP} 'BEGIN {
+		printf "#ASSEMBLY_ID\tGS00000-DNA_A01\n"
+		printf "#BATCH_FILE_NUMBER\t1\n"
+		printf "#FORMAT_VERSION\t1.3\n"
+		printf "#LANE\t%s\n", lane
+		printf "#SLIDE\t%s\n", slide
+		printf "#TYPE\tREADS\n"
+		printf "\n>flags\treads\tscores\n"
+		x = seed
+		for (i = 0; i < 5000 + 1000 * seed; ++i) {
+			reads = ""; scores = ""
+			for (j = 0; j < 70; ++j) {
+				x = (x * 69069 + 1) % 4294967296
+				reads = reads substr("ACGT", int(x / 65536) % 4 + 1, 1)
+				scores = scores sprintf("%c", 35 + int(x / 256) % 40)
+			}
+			printf "%d\t%s\t%s\n", (i % 2 ? 5 : 10), reads, scores
+		}
+	}' > $WORKDIR/MAP/reads_GS0000${GROUP}-FS3_L0${GROUP}_001.tsv
+done
+
+output=$(VDB_CONFIG=$WORKDIR ${DIRTOTEST}/cg-load -m $WORKDIR/MAP -o $WORKDIR/serial 2>&1)
+res=$?
+if [ "$res" != "0" ];
+	then echo "cg-load FAILED, res=$res output=$output" && exit 1;
+fi
+output=$(VDB_CONFIG=$WORKDIR ${DIRTOTEST}/cg-load --parse-threads 2 -m $WORKDIR/MAP -o $WORKDIR/parallel 2>&1)
+res=$?
+if [ "$res" != "0" ];
+	then echo "cg-load --parse-threads 2 FAILED, res=$res output=$output" && exit 1;
+fi
+
+VDB_CONFIG=$WORKDIR ${DIRTOTEST}/vdb-diff $WORKDIR/serial $WORKDIR/parallel
+if [ "$?" != "0" ];
+	then echo "cg-load --parse-threads 2 produced a different database" && exit 1;
+fi
+echo "cg-load --parse-threads 2 and serial load agree"
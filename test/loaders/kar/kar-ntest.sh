@@ -227,6 +227,35 @@ do
     fi
 done
 
+##
+## Extracting and re-creating the local archive with several threads
+## must give the same files, and byte-identical archives
+##
+OUT3=$VOTCHINA/d3
+multi_bark $KAR_B --threads 4 --extract $POUT --directory $OUT3
+
+echo "## Comparing threaded extract"
+for i in `cd $OUT2; find . -type f`
+do
+    cmp $OUT2/$i $OUT3/$i >/dev/null 2>&1
+    if [ $? -ne 0 ]
+    then
+        echo Error: sequentially and concurrently un-karred datasets are different >&2
+        exit 1
+    fi
+done
+
+multi_bark $KAR_B --create $VOTCHINA/seq.sra --directory $OUT2
+multi_bark $KAR_B --threads 4 --md5 --create $VOTCHINA/thr.sra --directory $OUT2
+multi_bark cmp $VOTCHINA/seq.sra $VOTCHINA/thr.sra
+
+echo "## Comparing md5 of threaded create"
+if [ "`md5sum $VOTCHINA/thr.sra | cut -d' ' -f1`" != "`cut -d' ' -f1 $VOTCHINA/thr.sra.md5`" ]
+then
+    echo Error: md5 file of concurrently created archive is wrong >&2
+    exit 1
+fi
+
 ##
 ## Everything is OK
 ##
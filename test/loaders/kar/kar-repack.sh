@@ -0,0 +1,138 @@
+#!/bin/bash
+# ===========================================================================
+#
+#                            PUBLIC DOMAIN NOTICE
+#               National Center for Biotechnology Information
+#
+#  This software/database is a "United States Government Work" under the
+#  terms of the United States Copyright Act.  It was written as part of
+#  the author's official duties as a United States Government employee and
+#  thus cannot be copyrighted.  This software/database is freely available
+#  to the public for use. The National Library of Medicine and the U.S.
+#  Government have not placed any restriction on its use or reproduction.
+#
+#  Although all reasonable efforts have been taken to ensure the accuracy
+#  and reliability of the software and data, the NLM and the U.S.
+#  Government do not and cannot warrant the performance or results that
+#  may be obtained by using this software or data. The NLM and the U.S.
+#  Government disclaim all warranties, express or implied, including
+#  warranties of performance, merchantability or fitness for any particular
+#  purpose.
+#
+#  Please cite the author in any work or product based on this material.
+#
+
+# set -x
+
+#####
+#### This script tests 'kar+ --repack', creating an archive straight from
+### another one: all members, members filtered by 'drop', and a directory
+## extracted from the archive and then edited
+#
+
+echo "## TEST INIT"
+
+multi_bark ()
+{
+    CMD="$@"
+    if [ -z "$CMD" ]
+    then
+        echo Error: no command defined >&2
+        exit 1
+    fi
+
+    echo "## $CMD"
+    eval "$CMD"
+    if [ $? -ne 0 ]
+    then
+        echo Error: command failed \"$CMD\" >&2
+        exit 1
+    fi
+}
+
+if [ $# -ne 1 ]
+then
+    echo "Syntax: `basename $0` path_to_kar+_utility" >&2
+    exit 1
+fi
+
+KAR_B=$1
+if [ ! -x "$KAR_B" ]
+then
+    echo Error: can not stat executable \'$KAR_B\' >&2
+    exit 1
+fi
+
+BASEDIR=$( pwd )
+VOTCHINA=$BASEDIR/votchina-repack
+
+clean_up ()
+{
+    if [ -d "$VOTCHINA" ]
+    then
+        multi_bark chmod -R u+w $VOTCHINA
+        multi_bark rm -rf $VOTCHINA
+    fi
+}
+
+clean_up
+multi_bark mkdir $VOTCHINA
+
+##
+## The original archive, from a copy of the source tree
+##
+SRC=$VOTCHINA/src
+multi_bark cp -rp $BASEDIR/source $SRC
+multi_bark $KAR_B --create $VOTCHINA/orig.kar --directory $SRC
+
+##
+## All members streamed across
+##
+echo "## Repacking all members"
+multi_bark $KAR_B --create $VOTCHINA/all.kar --repack $VOTCHINA/orig.kar
+multi_bark $KAR_B --extract $VOTCHINA/all.kar --directory $VOTCHINA/all
+multi_bark diff -r $SRC $VOTCHINA/all
+
+##
+## Dropped members are left out, the others are the same
+##
+echo "## Repacking with drop"
+multi_bark $KAR_B --create $VOTCHINA/drop.kar --repack $VOTCHINA/orig.kar --drop d2 --drop f3
+multi_bark $KAR_B --extract $VOTCHINA/drop.kar --directory $VOTCHINA/drop
+if [ -e "$VOTCHINA/drop/d2" -o -e "$VOTCHINA/drop/f3" ]
+then
+    echo Error: dropped members are in repacked archive >&2
+    exit 1
+fi
+multi_bark rm -rf $SRC/d2 $SRC/f3
+multi_bark diff -r $SRC $VOTCHINA/drop
+
+##
+## The directory defines the contents: new and edited files are read from
+## it, removed ones are left out, unchanged ones come from the archive
+##
+echo "## Repacking with directory"
+EDIT=$VOTCHINA/edit
+multi_bark $KAR_B --extract $VOTCHINA/orig.kar --directory $EDIT
+multi_bark chmod -R u+w $EDIT
+multi_bark rm -f $EDIT/d1/d1f3
+multi_bark "echo new file > $EDIT/d3/new"
+multi_bark "sed 's/./X/' $EDIT/f2 > $EDIT/f2.tmp"
+multi_bark mv $EDIT/f2.tmp $EDIT/f2
+multi_bark cp $EDIT/d1/d1f2 $VOTCHINA/d1f2.orig
+multi_bark "sed 's/./X/' $EDIT/d1/d1f2 > $EDIT/d1/d1f2.tmp"
+multi_bark touch -r $VOTCHINA/d1f2.orig $EDIT/d1/d1f2.tmp
+multi_bark mv $EDIT/d1/d1f2.tmp $EDIT/d1/d1f2
+
+multi_bark $KAR_B --create $VOTCHINA/edit.kar --repack $VOTCHINA/orig.kar --directory $EDIT
+multi_bark $KAR_B --extract $VOTCHINA/edit.kar --directory $VOTCHINA/edited
+
+## d1/d1f2 has the size and the time of the archived one, so it is taken
+## from the archive, not from the directory
+multi_bark cmp $VOTCHINA/d1f2.orig $VOTCHINA/edited/d1/d1f2
+multi_bark cp -p $VOTCHINA/d1f2.orig $EDIT/d1/d1f2
+multi_bark diff -r $EDIT $VOTCHINA/edited
+
+echo "## TEST PASSED"
+
+clean_up
@@ -0,0 +1,408 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* Synopsis: writes a small synthetic PacBio bax.h5 file for the pacbio-load tests
+ * Usage:
+ *  make-bax <output-file> [<zmws>]
+ *
+ * It has every group/dataset pacbio-load reads: BaseCalls with its ZMW,
+ * ZMWMetrics and Regions, ConsensusBaseCalls with ZMW and Passes. The reads
+ * are random, with a fixed seed, of length 0 to 127; the default number of
+ * ZMWs spans several ZMW_BLOCK_SIZE blocks of the loader.
+ */
+
+#include <hdf5.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t seed = 0x9e3779b9;
+
+static uint32_t rnd( void )
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+
+static void * allocate( size_t size )
+{
+    void * res = calloc( 1, size > 0 ? size : 1 );
+    if ( res == NULL )
+    {
+        fprintf( stderr, "out of memory\n" );
+        exit( 3 );
+    }
+    return res;
+}
+
+
+static hid_t make_group( hid_t loc, const char * name )
+{
+    hid_t grp = H5Gcreate2( loc, name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+    if ( grp < 0 )
+    {
+        fprintf( stderr, "cannot create group '%s'\n", name );
+        exit( 1 );
+    }
+    return grp;
+}
+
+
+/* a 1-dimensional dataset if cols == 0, a 2-dimensional one otherwise */
+static hid_t write_dataset( hid_t loc, const char * name, hid_t type,
+                            hsize_t rows, hsize_t cols, const void * data )
+{
+    hsize_t dims[ 2 ] = { rows, cols };
+    hid_t space = H5Screate_simple( cols == 0 ? 1 : 2, dims, NULL );
+    hid_t ds = H5Dcreate2( loc, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+    if ( ds < 0 || ( rows > 0 && H5Dwrite( ds, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data ) < 0 ) )
+    {
+        fprintf( stderr, "cannot write dataset '%s'\n", name );
+        exit( 1 );
+    }
+    H5Sclose( space );
+    return ds;
+}
+
+
+static void dataset( hid_t loc, const char * name, hid_t type,
+                     hsize_t rows, hsize_t cols, const void * data )
+{
+    H5Dclose( write_dataset( loc, name, type, rows, cols, data ) );
+}
+
+
+static void write_strings_attr( hid_t loc, const char * name, const char ** values, hsize_t count )
+{
+    hid_t type = H5Tcopy( H5T_C_S1 );
+    hid_t space = H5Screate_simple( 1, &count, NULL );
+    hid_t attr;
+
+    H5Tset_size( type, H5T_VARIABLE );
+    attr = H5Acreate2( loc, name, type, space, H5P_DEFAULT, H5P_DEFAULT );
+    if ( attr < 0 || H5Awrite( attr, type, values ) < 0 )
+    {
+        fprintf( stderr, "cannot write attribute '%s'\n", name );
+        exit( 1 );
+    }
+    H5Aclose( attr );
+    H5Sclose( space );
+    H5Tclose( type );
+}
+
+
+typedef struct zmws
+{
+    uint32_t count;
+    uint64_t bases;
+    uint32_t * HoleNumber;
+    uint8_t  * HoleStatus;
+    int16_t  * HoleXY;
+    uint32_t * NumEvent;
+} zmws;
+
+
+static void make_zmws( zmws * z, uint32_t count )
+{
+    uint32_t i;
+
+    z->count = count;
+    z->bases = 0;
+    z->HoleNumber = allocate( count * sizeof z->HoleNumber[ 0 ] );
+    z->HoleStatus = allocate( count * sizeof z->HoleStatus[ 0 ] );
+    z->HoleXY     = allocate( count * 2 * sizeof z->HoleXY[ 0 ] );
+    z->NumEvent   = allocate( count * sizeof z->NumEvent[ 0 ] );
+    for ( i = 0; i < count; ++i )
+    {
+        z->HoleNumber[ i ] = i;
+        z->HoleStatus[ i ] = ( rnd() % 16 == 0 ) ? 1 : 0;
+        z->HoleXY[ i * 2 ]     = ( int16_t )( i / 128 ) - 64;
+        z->HoleXY[ i * 2 + 1 ] = ( int16_t )( i % 128 ) - 64;
+        z->NumEvent[ i ] = ( rnd() % 8 == 0 ) ? 0 : rnd() % 128;
+        z->bases += z->NumEvent[ i ];
+    }
+}
+
+
+static void write_zmws( hid_t loc, const zmws * z )
+{
+    hid_t grp = make_group( loc, "ZMW" );
+    dataset( grp, "HoleNumber", H5T_NATIVE_UINT32, z->count, 0, z->HoleNumber );
+    dataset( grp, "HoleStatus", H5T_NATIVE_UINT8, z->count, 0, z->HoleStatus );
+    dataset( grp, "HoleXY", H5T_NATIVE_INT16, z->count, 2, z->HoleXY );
+    dataset( grp, "NumEvent", H5T_NATIVE_UINT32, z->count, 0, z->NumEvent );
+    H5Gclose( grp );
+}
+
+
+static void write_u8( hid_t loc, const char * name, uint64_t count, const char * alphabet )
+{
+    uint8_t * data = allocate( count );
+    size_t n = strlen( alphabet );
+    uint64_t i;
+
+    for ( i = 0; i < count; ++i )
+        data[ i ] = ( n > 0 ) ? ( uint8_t )alphabet[ rnd() % n ] : rnd() % 41;
+    dataset( loc, name, H5T_NATIVE_UINT8, count, 0, data );
+    free( data );
+}
+
+
+static void write_flags( hid_t loc, const char * name, uint64_t count )
+{
+    uint8_t * data = allocate( count );
+    uint64_t i;
+
+    for ( i = 0; i < count; ++i )
+        data[ i ] = rnd() % 2;
+    dataset( loc, name, H5T_NATIVE_UINT8, count, 0, data );
+    free( data );
+}
+
+
+static void write_u16( hid_t loc, const char * name, uint64_t count )
+{
+    uint16_t * data = allocate( count * sizeof data[ 0 ] );
+    uint64_t i;
+
+    for ( i = 0; i < count; ++i )
+        data[ i ] = rnd() % 1000;
+    dataset( loc, name, H5T_NATIVE_UINT16, count, 0, data );
+    free( data );
+}
+
+
+static void write_u32_ascending( hid_t loc, const char * name, uint64_t count )
+{
+    uint32_t * data = allocate( count * sizeof data[ 0 ] );
+    uint64_t i;
+    uint32_t value = 0;
+
+    for ( i = 0; i < count; ++i )
+    {
+        value += 1 + rnd() % 3;
+        data[ i ] = value;
+    }
+    dataset( loc, name, H5T_NATIVE_UINT32, count, 0, data );
+    free( data );
+}
+
+
+static void write_f32( hid_t loc, const char * name, uint64_t rows, hsize_t cols )
+{
+    uint64_t count = rows * ( cols == 0 ? 1 : cols );
+    float * data = allocate( count * sizeof data[ 0 ] );
+    uint64_t i;
+
+    for ( i = 0; i < count; ++i )
+        data[ i ] = ( float )( rnd() % 100000 ) / 1000.0f;
+    dataset( loc, name, H5T_NATIVE_FLOAT, rows, cols, data );
+    free( data );
+}
+
+
+/* the columns common to BaseCalls and ConsensusBaseCalls */
+static void write_basecalls_cmn( hid_t grp, const zmws * z )
+{
+    write_zmws( grp, z );
+    write_u8( grp, "Basecall", z->bases, "ACGT" );
+    write_u8( grp, "QualityValue", z->bases, "" );
+    write_u8( grp, "DeletionQV", z->bases, "" );
+    write_u8( grp, "DeletionTag", z->bases, "ACGTN" );
+    write_u8( grp, "InsertionQV", z->bases, "" );
+    write_u8( grp, "SubstitutionQV", z->bases, "" );
+    write_u8( grp, "SubstitutionTag", z->bases, "ACGTN" );
+}
+
+
+static void write_basecalls( hid_t pulse, const zmws * z )
+{
+    hid_t grp = make_group( pulse, "BaseCalls" );
+    write_basecalls_cmn( grp, z );
+    write_u16( grp, "PreBaseFrames", z->bases );
+    write_u32_ascending( grp, "PulseIndex", z->bases );
+    write_u16( grp, "WidthInFrames", z->bases );
+    H5Gclose( grp );
+}
+
+
+static void write_metrics( hid_t pulse, const zmws * z )
+{
+    hid_t grp = make_group( pulse, "BaseCalls/ZMWMetrics" );
+    uint8_t * productivity = allocate( z->count );
+    uint32_t i;
+
+    write_f32( grp, "BaseFraction", z->count, 4 );
+    write_f32( grp, "BaseIpd", z->count, 0 );
+    write_f32( grp, "BaseRate", z->count, 0 );
+    write_f32( grp, "BaseWidth", z->count, 0 );
+    write_f32( grp, "CmBasQv", z->count, 4 );
+    write_f32( grp, "CmDelQv", z->count, 4 );
+    write_f32( grp, "CmInsQv", z->count, 4 );
+    write_f32( grp, "CmSubQv", z->count, 4 );
+    write_f32( grp, "LocalBaseRate", z->count, 0 );
+    write_f32( grp, "DarkBaseRate", z->count, 0 );
+    write_f32( grp, "HQRegionStartTime", z->count, 0 );
+    write_f32( grp, "HQRegionEndTime", z->count, 0 );
+    write_f32( grp, "HQRegionSNR", z->count, 4 );
+    write_f32( grp, "ReadScore", z->count, 0 );
+    write_f32( grp, "RmBasQv", z->count, 0 );
+    write_f32( grp, "RmDelQv", z->count, 0 );
+    write_f32( grp, "RmInsQv", z->count, 0 );
+    write_f32( grp, "RmSubQv", z->count, 0 );
+    for ( i = 0; i < z->count; ++i )
+        productivity[ i ] = rnd() % 3;
+    dataset( grp, "Productivity", H5T_NATIVE_UINT8, z->count, 0, productivity );
+    free( productivity );
+    H5Gclose( grp );
+}
+
+
+/* every read gets a HQRegion over its whole length,
+   the longer ones an adapter in the middle with an insert on either side */
+static void write_regions( hid_t pulse, const zmws * z )
+{
+    static const char * types[] = { "Adapter", "Insert", "HQRegion" };
+    enum { rgn_adapter = 0, rgn_insert, rgn_hq };
+    int32_t * rows = allocate( z->count * 4 * 5 * sizeof rows[ 0 ] );
+    uint32_t i, count = 0;
+    hid_t ds;
+
+    for ( i = 0; i < z->count; ++i )
+    {
+        int32_t len = z->NumEvent[ i ];
+        int32_t * r = &rows[ count * 5 ];
+
+        r[ 0 ] = i; r[ 1 ] = rgn_hq; r[ 2 ] = 0; r[ 3 ] = len; r[ 4 ] = 700 + rnd() % 300;
+        ++count;
+        if ( len >= 60 )
+        {
+            int32_t mid = len / 2;
+            r += 5;
+            r[ 0 ] = i; r[ 1 ] = rgn_insert; r[ 2 ] = 0; r[ 3 ] = mid - 10; r[ 4 ] = -1;
+            r += 5;
+            r[ 0 ] = i; r[ 1 ] = rgn_adapter; r[ 2 ] = mid - 10; r[ 3 ] = mid + 10; r[ 4 ] = rnd() % 1000;
+            r += 5;
+            r[ 0 ] = i; r[ 1 ] = rgn_insert; r[ 2 ] = mid + 10; r[ 3 ] = len; r[ 4 ] = -1;
+            count += 3;
+        }
+    }
+    ds = write_dataset( pulse, "Regions", H5T_NATIVE_INT32, count, 5, rows );
+    write_strings_attr( ds, "RegionTypes", types, 3 );
+    H5Dclose( ds );
+    free( rows );
+}
+
+
+static void write_consensus( hid_t pulse, const zmws * z )
+{
+    hid_t grp = make_group( pulse, "ConsensusBaseCalls" );
+    hid_t passes = make_group( grp, "Passes" );
+    uint32_t * num_passes = allocate( z->count * sizeof num_passes[ 0 ] );
+    uint32_t * num_bases;
+    uint32_t * start_base;
+    uint64_t total = 0, i;
+
+    write_basecalls_cmn( grp, z );
+
+    for ( i = 0; i < z->count; ++i )
+    {
+        num_passes[ i ] = ( z->NumEvent[ i ] > 0 ) ? 1 + rnd() % 5 : 0;
+        total += num_passes[ i ];
+    }
+    dataset( passes, "NumPasses", H5T_NATIVE_UINT32, z->count, 0, num_passes );
+
+    num_bases = allocate( total * sizeof num_bases[ 0 ] );
+    start_base = allocate( total * sizeof start_base[ 0 ] );
+    for ( i = 0; i < total; ++i )
+    {
+        start_base[ i ] = rnd() % 1000;
+        num_bases[ i ] = 50 + rnd() % 500;
+    }
+    write_flags( passes, "AdapterHitAfter", total );
+    write_flags( passes, "AdapterHitBefore", total );
+    write_flags( passes, "PassDirection", total );
+    dataset( passes, "PassNumBases", H5T_NATIVE_UINT32, total, 0, num_bases );
+    dataset( passes, "PassStartBase", H5T_NATIVE_UINT32, total, 0, start_base );
+
+    free( num_passes );
+    free( num_bases );
+    free( start_base );
+    H5Gclose( passes );
+    H5Gclose( grp );
+}
+
+
+static void free_zmws( zmws * z )
+{
+    free( z->HoleNumber );
+    free( z->HoleStatus );
+    free( z->HoleXY );
+    free( z->NumEvent );
+}
+
+
+int main( int argc, char * argv[] )
+{
+    uint32_t count = 20000;
+    zmws reads, consensus;
+    hid_t file, pulse;
+
+    if ( argc < 2 || argc > 3 )
+    {
+        fprintf( stderr, "usage: %s <output-file> [<zmws>]\n", argv[ 0 ] );
+        return 2;
+    }
+    if ( argc == 3 )
+        count = strtoul( argv[ 2 ], NULL, 10 );
+
+    file = H5Fcreate( argv[ 1 ], H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+    if ( file < 0 )
+    {
+        fprintf( stderr, "cannot create '%s'\n", argv[ 1 ] );
+        return 1;
+    }
+    pulse = make_group( file, "PulseData" );
+
+    make_zmws( &reads, count );
+    write_basecalls( pulse, &reads );
+    write_metrics( pulse, &reads );
+    write_regions( pulse, &reads );
+
+    make_zmws( &consensus, count );
+    write_consensus( pulse, &consensus );
+
+    free_zmws( &reads );
+    free_zmws( &consensus );
+    H5Gclose( pulse );
+    H5Fclose( file );
+    return 0;
+}
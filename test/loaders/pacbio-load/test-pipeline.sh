@@ -0,0 +1,35 @@
+#!/bin/bash
+# pacbio-load --pipeline has to produce the same database as the serial load
+
+VDB_INCDIR=$1
+DIRTOTEST=$2
+TESTBINDIR=$3
+
+WORKDIR=`mktemp -d ${TMPDIR:-/tmp}/pacbio-pipeline.XXXXXX`
+trap "rm -rf $WORKDIR" EXIT
+
+echo "vdb/schema/paths = \"${VDB_INCDIR}\"" > $WORKDIR/tmp.kfg
+${TESTBINDIR}/make-bax $WORKDIR/test.bax.h5 || exit 1
+
+output=$(VDB_CONFIG=$WORKDIR ${DIRTOTEST}/pacbio-load -o $WORKDIR/serial $WORKDIR/test.bax.h5 2>&1)
+res=$?
+if [ "$res" != "0" ];
+	then echo "pacbio-load FAILED, res=$res output=$output" && exit 1;
+fi
+output=$(VDB_CONFIG=$WORKDIR ${DIRTOTEST}/pacbio-load --pipeline -o $WORKDIR/pipeline $WORKDIR/test.bax.h5 2>&1)
+res=$?
+if [ "$res" != "0" ];
+	then echo "pacbio-load --pipeline FAILED, res=$res output=$output" && exit 1;
+fi
+
+# every table has been loaded by its own writer-thread
+for TBL in SEQUENCE CONSENSUS PASSES ZMW_METRICS; do
+	VDB_CONFIG=$WORKDIR ${DIRTOTEST}/vdb-dump -E $WORKDIR/pipeline | grep --quiet -w $TBL || \
+		{ echo "pacbio-load --pipeline did not create the $TBL-table" && exit 1; }
+done
+
+VDB_CONFIG=$WORKDIR ${DIRTOTEST}/vdb-diff $WORKDIR/serial $WORKDIR/pipeline
+if [ "$?" != "0" ];
+	then echo "pacbio-load --pipeline produced a different database" && exit 1;
+fi
+echo "pacbio-load --pipeline and serial load agree"
@@ -858,6 +858,34 @@ FIXTURE_TEST_CASE(Nanopore_Barcode_Edit, NanoporeFixture)
     REQUIRE_EQ( m_read.SpotGroup(), string( "BC01") );
 }
 
+FIXTURE_TEST_CASE(IncrementalCollation_MidStream, LoaderFixture)
+{   // every name is repeated once, so each shard collects far more candidates
+    // than it keeps before confirming them: the duplicate has to be reported
+    // by add() while names are still coming, not only by finish()
+    const size_t unique = 200000;
+    const size_t limit = 4000000;
+    spot_name_stream_check check;
+    size_t added = 0;
+    try {
+        for (; added < limit; ++added)
+            check.add("SPOT_" + to_string(added < 2 * unique ? added % unique : added));
+        FAIL("Should not reach this point");
+    } catch (fastq_error& err) {
+        REQUIRE_EQ(err.error_code(), 170);
+        REQUIRE(err.Message().find("Duplicate spot 'SPOT_") != string::npos);
+    }
+    REQUIRE(added < limit);
+}
+
+FIXTURE_TEST_CASE(IncrementalCollation_Unique, LoaderFixture)
+{
+    spot_name_stream_check check;
+    for (size_t i = 0; i < 300000; ++i)
+        check.add("SPOT_" + to_string(i));
+    check.finish();
+    REQUIRE_EQ(check.size(), (size_t)300000);
+}
+
 ////////////////////////////////////////////
 
 int main (int argc, char *argv [])
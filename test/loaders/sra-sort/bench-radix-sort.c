@@ -0,0 +1,260 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+/* Synopsis: benchmark of the sra-sort radix sort against ksort
+ * Usage:
+ *  bench-radix-sort [--verify] [<records>] [<threads>]
+ *
+ * The arrays follow what sra-sort sorts:
+ *  - ( old_id, new_id ) pairs on new_id, where new_id is a permutation of
+ *    a contiguous row range: alignments re-ordered by position
+ *  - ( old_id, new_id ) pairs on old_id, nearly sorted: ids re-ordered
+ *    only within windows, as produced from an almost sorted table
+ *  - 64-bit alignment ids gathered from REFERENCE: sparse and clustered
+ *  - ( id, poslen ) pairs on poslen, global position in the high 32 bits
+ *    and length in the low, with ids ascending as in AlignIdColReader
+ * Every result is compared to that of ksort; any difference is an error.
+ */
+
+#include "radix-sort.h"
+#include "bench.h"
+
+#include <klib/sort.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Pair Pair;
+struct Pair
+{
+    int64_t a;
+    int64_t b;
+};
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t rnd ( void )
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+static int64_t CC cmp_second ( const void *a, const void *b, void *data )
+{
+    const Pair *ap = a;
+    const Pair *bp = b;
+    return ap -> b < bp -> b ? -1 : ap -> b > bp -> b;
+}
+
+static int64_t CC cmp_first ( const void *a, const void *b, void *data )
+{
+    const Pair *ap = a;
+    const Pair *bp = b;
+    return ap -> a < bp -> a ? -1 : ap -> a > bp -> a;
+}
+
+static int64_t CC cmp_int64 ( const void *a, const void *b, void *data )
+{
+    const int64_t *ap = a;
+    const int64_t *bp = b;
+    return * ap < * bp ? -1 : * ap > * bp;
+}
+
+static int64_t CC cmp_poslen ( const void *a, const void *b, void *data )
+{
+    const Pair *ap = a;
+    const Pair *bp = b;
+    if ( ( uint64_t ) ap -> b != ( uint64_t ) bp -> b )
+        return ( uint64_t ) ap -> b < ( uint64_t ) bp -> b ? -1 : 1;
+    return ap -> a < bp -> a ? -1 : ap -> a > bp -> a;
+}
+
+static void shuffle ( int64_t *ids, size_t stride, size_t count, size_t window )
+{
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+    {
+        size_t lo = i - i % window;
+        size_t hi = lo + window < count ? lo + window : count;
+        size_t j = lo + rnd () % ( hi - lo );
+        int64_t tmp = ids [ i * stride ];
+        ids [ i * stride ] = ids [ j * stride ];
+        ids [ j * stride ] = tmp;
+    }
+}
+
+/* ( old_id, new_id ) on new_id: a full permutation of the row range */
+static void make_by_new ( void *recs, size_t count )
+{
+    Pair *p = recs;
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+    {
+        p [ i ] . a = 1 + i;
+        p [ i ] . b = 1 + i;
+    }
+    shuffle ( & p -> b, 2, count, count );
+}
+
+/* ( old_id, new_id ) on old_id: nearly sorted */
+static void make_by_old ( void *recs, size_t count )
+{
+    Pair *p = recs;
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+    {
+        p [ i ] . a = 1000000000 + i;
+        p [ i ] . b = 1 + i;
+    }
+    shuffle ( & p -> a, 2, count, 4096 );
+}
+
+/* alignment ids from REFERENCE: clusters of nearby ids, far apart */
+static void make_ref_ids ( void *recs, size_t count )
+{
+    int64_t *ids = recs;
+    size_t i = 0;
+    while ( i < count )
+    {
+        int64_t base = 1 + ( int64_t ) ( rnd () % ( count * 8 ) );
+        size_t run = 1 + rnd () % 64;
+        for ( ; run != 0 && i < count; -- run, ++ i )
+            ids [ i ] = base + ( int64_t ) ( rnd () % 256 );
+    }
+}
+
+/* ( id, poslen ) on poslen: ids ascending, positions along a genome */
+static void make_poslen ( void *recs, size_t count )
+{
+    Pair *p = recs;
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+    {
+        uint64_t pos = rnd () % 3000000000ULL;
+        uint64_t len = 100 + rnd () % 151;
+        p [ i ] . a = 1 + i * 2;
+        p [ i ] . b = ( int64_t ) ( ( pos << 32 ) | len );
+    }
+}
+
+typedef struct Profile Profile;
+struct Profile
+{
+    const char *name;
+    void ( * make ) ( void *recs, size_t count );
+    int64_t ( CC * cmp ) ( const void *a, const void *b, void *data );
+    size_t rec_size;
+    size_t key_off;
+    bool key_signed;
+};
+
+static const Profile profiles [] =
+{
+    { "id-map by new_id", make_by_new, cmp_second, sizeof ( Pair ), offsetof ( Pair, b ), true },
+    { "id-map by old_id", make_by_old, cmp_first, sizeof ( Pair ), offsetof ( Pair, a ), true },
+    { "reference align ids", make_ref_ids, cmp_int64, sizeof ( int64_t ), 0, true },
+    { "id/poslen by poslen", make_poslen, cmp_poslen, sizeof ( Pair ), offsetof ( Pair, b ), false }
+};
+
+int main ( int argc, char *argv [] )
+{
+    BenchArgs args;
+    size_t count;
+    uint32_t threads;
+    size_t errors = 0;
+    size_t i;
+
+    BenchArgsInit ( & args, argc, argv, "records", 50 * 1000 * 1000, 3 * 1024 * 1024, 4 );
+    count = args . count;
+    threads = args . threads;
+
+    printf ( "%zu records, radix sort on 1 and %u threads\n", count, threads );
+    for ( i = 0; i < sizeof profiles / sizeof profiles [ 0 ]; ++ i )
+    {
+        const Profile *p = & profiles [ i ];
+        size_t bytes = count * p -> rec_size;
+        void *orig = BenchAlloc ( bytes );
+        void *expected = BenchAlloc ( bytes );
+        void *actual = BenchAlloc ( bytes );
+        void *scratch = BenchAlloc ( bytes );
+        double start, ksort_time, radix1_time, radixN_time;
+
+        p -> make ( orig, count );
+
+        memmove ( expected, orig, bytes );
+        start = BenchNow ();
+        ksort ( expected, count, p -> rec_size, p -> cmp, NULL );
+        ksort_time = BenchNow () - start;
+
+        memmove ( actual, orig, bytes );
+        start = BenchNow ();
+        RadixSort64 ( actual, scratch, count, p -> rec_size, p -> key_off, p -> key_signed, 1 );
+        radix1_time = BenchNow () - start;
+        if ( memcmp ( actual, expected, bytes ) != 0 )
+        {
+            fprintf ( stderr, "%s: single-threaded radix sort differs from ksort\n", p -> name );
+            ++ errors;
+        }
+
+        memmove ( actual, orig, bytes );
+        start = BenchNow ();
+        RadixSort64 ( actual, scratch, count, p -> rec_size, p -> key_off, p -> key_signed, threads );
+        radixN_time = BenchNow () - start;
+        if ( memcmp ( actual, expected, bytes ) != 0 )
+        {
+            fprintf ( stderr, "%s: radix sort on %u threads differs from ksort\n", p -> name, threads );
+            ++ errors;
+        }
+
+        if ( ! args . verify_only )
+        {
+            printf ( "%-22s ksort %7.3fs, radix %7.3fs ( x%.1f ), %u threads %7.3fs ( x%.1f )\n"
+                     , p -> name, ksort_time
+                     , radix1_time, ksort_time / radix1_time
+                     , threads, radixN_time, ksort_time / radixN_time );
+        }
+
+        free ( scratch );
+        free ( actual );
+        free ( expected );
+        free ( orig );
+    }
+
+    if ( errors != 0 )
+    {
+        fprintf ( stderr, "%zu sorts differ\n", errors );
+        return 1;
+    }
+
+    printf ( "radix sort and ksort agree\n" );
+    return 0;
+}
@@ -93,6 +93,13 @@ $SRASTAT -sx ./$SORTED_CSRA | sed 's/sorted_csra/org_csra/' | grep -vE "(<Size v
 
 diff -s before.xml after.xml
 
+#sort again, copying the columns of each table on several threads
+#the result has to be the same
+THREADED_CSRA="threaded_csra"
+$SRASORT -f --threads 4 ./$ORG_CSRA ./$THREADED_CSRA
+$SRASTAT -sx ./$THREADED_CSRA | sed 's/threaded_csra/org_csra/' | grep -vE "(<Size value)" > threaded.xml
+diff -s before.xml threaded.xml
+
 #we do not need the CSRA-objects any more ...
 #we also do not need the xml-output(s) of sra-stat any more ...
-rm -rf "$ORG_CSRA" $SORTED_CSRA before.xml after.xml tmp.kfg
+rm -rf "$ORG_CSRA" $SORTED_CSRA $THREADED_CSRA before.xml after.xml threaded.xml tmp.kfg
@@ -91,6 +91,8 @@
     TOOL_ARG("disk-limit-tmp", "", true, TOOL_HELP("explicitly set disk-limit for temp. files", 0)), \
     TOOL_ARG("size-check", "", true, TOOL_HELP("switch to control:", "on=perform size-check (default), ", "off=do not perform size-check, ", "only=perform size-check only", 0)), \
     TOOL_ARG("ngc", "", true, TOOL_HELP("PATH to ngc file", 0)), \
+    TOOL_ARG("blob-reads", "", false, TOOL_HELP("read columns a blob at a time", 0)), \
+    TOOL_ARG("concurrent", "", true, TOOL_HELP("accessions processed at the same time", "if more than one is given (default 2)", 0)), \
     TOOL_ARG(0, 0, 0, TOOL_HELP(0)))
 
 #define TOOL_NAME_SAM_DUMP "sam-dump" /* from argv[0] */
@@ -46,6 +46,10 @@
 #include <vdb/cursor.h>
 #endif
 
+#ifndef _h_vdb_blob_
+#include <vdb/blob.h>
+#endif
+
 #ifndef _h_vdb_database_
 #include <vdb/database.h>
 #endif
@@ -58,12 +62,26 @@
 #include <vfs/path.h>
 #endif
 
+/* in blob-mode every column keeps the blob of the current row, the cells of the
+   following rows are taken from it until the row-id leaves the range of the blob */
+#define CMN_ITER_MAX_BLOBS 16
+
+typedef struct cmn_blob_t {
+    const VBlob * blob;
+    int64_t first;
+    uint64_t count;
+    uint32_t col_id;
+} cmn_blob_t;
+
 typedef struct cmn_iter_t {
     const VCursor * cursor;
     struct num_gen * ranges;
     const struct num_gen_iter * row_iter;
     uint64_t row_count;
     int64_t first_row, row_id;
+    cmn_blob_t blobs[ CMN_ITER_MAX_BLOBS ];
+    uint32_t num_blobs;
+    bool use_blobs;
 } cmn_iter_t;
 
 /* ------------------------------------------------------------------------------------------------------- */
@@ -137,6 +155,15 @@ static rc_t cmn_release_tbl( const VTable * tbl, rc_t rc, const char * function,
     return rc;
 }
 
+static rc_t cmn_release_blob( const VBlob * blob, rc_t rc, const char * function, int64_t row_id ) {
+    rc_t rc2 = VBlobRelease( blob );
+    if ( 0 != rc2 ) {
+        ErrMsg( "cmn_iter.c %s( #%ld ).VBlobRelease() -> %R", function, row_id, rc2 );
+        rc = ( 0 == rc ) ? rc2 : rc;
+    }
+    return rc;
+}
+
 static rc_t cmn_release_curs( const VCursor * curs, rc_t rc, const char * function, const char * accession_short ) {
     rc_t rc2 = VCursorRelease( curs );
     if ( 0 != rc2 ) {
@@ -150,6 +177,12 @@ static rc_t cmn_release_curs( const VCursor * curs, rc_t rc, const char * functi
 
 void destroy_cmn_iter( cmn_iter_t * self ) {
     if ( NULL != self ) {
+        uint32_t idx;
+        for ( idx = 0; idx < self -> num_blobs; ++idx ) {
+            if ( NULL != self -> blobs[ idx ] . blob ) {
+                cmn_release_blob( self -> blobs[ idx ] . blob, 0, "destroy_cmn_iter", self -> row_id );
+            }
+        }
         if ( NULL != self -> row_iter ) {
             num_gen_iterator_destroy( self -> row_iter );
         }
@@ -241,6 +274,7 @@ rc_t make_cmn_iter( const cmn_iter_params_t * cp, const char * tblname, cmn_iter
                     i -> cursor = cur;
                     i -> first_row = cp -> first_row;
                     i -> row_count = cp -> row_count;
+                    i -> use_blobs = cp -> use_blobs;
                     *iter = i;
                 }
             } else {
@@ -264,6 +298,9 @@ rc_t cmn_iter_add_column( struct cmn_iter_t * self, const char * name, uint32_t
         rc = VCursorAddColumn( self -> cursor, id, name );
         if ( 0 != rc ) {
             ErrMsg( "cmn_iter.c cmn_iter_add_column().VCursorAddColumn( '%s' ) -> %R", name, rc );
+        } else if ( self -> use_blobs && self -> num_blobs < CMN_ITER_MAX_BLOBS ) {
+            /* columns beyond CMN_ITER_MAX_BLOBS are read cell by cell */
+            self -> blobs[ self -> num_blobs++ ] . col_id = *id;
         }
     }
     return rc;
@@ -351,13 +388,66 @@ rc_t cmn_iter_range( struct cmn_iter_t * self, uint32_t col_id ) {
     return rc;
 }
 
+static cmn_blob_t * cmn_find_blob( cmn_iter_t * self, uint32_t col_id ) {
+    uint32_t idx;
+    for ( idx = 0; idx < self -> num_blobs; ++idx ) {
+        if ( self -> blobs[ idx ] . col_id == col_id ) {
+            return &( self -> blobs[ idx ] );
+        }
+    }
+    return NULL;
+}
+
+static rc_t cmn_fetch_blob( cmn_iter_t * self, cmn_blob_t * b ) {
+    rc_t rc = 0;
+    if ( NULL != b -> blob ) {
+        rc = cmn_release_blob( b -> blob, 0, "cmn_fetch_blob", self -> row_id );
+        b -> blob = NULL;
+    }
+    if ( 0 == rc ) {
+        rc = VCursorGetBlobDirect( self -> cursor, &( b -> blob ), self -> row_id, b -> col_id );
+        if ( 0 != rc ) {
+            ErrMsg( "cmn_iter.c cmn_fetch_blob( #%ld ).VCursorGetBlobDirect() -> %R\n", self -> row_id, rc );
+            b -> blob = NULL;
+        } else {
+            rc = VBlobIdRange( b -> blob, &( b -> first ), &( b -> count ) );
+            if ( 0 != rc ) {
+                ErrMsg( "cmn_iter.c cmn_fetch_blob( #%ld ).VBlobIdRange() -> %R\n", self -> row_id, rc );
+                rc = cmn_release_blob( b -> blob, rc, "cmn_fetch_blob", self -> row_id );
+                b -> blob = NULL;
+            }
+        }
+    }
+    return rc;
+}
+
+/* the pointer handed out stays valid until the same column is read for a row
+   outside of the current blob ( blob-mode ) or for the next row ( cell-mode ) */
+static rc_t cmn_cell_data( cmn_iter_t * self, uint32_t col_id, uint32_t * elem_bits,
+                           const void ** base, uint32_t * boff, uint32_t * row_len ) {
+    if ( self -> use_blobs ) {
+        cmn_blob_t * b = cmn_find_blob( self, col_id );
+        if ( NULL != b ) {
+            rc_t rc = 0;
+            int64_t row_id = self -> row_id;
+            if ( NULL == b -> blob || row_id < b -> first || ( uint64_t )( row_id - b -> first ) >= b -> count ) {
+                rc = cmn_fetch_blob( self, b );
+            }
+            if ( 0 == rc ) {
+                rc = VBlobCellData( b -> blob, row_id, elem_bits, base, boff, row_len );
+            }
+            return rc;
+        }
+    }
+    return VCursorCellDataDirect( self -> cursor, self -> row_id, col_id, elem_bits, base, boff, row_len );
+}
+
 rc_t cmn_read_uint64( struct cmn_iter_t * self, uint32_t col_id, uint64_t *value ) {
     uint32_t elem_bits, boff, row_len;
     const uint64_t * value_ptr;
-    rc_t rc = VCursorCellDataDirect( self -> cursor, self -> row_id, col_id, &elem_bits,
-                                 (const void **)&value_ptr, &boff, &row_len );
+    rc_t rc = cmn_cell_data( self, col_id, &elem_bits, (const void **)&value_ptr, &boff, &row_len );
     if ( 0 != rc ) {
-        ErrMsg( "cmn_iter.c cmn_read_uint64( #%ld ).VCursorCellDataDirect() -> %R\n", self -> row_id, rc );
+        ErrMsg( "cmn_iter.c cmn_read_uint64( #%ld ).cmn_cell_data() -> %R\n", self -> row_id, rc );
     } else if ( 64 != elem_bits || 0 != boff ) {
         ErrMsg( "cmn_iter.c cmn_read_uint64( #%ld ) : bits=%d, boff=%d\n", self -> row_id, elem_bits, boff );
         rc = RC( rcApp, rcNoTarg, rcAccessing, rcRow, rcInvalid );
@@ -375,10 +465,9 @@ rc_t cmn_read_uint64_array( struct cmn_iter_t * self, uint32_t col_id, uint64_t
                             uint32_t num_values, uint32_t * values_read ) {
     uint32_t elem_bits, boff, row_len;
     const uint64_t * value_ptr;
-    rc_t rc = VCursorCellDataDirect( self -> cursor, self -> row_id, col_id, &elem_bits,
-                                 (const void **)&value_ptr, &boff, &row_len );
+    rc_t rc = cmn_cell_data( self, col_id, &elem_bits, (const void **)&value_ptr, &boff, &row_len );
     if ( 0 != rc ) {
-        ErrMsg( "cmn_iter.c cmn_read_uint64_array( #%ld ).VCursorCellDataDirect() -> %R\n", self -> row_id, rc );
+        ErrMsg( "cmn_iter.c cmn_read_uint64_array( #%ld ).cmn_cell_data() -> %R\n", self -> row_id, rc );
     } else if ( 64 != elem_bits || 0 != boff ) {
         ErrMsg( "cmn_iter.c cmn_read_uint64_array( #%ld ) : bits=%d, boff=%d\n", self -> row_id, elem_bits, boff );
         rc = RC( rcApp, rcNoTarg, rcAccessing, rcRow, rcInvalid );
@@ -397,10 +486,9 @@ rc_t cmn_read_uint64_array( struct cmn_iter_t * self, uint32_t col_id, uint64_t
 rc_t cmn_read_uint32( struct cmn_iter_t * self, uint32_t col_id, uint32_t *value ) {
     uint32_t elem_bits, boff, row_len;
     const uint32_t * value_ptr;
-    rc_t rc = VCursorCellDataDirect( self -> cursor, self -> row_id, col_id, &elem_bits,
-                                 (const void **)&value_ptr, &boff, &row_len );
+    rc_t rc = cmn_cell_data( self, col_id, &elem_bits, (const void **)&value_ptr, &boff, &row_len );
     if ( 0 != rc ) {
-        ErrMsg( "cmn_iter.c cmn_read_uint32( #%ld ).VCursorCellDataDirect() -> %R\n", self -> row_id, rc );
+        ErrMsg( "cmn_iter.c cmn_read_uint32( #%ld ).cmn_cell_data() -> %R\n", self -> row_id, rc );
     }
     else if ( 32 != elem_bits || 0 != boff ) {
         ErrMsg( "cmn_iter.c cmn_read_uint32( #%ld ) : bits=%d, boff=%d\n", self -> row_id, elem_bits, boff );
@@ -418,10 +506,9 @@ rc_t cmn_read_uint32( struct cmn_iter_t * self, uint32_t col_id, uint32_t *value
 rc_t cmn_read_uint32_array( struct cmn_iter_t * self, uint32_t col_id, uint32_t ** values,
                             uint32_t * values_read ) {
     uint32_t elem_bits, boff, row_len;
-    rc_t rc = VCursorCellDataDirect( self -> cursor, self -> row_id, col_id, &elem_bits,
-                                 (const void **)values, &boff, &row_len );
+    rc_t rc = cmn_cell_data( self, col_id, &elem_bits, (const void **)values, &boff, &row_len );
     if ( 0 != rc ) {
-        ErrMsg( "cmn_iter.c cmn_read_uint32_array( #%ld ).VCursorCellDataDirect() -> %R\n", self -> row_id, rc );
+        ErrMsg( "cmn_iter.c cmn_read_uint32_array( #%ld ).cmn_cell_data() -> %R\n", self -> row_id, rc );
     } else if ( 32 != elem_bits || 0 != boff ) {
         ErrMsg( "row#%ld : bits=%d, boff=%d, len=%d\n", self -> row_id, elem_bits, boff, row_len );
         rc = RC( rcApp, rcNoTarg, rcAccessing, rcRow, rcInvalid );
@@ -436,10 +523,9 @@ rc_t cmn_read_uint32_array( struct cmn_iter_t * self, uint32_t col_id, uint32_t
 rc_t cmn_read_uint8_array( struct cmn_iter_t * self, uint32_t col_id, uint8_t ** values,
                             uint32_t * values_read ) {
     uint32_t elem_bits, boff, row_len;
-    rc_t rc = VCursorCellDataDirect( self -> cursor, self -> row_id, col_id, &elem_bits,
-                                 (const void **)values, &boff, &row_len );
+    rc_t rc = cmn_cell_data( self, col_id, &elem_bits, (const void **)values, &boff, &row_len );
     if ( 0 != rc ) {
-        ErrMsg( "cmn_iter.c cmn_read_uint8_array( #%ld ).VCursorCellDataDirect() -> %R\n", self -> row_id, rc );
+        ErrMsg( "cmn_iter.c cmn_read_uint8_array( #%ld ).cmn_cell_data() -> %R\n", self -> row_id, rc );
     } else if ( 8 != elem_bits || 0 != boff ) {
         ErrMsg( "cmn_iter.c cmn_read_uint8_array( #%ld ) : bits=%d, boff=%d\n", self -> row_id, elem_bits, boff );
         rc = RC( rcApp, rcNoTarg, rcAccessing, rcRow, rcInvalid );
@@ -451,10 +537,9 @@ rc_t cmn_read_uint8_array( struct cmn_iter_t * self, uint32_t col_id, uint8_t **
 
 rc_t cmn_read_String( struct cmn_iter_t * self, uint32_t col_id, String * value ) {
     uint32_t elem_bits, boff;
-    rc_t rc = VCursorCellDataDirect( self -> cursor, self -> row_id, col_id, &elem_bits,
-                                 (const void **)&value->addr, &boff, &value -> len );
+    rc_t rc = cmn_cell_data( self, col_id, &elem_bits, (const void **)&value->addr, &boff, &value -> len );
     if ( 0 != rc ) {
-        ErrMsg( "cmn_iter.c cmn_read_String( #%ld ).VCursorCellDataDirect() -> %R\n", self -> row_id, rc );
+        ErrMsg( "cmn_iter.c cmn_read_String( #%ld ).cmn_cell_data() -> %R\n", self -> row_id, rc );
     } else if ( 8 != elem_bits || 0 != boff ) {
         ErrMsg( "cmn_iter.c cmn_read_String( #%ld ) : bits=%d, boff=%d\n", self -> row_id, elem_bits, boff );
         rc = RC( rcApp, rcNoTarg, rcAccessing, rcRow, rcInvalid );
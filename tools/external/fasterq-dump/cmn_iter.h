@@ -52,6 +52,7 @@ typedef struct cmn_iter_params
     int64_t first_row;
     uint64_t row_count;
     size_t cursor_cache;
+    bool use_blobs;         /* read the columns a blob at a time instead of cell by cell */
 } cmn_iter_params_t;
 
 struct cmn_iter_t;
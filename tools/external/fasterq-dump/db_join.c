@@ -1594,7 +1594,8 @@ static rc_t CC cmn_thread_func( const KThread * self, void * data ) {
             jtd -> accession_path,
             jtd -> first_row,
             jtd -> row_limit > 0 ? jtd -> row_limit : jtd -> row_count,
-            jtd -> cur_cache };
+            jtd -> cur_cache,
+            jo -> blob_reads };
         rc = init_join( &cp,
                         flex_printer,
                         filter,
@@ -1805,6 +1806,7 @@ rc_t check_lookup( const KDirectory * dir,
             params . first_row = 0;
             params . row_count = 0;
             params . cursor_cache = cursor_cache;
+            params . use_blobs = false;
 
             rc = make_raw_read_iter( &params, &iter ); /* raw_read_iter.c */
             if ( 0 == rc ) {
@@ -1883,7 +1885,8 @@ static rc_t CC unsorted_fasta_align_thread_func( const KThread * self, void * da
         jtd -> accession_path,
         jtd -> first_row,
         jtd -> row_limit > 0 ? jtd -> row_limit : jtd -> row_count,
-        jtd -> cur_cache };
+        jtd -> cur_cache,
+        jtd -> join_options -> blob_reads };
     struct align_iter_t * iter;
     uint64_t loop_nr = 0;
 
@@ -2019,7 +2022,8 @@ static rc_t CC unsorted_fasta_seq_thread_func( const KThread * self, void * data
         jtd -> accession_path,
         jtd -> first_row,
         jtd -> row_limit > 0 ? jtd -> row_limit : jtd -> row_count,
-        jtd -> cur_cache };
+        jtd -> cur_cache,
+        jtd -> join_options -> blob_reads };
     struct fastq_csra_iter_t * iter;
     uint64_t loop_nr = 0;
     fastq_iter_opt_t opt;
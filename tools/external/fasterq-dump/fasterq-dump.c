@@ -56,6 +56,10 @@
 #include "tbl_join.h"
 #endif
 
+#ifndef _h_thread_budget_
+#include "thread_budget.h"
+#endif
+
 #ifndef _h_kapp_main_
 #include <kapp/main.h>
 #endif
@@ -76,6 +80,10 @@
 #include <klib/printf.h>
 #endif
 
+#ifndef _h_kproc_lock_
+#include <kproc/lock.h>
+#endif
+
 /* ---------------------------------------------------------------------------------- */
 
 static const char * format_usage[] = { "format (special, fastq, default=fastq)", NULL };
@@ -208,6 +216,13 @@ static const char * disk_limit_tmp_usage[] = { "explicitly set disk-limit for te
 static const char * ngc_usage[] = { "PATH to ngc file", NULL };
 #define OPTION_NGC              "ngc"
 
+static const char * blob_reads_usage[] = { "read columns a blob at a time", NULL };
+#define OPTION_BLOB_READS       "blob-reads"
+
+static const char * concurrent_usage[] = { "accessions processed at the same time",
+                                           "if more than one is given (default 2)", NULL };
+#define OPTION_CONCURRENT       "concurrent"
+
 /* ---------------------------------------------------------------------------------- */
 
 OptDef ToolOptions[] = {
@@ -243,7 +258,9 @@ OptDef ToolOptions[] = {
     { OPTION_DISK_LIMIT_OUT,NULL,               NULL, disk_limit_out_usage, 1, true,   false },
     { OPTION_DISK_LIMIT_TMP,NULL,               NULL, disk_limit_tmp_usage, 1, true,   false },    
     { OPTION_CHECK,         NULL,               NULL, check_usage,          1, true,   false },
-    { OPTION_NGC,           NULL,               NULL, ngc_usage,            1, true,   false }
+    { OPTION_NGC,           NULL,               NULL, ngc_usage,            1, true,   false },
+    { OPTION_BLOB_READS,    NULL,               NULL, blob_reads_usage,     1, false,  false },
+    { OPTION_CONCURRENT,    NULL,               NULL, concurrent_usage,     1, true,   false }
 };
 
 /* ----------------------------------------------------------------------------------- */
@@ -256,8 +273,9 @@ rc_t CC UsageSummary( const char * progname ) {
     return KOutMsg( "\n"
                      "Usage:\n"
                      "  %s <path> [options]\n"
-                     "  %s <accession> [options]\n"                     
-                     "\n", progname, progname );
+                     "  %s <accession> [options]\n"
+                     "  %s <accession> <accession> ... [options]\n"
+                     "\n", progname, progname, progname );
 }
 
 /* ----------------------------------------------------------------------------------- */
@@ -310,10 +328,10 @@ static const char * dflt_requested_seq_tabl_name = "SEQUENCE";
 #define DFLT_BUF_SIZE ( 1024 * 1024 )
 #define DFLT_MEM_LIMIT ( 1024L * 1024 * 50 )
 #define DFLT_NUM_THREADS 6
-static rc_t get_user_input( tool_ctx_t * tool_ctx, const Args * args ) {
+static rc_t get_user_input( tool_ctx_t * tool_ctx, const Args * args, uint32_t param_idx ) {
     bool split_spot, split_file, split_3, whole_spot, fasta, fasta_us;
 
-    rc_t rc = ArgsParamValue( args, 0, ( const void ** )&( tool_ctx -> accession_path ) );
+    rc_t rc = ArgsParamValue( args, param_idx, ( const void ** )&( tool_ctx -> accession_path ) );
     if ( 0 != rc ) {
         ErrMsg( "ArgsParamValue() -> %R", rc );
     }
@@ -337,6 +355,7 @@ static rc_t get_user_input( tool_ctx_t * tool_ctx, const Args * args ) {
     tool_ctx -> join_options . skip_tech = !( get_bool_option( args, OPTION_INCL_TECH ) );
     tool_ctx -> join_options . min_read_len = get_uint32_t_option( args, OPTION_MINRDLEN, 0 );
     tool_ctx -> join_options . filter_bases = get_str_option( args, OPTION_BASE_FLT, NULL );
+    tool_ctx -> join_options . blob_reads = get_bool_option( args, OPTION_BLOB_READS );
 
     split_spot = get_bool_option( args, OPTION_SPLIT_SPOT );
     split_file = get_bool_option( args, OPTION_SPLIT_FILE );
@@ -456,6 +475,7 @@ static rc_t produce_lookup_files( const tool_ctx_t * tool_ctx ) {
     if ( 0 == rc ) {
 
         lookup_production_args_t args;
+        uint32_t num_threads = 0;
 
         args . dir = tool_ctx -> dir;
         args . vdb_mgr = tool_ctx -> vdb_mgr;
@@ -466,10 +486,16 @@ static rc_t produce_lookup_files( const tool_ctx_t * tool_ctx ) {
         args . cursor_cache = tool_ctx -> cursor_cache;
         args . buf_size = tool_ctx -> buf_size;
         args . mem_limit = tool_ctx -> mem_limit;
-        args . num_threads = tool_ctx -> num_threads;
         args . show_progress = tool_ctx -> show_progress;
+        args . blob_reads = tool_ctx -> join_options . blob_reads;
 
-        rc = execute_lookup_production( &args ); /* sorter.c */
+        /* in batch-mode the threads are shared with the other accessions */
+        rc = thread_budget_acquire( tool_ctx -> thread_budget, tool_ctx -> num_threads, &num_threads ); /* thread_budget.c */
+        if ( 0 == rc ) {
+            args . num_threads = num_threads;
+            rc = execute_lookup_production( &args ); /* sorter.c */
+            thread_budget_return( tool_ctx -> thread_budget, num_threads ); /* thread_budget.c */
+        }
     }
     bg_update_start( gap, "merge  : " ); /* progress_thread.c ...start showing the activity... */
 
@@ -532,13 +558,18 @@ static rc_t produce_final_db_output( const tool_ctx_t * tool_ctx ) {
     args . registry= registry;
     args . cursor_cache = tool_ctx -> cursor_cache;
     args . buf_size = tool_ctx -> buf_size;
-    args . num_threads = tool_ctx -> num_threads;
     args . row_limit = tool_ctx -> row_limit;
     args . show_progress = tool_ctx -> show_progress;
     args . fmt = tool_ctx -> fmt;
 
     if ( rc == 0 ) {
-        rc = execute_db_join( &args ); /* join.c */
+        uint32_t num_threads = 0;
+        rc = thread_budget_acquire( tool_ctx -> thread_budget, tool_ctx -> num_threads, &num_threads ); /* thread_budget.c */
+        if ( 0 == rc ) {
+            args . num_threads = num_threads;
+            rc = execute_db_join( &args ); /* join.c */
+            thread_budget_return( tool_ctx -> thread_budget, num_threads ); /* thread_budget.c */
+        }
     }
     
     /* from now on we do not need the lookup-file and it's index any more... */
@@ -579,6 +610,7 @@ static rc_t produce_final_db_output( const tool_ctx_t * tool_ctx ) {
 
 static rc_t process_csra_fasta_unsorted( const tool_ctx_t * tool_ctx ) {
     rc_t rc;
+    uint32_t num_threads = 0;
 
     join_stats_t stats; /* helper.h */
     execute_unsorted_fasta_db_join_args_t args; /* join.h */
@@ -596,14 +628,18 @@ static rc_t process_csra_fasta_unsorted( const tool_ctx_t * tool_ctx ) {
     args . join_options = &( tool_ctx -> join_options );
     args . cur_cache = tool_ctx -> cursor_cache;
     args . buf_size = tool_ctx -> buf_size;
-    args . num_threads = tool_ctx -> num_threads;
     args . row_limit = tool_ctx -> row_limit;
     args . show_progress = tool_ctx -> show_progress;
     args . force = tool_ctx -> force;
     args . only_unaligned = tool_ctx -> only_unaligned;
     args . only_aligned = tool_ctx -> only_aligned;
 
-    rc = execute_unsorted_fasta_db_join( &args ); /* join.c */
+    rc = thread_budget_acquire( tool_ctx -> thread_budget, tool_ctx -> num_threads, &num_threads ); /* thread_budget.c */
+    if ( 0 == rc ) {
+        args . num_threads = num_threads;
+        rc = execute_unsorted_fasta_db_join( &args ); /* join.c */
+        thread_budget_return( tool_ctx -> thread_budget, num_threads ); /* thread_budget.c */
+    }
 
     print_stats( &stats ); /* helper.c */
 
@@ -649,6 +685,7 @@ static rc_t process_table_in_seq_order( const tool_ctx_t * tool_ctx, const char
     if ( 0 == rc ) {
         
         execute_tbl_join_args_t args; /* tbl_join.h */
+        uint32_t num_threads = 0;
 
         args . dir = tool_ctx -> dir;
         args . vdb_mgr = tool_ctx -> vdb_mgr;
@@ -664,12 +701,16 @@ static rc_t process_table_in_seq_order( const tool_ctx_t * tool_ctx, const char
         args . registry = registry;
         args . cursor_cache = tool_ctx -> cursor_cache;
         args . buf_size = tool_ctx -> buf_size;
-        args . num_threads = tool_ctx -> num_threads;
         args . show_progress = tool_ctx -> show_progress;
         args . fmt = tool_ctx -> fmt;
         args . row_limit = tool_ctx -> row_limit;
 
-        rc = execute_tbl_join( &args ); /* tbl_join.c */
+        rc = thread_budget_acquire( tool_ctx -> thread_budget, tool_ctx -> num_threads, &num_threads ); /* thread_budget.c */
+        if ( 0 == rc ) {
+            args . num_threads = num_threads;
+            rc = execute_tbl_join( &args ); /* tbl_join.c */
+            thread_budget_return( tool_ctx -> thread_budget, num_threads ); /* thread_budget.c */
+        }
     }
 
     if ( 0 == rc ) {
@@ -699,6 +740,7 @@ static rc_t process_table_in_seq_order( const tool_ctx_t * tool_ctx, const char
 
 static rc_t process_table_fasta_unsorted( const tool_ctx_t * tool_ctx, const char * tbl_name ) {
     rc_t rc = 0;
+    uint32_t num_threads = 0;
     join_stats_t stats; /* helper.h */
     execute_fasta_tbl_join_args_t args; /* tbl_join.h */
         
@@ -716,12 +758,16 @@ static rc_t process_table_fasta_unsorted( const tool_ctx_t * tool_ctx, const cha
     args . join_options = &( tool_ctx -> join_options );
     args . cursor_cache = tool_ctx -> cursor_cache;
     args . buf_size = tool_ctx -> buf_size;
-    args . num_threads = tool_ctx -> num_threads;
     args . show_progress = tool_ctx -> show_progress;
     args . force = tool_ctx -> force;
     args . row_limit = tool_ctx -> row_limit;
     
-    rc = execute_unsorted_fasta_tbl_join( &args ); /* tbl_join.c */
+    rc = thread_budget_acquire( tool_ctx -> thread_budget, tool_ctx -> num_threads, &num_threads ); /* thread_budget.c */
+    if ( 0 == rc ) {
+        args . num_threads = num_threads;
+        rc = execute_unsorted_fasta_tbl_join( &args ); /* tbl_join.c */
+        thread_budget_return( tool_ctx -> thread_budget, num_threads ); /* thread_budget.c */
+    }
 
     print_stats( &stats ); /* helper.c */
 
@@ -749,6 +795,208 @@ static rc_t process_table( const tool_ctx_t * tool_ctx, const char * tbl_name )
 
 /* ============================================================================================ */
 
+static rc_t process_accession( tool_ctx_t * tool_ctx ) {
+    rc_t rc = populate_tool_ctx( tool_ctx ); /* tool_ctx.c !includes inspector! */
+    /* returns rc != 0 if inspection failed, because of check-mode */
+
+    if ( 0 == rc && !( cmt_only == tool_ctx -> check_mode ) ) {
+        switch( tool_ctx -> insp_output . acc_type ) {
+            /* a cSRA-database with alignments */
+            case acc_csra       : rc = process_csra( tool_ctx ); break; /* above */
+
+            /* a PACBIO-database */
+            case acc_pacbio     : ErrMsg( "accession '%s' is PACBIO, please use fastq-dump instead", tool_ctx -> accession_path );
+                                    rc = 3; /* signal to main() that the accession is not-processed */
+                                    break;
+
+            /* a flat SRA-table */
+            case acc_sra_flat   : rc = process_table( tool_ctx, NULL ); break; /* above */
+
+            /* a SRA-database, containing only unaligned data */
+            case acc_sra_db     : rc = process_table( tool_ctx, tool_ctx -> insp_output . seq . tbl_name ); /* above */
+                                    break;
+
+            default             : ErrMsg( "invalid accession '%s'", tool_ctx -> accession_path );
+                                    rc = 3; /* signal to main() that the accession is not-found/invalid */
+                                    break;
+        }
+    }
+    return release_tool_ctx( tool_ctx, rc ); /* tool_ctx.c */
+}
+
+/* ============================================================================================
+    >>>>> batch-mode <<<<< ( more than one accession on the commandline )
+   ============================================================================================
+    a few accession-workers take the accessions one after the other out of the parameter-list,
+    each one runs the whole chain inspect -> lookup -> merge -> join -> concatenate.
+    The KDirectory and the VDBManager ( and with it the caches ) are shared,
+    the threads given via -e form a common budget: the parallel phases of an accession
+    take what they can get out of it, so while one accession merges or concatenates
+    another one can use the threads for its lookup-production or join.
+    Every accession has its own temp-directory and its own output-files, named as usual.
+   -------------------------------------------------------------------------------------------- */
+
+#define DFLT_CONCURRENT 2
+
+typedef struct batch_ctx_t {
+    const Args * args;
+    tool_ctx_t tmpl;            /* the options from the commandline, without the accession */
+    KLock * lock;               /* protects next_param and rc */
+    uint32_t param_count;
+    uint32_t next_param;
+    rc_t rc;                    /* first error of any accession */
+} batch_ctx_t;
+
+static bool batch_next_param( batch_ctx_t * batch, uint32_t * param_idx ) {
+    bool res = false;
+    rc_t rc = KLockAcquire( batch -> lock );
+    if ( 0 != rc ) {
+        ErrMsg( "fasterq-dump.c batch_next_param().KLockAcquire() -> %R", rc );
+    } else {
+        if ( batch -> next_param < batch -> param_count && 0 == get_quitting() ) { /* helper.c */
+            *param_idx = batch -> next_param++;
+            res = true;
+        }
+        KLockUnlock( batch -> lock );
+    }
+    return res;
+}
+
+static void batch_set_rc( batch_ctx_t * batch, rc_t rc ) {
+    if ( 0 == KLockAcquire( batch -> lock ) ) {
+        if ( 0 == batch -> rc ) {
+            batch -> rc = rc;
+        }
+        KLockUnlock( batch -> lock );
+    }
+}
+
+static rc_t CC batch_worker( const KThread * self, void * data ) {
+    batch_ctx_t * batch = data;
+    uint32_t param_idx;
+
+    while ( batch_next_param( batch, &param_idx ) ) {
+        tool_ctx_t tool_ctx = batch -> tmpl;    /* tool_ctx.h */
+        rc_t rc = ArgsParamValue( batch -> args, param_idx, ( const void ** )&( tool_ctx . accession_path ) );
+        if ( 0 != rc ) {
+            ErrMsg( "ArgsParamValue( %u ) -> %R", param_idx, rc );
+        } else {
+            /* the shared instances are released by every accession... */
+            KDirectoryAddRef( tool_ctx . dir );
+            VDBManagerAddRef( tool_ctx . vdb_mgr );
+            tool_ctx . batch_idx = param_idx + 1;
+
+            rc = process_accession( &tool_ctx ); /* above */
+        }
+        if ( 0 != rc ) {
+            ErrMsg( "accession '%s' failed -> %R", tool_ctx . accession_path, rc );
+            batch_set_rc( batch, rc );
+        }
+    }
+    return 0;
+}
+
+static rc_t check_batch_options( const tool_ctx_t * tool_ctx ) {
+    rc_t rc = 0;
+    if ( NULL != tool_ctx -> output_filename ) {
+        rc = RC( rcExe, rcArgv, rcParsing, rcParam, rcInvalid );
+        ErrMsg( "--%s cannot be used with more than one accession, use --%s", OPTION_OUTPUT_F, OPTION_OUTPUT_D );
+    } else if ( tool_ctx -> use_stdout ) {
+        rc = RC( rcExe, rcArgv, rcParsing, rcParam, rcInvalid );
+        ErrMsg( "--%s cannot be used with more than one accession", OPTION_STDOUT );
+    }
+    return rc;
+}
+
+static rc_t process_batch( const Args * args, uint32_t param_count ) {
+    batch_ctx_t batch;
+    uint32_t concurrent = get_uint32_t_option( args, OPTION_CONCURRENT, DFLT_CONCURRENT );
+
+    rc_t rc = KLockMake( &( batch . lock ) );
+    if ( 0 != rc ) {
+        ErrMsg( "fasterq-dump.c process_batch().KLockMake() -> %R", rc );
+        return rc;
+    }
+    memset( &( batch . tmpl ), 0, sizeof batch . tmpl );
+    batch . args = args;
+    batch . param_count = param_count;
+    batch . next_param = 0;
+    batch . rc = 0;
+
+    rc = get_user_input( &( batch . tmpl ), args, 0 ); /* above: the options are the same for all accessions */
+    if ( 0 == rc ) {
+        rc = check_batch_options( &( batch . tmpl ) ); /* above */
+    }
+    if ( 0 == concurrent ) {
+        concurrent = 1;
+    }
+    if ( concurrent > param_count ) {
+        concurrent = param_count;
+    }
+    if ( concurrent > 1 ) {
+        /* the progress-bars of accessions running side by side would overwrite each other */
+        batch . tmpl . show_progress = false;
+    }
+
+    if ( 0 == rc ) {
+        rc = KDirectoryNativeDir( &( batch . tmpl . dir ) );
+        if ( 0 != rc ) {
+            ErrMsg( "KDirectoryNativeDir() -> %R", rc );
+        }
+    }
+    if ( 0 == rc ) {
+        rc = VDBManagerMakeRead( &( batch . tmpl . vdb_mgr ), batch . tmpl . dir );
+        if ( 0 != rc ) {
+            ErrMsg( "fasterq-dump.c process_batch().VDBManagerMakeRead() -> %R\n", rc );
+        }
+    }
+    if ( 0 == rc ) {
+        uint32_t num_threads = batch . tmpl . num_threads;
+        uint32_t env_thread_count = get_env_u32( "DLFT_THREAD_COUNT", 0 ); /* helper.c */
+        if ( env_thread_count > 0 ) {
+            num_threads = env_thread_count; /* same rules as in tool_ctx.c */
+        } else if ( num_threads < 2 ) {
+            num_threads = 2;
+        }
+        rc = make_thread_budget( &( batch . tmpl . thread_budget ), num_threads ); /* thread_budget.c */
+    }
+
+    if ( 0 == rc ) {
+        Vector threads;
+        uint32_t idx;
+
+        VectorInit( &threads, 0, concurrent );
+        for ( idx = 0; 0 == rc && idx < concurrent; ++idx ) {
+            KThread * thread;
+            rc = helper_make_thread( &thread, batch_worker, &batch, THREAD_BIG_STACK_SIZE ); /* helper.c */
+            if ( 0 != rc ) {
+                ErrMsg( "fasterq-dump.c process_batch().helper_make_thread( #%u ) -> %R", idx, rc );
+            } else {
+                rc = VectorAppend( &threads, NULL, thread );
+                if ( 0 != rc ) {
+                    ErrMsg( "fasterq-dump.c process_batch().VectorAppend( #%u ) -> %R", idx, rc );
+                }
+            }
+        }
+        join_and_release_threads( &threads ); /* helper.c */
+        if ( 0 == rc ) {
+            rc = batch . rc;
+        }
+    }
+
+    destroy_thread_budget( batch . tmpl . thread_budget ); /* thread_budget.c */
+    if ( NULL != batch . tmpl . vdb_mgr ) {
+        VDBManagerRelease( batch . tmpl . vdb_mgr );
+    }
+    if ( NULL != batch . tmpl . dir ) {
+        KDirectoryRelease( batch . tmpl . dir );
+    }
+    KLockRelease( batch . lock );
+    return rc;
+}
+
+/* ============================================================================================ */
+
 rc_t CC KMain ( int argc, char *argv [] ) {
     Args * args;
     uint32_t num_options = sizeof ToolOptions / sizeof ToolOptions [ 0 ];
@@ -762,47 +1010,25 @@ rc_t CC KMain ( int argc, char *argv [] ) {
         if ( 0 != rc ) {
             ErrMsg( "ArgsParamCount() -> %R", rc );
         } else {
-            /* in case we are given no or more than one accessions/files to process */
-            if ( param_count == 0 || param_count > 1 ) {
+            /* in case we are given no accessions/files to process */
+            if ( param_count == 0 ) {
                 Usage ( args );
                 /* will make the caller of this function aka KMane() in man.c return
                 error code of 3 */
                 rc = 3;
+            } else if ( param_count > 1 ) {
+                rc = process_batch( args, param_count ); /* above */
             } else {
                 tool_ctx_t tool_ctx;    /* tool_ctx.h */
 
                 memset( &tool_ctx, 0, sizeof tool_ctx );
 
-                rc = get_user_input( &tool_ctx, args ); /* above: get argument and options from args */
+                rc = get_user_input( &tool_ctx, args, 0 ); /* above: get argument and options from args */
                 if ( 0 == rc ) {
-                    rc = populate_tool_ctx( &tool_ctx ); /* tool_ctx.c !includes inspector! */
-                    /* returns rc != 0 if inspection failed, because of check-mode */
-                }
-
-                if ( 0 == rc && !( cmt_only == tool_ctx . check_mode ) ) {
-                    switch( tool_ctx . insp_output . acc_type ) {
-                        /* a cSRA-database with alignments */
-                        case acc_csra       : rc = process_csra( &tool_ctx ); break; /* above */
-
-                        /* a PACBIO-database */
-                        case acc_pacbio     : ErrMsg( "accession '%s' is PACBIO, please use fastq-dump instead", tool_ctx . accession_path );
-                                                rc = 3; /* signal to main() that the accession is not-processed */
-                                                break;
-
-                        /* a flat SRA-table */
-                        case acc_sra_flat   : rc = process_table( &tool_ctx, NULL ); break; /* above */
-
-                        /* a SRA-database, containing only unaligned data */
-                        case acc_sra_db     : rc = process_table( &tool_ctx, tool_ctx . insp_output . seq . tbl_name ); /* above */
-                                                break;
-
-                        default             : ErrMsg( "invalid accession '%s'", tool_ctx . accession_path );
-                                                rc = 3; /* signal to main() that the accession is not-found/invalid */
-                                                break;
-                    }
+                    rc = process_accession( &tool_ctx ); /* above */
+                } else {
+                    rc = release_tool_ctx( &tool_ctx, rc ); /* tool_ctx.c */
                 }
-
-                rc = release_tool_ctx( &tool_ctx, rc ); /* tool_ctx.c */
             }
         }
     }
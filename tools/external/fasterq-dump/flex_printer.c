@@ -262,6 +262,10 @@ static struct flex_printer_t * make_flex_printer_cmn( flex_printer_t * self,
             if ( NULL == self -> fmt_v1 || NULL == self -> fmt_v2 ) {
                 release_flex_printer( self );
                 self = NULL;
+            } else {
+                /* the accession is the same for every spot: make it part of the literals */
+                var_fmt_set_const_str( self -> fmt_v1, sdi_acc, self -> string_data[ sdi_acc ] );
+                var_fmt_set_const_str( self -> fmt_v2, sdi_acc, self -> string_data[ sdi_acc ] );
             }
         }
         if ( NULL != flex_fmt1 ) { StringWhack( flex_fmt1 ); }  /* create_var_fmt makes a copy! */
@@ -554,6 +554,7 @@ void correct_join_options( join_options_t * dst, const join_options_t * src, boo
     dst -> print_spotgroup = src -> print_spotgroup;
     dst -> min_read_len = src -> min_read_len;
     dst -> filter_bases = src -> filter_bases;
+    dst -> blob_reads = src -> blob_reads;
 }
 
 /* ===================================================================================== */
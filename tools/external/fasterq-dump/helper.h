@@ -93,6 +93,7 @@ typedef struct join_options
     bool print_spotgroup;
     uint32_t min_read_len;
     const char * filter_bases;
+    bool blob_reads;        /* cmn_iter reads the columns a blob at a time */
 } join_options_t;
 
 /* -------------------------------------------------------------------------------- */
@@ -115,6 +115,7 @@ rc_t write_out_prim( const KDirectory *dir, size_t buf_size, size_t cursor_cache
     params . first_row = 0;
     params . row_count = 0;
     params . cursor_cache = cursor_cache;
+    params . use_blobs = false;
     
     rc = make_raw_read_iter( &params, &iter ); /* raw_read_iter.c */
     if ( 0 == rc ) {
@@ -322,6 +322,7 @@ rc_t execute_lookup_production( const lookup_production_args_t * args ) {
                         cip . first_row          = row;
                         cip . row_count          = rows_per_thread;
                         cip . cursor_cache       = args -> cursor_cache;
+                        cip . use_blobs          = args -> blob_reads;
 
                         rc = make_raw_read_iter( &cip, &( producer -> iter ) );
                     }
@@ -982,7 +982,8 @@ static rc_t CC sorted_fastq_fasta_thread_func( const KThread *self, void *data )
         jtd -> accession_path,
         jtd -> first_row,
         jtd -> row_limit > 0 ? jtd -> row_limit : jtd -> row_count,
-        jtd -> cur_cache }; /* helper.h */
+        jtd -> cur_cache,
+        jtd -> join_options -> blob_reads }; /* cmn_iter.h */
     file_printer_args_t file_args;
     set_file_printer_args( &file_args,
                             jtd -> dir,
@@ -1183,7 +1184,8 @@ static rc_t CC unsorted_fasta_thread_func( const KThread *self, void *data ) {
         jtd -> accession_path,
         jtd -> first_row,
         jtd -> row_limit > 0 ? jtd -> row_limit : jtd -> row_count,
-        jtd -> cur_cache };
+        jtd -> cur_cache,
+        jtd -> join_options -> blob_reads };
     fastq_iter_opt_t opt;
     const join_options_t * jo = jtd -> join_options;
     join_stats_t * stats = &( jtd -> stats );
@@ -54,6 +54,7 @@ typedef struct temp_dir_t {
     char hostname[ HOSTNAMELEN ];
     char path[ DFLT_PATH_LEN ];
     uint32_t pid;
+    uint32_t batch_idx;     /* > 0 : one of several accessions processed by this process */
 } temp_dir_t;
 
 void destroy_temp_dir( struct temp_dir_t * self ) {
@@ -90,11 +91,20 @@ static void append_slash( char * path, size_t maxlen ) {
 }
 
 static rc_t generate_dflt_path( temp_dir_t * self, const KDirectory * dir ) {
-    rc_t rc = KDirectoryResolvePath( dir,
-                                     true /* absolute */,
-                                     &( self -> path[ 0 ] ),
-                                     sizeof self -> path,
-                                     "fasterq.tmp.%s.%u", self -> hostname, self -> pid );
+    rc_t rc;
+    if ( self -> batch_idx > 0 ) {
+        rc = KDirectoryResolvePath( dir,
+                                    true /* absolute */,
+                                    &( self -> path[ 0 ] ),
+                                    sizeof self -> path,
+                                    "fasterq.tmp.%s.%u.%u", self -> hostname, self -> pid, self -> batch_idx );
+    } else {
+        rc = KDirectoryResolvePath( dir,
+                                    true /* absolute */,
+                                    &( self -> path[ 0 ] ),
+                                    sizeof self -> path,
+                                    "fasterq.tmp.%s.%u", self -> hostname, self -> pid );
+    }
     if ( 0 != rc ) {
         ErrMsg( "temp_dir.c generate_dflt_path() -> %R", rc );        
     } else {
@@ -112,7 +122,14 @@ static rc_t generate_dflt_path( temp_dir_t * self, const KDirectory * dir ) {
 static rc_t generate_sub_path( temp_dir_t * self, const char * requested, const KDirectory * dir ) {
     rc_t rc;
     bool es = ends_in_slash( requested );
-    if ( es ) {
+    if ( self -> batch_idx > 0 ) {
+        rc = KDirectoryResolvePath( dir,
+                                    true /* absolute */,
+                                    &( self -> path[ 0 ] ),
+                                    sizeof self -> path,
+                                    es ? "%sfasterq.tmp.%s.%u.%u/" : "%s/fasterq.tmp.%s.%u.%u/",
+                                    requested, self -> hostname, self -> pid, self -> batch_idx );
+    } else if ( es ) {
         rc = KDirectoryResolvePath( dir,
                                     true /* absolute */,
                                     &( self -> path[ 0 ] ),
@@ -134,7 +151,8 @@ static rc_t generate_sub_path( temp_dir_t * self, const char * requested, const
     return rc;
 }
 
-rc_t make_temp_dir( struct temp_dir_t ** obj, const char * requested, KDirectory * dir ) {
+rc_t make_temp_dir( struct temp_dir_t ** obj, const char * requested, KDirectory * dir,
+                    uint32_t batch_idx ) {
     rc_t rc = 0;
     if ( NULL == obj || NULL == dir ) {
         rc = RC( rcVDB, rcNoTarg, rcConstructing, rcParam, rcInvalid );
@@ -145,6 +163,7 @@ rc_t make_temp_dir( struct temp_dir_t ** obj, const char * requested, KDirectory
             rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
             ErrMsg( "temp_dir.c make_temp_dir().calloc( %d ) -> %R", ( sizeof * o ), rc );
         } else {
+            o -> batch_idx = batch_idx;
             rc = get_pid_and_hostname( o );
             if ( 0 == rc ) {
                 if ( requested == NULL ) {
@@ -43,7 +43,9 @@ struct temp_dir_t;
 
 void destroy_temp_dir( struct temp_dir_t * self );
 
-rc_t make_temp_dir( struct temp_dir_t ** obj, const char * requested, KDirectory * dir );
+/* batch_idx > 0 gives every accession of a batch its own directory */
+rc_t make_temp_dir( struct temp_dir_t ** obj, const char * requested, KDirectory * dir,
+                    uint32_t batch_idx );
 
 const char * get_temp_dir( struct temp_dir_t * self );
 
@@ -0,0 +1,155 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#include "thread_budget.h"
+
+#ifndef _h_err_msg_
+#include "err_msg.h"
+#endif
+
+#ifndef _h_kproc_lock_
+#include <kproc/lock.h>
+#endif
+
+#ifndef _h_kproc_cond_
+#include <kproc/cond.h>
+#endif
+
+#include <stdlib.h>
+
+#define MIN_GRANT 2
+
+typedef struct thread_budget_t {
+    KLock * lock;
+    KCondition * returned;
+    uint32_t total;
+    uint32_t available;
+} thread_budget_t;
+
+void destroy_thread_budget( struct thread_budget_t * self ) {
+    if ( NULL != self ) {
+        if ( NULL != self -> returned ) {
+            rc_t rc = KConditionRelease( self -> returned );
+            if ( 0 != rc ) {
+                ErrMsg( "thread_budget.c destroy_thread_budget().KConditionRelease() -> %R", rc );
+            }
+        }
+        if ( NULL != self -> lock ) {
+            rc_t rc = KLockRelease( self -> lock );
+            if ( 0 != rc ) {
+                ErrMsg( "thread_budget.c destroy_thread_budget().KLockRelease() -> %R", rc );
+            }
+        }
+        free( ( void * ) self );
+    }
+}
+
+rc_t make_thread_budget( struct thread_budget_t ** budget, uint32_t total ) {
+    rc_t rc = 0;
+    if ( NULL == budget || 0 == total ) {
+        rc = RC( rcVDB, rcNoTarg, rcConstructing, rcParam, rcInvalid );
+        ErrMsg( "thread_budget.c make_thread_budget() -> %R", rc );
+    } else {
+        thread_budget_t * b = calloc( 1, sizeof * b );
+        if ( NULL == b ) {
+            rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+            ErrMsg( "thread_budget.c make_thread_budget().calloc( %d ) -> %R", ( sizeof * b ), rc );
+        } else {
+            rc = KLockMake( &( b -> lock ) );
+            if ( 0 != rc ) {
+                ErrMsg( "thread_budget.c make_thread_budget().KLockMake() -> %R", rc );
+            } else {
+                rc = KConditionMake( &( b -> returned ) );
+                if ( 0 != rc ) {
+                    ErrMsg( "thread_budget.c make_thread_budget().KConditionMake() -> %R", rc );
+                }
+            }
+            if ( 0 == rc ) {
+                b -> total = total;
+                b -> available = total;
+                *budget = b;
+            } else {
+                destroy_thread_budget( b );
+            }
+        }
+    }
+    return rc;
+}
+
+rc_t thread_budget_acquire( struct thread_budget_t * self, uint32_t wanted, uint32_t * granted ) {
+    rc_t rc = 0;
+    if ( NULL == granted || 0 == wanted ) {
+        rc = RC( rcVDB, rcNoTarg, rcAccessing, rcParam, rcInvalid );
+        ErrMsg( "thread_budget.c thread_budget_acquire() -> %R", rc );
+    } else if ( NULL == self ) {
+        *granted = wanted;
+    } else {
+        uint32_t min_grant = MIN_GRANT;
+        if ( min_grant > self -> total ) { min_grant = self -> total; }
+        if ( min_grant > wanted ) { min_grant = wanted; }
+
+        rc = KLockAcquire( self -> lock );
+        if ( 0 != rc ) {
+            ErrMsg( "thread_budget.c thread_budget_acquire().KLockAcquire() -> %R", rc );
+        } else {
+            while ( 0 == rc && self -> available < min_grant ) {
+                rc = KConditionWait( self -> returned, self -> lock );
+                if ( 0 != rc ) {
+                    ErrMsg( "thread_budget.c thread_budget_acquire().KConditionWait() -> %R", rc );
+                }
+            }
+            if ( 0 == rc ) {
+                uint32_t n = ( wanted < self -> available ) ? wanted : self -> available;
+                self -> available -= n;
+                *granted = n;
+            }
+            KLockUnlock( self -> lock );
+        }
+    }
+    return rc;
+}
+
+rc_t thread_budget_return( struct thread_budget_t * self, uint32_t count ) {
+    rc_t rc = 0;
+    if ( NULL != self && count > 0 ) {
+        rc = KLockAcquire( self -> lock );
+        if ( 0 != rc ) {
+            ErrMsg( "thread_budget.c thread_budget_return().KLockAcquire() -> %R", rc );
+        } else {
+            self -> available += count;
+            if ( self -> available > self -> total ) {
+                self -> available = self -> total;
+            }
+            rc = KConditionBroadcast( self -> returned );
+            if ( 0 != rc ) {
+                ErrMsg( "thread_budget.c thread_budget_return().KConditionBroadcast() -> %R", rc );
+            }
+            KLockUnlock( self -> lock );
+        }
+    }
+    return rc;
+}
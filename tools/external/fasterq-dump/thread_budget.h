@@ -0,0 +1,57 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#ifndef _h_thread_budget_
+#define _h_thread_budget_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+/* a pool of worker-threads shared by the accessions of a batch:
+   every parallel phase ( lookup-production, join ) takes threads out of it
+   before it starts and hands them back when it is done */
+struct thread_budget_t;
+
+rc_t make_thread_budget( struct thread_budget_t ** budget, uint32_t total );
+void destroy_thread_budget( struct thread_budget_t * self );
+
+/* blocks until at least 2 threads ( or the total if smaller ) are available,
+   grants as many as possible up to 'wanted'
+   a NULL-budget ( single accession ) grants 'wanted' without waiting */
+rc_t thread_budget_acquire( struct thread_budget_t * self, uint32_t wanted, uint32_t * granted );
+rc_t thread_budget_return( struct thread_budget_t * self, uint32_t count );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
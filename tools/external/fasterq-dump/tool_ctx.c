@@ -73,6 +73,9 @@ static rc_t print_tool_ctx( const tool_ctx_t * tool_ctx ) {
     if ( 0 == rc ) {
         rc = KOutMsg( "threads      : %u\n", tool_ctx -> num_threads );
     }
+    if ( 0 == rc ) {
+        rc = KOutMsg( "blob-reads   : '%s'\n", yes_or_no( tool_ctx -> join_options . blob_reads ) );
+    }
     if ( 0 == rc && tool_ctx -> row_limit > 0 ) {
         rc = KOutMsg( "row-limit    : %,lu rows\n", tool_ctx -> row_limit );
     }
@@ -532,14 +535,18 @@ rc_t populate_tool_ctx( tool_ctx_t * tool_ctx ) {
 
     bool fasta = is_format_fasta( tool_ctx -> fmt ); /* helper.c */
 
-    /* create the KDirectory-instance for all modules to use */
-    rc_t rc = KDirectoryNativeDir( &( tool_ctx -> dir ) );
-    if ( 0 != rc ) {
-        ErrMsg( "KDirectoryNativeDir() -> %R", rc );
+    /* create the KDirectory-instance for all modules to use
+       ( in batch-mode it is already there, shared by all accessions ) */
+    rc_t rc = 0;
+    if ( NULL == tool_ctx -> dir ) {
+        rc = KDirectoryNativeDir( &( tool_ctx -> dir ) );
+        if ( 0 != rc ) {
+            ErrMsg( "KDirectoryNativeDir() -> %R", rc );
+        }
     }
 
-    /* create the VDB-Manager-instance for all modules to use */
-    if ( 0 == rc ) {
+    /* create the VDB-Manager-instance for all modules to use ( shared in batch-mode ) */
+    if ( 0 == rc && NULL == tool_ctx -> vdb_mgr ) {
         rc = VDBManagerMakeRead( &( tool_ctx -> vdb_mgr ), tool_ctx -> dir );
         if ( 0 != rc ) {
             ErrMsg( "fasterq-dump.c populate_tool_ctx().VDBManagerMakeRead() -> %R\n", rc );
@@ -568,7 +575,8 @@ rc_t populate_tool_ctx( tool_ctx_t * tool_ctx ) {
     if ( 0 == rc && tool_ctx -> fmt != ft_fasta_us_split_spot ) {
         rc = make_temp_dir( &tool_ctx -> temp_dir,
                         tool_ctx -> requested_temp_path,
-                        tool_ctx -> dir ); /* temp_dir.c */
+                        tool_ctx -> dir,
+                        tool_ctx -> batch_idx ); /* temp_dir.c */
     }
 
     /* create the lookup- and index-filenames ( only if we need it! ) */
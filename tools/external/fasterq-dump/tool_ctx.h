@@ -73,6 +73,8 @@ typedef struct tool_ctx_t {
     char dflt_output[ DFLT_PATH_LEN ];
     
     struct KFastDumpCleanupTask_t * cleanup_task; /* cleanup_task.h */
+    struct thread_budget_t * thread_budget; /* thread_budget.h, shared in batch-mode, NULL otherwise */
+    uint32_t batch_idx;                     /* 1-based position in the batch, 0 if not in batch-mode */
     
     size_t cursor_cache, buf_size, mem_limit;
     size_t estimated_output_size;
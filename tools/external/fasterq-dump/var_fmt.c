@@ -26,6 +26,8 @@
 
 #include "var_fmt.h"
 
+#include <string.h>     /* memcpy(), memmove() */
+
 #ifndef _h_klib_out_
 #include <klib/out.h>
 #endif
@@ -248,66 +250,35 @@ static var_fmt_entry_t * clone_var_fmt_entry( const var_fmt_entry_t * src ) {
     return res;
 }
 
-static void var_fmt_String_to_buffer( SBuffer_t *buffer, const String * src ) {
-    if ( NULL != src && NULL != buffer ) {
-        uint32_t i = 0;
-        String * dst = &( buffer -> S );
-        char * dst_addr = ( char * )( dst -> addr );
-        while ( i < src -> len && dst -> len < buffer -> buffer_size ) {
-            dst_addr [ dst -> len ] = src -> addr[ i++ ];
-            dst -> len += 1;
-        }
-    }
-}
-
-static void var_fmt_entry_int_value_to_buffer( SBuffer_t *buffer, uint64_t value ) {
-    char temp[ 21 ];
-    size_t temp_written;
-    rc_t rc = string_printf ( temp, sizeof temp, &temp_written, "%lu", value );
-    if ( 0 == rc ) {
-        String S;
-        StringInitCString( &S, temp );
-        var_fmt_String_to_buffer( buffer, &S );
-    }
-}
-
-static void var_fmt_entry_int_to_buffer( const var_fmt_entry_t * self, SBuffer_t *buffer,
-                                         const uint64_t * args, size_t args_len ) {
-    if ( NULL != args && self -> idx < args_len ) {
-        var_fmt_entry_int_value_to_buffer( buffer, args[ self -> idx ] );
+/* two decimal digits at a time, the conversion runs right to left into a temp. buffer */
+static const char var_fmt_digit_pairs[ 201 ] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static size_t var_fmt_u64_to_dec( char * dst, uint64_t value ) {
+    char temp[ 20 ];    /* the length of max_uint64_t as string */
+    char * p = temp + sizeof temp;
+    size_t len;
+    while ( value >= 100 ) {
+        uint32_t two = ( uint32_t )( value % 100 );
+        value /= 100;
+        p -= 2;
+        memcpy( p, &( var_fmt_digit_pairs[ two * 2 ] ), 2 );
+    }
+    if ( value >= 10 ) {
+        p -= 2;
+        memcpy( p, &( var_fmt_digit_pairs[ value * 2 ] ), 2 );
+    } else {
+        *( --p ) = ( char )( '0' + value );
     }
+    len = ( temp + sizeof temp ) - p;
+    memcpy( dst, p, len );
+    return len;
 }
 
-/*we need both: str-args AND int-args, because of the alternative idx-usage */
-static void var_fmt_entry_str_to_buffer( const var_fmt_entry_t * self, SBuffer_t *buffer,
-                                         const String ** str_args, size_t str_args_len,
-                                         const uint64_t * int_args, size_t int_args_len ) {
-    if ( NULL != str_args && self -> idx < str_args_len ) {
-        const String * src = str_args[ self -> idx ];
-        if ( NULL != src ) {
-            /* we have a string to use */
-            if ( self -> idx2 == 0xFF ) {
-                /* there is no alternative -> print the string even if len == 0 */
-                var_fmt_String_to_buffer( buffer, src );
-            } else {
-                if ( src -> len > 0 ) {
-                    /* there is an alternative, but we have a valid string to print */
-                    var_fmt_String_to_buffer( buffer, src );
-                } else if ( NULL != int_args && self -> idx2 < int_args_len ) {
-                    /* there is an alternative - and we have an empty string -  */
-                    var_fmt_entry_int_value_to_buffer( buffer, int_args[ self -> idx2 ] );
-                }
-            }
-        } else if ( NULL != int_args && self -> idx2 < int_args_len ) {
-            /* the string-source is NULL, and we have an alternative to use */
-            var_fmt_entry_int_value_to_buffer( buffer, int_args[ self -> idx2 ] );
-        }
-    } else if ( NULL != int_args && self -> idx2 < int_args_len ) {
-        /* there is not even a array of strings, and we have an alternative to use */
-        var_fmt_entry_int_value_to_buffer( buffer, int_args[ self -> idx2 ] );
-    }
-}
-    
 /* releases an element, data-pointer to match VectorWhack-callback */
 static void destroy_var_fmt_entry( void * self, void * data ) {
     if ( NULL != self ) {
@@ -317,11 +288,32 @@ static void destroy_var_fmt_entry( void * self, void * data ) {
     }
 }
 
+/* ============================================================================================================= */
+/* private: the compiled form of the elements, a flat array of instructions executed per spot */
+typedef enum var_fmt_op_code_t {
+    vop_literal,            /* copy a span of the literal-pool */
+    vop_str,                /* copy str-arg #idx */
+    vop_str_or_int,         /* copy str-arg #idx, if it is NULL or empty print int-arg #idx2 */
+    vop_int                 /* print int-arg #idx as decimal */
+} var_fmt_op_code_t;
+
+typedef struct var_fmt_op_t {
+    var_fmt_op_code_t code;
+    uint32_t offset;        /* vop_literal: start of the span in the literal-pool */
+    uint32_t len;           /* vop_literal: length of the span */
+    uint8_t idx;
+    uint8_t idx2;
+} var_fmt_op_t;
+/* ============================================================================================================= */
+
 /* ============================================================================================================= */
 typedef struct var_fmt_t {
     Vector elements;        /* the elements are pointers to var_fmt_entry_t - structs */
     size_t fixed_len;       /* sum of all literal elements + sum of dflt-len of int-elements */
     SBuffer_t buffer;       /* internal buffer to print into */
+    var_fmt_op_t * ops;     /* the compiled elements, adjacent literals are merged */
+    uint32_t num_ops;
+    char * pool;            /* all literals, back to back */
 } var_fmt_t;
 /* ============================================================================================================= */
 
@@ -361,12 +353,78 @@ static size_t var_fmt_calc_fixed_len( Vector * v ) {
         switch( entry -> type ) {
             case vft_literal: res += entry -> literal -> len; break;
             case vft_int    : res += 20; break;     /* the length of max_uint64_t as string */
-            case vft_str    : break;    /* we do not know yet... */
+            case vft_str    : if ( entry -> idx2 != 0xFF ) { res += 20; } break; /* room for the alternative */
         }
     }
     return res;
 }
 
+/* translate the elements into the flat instruction-array, called after every change of the elements */
+static void var_fmt_compile( var_fmt_t * self ) {
+    const Vector * v = &( self -> elements );
+    uint32_t i, l = VectorLength( v );
+    size_t pool_len = 0;
+
+    free( ( void * ) self -> ops );
+    free( ( void * ) self -> pool );
+    self -> ops = NULL;
+    self -> pool = NULL;
+    self -> num_ops = 0;
+
+    for ( i = VectorStart( v ); i < l; ++i ) {
+        const var_fmt_entry_t * entry = VectorGet( v, i );
+        if ( NULL != entry && vft_literal == entry -> type ) {
+            pool_len += entry -> literal -> len;
+        }
+    }
+    self -> ops = calloc( l > 0 ? l : 1, sizeof self -> ops[ 0 ] );
+    self -> pool = malloc( pool_len > 0 ? pool_len : 1 );
+    if ( NULL == self -> ops || NULL == self -> pool ) {
+        free( ( void * ) self -> ops );
+        free( ( void * ) self -> pool );
+        self -> ops = NULL;
+        self -> pool = NULL;
+    } else {
+        uint32_t pool_pos = 0;
+        for ( i = VectorStart( v ); i < l; ++i ) {
+            const var_fmt_entry_t * entry = VectorGet( v, i );
+            if ( NULL != entry ) {
+                var_fmt_op_t * prev = ( self -> num_ops > 0 ) ? &( self -> ops[ self -> num_ops - 1 ] ) : NULL;
+                var_fmt_op_t * op = &( self -> ops[ self -> num_ops ] );
+                switch( entry -> type ) {
+                    case vft_literal : {
+                            uint32_t len = entry -> literal -> len;
+                            if ( len > 0 ) {
+                                memmove( self -> pool + pool_pos, entry -> literal -> addr, len );
+                                if ( NULL != prev && vop_literal == prev -> code ) {
+                                    /* the pool is filled in order: the span continues the previous one */
+                                    prev -> len += len;
+                                } else {
+                                    op -> code = vop_literal;
+                                    op -> offset = pool_pos;
+                                    op -> len = len;
+                                    self -> num_ops++;
+                                }
+                                pool_pos += len;
+                            }
+                        } break;
+
+                    case vft_str : op -> code = ( 0xFF == entry -> idx2 ) ? vop_str : vop_str_or_int;
+                                   op -> idx = entry -> idx;
+                                   op -> idx2 = entry -> idx2;
+                                   self -> num_ops++;
+                                   break;
+
+                    case vft_int : op -> code = vop_int;
+                                   op -> idx = entry -> idx;
+                                   self -> num_ops++;
+                                   break;
+                }
+            }
+        }
+    }
+}
+
 /* create an empty var-print struct, to be added into later */
 struct var_fmt_t * create_empty_var_fmt( size_t buffer_size ) {
     var_fmt_t * self = calloc( 1, sizeof * self );
@@ -399,6 +457,7 @@ void var_fmt_append( struct var_fmt_t * self,  const String * fmt, const struct
         /* calculate new fixed-len, and adjust print-buffer */
         self -> fixed_len = var_fmt_calc_fixed_len( &( self -> elements ) );
         increase_SBuffer_to( &( self -> buffer ), ( self -> fixed_len * 4 ) );
+        var_fmt_compile( self );
     }
 }
 
@@ -439,16 +498,41 @@ struct var_fmt_t * var_fmt_clone( const struct var_fmt_t * src ) {
             }
             self -> fixed_len = var_fmt_calc_fixed_len( &( self -> elements ) );
             increase_SBuffer_to( &( self -> buffer ), ( self -> fixed_len * 4 ) );
+            var_fmt_compile( self );
         }
     }
     return self;
 }
 
+/* turn every use of str-arg #idx into a literal: for arguments that do not change
+   during the lifetime of the format, like the accession */
+void var_fmt_set_const_str( struct var_fmt_t * self, uint32_t idx, const String * value ) {
+    if ( NULL != self && NULL != value ) {
+        const Vector * v = &( self -> elements );
+        uint32_t i, l = VectorLength( v );
+        for ( i = VectorStart( v ); i < l; ++i ) {
+            var_fmt_entry_t * entry = VectorGet( v, i );
+            /* an empty value with an alternative has to stay dynamic */
+            if ( NULL != entry && vft_str == entry -> type && idx == entry -> idx &&
+                 ( 0xFF == entry -> idx2 || value -> len > 0 ) ) {
+                if ( 0 == StringCopy( &( entry -> literal ), value ) ) {
+                    entry -> type = vft_literal;
+                }
+            }
+        }
+        self -> fixed_len = var_fmt_calc_fixed_len( &( self -> elements ) );
+        increase_SBuffer_to( &( self -> buffer ), ( self -> fixed_len * 4 ) );
+        var_fmt_compile( self );
+    }
+}
+
 /* release a var-print struct and call destructors on its elements */
 void release_var_fmt( struct var_fmt_t * self ) {
     if ( NULL != self ) {
         VectorWhack ( &( self -> elements ), destroy_var_fmt_entry, NULL );
         release_SBuffer( &( self -> buffer ) );
+        free( ( void * ) self -> ops );
+        free( ( void * ) self -> pool );
         free( ( void * ) self );
     }
 }
@@ -457,19 +541,14 @@ size_t var_fmt_buffer_size( const struct var_fmt_t * self,
                     const String ** str_args, size_t str_args_len ) {
     size_t res = 0;
     if ( NULL != self ) {
-        const Vector * v = &( self -> elements );
-        uint32_t i, l = VectorLength( v );
+        uint32_t i;
         res = self -> fixed_len;
-        for ( i = VectorStart( v ); i < l; ++i ) {
-            const var_fmt_entry_t * entry = VectorGet( v, i );
-            if ( NULL != entry ) {
-                if ( vft_str == entry -> type ) {
-                    if ( entry -> idx < str_args_len ) {
-                        const String * S = str_args[ entry -> idx ];
-                        if ( NULL != S ) {
-                            res += S -> len;
-                        }
-                    }
+        for ( i = 0; NULL != str_args && i < self -> num_ops; ++i ) {
+            const var_fmt_op_t * op = &( self -> ops[ i ] );
+            if ( ( vop_str == op -> code || vop_str_or_int == op -> code ) && op -> idx < str_args_len ) {
+                const String * S = str_args[ op -> idx ];
+                if ( NULL != S ) {
+                    res += S -> len;
                 }
             }
         }
@@ -502,7 +581,7 @@ SBuffer_t * var_fmt_to_buffer( struct var_fmt_t * self,
                     const String ** str_args, size_t str_args_len,
                     const uint64_t * int_args, size_t int_args_len ) {
     SBuffer_t * res = NULL;
-    if ( NULL != self )
+    if ( NULL != self && NULL != self -> ops )
     {
         size_t needed = var_fmt_buffer_size( self, str_args, str_args_len ); /* above */
         if ( needed > 0 )
@@ -510,33 +589,44 @@ SBuffer_t * var_fmt_to_buffer( struct var_fmt_t * self,
             rc_t rc = increase_SBuffer_to( &( self -> buffer ), needed ); /* does nothing if not neccessary */
             if ( 0 == rc )
             {
-                SBuffer_t * dst = &( self -> buffer );
-                self -> buffer . S . len = 0;
-                self -> buffer . S . size = 0;
-                
-                const Vector * v = &( self -> elements );
-                uint32_t i, l = VectorLength( v );
-                for ( i = VectorStart( v ); i < l; ++i ) {
-                    const var_fmt_entry_t * entry = VectorGet( v, i );
-                    if ( NULL != entry ) {
-                        switch ( entry -> type ) {
-                            /* we enter a string literal */
-                            case vft_literal : var_fmt_String_to_buffer( dst,
-                                                                         entry -> literal );
-                                               break;
-
-                            /* we enter a string argument ( supply the int-vector too, because of the alternative! ) */
-                            case vft_str    : var_fmt_entry_str_to_buffer( entry, dst,
-                                                                           str_args, str_args_len,
-                                                                           int_args, int_args_len );
-                                              break;
-
-                            /* we enter a int argument */
-                            case vft_int    : var_fmt_entry_int_to_buffer( entry, dst, int_args, int_args_len ); break;
-                        }
+                /* needed is an upper bound: every instruction writes without checking */
+                char * dst = ( char * )( self -> buffer . S . addr );
+                size_t pos = 0;
+                uint32_t i;
+                for ( i = 0; i < self -> num_ops; ++i ) {
+                    const var_fmt_op_t * op = &( self -> ops[ i ] );
+                    switch ( op -> code ) {
+                        case vop_literal : memmove( dst + pos, self -> pool + op -> offset, op -> len );
+                                           pos += op -> len;
+                                           break;
+
+                        case vop_str : if ( NULL != str_args && op -> idx < str_args_len ) {
+                                            const String * S = str_args[ op -> idx ];
+                                            if ( NULL != S ) {
+                                                memmove( dst + pos, S -> addr, S -> len );
+                                                pos += S -> len;
+                                            }
+                                       }
+                                       break;
+
+                        case vop_str_or_int : {
+                                const String * S = ( NULL != str_args && op -> idx < str_args_len ) ? str_args[ op -> idx ] : NULL;
+                                if ( NULL != S && S -> len > 0 ) {
+                                    memmove( dst + pos, S -> addr, S -> len );
+                                    pos += S -> len;
+                                } else if ( NULL != int_args && op -> idx2 < int_args_len ) {
+                                    pos += var_fmt_u64_to_dec( dst + pos, int_args[ op -> idx2 ] );
+                                }
+                            } break;
+
+                        case vop_int : if ( NULL != int_args && op -> idx < int_args_len ) {
+                                            pos += var_fmt_u64_to_dec( dst + pos, int_args[ op -> idx ] );
+                                       }
+                                       break;
                     }
                 }
-                self -> buffer . S . size = self -> buffer . S . len;
+                self -> buffer . S . len = ( uint32_t )pos;
+                self -> buffer . S . size = pos;
                 res = &( self -> buffer );
             }
         }
@@ -74,6 +74,9 @@ void var_fmt_append( struct var_fmt_t * self,  const String * fmt, const struct
 void var_fmt_append_str( struct var_fmt_t * self,  const char * fmt, const struct var_desc_list_t * vars );
 struct var_fmt_t * var_fmt_clone( const struct var_fmt_t * src );
 
+/* fold a str-arg that does not change ( e.g. the accession ) into the literals */
+void var_fmt_set_const_str( struct var_fmt_t * self, uint32_t idx, const String * value );
+
 void var_fmt_debug( const struct var_fmt_t * self );
 
 void release_var_fmt( struct var_fmt_t * self );
@@ -0,0 +1,833 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "mate_lookup.h"
+
+#ifndef _h_klib_log_
+#include <klib/log.h>
+#endif
+
+#ifndef _h_klib_text_
+#include <klib/text.h>
+#endif
+
+#ifndef _h_klib_printf_
+#include <klib/printf.h>
+#endif
+
+#ifndef _h_klib_container_
+#include <klib/container.h>
+#endif
+
+#ifndef _h_kfs_directory_
+#include <kfs/directory.h>
+#endif
+
+#ifndef _h_kfs_file_
+#include <kfs/file.h>
+#endif
+
+#ifndef _h_kfs_mmap_
+#include <kfs/mmap.h>
+#endif
+
+#ifndef _h_kproc_thread_
+#include <kproc/thread.h>
+#endif
+
+#ifndef _h_read_fkt_
+#include "read_fkt.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+rc_t Quitting( void );      /* instead of including <kapp/main.h> */
+
+/* the 4 code-bits in the upper nibble of a mate-entry */
+#define MATE_ID_MASK        0x0FFFFFFFFFFFFFFFLL
+#define MATE_CODE_SHIFT     60
+#define MATE_CODE_PAIRED    0x8
+#define MATE_CODE_CRITERIA  0x4     /* READ_FILTER_CRITERIA ---> 0x400 */
+#define MATE_CODE_REJECT    0x2     /* READ_FILTER_REJECT   ---> 0x200 */
+#define MATE_CODE_READ2     0x1
+
+#define PLACE_REVERSED      0x80000000
+#define PLACE_IDX_MASK      0x7FFFFFFF
+
+#define QUAL_WRITE_BUFFER   ( 1024 * 1024 )
+#define QUITTING_CHECK      0xFFFF
+
+#define COL_PRIM_AL_ID      "(I64)PRIMARY_ALIGNMENT_ID"
+#define COL_RD_FILTER       "(INSDC:SRA:read_filter)READ_FILTER"
+#define COL_RD_LEN          "(INSDC:coord:len)READ_LEN"
+#define COL_QUALITY         "(INSDC:quality:text:phred_33)QUALITY"
+#define COL_REF_NAME        "(ascii)REF_NAME"
+#define COL_REF_SEQ_ID      "(ascii)REF_SEQ_ID"
+#define COL_REF_POS         "(INSDC:coord:zero)REF_POS"
+#define COL_REF_LEN         "(INSDC:coord:len)REF_LEN"
+#define COL_REF_ORIENT      "(bool)REF_ORIENTATION"
+
+typedef struct ml_place {
+    uint32_t ref_idx;           /* bit 31 ... reversed */
+    INSDC_coord_zero ref_pos;
+    INSDC_coord_len ref_len;
+} ml_place;
+
+/* one memory-mapped lookup-file */
+typedef struct ml_map {
+    KFile * f;
+    KMMap * mm;
+    void * addr;
+    uint64_t size;
+    char path[ 4096 ];
+} ml_map;
+
+typedef struct ml_ref_name {
+    BSTNode node;
+    uint32_t idx;
+    String name;
+} ml_ref_name;
+
+typedef struct ml_per_file {
+    const VDatabase * db;
+    const VCursor * prim_cursor;    /* opened up front, handed to the place-thread */
+    uint32_t ref_name_idx;
+    uint32_t ref_pos_idx;
+    uint32_t ref_len_idx;
+    uint32_t ref_orient_idx;
+    KDirectory * dir;
+    uint32_t db_idx;
+
+    int64_t first;                  /* the row-range of PRIMARY_ALIGNMENT */
+    uint64_t count;
+
+    ml_map mate;
+    ml_map place;
+    ml_map qual_idx;
+    ml_map qual;
+
+    BSTree ref_names;               /* ml_ref_name, by name */
+    Vector ref_by_idx;              /* ml_ref_name, by idx */
+
+    char * qual_buffer;             /* reversed quality for output */
+    size_t qual_buffer_size;
+
+    bool use_seqid;
+    bool with_qual;
+} ml_per_file;
+
+struct mate_lookup {
+    ml_per_file * per_file;
+    uint32_t count;
+};
+
+/* ----------------------------------------------------------------------------------------------- */
+
+static rc_t ml_map_update( ml_map * self ) {
+    rc_t rc = KMMapMakeUpdate( &( self -> mm ), self -> f );
+    if ( rc == 0 ) {
+        rc = KMMapAddrUpdate( self -> mm, &( self -> addr ) );
+    }
+    if ( rc != 0 ) {
+        (void)PLOGERR( klogErr, ( klogErr, rc, "cannot memory-map lookup-file '$(f)'", "f=%s", self -> path ) );
+    }
+    return rc;
+}
+
+static rc_t ml_map_create( ml_map * self, KDirectory * dir, const char * base,
+                           uint32_t db_idx, const char * ext, uint64_t size ) {
+    size_t written;
+    rc_t rc = string_printf( self -> path, sizeof self -> path, &written, "%s/%u.%s", base, db_idx, ext );
+    if ( rc != 0 ) {
+        (void)PLOGERR( klogErr, ( klogErr, rc, "cannot build path of lookup-file in '$(d)'", "d=%s", base ) );
+    } else {
+        rc = KDirectoryCreateFile( dir, &( self -> f ), true, 0664, kcmInit | kcmParents, "%s", self -> path );
+        if ( rc != 0 ) {
+            (void)PLOGERR( klogErr, ( klogErr, rc, "cannot create lookup-file '$(f)'", "f=%s", self -> path ) );
+        } else if ( size > 0 ) {
+            rc = KFileSetSize( self -> f, size );
+            if ( rc != 0 ) {
+                (void)PLOGERR( klogErr, ( klogErr, rc, "cannot set size of lookup-file '$(f)'", "f=%s", self -> path ) );
+            } else {
+                rc = ml_map_update( self );
+            }
+        }
+    }
+    return rc;
+}
+
+static void ml_map_release( ml_map * self, KDirectory * dir ) {
+    if ( self -> mm != NULL ) {
+        KMMapRelease( self -> mm );
+        self -> mm = NULL;
+    }
+    if ( self -> f != NULL ) {
+        KFileRelease( self -> f );
+        self -> f = NULL;
+        KDirectoryRemove( dir, false, "%s", self -> path );
+    }
+    self -> addr = NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+
+static int64_t CC ml_ref_name_vs_string( const void * item, const BSTNode * n ) {
+    const String * name = item;
+    const ml_ref_name * node = ( const ml_ref_name * )n;
+    return StringCompare( name, &( node -> name ) );
+}
+
+static int64_t CC ml_ref_name_vs_ref_name( const BSTNode * item, const BSTNode * n ) {
+    const ml_ref_name * a = ( const ml_ref_name * )item;
+    const ml_ref_name * b = ( const ml_ref_name * )n;
+    return StringCompare( &( a -> name ), &( b -> name ) );
+}
+
+static void CC ml_ref_name_whack( BSTNode * n, void * data ) {
+    free( n );
+}
+
+/* the alignments come sorted by reference, the last one found is the most likely one */
+static rc_t ml_intern_ref_name( ml_per_file * pf, const char * name, uint32_t name_len,
+                                ml_ref_name ** last, uint32_t * idx ) {
+    rc_t rc = 0;
+    String s;
+    StringInit( &s, name, name_len, name_len );
+    if ( *last == NULL || StringCompare( &s, &( ( *last ) -> name ) ) != 0 ) {
+        ml_ref_name * node = ( ml_ref_name * )BSTreeFind( &( pf -> ref_names ), &s, ml_ref_name_vs_string );
+        if ( node == NULL ) {
+            node = malloc( sizeof * node + name_len + 1 );
+            if ( node == NULL ) {
+                rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+                (void)LOGERR( klogErr, rc, "cannot allocate reference-name for mate-lookup" );
+            } else {
+                char * dst = ( char * )( node + 1 );
+                memmove( dst, name, name_len );
+                dst[ name_len ] = 0;
+                StringInit( &( node -> name ), dst, name_len, name_len );
+                node -> idx = VectorLength( &( pf -> ref_by_idx ) );
+                rc = VectorAppend( &( pf -> ref_by_idx ), NULL, node );
+                if ( rc == 0 ) {
+                    rc = BSTreeInsert( &( pf -> ref_names ), &( node -> node ), ml_ref_name_vs_ref_name );
+                }
+                if ( rc != 0 ) {
+                    (void)LOGERR( klogErr, rc, "cannot store reference-name for mate-lookup" );
+                }
+            }
+        }
+        *last = node;
+    }
+    if ( rc == 0 ) {
+        *idx = ( *last ) -> idx;
+    }
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+
+static rc_t ml_open_seq_cursor( const ml_per_file * pf, const VCursor ** cursor ) {
+    const VTable * tbl;
+    rc_t rc = VDatabaseOpenTableRead( pf -> db, &tbl, "SEQUENCE" );
+    if ( rc != 0 ) {
+        (void)LOGERR( klogErr, rc, "VDatabaseOpenTableRead( SEQUENCE ) failed" );
+    } else {
+        rc = VTableCreateCursorRead( tbl, cursor );
+        if ( rc != 0 ) {
+            (void)LOGERR( klogErr, rc, "VTableCreateCursorRead( SEQUENCE ) failed" );
+        }
+        VTableRelease( tbl );
+    }
+    return rc;
+}
+
+static bool ml_valid_align_id( const ml_per_file * pf, int64_t align_id ) {
+    return ( align_id >= pf -> first && align_id < pf -> first + ( int64_t )pf -> count );
+}
+
+/* the mate of read #idx is the next other read of the spot that aligned */
+static int64_t ml_mate_of( const ml_per_file * pf, const int64_t * al_ids, uint32_t n, uint32_t idx ) {
+    uint32_t i;
+    for ( i = 1; i < n; ++i ) {
+        int64_t id = al_ids[ ( idx + i ) % n ];
+        if ( ml_valid_align_id( pf, id ) ) {
+            return id;
+        }
+    }
+    return 0;
+}
+
+/* thread #1 : walks SEQUENCE, PRIMARY_ALIGNMENT_ID and READ_FILTER into <db_idx>.mate */
+static rc_t CC ml_build_mate( const KThread * self, void * data ) {
+    ml_per_file * pf = data;
+    const VCursor * cursor;
+    rc_t rc = ml_open_seq_cursor( pf, &cursor );
+    if ( rc == 0 ) {
+        uint32_t al_id_idx, rd_filter_idx;
+        rc = add_column( cursor, COL_PRIM_AL_ID, &al_id_idx ); /* read_fkt.c */
+        if ( rc == 0 ) {
+            rc = add_column( cursor, COL_RD_FILTER, &rd_filter_idx ); /* read_fkt.c */
+        }
+        if ( rc == 0 ) {
+            rc = VCursorOpen( cursor );
+            if ( rc != 0 ) {
+                (void)LOGERR( klogErr, rc, "cannot open SEQUENCE-cursor for mate-lookup" );
+            }
+        }
+        if ( rc == 0 ) {
+            int64_t first, row;
+            uint64_t count;
+            rc = VCursorIdRange( cursor, al_id_idx, &first, &count );
+            for ( row = first; rc == 0 && row < first + ( int64_t )count; ++row ) {
+                const int64_t * al_ids;
+                uint32_t n, idx;
+                rc = read_int64_ptr( row, cursor, al_id_idx, &al_ids, &n, "PRIMARY_ALIGNMENT_ID" );
+                for ( idx = 0; rc == 0 && idx < n; ++idx ) {
+                    if ( ml_valid_align_id( pf, al_ids[ idx ] ) ) {
+                        const INSDC_read_filter * rd_filter;
+                        uint32_t n_filter;
+                        uint64_t codes = ( n > 1 ) ? MATE_CODE_PAIRED : 0;
+                        uint64_t * mates = pf -> mate . addr;
+
+                        /* the read-filter is only needed for aligned reads */
+                        rc = read_INSDC_read_filter_ptr( row, cursor, rd_filter_idx, &rd_filter, &n_filter, "READ_FILTER" );
+                        if ( rc == 0 && idx < n_filter ) {
+                            if ( ( rd_filter[ idx ] & READ_FILTER_REJECT ) == READ_FILTER_REJECT ) {
+                                codes |= MATE_CODE_REJECT;
+                            }
+                            if ( ( rd_filter[ idx ] & READ_FILTER_CRITERIA ) == READ_FILTER_CRITERIA ) {
+                                codes |= MATE_CODE_CRITERIA;
+                            }
+                        }
+                        if ( idx == 1 ) {
+                            codes |= MATE_CODE_READ2;
+                        }
+                        mates[ al_ids[ idx ] - pf -> first ] =
+                            ( ( uint64_t )ml_mate_of( pf, al_ids, n, idx ) & MATE_ID_MASK ) |
+                            ( codes << MATE_CODE_SHIFT );
+                    }
+                }
+                if ( rc == 0 && ( row & QUITTING_CHECK ) == 0 ) {
+                    rc = Quitting();
+                }
+            }
+        }
+        VCursorRelease( cursor );
+    }
+    return rc;
+}
+
+typedef struct ml_qual_writer {
+    KFile * f;
+    uint64_t pos;       /* of buffer[ 0 ] in the file */
+    char * buffer;
+    size_t used;
+} ml_qual_writer;
+
+static rc_t ml_qual_writer_flush( ml_qual_writer * w ) {
+    rc_t rc = 0;
+    if ( w -> used > 0 ) {
+        size_t written;
+        rc = KFileWriteAll( w -> f, w -> pos, w -> buffer, w -> used, &written );
+        if ( rc == 0 && written != w -> used ) {
+            rc = RC( rcApp, rcFile, rcWriting, rcTransfer, rcIncomplete );
+        }
+        if ( rc != 0 ) {
+            (void)LOGERR( klogErr, rc, "cannot write quality-lookup" );
+        }
+        w -> pos += w -> used;
+        w -> used = 0;
+    }
+    return rc;
+}
+
+static rc_t ml_qual_writer_append( ml_qual_writer * w, const void * src, size_t len ) {
+    rc_t rc = 0;
+    if ( w -> used + len > QUAL_WRITE_BUFFER ) {
+        rc = ml_qual_writer_flush( w );
+    }
+    if ( rc == 0 ) {
+        if ( len > QUAL_WRITE_BUFFER ) {
+            size_t written;
+            rc = KFileWriteAll( w -> f, w -> pos, src, len, &written );
+            if ( rc != 0 ) {
+                (void)LOGERR( klogErr, rc, "cannot write quality-lookup" );
+            }
+            w -> pos += len;
+        } else {
+            memmove( w -> buffer + w -> used, src, len );
+            w -> used += len;
+        }
+    }
+    return rc;
+}
+
+/* thread #2 : walks SEQUENCE, splits QUALITY by READ_LEN into <db_idx>.qual and <db_idx>.qual.idx */
+static rc_t CC ml_build_qual( const KThread * self, void * data ) {
+    ml_per_file * pf = data;
+    ml_qual_writer w;
+    const VCursor * cursor;
+    rc_t rc;
+
+    memset( &w, 0, sizeof w );
+    w . f = pf -> qual . f;
+    w . buffer = malloc( QUAL_WRITE_BUFFER );
+    if ( w . buffer == NULL ) {
+        rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+        (void)LOGERR( klogErr, rc, "cannot allocate quality-lookup buffer" );
+        return rc;
+    }
+
+    rc = ml_open_seq_cursor( pf, &cursor );
+    if ( rc == 0 ) {
+        uint32_t al_id_idx, rd_len_idx, qual_idx;
+        rc = add_column( cursor, COL_PRIM_AL_ID, &al_id_idx ); /* read_fkt.c */
+        if ( rc == 0 ) {
+            rc = add_column( cursor, COL_RD_LEN, &rd_len_idx ); /* read_fkt.c */
+        }
+        if ( rc == 0 ) {
+            rc = add_column( cursor, COL_QUALITY, &qual_idx ); /* read_fkt.c */
+        }
+        if ( rc == 0 ) {
+            rc = VCursorOpen( cursor );
+            if ( rc != 0 ) {
+                (void)LOGERR( klogErr, rc, "cannot open SEQUENCE-cursor for quality-lookup" );
+            }
+        }
+        if ( rc == 0 ) {
+            int64_t first, row;
+            uint64_t count;
+            uint64_t * offsets = pf -> qual_idx . addr;
+            rc = VCursorIdRange( cursor, al_id_idx, &first, &count );
+            for ( row = first; rc == 0 && row < first + ( int64_t )count; ++row ) {
+                const int64_t * al_ids;
+                uint32_t n, idx;
+                bool aligned = false;
+                rc = read_int64_ptr( row, cursor, al_id_idx, &al_ids, &n, "PRIMARY_ALIGNMENT_ID" );
+                for ( idx = 0; rc == 0 && idx < n && !aligned; ++idx ) {
+                    aligned = ml_valid_align_id( pf, al_ids[ idx ] );
+                }
+                if ( rc == 0 && aligned ) {
+                    const INSDC_coord_len * rd_len;
+                    const char * qual;
+                    uint32_t n_len, qual_len, start = 0;
+                    rc = read_INSDC_coord_len_ptr( row, cursor, rd_len_idx, &rd_len, &n_len, "READ_LEN" );
+                    if ( rc == 0 ) {
+                        rc = read_char_ptr( row, cursor, qual_idx, &qual, &qual_len, "QUALITY" );
+                    }
+                    for ( idx = 0; rc == 0 && idx < n && idx < n_len; ++idx ) {
+                        uint32_t len = rd_len[ idx ];
+                        if ( start + len > qual_len ) {
+                            len = ( start < qual_len ) ? qual_len - start : 0;
+                        }
+                        if ( ml_valid_align_id( pf, al_ids[ idx ] ) ) {
+                            /* offset + 1, a zero ( from KFileSetSize ) means: no quality for this alignment */
+                            offsets[ al_ids[ idx ] - pf -> first ] = w . pos + w . used + 1;
+                            rc = ml_qual_writer_append( &w, &len, sizeof len );
+                            if ( rc == 0 ) {
+                                rc = ml_qual_writer_append( &w, qual + start, len );
+                            }
+                        }
+                        start += rd_len[ idx ];
+                    }
+                }
+                if ( rc == 0 && ( row & QUITTING_CHECK ) == 0 ) {
+                    rc = Quitting();
+                }
+            }
+            if ( rc == 0 ) {
+                rc = ml_qual_writer_flush( &w );
+            }
+        }
+        VCursorRelease( cursor );
+    }
+    free( w . buffer );
+    return rc;
+}
+
+/* thread #3 : walks PRIMARY_ALIGNMENT, the placement of each alignment into <db_idx>.place */
+static rc_t CC ml_build_place( const KThread * self, void * data ) {
+    ml_per_file * pf = data;
+    const VCursor * cursor = pf -> prim_cursor;
+    ml_place * places = pf -> place . addr;
+    ml_ref_name * last = NULL;
+    int64_t row;
+    rc_t rc = 0;
+    for ( row = pf -> first; rc == 0 && row < pf -> first + ( int64_t )pf -> count; ++row ) {
+        ml_place * p = &( places[ row - pf -> first ] );
+        const char * ref_name;
+        uint32_t ref_name_len;
+        bool reversed;
+        rc = read_char_ptr( row, cursor, pf -> ref_name_idx, &ref_name, &ref_name_len, "REF_NAME" );
+        if ( rc == 0 ) {
+            rc = ml_intern_ref_name( pf, ref_name, ref_name_len, &last, &( p -> ref_idx ) );
+        }
+        if ( rc == 0 ) {
+            rc = read_INSDC_coord_zero( row, cursor, pf -> ref_pos_idx, &( p -> ref_pos ), 0, "REF_POS" );
+        }
+        if ( rc == 0 ) {
+            rc = read_INSDC_coord_len( row, cursor, pf -> ref_len_idx, &( p -> ref_len ), 0, "REF_LEN" );
+        }
+        if ( rc == 0 ) {
+            rc = read_bool( row, cursor, pf -> ref_orient_idx, &reversed, false, "REF_ORIENTATION" );
+            if ( rc == 0 && reversed ) {
+                p -> ref_idx |= PLACE_REVERSED;
+            }
+        }
+        if ( rc == 0 && ( row & QUITTING_CHECK ) == 0 ) {
+            rc = Quitting();
+        }
+    }
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+
+static rc_t ml_start( KThread ** t, rc_t ( CC * f ) ( const KThread *, void * ), ml_per_file * pf ) {
+    rc_t rc = KThreadMake( t, f, pf );
+    if ( rc != 0 ) {
+        (void)LOGERR( klogErr, rc, "cannot start mate-lookup thread" );
+        *t = NULL;
+    }
+    return rc;
+}
+
+static rc_t ml_join( KThread * t, rc_t rc ) {
+    if ( t != NULL ) {
+        rc_t status = 0;
+        rc_t rc2 = KThreadWait( t, &status );
+        if ( rc2 == 0 ) {
+            rc2 = status;
+        }
+        if ( rc == 0 ) {
+            rc = rc2;
+        }
+        KThreadRelease( t );
+    }
+    return rc;
+}
+
+static rc_t ml_build_per_file( ml_per_file * pf, const char * dir ) {
+    const VTable * tbl;
+    rc_t rc = VDatabaseOpenTableRead( pf -> db, &tbl, "PRIMARY_ALIGNMENT" );
+    if ( rc != 0 ) {
+        (void)LOGERR( klogErr, rc, "VDatabaseOpenTableRead( PRIMARY_ALIGNMENT ) failed" );
+    } else {
+        rc = VTableCreateCursorRead( tbl, &( pf -> prim_cursor ) );
+        if ( rc != 0 ) {
+            (void)LOGERR( klogErr, rc, "VTableCreateCursorRead( PRIMARY_ALIGNMENT ) failed" );
+        } else {
+            const VCursor * cursor = pf -> prim_cursor;
+            rc = add_column( cursor, pf -> use_seqid ? COL_REF_SEQ_ID : COL_REF_NAME, &( pf -> ref_name_idx ) ); /* read_fkt.c */
+            if ( rc == 0 ) {
+                rc = add_column( cursor, COL_REF_POS, &( pf -> ref_pos_idx ) ); /* read_fkt.c */
+            }
+            if ( rc == 0 ) {
+                rc = add_column( cursor, COL_REF_LEN, &( pf -> ref_len_idx ) ); /* read_fkt.c */
+            }
+            if ( rc == 0 ) {
+                rc = add_column( cursor, COL_REF_ORIENT, &( pf -> ref_orient_idx ) ); /* read_fkt.c */
+            }
+            if ( rc == 0 ) {
+                rc = VCursorOpen( cursor );
+                if ( rc != 0 ) {
+                    (void)LOGERR( klogErr, rc, "cannot open PRIMARY_ALIGNMENT-cursor for mate-lookup" );
+                }
+            }
+            if ( rc == 0 ) {
+                /* the row-range of PRIMARY_ALIGNMENT gives the size of all the lookups */
+                rc = VCursorIdRange( cursor, pf -> ref_len_idx, &( pf -> first ), &( pf -> count ) );
+                if ( rc != 0 ) {
+                    (void)LOGERR( klogErr, rc, "cannot detect row-range of PRIMARY_ALIGNMENT" );
+                }
+            }
+        }
+        VTableRelease( tbl );
+    }
+
+    if ( rc == 0 && pf -> count > 0 ) {
+        rc = ml_map_create( &( pf -> mate ), pf -> dir, dir, pf -> db_idx, "mate", pf -> count * sizeof( uint64_t ) );
+        if ( rc == 0 ) {
+            rc = ml_map_create( &( pf -> place ), pf -> dir, dir, pf -> db_idx, "place", pf -> count * sizeof( ml_place ) );
+        }
+        if ( rc == 0 && pf -> with_qual ) {
+            rc = ml_map_create( &( pf -> qual_idx ), pf -> dir, dir, pf -> db_idx, "qual.idx", pf -> count * sizeof( uint64_t ) );
+            if ( rc == 0 ) {
+                rc = ml_map_create( &( pf -> qual ), pf -> dir, dir, pf -> db_idx, "qual", 0 );
+            }
+        }
+        if ( rc == 0 ) {
+            KThread * t_mate = NULL;
+            KThread * t_qual = NULL;
+            KThread * t_place = NULL;
+
+            rc = ml_start( &t_mate, ml_build_mate, pf );
+            if ( rc == 0 && pf -> with_qual ) {
+                rc = ml_start( &t_qual, ml_build_qual, pf );
+            }
+            if ( rc == 0 ) {
+                rc = ml_start( &t_place, ml_build_place, pf );
+            }
+            rc = ml_join( t_mate, rc );
+            rc = ml_join( t_qual, rc );
+            rc = ml_join( t_place, rc );
+        }
+        if ( rc == 0 && pf -> with_qual ) {
+            /* now that the quality-file is complete, map it for reading */
+            uint64_t size;
+            rc = KFileSize( pf -> qual . f, &size );
+            if ( rc == 0 && size > 0 ) {
+                rc = ml_map_update( &( pf -> qual ) );
+                pf -> qual . size = size;
+            }
+        }
+    }
+    VCursorRelease( pf -> prim_cursor );
+    pf -> prim_cursor = NULL;
+    return rc;
+}
+
+void release_mate_lookup( mate_lookup * const self ) {
+    if ( self != NULL ) {
+        if ( self -> per_file != NULL ) {
+            uint32_t idx;
+            for ( idx = 0; idx < self -> count; ++idx ) {
+                ml_per_file * pf = &( self -> per_file[ idx ] );
+                ml_map_release( &( pf -> mate ), pf -> dir );
+                ml_map_release( &( pf -> place ), pf -> dir );
+                ml_map_release( &( pf -> qual_idx ), pf -> dir );
+                ml_map_release( &( pf -> qual ), pf -> dir );
+                VCursorRelease( pf -> prim_cursor );
+                BSTreeWhack( &( pf -> ref_names ), ml_ref_name_whack, NULL );
+                VectorWhack( &( pf -> ref_by_idx ), NULL, NULL );
+                KDirectoryRelease( pf -> dir );
+                if ( pf -> qual_buffer != NULL ) {
+                    free( pf -> qual_buffer );
+                }
+            }
+            free( self -> per_file );
+        }
+        free( self );
+    }
+}
+
+rc_t make_mate_lookup( mate_lookup ** self, const input_files * ifs, const char * dir,
+                       bool use_seqid_as_refname, bool with_qual ) {
+    rc_t rc = 0;
+    mate_lookup * ml = calloc( 1, sizeof * ml );
+    *self = NULL;
+    if ( ml == NULL ) {
+        rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+        (void)LOGERR( klogErr, rc, "cannot create mate-lookup structure" );
+    } else {
+        ml -> count = ifs -> database_count;
+        ml -> per_file = calloc( ml -> count > 0 ? ml -> count : 1, sizeof *( ml -> per_file ) );
+        if ( ml -> per_file == NULL ) {
+            rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+            (void)LOGERR( klogErr, rc, "cannot create mate-lookup internal structure" );
+        } else {
+            uint32_t idx;
+            for ( idx = 0; idx < ml -> count && rc == 0; ++idx ) {
+                const input_database * ids = VectorGet( &( ifs -> dbs ), idx );
+                ml_per_file * pf = &( ml -> per_file[ idx ] );
+                BSTreeInit( &( pf -> ref_names ) );
+                VectorInit( &( pf -> ref_by_idx ), 0, 64 );
+                pf -> use_seqid = use_seqid_as_refname;
+                pf -> with_qual = with_qual;
+                if ( ids != NULL ) {
+                    pf -> db = ids -> db;
+                    pf -> db_idx = ids -> db_idx;
+                    rc = KDirectoryNativeDir( &( pf -> dir ) );
+                    if ( rc != 0 ) {
+                        (void)LOGERR( klogErr, rc, "cannot create native directory" );
+                    } else {
+                        rc = ml_build_per_file( pf, dir );
+                    }
+                }
+            }
+        }
+        if ( rc == 0 ) {
+            *self = ml;
+        } else {
+            release_mate_lookup( ml );
+        }
+    }
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+
+static const ml_per_file * ml_get_per_file( const mate_lookup * const self, uint32_t db_idx, int64_t align_id ) {
+    if ( self != NULL && db_idx < self -> count ) {
+        const ml_per_file * pf = &( self -> per_file[ db_idx ] );
+        if ( pf -> mate . addr != NULL && ml_valid_align_id( pf, align_id ) ) {
+            return pf;
+        }
+    }
+    return NULL;
+}
+
+/* the same computation as in the experiment, see vdb-cache-less-experiment/tools.hpp */
+static int32_t ml_calc_tlen( const ml_place * self, const ml_place * mate, bool is_rd2 ) {
+    uint32_t self_left  = self -> ref_pos;
+    uint32_t self_right = self -> ref_pos + self -> ref_len;
+    uint32_t mate_left  = mate -> ref_pos;
+    uint32_t mate_right = mate -> ref_pos + mate -> ref_len;
+    uint32_t leftmost   = ( self_left  < mate_left  ) ? self_left  : mate_left;
+    uint32_t rightmost  = ( self_right > mate_right ) ? self_right : mate_right;
+    int32_t tlen = ( int32_t )( rightmost - leftmost );
+
+    /* The standard says, "The leftmost segment has a plus sign and the rightmost has a minus sign." */
+    if ( ( self_left <= mate_left && self_right >= mate_right ) ||     /* mate fully contained within self or */
+         ( mate_left <= self_left && mate_right >= self_right ) ) {    /* self fully contained within mate; */
+        if ( self_left < mate_left || ( !is_rd2 && self_left == mate_left ) ) {
+            return tlen;
+        }
+        return -tlen;
+    } else if ( ( self_right == mate_right && mate_left == leftmost ) || /* both are rightmost, but mate is leftmost */
+                ( self_right == rightmost ) ) {
+        return -tlen;
+    }
+    return tlen;
+}
+
+rc_t mate_lookup_get( const mate_lookup * const self, uint32_t db_idx, int64_t align_id,
+                      mate_lookup_info * info ) {
+    const ml_per_file * pf = ml_get_per_file( self, db_idx, align_id );
+    const uint64_t * mates;
+    const ml_place * places;
+    const ml_place * own;
+    uint64_t entry, codes;
+    bool paired, is_rd2;
+
+    if ( pf == NULL ) {
+        return RC( rcApp, rcNoTarg, rcAccessing, rcItem, rcNotFound );
+    }
+    mates = pf -> mate . addr;
+    places = pf -> place . addr;
+    entry = mates[ align_id - pf -> first ];
+    codes = entry >> MATE_CODE_SHIFT;
+    paired = ( ( codes & MATE_CODE_PAIRED ) == MATE_CODE_PAIRED );
+    is_rd2 = ( ( codes & MATE_CODE_READ2 ) == MATE_CODE_READ2 );
+    own = &( places[ align_id - pf -> first ] );
+
+    memset( info, 0, sizeof * info );
+    info -> mate_align_id = ( int64_t )( entry & MATE_ID_MASK );
+    if ( !ml_valid_align_id( pf, info -> mate_align_id ) ) {
+        info -> mate_align_id = 0;
+    }
+
+    if ( paired ) { info -> sam_flags |= 0x1; }
+    if ( ( own -> ref_idx & PLACE_REVERSED ) == PLACE_REVERSED ) { info -> sam_flags |= 0x10; }
+    if ( ( codes & MATE_CODE_REJECT ) == MATE_CODE_REJECT ) { info -> sam_flags |= 0x200; }
+    if ( ( codes & MATE_CODE_CRITERIA ) == MATE_CODE_CRITERIA ) { info -> sam_flags |= 0x400; }
+
+    if ( info -> mate_align_id != 0 ) {
+        const ml_place * mate = &( places[ info -> mate_align_id - pf -> first ] );
+        uint32_t mate_ref_idx = mate -> ref_idx & PLACE_IDX_MASK;
+        const ml_ref_name * mate_ref = VectorGet( &( pf -> ref_by_idx ), mate_ref_idx );
+
+        info -> same_ref = ( ( own -> ref_idx & PLACE_IDX_MASK ) == mate_ref_idx );
+        info -> mate_ref_pos = mate -> ref_pos;
+        if ( mate_ref != NULL ) {
+            info -> mate_ref_name = mate_ref -> name . addr;
+            info -> mate_ref_name_len = mate_ref -> name . len;
+        }
+        if ( info -> same_ref ) {
+            info -> sam_flags |= 0x2;
+            info -> tlen = ml_calc_tlen( own, mate, is_rd2 );
+        }
+        if ( ( mate -> ref_idx & PLACE_REVERSED ) == PLACE_REVERSED ) { info -> sam_flags |= 0x20; }
+    } else if ( paired ) {
+        info -> sam_flags |= 0x8;
+    }
+    if ( paired ) {
+        info -> sam_flags |= is_rd2 ? 0x80 : 0x40;
+    }
+    return 0;
+}
+
+rc_t mate_lookup_get_quality( mate_lookup * const self, uint32_t db_idx, int64_t align_id,
+                              const char ** quality, uint32_t * quality_len ) {
+    const ml_per_file * cpf = ml_get_per_file( self, db_idx, align_id );
+    ml_per_file * pf;
+    const uint64_t * offsets;
+    const ml_place * places;
+    const char * src;
+    uint64_t offset;
+    uint32_t len;
+
+    *quality = NULL;
+    *quality_len = 0;
+    if ( cpf == NULL ) {
+        return RC( rcApp, rcNoTarg, rcAccessing, rcItem, rcNotFound );
+    }
+    pf = &( self -> per_file[ db_idx ] );
+    if ( pf -> qual . addr == NULL || pf -> qual_idx . addr == NULL ) {
+        return 0;
+    }
+    offsets = pf -> qual_idx . addr;
+    places = pf -> place . addr;
+    offset = offsets[ align_id - pf -> first ];
+    if ( offset == 0 ) {
+        return 0;
+    }
+    offset -= 1;
+    /* the length and the quality itself have to be inside of the quality-file */
+    if ( offset + sizeof len > pf -> qual . size ) {
+        len = 0;
+    } else {
+        memmove( &len, ( const char * )pf -> qual . addr + offset, sizeof len );
+    }
+    if ( offset + sizeof len + len > pf -> qual . size ) {
+        rc_t rc = RC( rcApp, rcNoTarg, rcAccessing, rcData, rcCorrupt );
+        (void)PLOGERR( klogErr, ( klogErr, rc, "quality of alignment #$(id) outside of lookup-file '$(f)'",
+                                  "id=%ld,f=%s", align_id, pf -> qual . path ) );
+        return rc;
+    }
+    src = ( const char * )pf -> qual . addr + offset + sizeof len;
+
+    if ( ( places[ align_id - pf -> first ] . ref_idx & PLACE_REVERSED ) == PLACE_REVERSED ) {
+        uint32_t i;
+        if ( pf -> qual_buffer_size < len ) {
+            char * tmp = realloc( pf -> qual_buffer, len );
+            if ( tmp == NULL ) {
+                rc_t rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+                (void)LOGERR( klogErr, rc, "cannot allocate quality-buffer for mate-lookup" );
+                return rc;
+            }
+            pf -> qual_buffer = tmp;
+            pf -> qual_buffer_size = len;
+        }
+        for ( i = 0; i < len; ++i ) {
+            pf -> qual_buffer[ i ] = src[ len - 1 - i ];
+        }
+        src = pf -> qual_buffer;
+    }
+    *quality = src;
+    *quality_len = len;
+    return 0;
+}
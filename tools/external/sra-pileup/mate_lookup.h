@@ -0,0 +1,96 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_mate_lookup_
+#define _h_mate_lookup_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+#ifndef _h_insdc_sra_
+#include <insdc/sra.h>      /* INSDC_coord_* */
+#endif
+
+#ifndef _h_inputfiles_
+#include "inputfiles.h"
+#endif
+
+/*
+    cache-less mate resolution ( --mate-lookup <dir> )
+
+    The mate of a primary alignment is normally found via the SEQUENCE-table,
+    which is slow without a vdbcache-file, or via the in-memory matecache,
+    which grows with the distance between the mates.
+
+    Instead, these lookup-files are written into <dir> for every input-database
+    before any SAM is produced, each one by its own thread:
+
+        <db_idx>.mate       ... u64 per PRIMARY_ALIGNMENT-row:
+                                4 code-bits ( paired, rd-filter, is-read-2 ) + 60 bits mate-id
+        <db_idx>.place      ... ref-idx/orientation, ref-pos and ref-len per PRIMARY_ALIGNMENT-row
+        <db_idx>.qual.idx   ... u64 per PRIMARY_ALIGNMENT-row, offset into <db_idx>.qual
+        <db_idx>.qual       ... u32 length + quality of each aligned read ( split from its spot )
+
+    They are memory-mapped for the output-phase and removed when released.
+*/
+
+typedef struct mate_lookup_info {
+    int64_t mate_align_id;          /* 0 ... mate not aligned */
+    uint32_t sam_flags;
+    const char * mate_ref_name;     /* NULL ... mate not aligned */
+    uint32_t mate_ref_name_len;
+    bool same_ref;
+    INSDC_coord_zero mate_ref_pos;
+    int32_t tlen;
+} mate_lookup_info;
+
+struct mate_lookup;
+typedef struct mate_lookup mate_lookup;
+
+rc_t make_mate_lookup( mate_lookup ** self, const input_files * ifs, const char * dir,
+                       bool use_seqid_as_refname, bool with_qual );
+
+void release_mate_lookup( mate_lookup * const self );
+
+/* align_id ... row-id in the PRIMARY_ALIGNMENT-table of input-database #db_idx */
+rc_t mate_lookup_get( const mate_lookup * const self, uint32_t db_idx, int64_t align_id,
+                      mate_lookup_info * info );
+
+/* the quality is returned in the orientation of the alignment, valid until the next call,
+   NULL if none was recorded for the alignment */
+rc_t mate_lookup_get_quality( mate_lookup * const self, uint32_t db_idx, int64_t align_id,
+                              const char ** quality, uint32_t * quality_len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*  _h_mate_lookup_ */
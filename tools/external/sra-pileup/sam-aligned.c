@@ -58,6 +58,10 @@
 #include "rna_splice_log.h"
 #endif
 
+#ifndef _h_mate_lookup_
+#include "mate_lookup.h"
+#endif
+
 rc_t Quitting( void );      /* instead of including <kapp/main.h> */
 
 const char * PRIM_TABLE = "PRIMARY_ALIGNMENT";
@@ -319,7 +323,8 @@ static rc_t prepare_cmn_table_rows( const samdump_opts * const opts,
     if ( rc == 0 ) {
         rc = add_column( cursor, COL_READ_LEN, &( cmn -> read_len_idx ) ); /* read_fkt.c */
     }
-    if ( rc == 0 && !( opts -> no_qual ) ) {
+    /* with a mate-lookup the quality of primary alignments comes from the lookup-files */
+    if ( rc == 0 && !( opts -> no_qual ) && !( src == 'P' && opts -> use_mate_lookup ) ) {
         rc = add_column( cursor, COL_SAM_QUALITY, &( cmn -> sam_quality_idx ) ); /* read_fkt.c */
     }
     if ( rc == 0 ) {
@@ -1384,8 +1389,32 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
         rc = read_int64_ptr( id, cursor, atx -> cmn . seq_spot_id_idx, &seq_spot_id,
                              &seq_spot_id_len, "SEQ_SPOT_ID" );
     }
+    /* take the info about the mate from the precomputed lookup-files... */
+    if ( rc == 0 && sam_ctx -> ml != NULL && atx -> align_table_type == att_primary ) {
+        mate_lookup_info mli;
+        rc = mate_lookup_get( sam_ctx -> ml, atx -> db_idx, id, &mli ); /* mate_lookup.c */
+        if ( rc == 0 ) {
+            mate_align_id = mli . mate_align_id;
+            sam_flags = mli . sam_flags;
+            tlen = mli . tlen;
+            mate_ref_pos = mli . mate_ref_pos;
+            if ( mli . mate_ref_name == NULL ) {
+                mate_ref_name_len = 0;
+                if ( opts -> use_mate_cache && opts -> print_half_unaligned_reads ) {
+                    rc = matecache_insert_unaligned( sam_ctx -> mc, atx -> db_idx, id, pos,
+                                                     atx -> ref_idx, *seq_spot_id );
+                }
+            } else if ( mli . same_ref ) {
+                mate_ref_name = equal_sign;
+                mate_ref_name_len = 1;
+            } else {
+                mate_ref_name = mli . mate_ref_name;
+                mate_ref_name_len = mli . mate_ref_name_len;
+            }
+        }
+    }
     /* try to find the info about the mate in the CACHE... */
-    if ( rc == 0 ) {
+    else if ( rc == 0 ) {
         if ( mate_align_id != 0 ) {
             if ( opts -> use_mate_cache && sam_ctx -> mc != NULL ) {
                 rc = matecache_lookup_same_ref( sam_ctx -> mc, atx -> db_idx, mate_align_id,
@@ -1509,6 +1538,11 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
     if ( rc == 0 ) {
         rc = get_READ_QUALITY_EDIT_DIST( &cgc_output, id, &( atx -> cmn ) );
     }
+    if ( rc == 0 && sam_ctx -> ml != NULL && atx -> align_table_type == att_primary && !( opts -> no_qual ) ) {
+        rc = mate_lookup_get_quality( sam_ctx -> ml, atx -> db_idx, id,
+                                      &( cgc_output . p_quality . ptr ),
+                                      &( cgc_output . p_quality . len ) ); /* mate_lookup.c */
+    }
     /* SAM-FIELD: CIGAR     SRA-column: CIGAR_SHORT / with or without treatment */
     if ( rc == 0 ) {
         cg_cigar_input cgc_input;
@@ -961,6 +961,18 @@ static rc_t gather_string_options( Args * args, samdump_opts * opts ) {
         }
     }
 
+    rc = get_str_option( args, OPT_MATE_LOOKUP, &s );
+    if ( rc == 0 && s != NULL ) {
+        opts->mate_lookup_dir = string_dup_measure( s, NULL );
+        if ( opts->mate_lookup_dir == NULL ) {
+            rc = RC( rcExe, rcNoTarg, rcValidating, rcMemory, rcExhausted );
+            (void)LOGERR( klogErr, rc, "error storing mate-lookup-DIR into sam-dump-options" );
+        } else {
+            /* fasta/fastq do not print mates */
+            opts->use_mate_lookup = ( opts->output_format == of_sam );
+        }
+    }
+
     rc = get_str_option( args, OPT_NGC, &s );
     if ( rc == 0 && s != NULL ) {
         KConfigSetNgcFile( s );
@@ -1155,6 +1167,7 @@ void report_options( const samdump_opts * opts ) {
     KOutMsg( "rna-splicing          : %s\n",  opts -> rna_splicing ? "YES" : "NO" );
     KOutMsg( "rna-splice-level      : %u\n",  opts -> rna_splice_level );
     KOutMsg( "rna-splice-log        : %s\n",  opts -> rna_splice_log_file );
+    KOutMsg( "mate-lookup           : %s\n",  opts -> use_mate_lookup ? opts -> mate_lookup_dir : "NO" );
 
     KOutMsg( "multithreading        : %s\n",  opts -> no_mt ? "NO" : "YES" );  
     KOutMsg( "with-MD-flag          : %s\n",  opts -> with_md_flag ? "YES" : "NO" );
@@ -1179,6 +1192,7 @@ void release_options( samdump_opts * opts ) {
     if( opts->header_file != NULL )     { free( (void*)opts->header_file ); }
     if( opts->timing_file != NULL )     { free( (void*)opts->timing_file ); }
     if( opts->rna_splice_log_file != NULL ) { free( (void*)opts->rna_splice_log_file ); }
+    if( opts->mate_lookup_dir != NULL ) { free( (void*)opts->mate_lookup_dir ); }
 
 #if _DEBUGGING
     if ( opts->perf_log != NULL ) { free_perf_log( opts->perf_log ); }
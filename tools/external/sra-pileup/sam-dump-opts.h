@@ -110,6 +110,7 @@ extern "C" {
 #define OPT_RNA_SPLICE  "rna-splicing"
 #define OPT_RNA_SPLICEL "rna-splice-level"
 #define OPT_RNA_SPLICE_LOG "rna-splice-log"
+#define OPT_MATE_LOOKUP "mate-lookup"
 #define OPT_NO_MT       "disable-multithreading"
 #define OPT_TIMING      "timing"
 #define OPT_MD_FLAG     "with-md-flag"
@@ -192,6 +193,9 @@ typedef struct samdump_opts {
     /* log file for rna-splicing-events */
     const char * rna_splice_log_file;
 
+    /* directory for the lookup-files of cache-less mate resolution */
+    const char * mate_lookup_dir;
+
     /* timing-performane-log, created if timing_file given */
     struct perf_log * perf_log;
 
@@ -229,6 +233,9 @@ typedef struct samdump_opts {
 
     /* use a mate-cache to dump aligned and half-aligned reads */
     bool use_mate_cache;
+
+    /* resolve mates of primary alignments via precomputed lookup-files ( SAM only ) */
+    bool use_mate_lookup;
     bool force_legacy;
     bool force_new;
 
@@ -312,6 +319,7 @@ typedef struct samdump_ctx {
     const input_files * const ifs;
     matecache * mc;
     struct dyn_string * ds;
+    struct mate_lookup * ml;
 } sam_dump_ctx;
 
 #ifdef __cplusplus
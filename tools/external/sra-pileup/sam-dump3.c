@@ -64,6 +64,10 @@
 #include "matecache.h"
 #endif
 
+#ifndef _h_mate_lookup_
+#include "mate_lookup.h"
+#endif
+
 #ifndef _h_cgtools_
 #include "cg_tools.h"
 #endif
@@ -204,6 +208,9 @@ char const *rna_splicel_usage[]       = { "level of rna-splicing detection (0,1,
 
 char const *rna_splice_log_usage[]    = { "file, into which rna-splice events are written", NULL };
 
+char const *mate_lookup_usage[]       = { "resolve mates via lookup-files precomputed in this directory,",
+                                           "fast without vdbcache-files (SAM output only)", NULL };
+
 char const *no_mt_usage[]             = { "disable multithreading", NULL };
 
 char const *no_qual_usage[]           = { "omit qualities", NULL };
@@ -252,6 +259,7 @@ OptDef SamDumpArgs[] = {
     { OPT_RNA_SPLICE,   NULL, NULL, rna_splice_usage,        0, false, false },  /* detect rna-splicing in sequence */
     { OPT_RNA_SPLICEL,  NULL, NULL, rna_splicel_usage,       0, true,  false },  /* level of rna-splicing detection */
     { OPT_RNA_SPLICE_LOG,  NULL, NULL, rna_splice_log_usage, 0, true,  false },  /* filename to log rna-splice events into */
+    { OPT_MATE_LOOKUP,  NULL, NULL, mate_lookup_usage,       0, true,  false },  /* directory for mate-lookup files */
     { OPT_NO_MT,        NULL, NULL, no_mt_usage,             0, false, false },  /* force new code-path */
     { OPT_NOQUAL,       "o",  NULL, no_qual_usage,           0, false, false },  /* ommit qualities */
     { OPT_MD_FLAG,      NULL, NULL, with_md_flag_usage,      0, false, false },  /* print the MD-flag */	
@@ -303,6 +311,7 @@ char const *sd_usage_params[] = {
     NULL,                       /* detect rna-splicing in sequence */
     NULL,                       /* level of rna-splicing detection */
     NULL,                       /* file to log rna-splice-events into */
+    "PATH",                     /* mate-lookup directory */
     NULL,                       /* no-mt */
     NULL,                       /* no-qualities */
     NULL,                       /* with-md-flag */
@@ -390,7 +399,7 @@ static rc_t print_samdump( const samdump_opts * const opts ) {
         if ( rc != 0 ) {
             (void)LOGERR( klogErr, rc, "cannot create vdb-manager" );
         } else {
-            sam_dump_ctx sam_ctx = { opts, NULL, NULL, NULL };
+            sam_dump_ctx sam_ctx = { opts, NULL, NULL, NULL, NULL };
             uint32_t reflist_opt = tabsel_2_ReferenceList_Options( opts );
 
             ReportSetVDBManager( mgr ); /**/
@@ -417,6 +426,16 @@ static rc_t print_samdump( const samdump_opts * const opts ) {
                             rc = make_matecache( ( matecache **)&( sam_ctx . mc ),
                                                  sam_ctx . ifs -> database_count );
 
+                        if ( rc == 0 && opts -> use_mate_lookup ) {
+                            /* ------------------------------------------------------ */
+                            rc = make_mate_lookup( &( sam_ctx . ml ),
+                                                   sam_ctx . ifs,
+                                                   opts -> mate_lookup_dir,
+                                                   opts -> use_seqid_as_refname,
+                                                   !( opts -> no_qual ) ); /* mate_lookup.c */
+                            /* ------------------------------------------------------ */
+                        }
+
                         if ( rc == 0 ) {
                             /* create a dynamic string to be optionally used by
                                aligned and unaligned spots */
@@ -461,6 +480,9 @@ static rc_t print_samdump( const samdump_opts * const opts ) {
                             
                             ds_free( sam_ctx . ds );    /* tolerates NULL-ptr */
                         }
+                        if ( sam_ctx . ml != NULL ) {
+                            release_mate_lookup( sam_ctx . ml ); /* mate_lookup.c */
+                        }
                     }
                     release_input_files( ( input_files * )sam_ctx . ifs ); /* inputfiles.c */
                 }
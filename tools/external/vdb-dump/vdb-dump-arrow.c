@@ -0,0 +1,825 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "vdb-dump-arrow.h"
+#include "vdb-dump-helper.h"
+
+#include <klib/log.h>
+#include <klib/out.h>
+#include <klib/num-gen.h>
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+rc_t CC Quitting ( void );
+
+/*************************************************************************************
+    Arrow IPC streaming format, written without the arrow-library:
+
+    every message is: 0xFFFFFFFF, int32 size of the metadata, the metadata
+    ( a flatbuffer-encoded 'Message', padded to 8 bytes ) and the message-body
+
+    the body of a record-batch is the sequence of buffers of all columns,
+    each padded to 8 bytes:
+        text-columns    ... utf8: validity, int32-offsets, bytes
+        other columns   ... list: validity, int32-offsets, child: validity, values
+        row-id          ... int64: validity, values
+    a VDB-cell is an array of elements, that is why the numeric columns become
+    lists of fixed-width values; there are no nulls, all validity-buffers are empty
+*************************************************************************************/
+
+#define ARROW_TYPE_INT      2
+#define ARROW_TYPE_FLOAT    3
+#define ARROW_TYPE_UTF8     5
+#define ARROW_TYPE_BOOL     6
+#define ARROW_TYPE_LIST     12
+
+#define ARROW_HEADER_SCHEMA 1
+#define ARROW_HEADER_BATCH  3
+
+#define ARROW_METADATA_V5   4
+
+/* keep the int32-offsets of a batch from overflowing */
+#define ARROW_MAX_VALUES    0x40000000
+
+typedef struct arrow_buf
+{
+    uint8_t * data;
+    size_t size;
+    size_t capacity;
+} arrow_buf;
+
+typedef struct arrow_col
+{
+    const col_def * def;    /* NULL for the row-id */
+    uint8_t type;           /* ARROW_TYPE_XXX of the values */
+    bool is_signed;
+    bool is_list;           /* numeric VDB-columns: list of values per row */
+    uint32_t value_bits;    /* 1 for booleans */
+    uint32_t dim;           /* values per VDB-element */
+    uint64_t value_count;
+    arrow_buf offsets;      /* int32 per row + 1, for lists and text */
+    arrow_buf values;
+} arrow_col;
+
+typedef struct arrow_writer
+{
+    const p_row_context r_ctx;
+    arrow_col * cols;
+    uint32_t col_count;
+    uint32_t rows;
+    uint32_t batch_rows;
+} arrow_writer;
+
+static rc_t vdar_buf_append( arrow_buf * self, const void * src, size_t size )
+{
+    if ( self -> size + size > self -> capacity )
+    {
+        size_t capacity = ( 0 == self -> capacity ) ? 4096 : self -> capacity;
+        uint8_t * temp;
+        while ( capacity < self -> size + size )
+        {
+            capacity *= 2;
+        }
+        temp = realloc( self -> data, capacity );
+        if ( NULL == temp )
+        {
+            return RC( rcVDB, rcNoTarg, rcWriting, rcMemory, rcExhausted );
+        }
+        self -> data = temp;
+        self -> capacity = capacity;
+    }
+    if ( NULL == src )
+    {
+        memset( self -> data + self -> size, 0, size );
+    }
+    else
+    {
+        memmove( self -> data + self -> size, src, size );
+    }
+    self -> size += size;
+    return 0;
+}
+
+/*************************************************************************************
+    a minimal flatbuffer-builder:
+    objects are written front to back, a table first and then the objects it
+    refers to, the 4-byte offsets to these are filled in ( linked ) afterwards;
+    the metadata is always little-endian
+*************************************************************************************/
+#define FB_MAX_FIELDS 8
+
+typedef struct fb_builder
+{
+    arrow_buf buf;
+    rc_t rc;
+} fb_builder;
+
+/* one field of a table: size 0 means absent, offsets have size 4 and
+   get linked later via 'pos', the position where the table holds them */
+typedef struct fb_field
+{
+    uint32_t size;
+    uint64_t value;
+    size_t pos;
+} fb_field;
+
+static size_t fb_put( fb_builder * self, const void * src, size_t size )
+{
+    size_t pos = self -> buf . size;
+    if ( 0 == self -> rc )
+    {
+        self -> rc = vdar_buf_append( &( self -> buf ), src, size );
+    }
+    return pos;
+}
+
+static size_t fb_put_le( fb_builder * self, uint64_t value, uint32_t size )
+{
+    uint8_t le[ 8 ];
+    uint32_t i;
+    for ( i = 0; i < size; ++i )
+    {
+        le[ i ] = ( uint8_t )( value >> ( 8 * i ) );
+    }
+    return fb_put( self, le, size );
+}
+
+/* pads until the position is 'rem' modulo 'align' */
+static void fb_pad( fb_builder * self, size_t align, size_t rem )
+{
+    while ( 0 == self -> rc && ( self -> buf . size % align ) != rem )
+    {
+        fb_put( self, NULL, 1 );
+    }
+}
+
+static void fb_link( fb_builder * self, size_t at, size_t target )
+{
+    if ( 0 == self -> rc )
+    {
+        uint32_t offset = ( uint32_t )( target - at );
+        uint32_t i;
+        for ( i = 0; i < 4; ++i )
+        {
+            self -> buf . data[ at + i ] = ( uint8_t )( offset >> ( 8 * i ) );
+        }
+    }
+}
+
+static size_t fb_table( fb_builder * self, fb_field * fields, uint32_t count )
+{
+    uint16_t vtable[ 2 + FB_MAX_FIELDS ];
+    uint16_t offset = 4;
+    uint32_t size, i;
+    size_t vtable_pos, table_pos;
+
+    /* the fields go by descending size: if the table starts 4 bytes after an
+       8-byte boundary ( behind its vtable-offset ) every field is aligned */
+    memset( vtable, 0, sizeof vtable );
+    for ( size = 8; size > 0; size /= 2 )
+    {
+        for ( i = 0; i < count; ++i )
+        {
+            if ( fields[ i ] . size == size )
+            {
+                vtable[ 2 + i ] = offset;
+                offset += size;
+            }
+        }
+    }
+    vtable[ 0 ] = ( uint16_t )( 4 + 2 * count );
+    vtable[ 1 ] = offset;
+
+    fb_pad( self, 2, 0 );
+    vtable_pos = self -> buf . size;
+    for ( i = 0; i < 2 + count; ++i )
+    {
+        fb_put_le( self, vtable[ i ], 2 );
+    }
+    fb_pad( self, 8, 4 );
+    table_pos = self -> buf . size;
+    /* the vtable is found at table_pos minus this value */
+    fb_put_le( self, table_pos - vtable_pos, 4 );
+    for ( size = 8; size > 0; size /= 2 )
+    {
+        for ( i = 0; i < count; ++i )
+        {
+            if ( fields[ i ] . size == size )
+            {
+                fields[ i ] . pos = fb_put_le( self, fields[ i ] . value, size );
+            }
+        }
+    }
+    return table_pos;
+}
+
+static size_t fb_string( fb_builder * self, const char * s )
+{
+    size_t len = strlen( s );
+    size_t pos;
+
+    fb_pad( self, 4, 0 );
+    pos = fb_put_le( self, len, 4 );
+    fb_put( self, s, len );
+    fb_put( self, NULL, 1 );
+    return pos;
+}
+
+/* a vector of offsets to be linked: the first one is at *slots, the next ones follow */
+static size_t fb_offset_vector( fb_builder * self, uint32_t count, size_t * slots )
+{
+    size_t pos;
+
+    fb_pad( self, 4, 0 );
+    pos = fb_put_le( self, count, 4 );
+    *slots = fb_put( self, NULL, 4 * ( size_t )count );
+    return pos;
+}
+
+/* a vector of structs made of two int64's ( FieldNode, Buffer ) */
+static size_t fb_pair_vector( fb_builder * self, const arrow_buf * pairs )
+{
+    uint32_t count = ( uint32_t )( pairs -> size / ( 2 * sizeof( uint64_t ) ) );
+    const uint64_t * values = ( const uint64_t * )pairs -> data;
+    size_t pos;
+    uint32_t i;
+
+    fb_pad( self, 8, 4 );
+    pos = fb_put_le( self, count, 4 );
+    for ( i = 0; i < 2 * count; ++i )
+    {
+        fb_put_le( self, values[ i ], 8 );
+    }
+    return pos;
+}
+
+/*************************************************************************************
+    arrow-metadata
+*************************************************************************************/
+static size_t vdar_fb_type( fb_builder * fb, uint8_t type, const arrow_col * col )
+{
+    fb_field f[ 2 ];
+
+    memset( f, 0, sizeof f );
+    switch ( type )
+    {
+        case ARROW_TYPE_INT :
+            f[ 0 ] . size = 4; f[ 0 ] . value = col -> value_bits;      /* bitWidth */
+            f[ 1 ] . size = 1; f[ 1 ] . value = col -> is_signed;       /* is_signed */
+            return fb_table( fb, f, 2 );
+
+        case ARROW_TYPE_FLOAT :
+            /* precision: SINGLE = 1, DOUBLE = 2 */
+            f[ 0 ] . size = 2; f[ 0 ] . value = ( 32 == col -> value_bits ) ? 1 : 2;
+            return fb_table( fb, f, 1 );
+
+        default :
+            /* Utf8, Bool and List have no properties */
+            return fb_table( fb, f, 0 );
+    }
+}
+
+static size_t vdar_fb_field( fb_builder * fb, const char * name, const arrow_col * col, bool as_list )
+{
+    uint8_t type = as_list ? ARROW_TYPE_LIST : col -> type;
+    fb_field f[ 6 ];
+    size_t pos, children, slots;
+
+    memset( f, 0, sizeof f );
+    f[ 0 ] . size = 4;                          /* name */
+    f[ 1 ] . size = 1;                          /* nullable = false */
+    f[ 2 ] . size = 1; f[ 2 ] . value = type;   /* type_type */
+    f[ 3 ] . size = 4;                          /* type */
+    f[ 5 ] . size = 4;                          /* children, required even if empty */
+    pos = fb_table( fb, f, 6 );
+    fb_link( fb, f[ 0 ] . pos, fb_string( fb, name ) );
+    fb_link( fb, f[ 3 ] . pos, vdar_fb_type( fb, type, col ) );
+    children = fb_offset_vector( fb, as_list ? 1 : 0, &slots );
+    fb_link( fb, f[ 5 ] . pos, children );
+    if ( as_list )
+    {
+        fb_link( fb, slots, vdar_fb_field( fb, "item", col, false ) );
+    }
+    return pos;
+}
+
+/* the Message-table, returns where to link the header */
+static size_t vdar_fb_message( fb_builder * fb, uint8_t header_type, uint64_t body_length )
+{
+    fb_field f[ 4 ];
+    size_t root = fb_put( fb, NULL, 4 );
+
+    memset( f, 0, sizeof f );
+    f[ 0 ] . size = 2; f[ 0 ] . value = ARROW_METADATA_V5;  /* version */
+    f[ 1 ] . size = 1; f[ 1 ] . value = header_type;        /* header_type */
+    f[ 2 ] . size = 4;                                      /* header */
+    f[ 3 ] . size = 8; f[ 3 ] . value = body_length;        /* bodyLength */
+    fb_link( fb, root, fb_table( fb, f, 4 ) );
+    return f[ 2 ] . pos;
+}
+
+static bool vdar_big_endian( void )
+{
+    const uint16_t probe = 1;
+    return ( 0 == *( const uint8_t * )&probe );
+}
+
+static const char * vdar_col_name( const arrow_col * col )
+{
+    return ( NULL == col -> def ) ? "ROW_ID" : col -> def -> name;
+}
+
+/*************************************************************************************
+    output
+*************************************************************************************/
+static rc_t vdar_write( const void * src, size_t size )
+{
+    rc_t rc = 0;
+    if ( size > 0 )
+    {
+        size_t num_writ = 0;
+        KWrtWriter writer = KOutWriterGet();
+        rc = writer( KOutDataGet(), ( const char * )src, size, &num_writ );
+        if ( 0 == rc && num_writ != size )
+        {
+            rc = RC( rcVDB, rcNoTarg, rcWriting, rcTransfer, rcIncomplete );
+        }
+    }
+    return rc;
+}
+
+static rc_t vdar_write_padded( const void * src, size_t size )
+{
+    static const uint8_t zeros[ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    rc_t rc = vdar_write( src, size );
+    if ( 0 == rc && 0 != ( size & 7 ) )
+    {
+        rc = vdar_write( zeros, 8 - ( size & 7 ) );
+    }
+    return rc;
+}
+
+static rc_t vdar_write_message( fb_builder * fb )
+{
+    rc_t rc = fb -> rc;
+    if ( 0 == rc )
+    {
+        uint8_t prefix[ 8 ];
+        uint32_t meta_size = ( uint32_t )( ( fb -> buf . size + 7 ) & ~( size_t )7 );
+        uint32_t i;
+        for ( i = 0; i < 4; ++i )
+        {
+            prefix[ i ] = 0xFF;                                  /* continuation */
+            prefix[ 4 + i ] = ( uint8_t )( meta_size >> ( 8 * i ) );
+        }
+        rc = vdar_write( prefix, sizeof prefix );
+        if ( 0 == rc )
+        {
+            rc = vdar_write_padded( fb -> buf . data, fb -> buf . size );
+        }
+    }
+    return rc;
+}
+
+static rc_t vdar_write_schema( const arrow_writer * self )
+{
+    fb_builder fb;
+    fb_field f[ 2 ];
+    size_t fields, slots;
+    uint32_t i;
+    rc_t rc;
+
+    memset( &fb, 0, sizeof fb );
+    memset( f, 0, sizeof f );
+    f[ 0 ] . size = 2; f[ 0 ] . value = vdar_big_endian() ? 1 : 0;    /* endianness of the body */
+    f[ 1 ] . size = 4;                                                  /* fields */
+    {
+        size_t header = vdar_fb_message( &fb, ARROW_HEADER_SCHEMA, 0 );
+        fb_link( &fb, header, fb_table( &fb, f, 2 ) );
+    }
+    fields = fb_offset_vector( &fb, self -> col_count, &slots );
+    fb_link( &fb, f[ 1 ] . pos, fields );
+    for ( i = 0; i < self -> col_count; ++i )
+    {
+        const arrow_col * col = &( self -> cols[ i ] );
+        fb_link( &fb, slots + 4 * i, vdar_fb_field( &fb, vdar_col_name( col ), col, col -> is_list ) );
+    }
+    rc = vdar_write_message( &fb );
+    free( fb . buf . data );
+    return rc;
+}
+
+static size_t vdar_values_size( const arrow_col * col )
+{
+    if ( ARROW_TYPE_BOOL == col -> type )
+    {
+        return ( size_t )( ( col -> value_count + 7 ) / 8 );
+    }
+    return col -> values . size;
+}
+
+static rc_t vdar_add_pair( arrow_buf * dst, uint64_t a, uint64_t b )
+{
+    uint64_t pair[ 2 ];
+    pair[ 0 ] = a;
+    pair[ 1 ] = b;
+    return vdar_buf_append( dst, pair, sizeof pair );
+}
+
+/* the buffer-list of the batch: ( offset, length ) for every buffer in the body */
+static rc_t vdar_add_buffer( arrow_buf * dst, uint64_t * body_size, size_t size )
+{
+    rc_t rc = vdar_add_pair( dst, *body_size, size );
+    *body_size += ( size + 7 ) & ~( uint64_t )7;
+    return rc;
+}
+
+static rc_t vdar_write_batch( arrow_writer * self )
+{
+    arrow_buf nodes, buffers;
+    uint64_t body_size = 0;
+    uint32_t i;
+    rc_t rc = 0;
+
+    memset( &nodes, 0, sizeof nodes );
+    memset( &buffers, 0, sizeof buffers );
+    for ( i = 0; 0 == rc && i < self -> col_count; ++i )
+    {
+        const arrow_col * col = &( self -> cols[ i ] );
+        rc = vdar_add_pair( &nodes, self -> rows, 0 );
+        if ( 0 == rc )
+        {
+            rc = vdar_add_buffer( &buffers, &body_size, 0 );    /* validity */
+        }
+        if ( 0 == rc && col -> offsets . size > 0 )
+        {
+            rc = vdar_add_buffer( &buffers, &body_size, col -> offsets . size );
+        }
+        if ( 0 == rc && col -> is_list )
+        {
+            rc = vdar_add_pair( &nodes, col -> value_count, 0 );
+            if ( 0 == rc )
+            {
+                rc = vdar_add_buffer( &buffers, &body_size, 0 ); /* validity of the values */
+            }
+        }
+        if ( 0 == rc )
+        {
+            rc = vdar_add_buffer( &buffers, &body_size, vdar_values_size( col ) );
+        }
+    }
+
+    if ( 0 == rc )
+    {
+        fb_builder fb;
+        fb_field f[ 3 ];
+
+        memset( &fb, 0, sizeof fb );
+        memset( f, 0, sizeof f );
+        f[ 0 ] . size = 8; f[ 0 ] . value = self -> rows;  /* length */
+        f[ 1 ] . size = 4;                                  /* nodes */
+        f[ 2 ] . size = 4;                                  /* buffers */
+        {
+            size_t header = vdar_fb_message( &fb, ARROW_HEADER_BATCH, body_size );
+            fb_link( &fb, header, fb_table( &fb, f, 3 ) );
+        }
+        fb_link( &fb, f[ 1 ] . pos, fb_pair_vector( &fb, &nodes ) );
+        fb_link( &fb, f[ 2 ] . pos, fb_pair_vector( &fb, &buffers ) );
+        rc = vdar_write_message( &fb );
+        free( fb . buf . data );
+    }
+
+    /* the body, in the same order as the buffer-list */
+    for ( i = 0; 0 == rc && i < self -> col_count; ++i )
+    {
+        arrow_col * col = &( self -> cols[ i ] );
+        if ( col -> offsets . size > 0 )
+        {
+            rc = vdar_write_padded( col -> offsets . data, col -> offsets . size );
+        }
+        if ( 0 == rc )
+        {
+            rc = vdar_write_padded( col -> values . data, vdar_values_size( col ) );
+        }
+    }
+
+    free( nodes . data );
+    free( buffers . data );
+    return rc;
+}
+
+static rc_t vdar_write_eos( void )
+{
+    static const uint8_t eos[ 8 ] = { 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0 };
+    return vdar_write( eos, sizeof eos );
+}
+
+/*************************************************************************************
+    collecting the rows of a batch
+*************************************************************************************/
+static rc_t vdar_start_batch( arrow_writer * self )
+{
+    uint32_t i;
+    rc_t rc = 0;
+
+    self -> rows = 0;
+    for ( i = 0; 0 == rc && i < self -> col_count; ++i )
+    {
+        arrow_col * col = &( self -> cols[ i ] );
+        col -> value_count = 0;
+        col -> values . size = 0;
+        col -> offsets . size = 0;
+        if ( col -> is_list || ARROW_TYPE_UTF8 == col -> type )
+        {
+            int32_t zero = 0;
+            rc = vdar_buf_append( &( col -> offsets ), &zero, sizeof zero );
+        }
+    }
+    return rc;
+}
+
+static bool vdar_batch_full( const arrow_writer * self )
+{
+    uint32_t i;
+
+    if ( self -> rows >= self -> batch_rows )
+    {
+        return true;
+    }
+    for ( i = 0; i < self -> col_count; ++i )
+    {
+        if ( self -> cols[ i ] . values . size >= ARROW_MAX_VALUES )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static rc_t vdar_append_cell( arrow_col * col, const uint8_t * src, uint32_t elem_count )
+{
+    uint64_t count = ( uint64_t )elem_count * col -> dim;
+    rc_t rc = 0;
+
+    if ( ARROW_TYPE_BOOL == col -> type )
+    {
+        /* VDB-booleans are bytes, arrow-booleans are bits */
+        uint64_t i;
+        size_t needed = ( size_t )( ( col -> value_count + count + 7 ) / 8 );
+        if ( needed > col -> values . size )
+        {
+            rc = vdar_buf_append( &( col -> values ), NULL, needed - col -> values . size );
+        }
+        for ( i = 0; 0 == rc && i < count; ++i )
+        {
+            if ( 0 != src[ i ] )
+            {
+                uint64_t bit = col -> value_count + i;
+                col -> values . data[ bit / 8 ] |= ( uint8_t )( 1 << ( bit & 7 ) );
+            }
+        }
+    }
+    else if ( count > 0 )
+    {
+        rc = vdar_buf_append( &( col -> values ), src, ( size_t )( count * ( col -> value_bits / 8 ) ) );
+    }
+    if ( 0 == rc )
+    {
+        col -> value_count += count;
+        if ( col -> offsets . size > 0 )
+        {
+            int32_t end = ( int32_t )( ARROW_TYPE_UTF8 == col -> type ? col -> values . size : col -> value_count );
+            rc = vdar_buf_append( &( col -> offsets ), &end, sizeof end );
+        }
+    }
+    return rc;
+}
+
+static rc_t vdar_append_row( arrow_writer * self, int64_t row_id )
+{
+    const p_row_context r_ctx = self -> r_ctx;
+    uint32_t i;
+    rc_t rc = 0;
+
+    for ( i = 0; 0 == rc && i < self -> col_count; ++i )
+    {
+        arrow_col * col = &( self -> cols[ i ] );
+        if ( NULL == col -> def )
+        {
+            rc = vdar_buf_append( &( col -> values ), &row_id, sizeof row_id );
+            col -> value_count++;
+        }
+        else
+        {
+            uint32_t elem_bits, boff, row_len;
+            const void * base;
+            rc_t rc2 = VCursorCellDataDirect( r_ctx -> cursor, row_id, col -> def -> idx,
+                                              &elem_bits, &base, &boff, &row_len );
+            if ( 0 == rc2 && 0 != ( boff & 7 ) )
+            {
+                rc2 = RC( rcVDB, rcNoTarg, rcReading, rcData, rcUnsupported );
+            }
+            if ( 0 != rc2 )
+            {
+                PLOGERR( klogInt, ( klogInt, rc2,
+                         "VCursorCellDataDirect( col:$(col_name) at row #$(row_nr) ) failed",
+                         "col_name=%s,row_nr=%ld", col -> def -> name, row_id ) );
+                /* be forgiving like the text-formats: write an empty cell and remember the error */
+                r_ctx -> last_rc = rc2;
+                row_len = 0;
+                base = NULL;
+                boff = 0;
+            }
+            rc = vdar_append_cell( col, ( const uint8_t * )base + ( boff >> 3 ), row_len );
+        }
+    }
+    if ( 0 == rc )
+    {
+        self -> rows++;
+    }
+    return rc;
+}
+
+/*************************************************************************************
+    mapping the VDB-types
+*************************************************************************************/
+static rc_t vdar_map_type( arrow_col * col, const col_def * def )
+{
+    const VTypedesc * desc = &( def -> type_desc );
+    uint32_t bits = desc -> intrinsic_bits;
+    bool byte_sized = ( 8 == bits || 16 == bits || 32 == bits || 64 == bits );
+    bool supported = false;
+
+    col -> def = def;
+    col -> dim = desc -> intrinsic_dim;
+    col -> value_bits = bits;
+    switch ( desc -> domain )
+    {
+        case vtdBool :
+            col -> type = ARROW_TYPE_BOOL;
+            col -> value_bits = 1;
+            col -> is_list = true;
+            supported = ( 8 == bits );
+            break;
+
+        case vtdUint :
+        case vtdInt :
+            col -> type = ARROW_TYPE_INT;
+            col -> is_signed = ( vtdInt == desc -> domain );
+            col -> is_list = true;
+            supported = byte_sized;
+            break;
+
+        case vtdFloat :
+            col -> type = ARROW_TYPE_FLOAT;
+            col -> is_list = true;
+            supported = ( 32 == bits || 64 == bits );
+            break;
+
+        case vtdAscii :
+        case vtdUnicode :
+            col -> type = ARROW_TYPE_UTF8;
+            supported = ( 8 == bits && 1 == col -> dim );
+            break;
+    }
+    if ( !supported )
+    {
+        rc_t rc = RC( rcVDB, rcNoTarg, rcConstructing, rcType, rcUnsupported );
+        PLOGERR( klogErr, ( klogErr, rc,
+                 "column '$(col_name)' has a type that cannot be written as arrow, exclude it with -x",
+                 "col_name=%s", def -> name ) );
+        return rc;
+    }
+    return 0;
+}
+
+static rc_t vdar_init( arrow_writer * self )
+{
+    const p_row_context r_ctx = self -> r_ctx;
+    Vector * cols = &( r_ctx -> col_defs -> cols );
+    uint32_t count = VectorLength( cols );
+    uint32_t i;
+    rc_t rc = 0;
+
+    self -> batch_rows = ( uint32_t )r_ctx -> ctx -> arrow_batch_rows;
+    if ( 0 == self -> batch_rows )
+    {
+        self -> batch_rows = DEF_ARROW_BATCH_ROWS;
+    }
+    self -> cols = calloc( count + 1, sizeof( self -> cols[ 0 ] ) );
+    if ( NULL == self -> cols )
+    {
+        return RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    }
+    if ( r_ctx -> ctx -> print_row_id )
+    {
+        arrow_col * col = &( self -> cols[ self -> col_count++ ] );
+        col -> type = ARROW_TYPE_INT;
+        col -> is_signed = true;
+        col -> value_bits = 64;
+        col -> dim = 1;
+    }
+    /* the columns selected by vdb-dump-coldefs.c ( -C / -x ), in their order */
+    for ( i = 0; 0 == rc && i < count; ++i )
+    {
+        const col_def * def = VectorGet( cols, i );
+        if ( NULL != def && def -> valid && !def -> excluded )
+        {
+            rc = vdar_map_type( &( self -> cols[ self -> col_count ] ), def );
+            if ( 0 == rc )
+            {
+                self -> col_count++;
+            }
+        }
+    }
+    return rc;
+}
+
+static void vdar_release( arrow_writer * self )
+{
+    uint32_t i;
+    for ( i = 0; NULL != self -> cols && i < self -> col_count; ++i )
+    {
+        free( self -> cols[ i ] . offsets . data );
+        free( self -> cols[ i ] . values . data );
+    }
+    free( self -> cols );
+}
+
+rc_t vdar_dump_rows( const p_row_context r_ctx )
+{
+    arrow_writer writer = { r_ctx, NULL, 0, 0, 0 };
+    rc_t rc = vdar_init( &writer );
+    if ( 0 == rc )
+    {
+        rc = vdar_write_schema( &writer );
+        DISP_RC( rc, "vdar_dump_rows().vdar_write_schema() failed" );
+    }
+    if ( 0 == rc )
+    {
+        const struct num_gen_iter * iter;
+        rc = num_gen_iterator_make( r_ctx -> ctx -> rows, &iter );
+        DISP_RC( rc, "vdar_dump_rows().num_gen_iterator_make() failed" );
+        if ( 0 == rc )
+        {
+            int64_t row_id;
+            rc = vdar_start_batch( &writer );
+            while ( 0 == rc && num_gen_iterator_next( iter, &row_id, &rc ) )
+            {
+                if ( 0 == rc )
+                {
+                    rc = Quitting();
+                }
+                if ( 0 == rc )
+                {
+                    rc = vdar_append_row( &writer, row_id );
+                }
+                if ( 0 == rc && vdar_batch_full( &writer ) )
+                {
+                    rc = vdar_write_batch( &writer );
+                    if ( 0 == rc )
+                    {
+                        rc = vdar_start_batch( &writer );
+                    }
+                }
+            }
+            num_gen_iterator_destroy( iter );
+        }
+        if ( 0 == rc && writer . rows > 0 )
+        {
+            rc = vdar_write_batch( &writer );
+        }
+        if ( 0 == rc )
+        {
+            rc = vdar_write_eos();
+        }
+        DISP_RC( rc, "vdar_dump_rows() failed" );
+    }
+    vdar_release( &writer );
+    return rc;
+}
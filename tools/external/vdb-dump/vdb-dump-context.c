@@ -129,6 +129,7 @@ static void vdco_init_values( p_dump_context ctx )
     ctx -> max_line_len = 0;
     ctx -> indented_line_len = 0;
     ctx -> slice_depth = 0;
+    ctx -> arrow_batch_rows = DEF_ARROW_BATCH_ROWS;
 
     ctx -> help_requested = false;
     ctx -> usage_requested = false;
@@ -447,6 +448,10 @@ static bool vdco_set_format( p_dump_context ctx, const char *src )
     {
         ctx -> format = df_sql;
     }
+    else if ( 0 == strcmp( src, "arrow" ) )
+    {
+        ctx -> format = df_arrow;
+    }
     else
     {
         ctx -> format = df_default;
@@ -630,6 +635,7 @@ static void vdco_evaluate_options( const Args *args, dump_context *ctx )
     
     ctx -> cur_cache_size = vdco_get_size_t_option( args, OPTION_CUR_CACHE, CURSOR_CACHE_SIZE );
     ctx -> output_buffer_size = vdco_get_size_t_option( args, OPTION_OUT_BUF_SIZE, DEF_OPTION_OUT_BUF_SIZE );
+    ctx -> arrow_batch_rows = vdco_get_size_t_option( args, OPTION_ARROW_BATCH, DEF_ARROW_BATCH_ROWS );
     
     if ( vdco_get_bool_option( args, OPTION_GZIP, false ) )
     {
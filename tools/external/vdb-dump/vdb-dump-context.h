@@ -94,6 +94,8 @@ extern "C" {
 
 #define OPTION_NGC               "ngc"
 
+#define OPTION_ARROW_BATCH       "arrow-batch"
+
 #define ALIAS_ROW_ID_ON         "I"
 #define ALIAS_LINE_FEED         "l"
 #define ALIAS_COLNAME_OFF       "N"
@@ -124,6 +126,7 @@ extern "C" {
 #define USE_PATHTYPE_TO_DETECT_DB_OR_TAB 1
 #define CURSOR_CACHE_SIZE 256*1024*1024
 #define DEF_OPTION_OUT_BUF_SIZE 1024*1024
+#define DEF_ARROW_BATCH_ROWS 65536
 
 typedef enum dump_format_t
 {
@@ -141,7 +144,8 @@ typedef enum dump_format_t
     df_fasta2,
     df_qual,
     df_qual1,
-    df_sql
+    df_sql,
+    df_arrow
 } dump_format_t;
 
 /********************************************************************
@@ -168,6 +172,7 @@ typedef struct dump_context
     uint32_t slice_depth;
     size_t cur_cache_size;
     size_t output_buffer_size;
+    size_t arrow_batch_rows;
     dump_format_t format;
     out_redir_mode_t compress_mode;
     char c_boolean;
@@ -72,6 +72,7 @@
 #include "vdb-dump-row-context.h"
 #include "vdb-dump-formats.h"
 #include "vdb-dump-fastq.h"
+#include "vdb-dump-arrow.h"
 #include "vdb-dump-redir.h"
 #include "vdb_info.h"
 
@@ -121,6 +122,7 @@ static const char * merge_ranges_usage[]        = { "merge and sort row-ranges",
 static const char * spread_usage[]              = { "show spread of integer values",                NULL };
 static const char * append_usage[]              = { "append to output-file, if output-file used",   NULL };
 static const char * ngc_usage[]                 = { "path to ngc file", NULL };
+static const char * arrow_batch_usage[]         = { "rows per record-batch for --format arrow", NULL };
 
 /* from here on: not mentioned in help */
 static const char * len_spread_usage[]          = { "show spread of READ/REF_LEN values",           NULL };
@@ -178,7 +180,8 @@ OptDef DumpOptions[] =
     { OPTION_SLICE,                 NULL,                     NULL, slice_usage,             1, true,   false },
     { OPTION_CELL_DEBUG,            NULL,                     NULL, NULL,                    1, false,  false },
     { OPTION_CELL_V1,               NULL,                     NULL, NULL,                    1, false,  false },
-    { OPTION_NGC,                   NULL,                     NULL, ngc_usage,               1, true,   false }
+    { OPTION_NGC,                   NULL,                     NULL, ngc_usage,               1, true,   false },
+    { OPTION_ARROW_BATCH,           NULL,                     NULL, arrow_batch_usage,       1, true,   false }
 };
 
 const char UsageDefaultName[] = "vdb-dump";
@@ -245,7 +248,8 @@ rc_t CC Usage ( const Args * args )
     KOutMsg( "      fasta1 .. one FASTA-record for the whole accession (REFSEQ)\n" );
     KOutMsg( "      fasta2 .. one FASTA-record for each REFERENCE in cSRA\n" );
     KOutMsg( "      qual .... QUAL( 2 lines ) for each row\n" );    
-    KOutMsg( "      qual1 ... QUAL( 2 lines ) for each fragment if possible\n\n" );
+    KOutMsg( "      qual1 ... QUAL( 2 lines ) for each fragment if possible\n" );
+    KOutMsg( "      arrow ... Arrow IPC stream ( binary ) of the selected columns\n\n" );
     
     HelpOptionLine ( ALIAS_ID_RANGE,            OPTION_ID_RANGE,        NULL,           id_range_usage );
     HelpOptionLine ( ALIAS_WITHOUT_SRA,         OPTION_WITHOUT_SRA,     NULL,           without_sra_usage );
@@ -275,6 +279,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( NULL,                      OPTION_SPREAD,          NULL,           spread_usage );
     HelpOptionLine ( ALIAS_APPEND,              OPTION_APPEND,          NULL,           append_usage );
     HelpOptionLine ( NULL,                      OPTION_NGC, "path", ngc_usage);
+    HelpOptionLine ( NULL,                      OPTION_ARROW_BATCH,     "rows",         arrow_batch_usage );
 
     HelpOptionsStandard ();
 
@@ -727,7 +732,14 @@ static rc_t vdm_dump_opened_table( const p_dump_context ctx, const VTable *tbl )
                                 else
                                 {
                                     r_ctx . ctx = ctx;
-                                    rc = vdm_dump_rows( &r_ctx ); /* <--- */
+                                    if ( df_arrow == ctx -> format )
+                                    {
+                                        rc = vdar_dump_rows( &r_ctx ); /* in vdb-dump-arrow.c */
+                                    }
+                                    else
+                                    {
+                                        rc = vdm_dump_rows( &r_ctx ); /* <--- */
+                                    }
                                 }
                             }
                         }
@@ -28,6 +28,8 @@
 
 #include <stdio.h>
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 #include <kapp/main.h>
 #include <klib/rc.h>
@@ -46,6 +48,7 @@ namespace AlignCache
         int64_t     id_spread_threshold;
         size_t      cursor_cache_size;
         size_t      min_cache_count;
+        uint32_t    thread_count;
 
         // Internal parameters
         bool cache_alignment_count;
@@ -62,6 +65,7 @@ namespace AlignCache
         1024UL << 20, // 1 GB
 #endif
         100000,
+        0,
         // Internal parameters
         true
     };
@@ -78,13 +82,48 @@ namespace AlignCache
     //char const ALIAS_MIN_CACHE_COUNT[]  = "";
     char const* USAGE_MIN_CACHE_COUNT[]  = { "if the number of primary alignment ids in the src db selected for caching is less than <min-cache-count>, the cache db will not be created at all", NULL };
 
+    char const OPTION_THREADS[] = "threads";
+    //char const ALIAS_THREADS[]  = "";
+    char const* USAGE_THREADS[]  = { "number of worker threads; with more than 1 the ids to cache are collected by parallel range scans, sorted, and the records are read in sorted runs by the workers (cursor cache is capped per cursor)", NULL };
+
     ::OptDef Options[] =
     {
         { OPTION_ID_SPREAD_THRESHOLD, ALIAS_ID_SPREAD_THRESHOLD, NULL, USAGE_ID_SPREAD_THRESHOLD, 1, true, false },
         { OPTION_CURSOR_CACHE_SIZE, NULL, NULL, USAGE_CURSOR_CACHE_SIZE, 1, true, false },
         { OPTION_MIN_CACHE_COUNT, NULL, NULL, USAGE_MIN_CACHE_COUNT, 1, true, false },
+        { OPTION_THREADS, NULL, NULL, USAGE_THREADS, 1, true, false },
     };
 
+    // Parallel mode (--threads > 1):
+    // the cursors read narrow, ascending id-ranges, they do not need the big cache
+    size_t const PARALLEL_CURSOR_CACHE_SIZE = 256UL << 20;
+    // number of ids a worker reads from PRIMARY_ALIGNMENT at a time
+    size_t const PARALLEL_RUN_SIZE = 16384;
+    // how many runs per worker may wait for the writer
+    size_t const PARALLEL_RUNS_AHEAD = 4;
+
+    // Defining the set of columns to be copied from PRIMARY_ALIGNMENT table
+    // to the new cache table
+    // ALIGNMENT_COUNT is the optional column, it must be at the end of this array
+#define DECLARE_PA_COLUMNS( arrName, column_suffix ) char const* arrName[] =\
+    {\
+        "MATE_ALIGN_ID"     column_suffix,\
+        "SAM_FLAGS"         column_suffix,\
+        "TEMPLATE_LEN"      column_suffix,\
+        "MATE_REF_NAME"     column_suffix,\
+        "MATE_REF_POS"      column_suffix,\
+        "SAM_QUALITY"       column_suffix,\
+        "RD_FILTER"         column_suffix,\
+        "SPOT_GROUP"        column_suffix,\
+        "ALIGNMENT_COUNT"   column_suffix\
+    }
+
+    DECLARE_PA_COLUMNS (ColumnNamesPrimaryAlignment, "");
+    DECLARE_PA_COLUMNS (ColumnNamesPrimaryAlignmentCache, "_CACHE");
+#undef DECLARE_PA_COLUMNS
+
+    size_t const PA_COLUMN_COUNT = countof (ColumnNamesPrimaryAlignment);
+
     struct PrimaryAlignmentData
     {
         uint64_t                    prev_key;
@@ -149,6 +188,22 @@ namespace AlignCache
     }
 
 
+    // prev_row_id == 0: the very first cached row - need to set starting row_id
+    // otherwise: filling gaps between actually cached rows with zero-length records
+    void PrepareCacheRow ( VDBObjects::CVCursor& cur_cache, int64_t prev_row_id, int64_t row_id )
+    {
+        if ( prev_row_id == 0 )
+            cur_cache.SetRowId ( row_id );
+        else if ( row_id - prev_row_id > 1)
+        {
+            cur_cache.OpenRow ();
+            cur_cache.CommitRow ();
+            if (row_id - prev_row_id > 2)
+                cur_cache.RepeatRow ( row_id - prev_row_id - 2 ); // -2 due to the first zero-row has been written in the previous line
+            cur_cache.CloseRow ();
+        }
+    }
+
     rc_t KVectorCallbackPrimaryAlignment ( uint64_t key, bool value, void *user_data )
     {
         if ( ::Quitting() )
@@ -168,25 +223,10 @@ namespace AlignCache
         //++p->count;
         //print_percent (p->count, p->total_count);
 
-        // Filling gaps between actually cached rows with zero-length records
-        if ( p->prev_key )
-        {
-            if ( row_id - prev_row_id > 1)
-            {
-                cur_cache.OpenRow ();
-                cur_cache.CommitRow ();
-                if (row_id - prev_row_id > 2)
-                    cur_cache.RepeatRow ( row_id - prev_row_id - 2 ); // -2 due to the first zero-row has been written in the previous line
-                cur_cache.CloseRow ();
-            }
-        }
+        PrepareCacheRow ( cur_cache, prev_row_id, row_id );
 
         // Caching (copying) actual record from PRIMARY_ALIGNMENT table
         {
-            // The very first visit - need to set starting row_id
-            if ( p->prev_key == 0 )
-                cur_cache.SetRowId ( row_id );
-
             VDBObjects::CVCursor const& cur_pa = *p->pCursorPA;
             uint32_t const* ColIndexPA = p->pColumnIndex;
             uint32_t const* ColIndexCache = p->pColumnIndexCache;
@@ -241,22 +281,30 @@ namespace AlignCache
         return 0;
     }
 
-    bool ProcessSequenceRow ( int64_t idRow, VDBObjects::CVCursor const& cursor, KLib::CKVector& vect, uint32_t idxCol )
+    // true if the spot has 2 aligned reads farther apart than the threshold
+    bool IsSpreadMatePair ( int64_t idRow, VDBObjects::CVCursor const& cursor, uint32_t idxCol, int64_t& id1, int64_t& id2 )
     {
         int64_t buf[3]; // TODO: find out the real type of this array
         uint32_t items_read_count = cursor.ReadItems ( idRow, idxCol, buf, countof(buf) );
         if ( items_read_count == 2 )
         {
-            int64_t id1 = buf[0];
-            int64_t id2 = buf[1];
+            id1 = buf[0];
+            id2 = buf[1];
             int64_t diff = id1 >= id2 ? id1 - id2 : id2 - id1;
 
-            if (id1 && id2 && diff > g_Params.id_spread_threshold)
-            {
-                vect.SetBool(id1, true);
-                vect.SetBool(id2, true);
-                return true;
-            }
+            return id1 && id2 && diff > g_Params.id_spread_threshold;
+        }
+        return false;
+    }
+
+    bool ProcessSequenceRow ( int64_t idRow, VDBObjects::CVCursor const& cursor, KLib::CKVector& vect, uint32_t idxCol )
+    {
+        int64_t id1, id2;
+        if ( IsSpreadMatePair ( idRow, cursor, idxCol, id1, id2 ) )
+        {
+            vect.SetBool(id1, true);
+            vect.SetBool(id2, true);
+            return true;
         }
         return false;
     }
@@ -296,44 +344,20 @@ namespace AlignCache
         return count;
     }
 
-    void CachePrimaryAlignment (VDBObjects::CVDBManager& mgr, VDBObjects::CVDatabase const& vdb, size_t cache_size, KLib::CKVector const& vect, size_t vect_size, KApp::CProgressBar& progress_bar)
+    // Openning cursor to read through PRIMARY_ALIGNMENT table
+    VDBObjects::CVCursor OpenPrimaryAlignmentCursor ( VDBObjects::CVTable const& tablePA, size_t cache_size, uint32_t* ColumnIndexPrimaryAlignment )
     {
-        // Defining the set of columns to be copied from PRIMARY_ALIGNMENT table
-        // to the new cache table
-        // ALIGNMENT_COUNT is the optional column, it must be at the end of this array
-#define DECLARE_PA_COLUMNS( arrName, column_suffix ) char const* arrName[] =\
-        {\
-            "MATE_ALIGN_ID"     column_suffix,\
-            "SAM_FLAGS"         column_suffix,\
-            "TEMPLATE_LEN"      column_suffix,\
-            "MATE_REF_NAME"     column_suffix,\
-            "MATE_REF_POS"      column_suffix,\
-            "SAM_QUALITY"       column_suffix,\
-            "RD_FILTER"         column_suffix,\
-            "SPOT_GROUP"        column_suffix,\
-            "ALIGNMENT_COUNT"   column_suffix\
-        }
-
-        DECLARE_PA_COLUMNS (ColumnNamesPrimaryAlignment, "");
-        DECLARE_PA_COLUMNS (ColumnNamesPrimaryAlignmentCache, "_CACHE");
-#undef DECLARE_PA_COLUMNS
-
-        uint32_t ColumnIndexPrimaryAlignment [ countof (ColumnNamesPrimaryAlignment) ];
-        uint32_t ColumnIndexPrimaryAlignmentCache [ countof (ColumnNamesPrimaryAlignmentCache) ];
-
-        // Openning cursor to iterate through PRIMARY_ALIGNMENT table
-        VDBObjects::CVTable tablePA = vdb.OpenTable("PRIMARY_ALIGNMENT");
         VDBObjects::CVCursor cursorPA = tablePA.CreateCursorRead ( cache_size );
         cursorPA.PermitPostOpenAdd();
-        cursorPA.InitColumnIndex ( ColumnNamesPrimaryAlignment, ColumnIndexPrimaryAlignment, countof(ColumnNamesPrimaryAlignment) - 1, false );
+        cursorPA.InitColumnIndex ( ColumnNamesPrimaryAlignment, ColumnIndexPrimaryAlignment, PA_COLUMN_COUNT - 1, false );
         cursorPA.Open();
 
         // Check if we can read ALIGNMENT_COUNT parameter
         try
         {
             cursorPA.InitColumnIndex(
-                ColumnNamesPrimaryAlignment + countof(ColumnNamesPrimaryAlignment) - 1,
-                ColumnIndexPrimaryAlignment + countof(ColumnIndexPrimaryAlignment) - 1,
+                ColumnNamesPrimaryAlignment + PA_COLUMN_COUNT - 1,
+                ColumnIndexPrimaryAlignment + PA_COLUMN_COUNT - 1,
                 1, false
             );
         }
@@ -344,20 +368,39 @@ namespace AlignCache
             else
                 throw;
         }
+        return cursorPA;
+    }
 
-        // Creating new cache table (with the same name - PRIMARY_ALIGNMENT but in the separate DB file)
+    // Creating new cache table (with the same name - PRIMARY_ALIGNMENT but in the separate DB file)
+    void CreateCacheTable ( VDBObjects::CVDBManager& mgr, VDBObjects::CVDatabase& dbCache, VDBObjects::CVTable& tableCache,
+                            VDBObjects::CVCursor& cursorCache, uint32_t* ColumnIndexPrimaryAlignmentCache )
+    {
         char const schema_path[] = "align/mate-cache.vschema";
 
         VDBObjects::CVSchema schema = mgr.MakeSchema ();
         schema.VSchemaParseFile ( schema_path );
         char szCacheDBName[256] = "";
         string_printf (szCacheDBName, countof (szCacheDBName), NULL, "%s", g_Params.dbPathDst );
-        VDBObjects::CVDatabase dbCache = mgr.CreateDB ( schema, "NCBI:align:db:mate_cache #1", kcmParents | kcmInit | kcmMD5, szCacheDBName );
-        VDBObjects::CVTable tableCache = dbCache.CreateTable ( "PRIMARY_ALIGNMENT" );
+        dbCache = mgr.CreateDB ( schema, "NCBI:align:db:mate_cache #1", kcmParents | kcmInit | kcmMD5, szCacheDBName );
+        tableCache = dbCache.CreateTable ( "PRIMARY_ALIGNMENT" );
 
-        VDBObjects::CVCursor cursorCache = tableCache.CreateCursorWrite ( kcmInsert );
-        cursorCache.InitColumnIndex ( ColumnNamesPrimaryAlignmentCache, ColumnIndexPrimaryAlignmentCache, countof (ColumnNamesPrimaryAlignmentCache) - (size_t) (!g_Params.cache_alignment_count), true );
+        cursorCache = tableCache.CreateCursorWrite ( kcmInsert );
+        cursorCache.InitColumnIndex ( ColumnNamesPrimaryAlignmentCache, ColumnIndexPrimaryAlignmentCache, PA_COLUMN_COUNT - (size_t) (!g_Params.cache_alignment_count), true );
         cursorCache.Open ();
+    }
+
+    void CachePrimaryAlignment (VDBObjects::CVDBManager& mgr, VDBObjects::CVDatabase const& vdb, size_t cache_size, KLib::CKVector const& vect, size_t vect_size, KApp::CProgressBar& progress_bar)
+    {
+        uint32_t ColumnIndexPrimaryAlignment [ PA_COLUMN_COUNT ];
+        uint32_t ColumnIndexPrimaryAlignmentCache [ PA_COLUMN_COUNT ];
+
+        VDBObjects::CVTable tablePA = vdb.OpenTable("PRIMARY_ALIGNMENT");
+        VDBObjects::CVCursor cursorPA = OpenPrimaryAlignmentCursor ( tablePA, cache_size, ColumnIndexPrimaryAlignment );
+
+        VDBObjects::CVDatabase dbCache;
+        VDBObjects::CVTable tableCache;
+        VDBObjects::CVCursor cursorCache;
+        CreateCacheTable ( mgr, dbCache, tableCache, cursorCache, ColumnIndexPrimaryAlignmentCache );
 
         //PrimaryAlignmentData data = { 0, &cursorPA, ColumnIndexPrimaryAlignment, ColumnIndexPrimaryAlignmentCache, countof (ColumnNamesPrimaryAlignment), &cursorCache, 0, vect_size };
         progress_bar.Append (vect_size);
@@ -367,7 +410,7 @@ namespace AlignCache
             &cursorPA,
             ColumnIndexPrimaryAlignment,
             ColumnIndexPrimaryAlignmentCache,
-            countof (ColumnNamesPrimaryAlignment),
+            PA_COLUMN_COUNT,
             &cursorCache,
             &progress_bar
         };
@@ -377,6 +420,383 @@ namespace AlignCache
         cursorCache.Commit ();
     }
 
+    // returns the rc_t of an exception caught in a worker thread, the message is logged
+    rc_t HandleThreadException ()
+    {
+        int64_t rc = Utils::HandleException ( false, NULL, 0 );
+        return rc > 0 ? (rc_t)rc : RC ( rcExe, rcThread, rcExecuting, rcThread, rcFailed );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Parallel mode, step 1: range scans of SEQUENCE collect the ids to cache
+
+    struct SequenceScan
+    {
+        VDBObjects::CVCursor cursor;
+        uint32_t idxCol;
+        int64_t idFirst;
+        uint64_t nCount;
+        std::vector<int64_t> ids;
+    };
+
+    rc_t CC SequenceScanThread ( ::KThread const* self, void* data )
+    {
+        SequenceScan* p = (SequenceScan*)data;
+        try
+        {
+            for ( int64_t idRow = p->idFirst; idRow < p->idFirst + (int64_t)p->nCount; ++idRow )
+            {
+                if ( (idRow & 0xFFFF) == 0 && ::Quitting() )
+                    break;
+
+                int64_t id1, id2;
+                if ( IsSpreadMatePair ( idRow, p->cursor, p->idxCol, id1, id2 ) )
+                {
+                    p->ids.push_back ( id1 );
+                    p->ids.push_back ( id2 );
+                }
+            }
+        }
+        catch (...)
+        {
+            return HandleThreadException ();
+        }
+        return 0;
+    }
+
+    size_t CollectAlignIDsParallel ( VDBObjects::CVDatabase const& vdb, size_t cache_size, std::vector<int64_t>& ids )
+    {
+        char const* ColumnNamesSequence[] =
+        {
+            "PRIMARY_ALIGNMENT_ID"
+        };
+        size_t const thread_count = g_Params.thread_count;
+
+        VDBObjects::CVTable table = vdb.OpenTable("SEQUENCE");
+
+        std::vector<SequenceScan> scans ( thread_count );
+        int64_t idFirst = 0;
+        uint64_t nRowCount = 0;
+        for ( size_t i = 0; i < thread_count; ++i )
+        {
+            SequenceScan& scan = scans [ i ];
+            scan.cursor = table.CreateCursorRead ( cache_size );
+            scan.cursor.InitColumnIndex (ColumnNamesSequence, & scan.idxCol, countof(ColumnNamesSequence), false);
+            scan.cursor.Open();
+            if ( i == 0 )
+                scan.cursor.GetIdRange (idFirst, nRowCount);
+        }
+
+        // one contiguous range of SEQUENCE rows per thread
+        uint64_t chunk = ( nRowCount + thread_count - 1 ) / thread_count;
+        for ( size_t i = 0; i < thread_count; ++i )
+        {
+            uint64_t start = std::min<uint64_t> ( i * chunk, nRowCount );
+            scans [ i ].idFirst = idFirst + (int64_t)start;
+            scans [ i ].nCount = std::min<uint64_t> ( chunk, nRowCount - start );
+        }
+
+        rc_t rc = 0;
+        {
+            std::vector<KProc::CKThread> threads ( thread_count );
+            for ( size_t i = 0; i < thread_count; ++i )
+                threads [ i ].Make ( SequenceScanThread, & scans [ i ] );
+            for ( size_t i = 0; i < thread_count; ++i )
+            {
+                rc_t rc_thread = threads [ i ].Wait ();
+                if ( rc == 0 )
+                    rc = rc_thread;
+            }
+        }
+        if ( rc )
+            throw Utils::CErrorMsg ( rc, "Scanning SEQUENCE table" );
+
+        if ( ::Quitting() )
+        {
+            LOGMSG ( klogWarn, "Interrupted" );
+            return 0;
+        }
+
+        size_t total = 0;
+        for ( size_t i = 0; i < thread_count; ++i )
+            total += scans [ i ].ids.size ();
+        ids.reserve ( total );
+        for ( size_t i = 0; i < thread_count; ++i )
+        {
+            ids.insert ( ids.end (), scans [ i ].ids.begin (), scans [ i ].ids.end () );
+            std::vector<int64_t> ().swap ( scans [ i ].ids );
+        }
+
+        // the cache table is written in ascending row_id order
+        std::sort ( ids.begin (), ids.end () );
+        ids.erase ( std::unique ( ids.begin (), ids.end () ), ids.end () );
+
+        return total / 2;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Parallel mode, step 2: workers read the records of the sorted ids
+    // in runs, a single writer appends the runs in order to the cache table
+
+    struct CachedRow
+    {
+        int64_t  row_id;
+        int64_t  mate_align_id;
+        uint32_t sam_flags;
+        int32_t  template_len;
+        uint32_t mate_ref_pos;
+        uint8_t  rd_filter;
+        uint8_t  alignment_count;
+        // MATE_REF_NAME, SAM_QUALITY, SPOT_GROUP: offset and length in CacheRun::text
+        size_t   str_offset[3];
+        uint32_t str_len[3];
+    };
+
+    struct CacheRun
+    {
+        CacheRun () : ready ( false ) {}
+
+        std::vector<CachedRow> rows;
+        std::vector<char> text;
+        bool ready;
+    };
+
+    struct CacheRunQueue
+    {
+        CacheRunQueue ( std::vector<int64_t> const& ids, size_t max_runs_ahead )
+            : ids ( ids ),
+            run_count ( ( ids.size () + PARALLEL_RUN_SIZE - 1 ) / PARALLEL_RUN_SIZE ),
+            next_run ( 0 ),
+            written_runs ( 0 ),
+            max_runs_ahead ( max_runs_ahead ),
+            runs ( run_count ),
+            aborted ( false )
+        {}
+
+        void Abort ()
+        {
+            lock.Acquire ();
+            aborted = true;
+            cond.Broadcast ();
+            lock.Unlock ();
+        }
+
+        std::vector<int64_t> const& ids;
+        size_t const run_count;
+        size_t next_run;        // the next run to be claimed by a worker
+        size_t written_runs;    // the runs the writer is done with
+        size_t const max_runs_ahead;
+        std::vector<CacheRun> runs;
+        bool aborted;
+        KProc::CKLock lock;
+        KProc::CKCondition cond;
+    };
+
+    struct CacheWorker
+    {
+        CacheRunQueue* queue;
+        VDBObjects::CVCursor cursor;
+        uint32_t ColumnIndex [ PA_COLUMN_COUNT ];
+    };
+
+    void read_str_field (
+        VDBObjects::CVCursor const& curFrom,
+        int64_t row_id,
+        uint32_t column_index_from,
+        CacheRun& run,
+        CachedRow& row,
+        size_t str_idx
+        )
+    {
+        char val[4096];
+        uint32_t item_count = curFrom.ReadItems ( row_id, column_index_from, val, sizeof (val) );
+        row.str_offset [ str_idx ] = run.text.size ();
+        row.str_len [ str_idx ] = item_count;
+        run.text.insert ( run.text.end (), val, val + item_count );
+    }
+
+    void ReadCacheRun ( CacheWorker const& w, size_t run_idx, CacheRun& run )
+    {
+        std::vector<int64_t> const& ids = w.queue->ids;
+        size_t first = run_idx * PARALLEL_RUN_SIZE;
+        size_t last = std::min ( first + PARALLEL_RUN_SIZE, ids.size () );
+        VDBObjects::CVCursor const& cur_pa = w.cursor;
+        uint32_t const* ColIndexPA = w.ColumnIndex;
+
+        run.rows.resize ( last - first );
+        run.text.clear ();
+        for ( size_t i = first; i < last; ++i )
+        {
+            CachedRow& row = run.rows [ i - first ];
+            int64_t row_id = ids [ i ];
+
+            row.row_id = row_id;
+            cur_pa.ReadItems ( row_id, ColIndexPA[0], & row.mate_align_id, 1 );
+            cur_pa.ReadItems ( row_id, ColIndexPA[1], & row.sam_flags, 1 );
+            cur_pa.ReadItems ( row_id, ColIndexPA[2], & row.template_len, 1 );
+            read_str_field ( cur_pa, row_id, ColIndexPA[3], run, row, 0 );
+            cur_pa.ReadItems ( row_id, ColIndexPA[4], & row.mate_ref_pos, 1 );
+            read_str_field ( cur_pa, row_id, ColIndexPA[5], run, row, 1 );
+            cur_pa.ReadItems ( row_id, ColIndexPA[6], & row.rd_filter, 1 );
+            read_str_field ( cur_pa, row_id, ColIndexPA[7], run, row, 2 );
+            row.alignment_count = 0;
+            if ( g_Params.cache_alignment_count )
+                cur_pa.ReadItems ( row_id, ColIndexPA[8], & row.alignment_count, 1 );
+        }
+    }
+
+    rc_t CC CacheWorkerThread ( ::KThread const* self, void* data )
+    {
+        CacheWorker* w = (CacheWorker*)data;
+        CacheRunQueue& q = *w->queue;
+        try
+        {
+            for ( ;; )
+            {
+                // claim the next run, but do not get too far ahead of the writer
+                q.lock.Acquire ();
+                while ( !q.aborted && q.next_run < q.run_count && q.next_run >= q.written_runs + q.max_runs_ahead )
+                    q.cond.Wait ( q.lock );
+                bool done = q.aborted || q.next_run >= q.run_count;
+                size_t run_idx = q.next_run++;
+                q.lock.Unlock ();
+
+                if ( done )
+                    break;
+
+                ReadCacheRun ( *w, run_idx, q.runs [ run_idx ] );
+
+                q.lock.Acquire ();
+                q.runs [ run_idx ].ready = true;
+                q.cond.Broadcast ();
+                q.lock.Unlock ();
+            }
+        }
+        catch (...)
+        {
+            rc_t rc = HandleThreadException ();
+            q.Abort ();
+            return rc;
+        }
+        return 0;
+    }
+
+    void WriteCachedRow ( VDBObjects::CVCursor& cur_cache, uint32_t const* ColIndexCache, CachedRow const& row, char const* text )
+    {
+        cur_cache.OpenRow ();
+
+        cur_cache.Write ( ColIndexCache[0], & row.mate_align_id, 1 );
+        cur_cache.Write ( ColIndexCache[1], & row.sam_flags, 1 );
+        cur_cache.Write ( ColIndexCache[2], & row.template_len, 1 );
+        cur_cache.Write ( ColIndexCache[3], text + row.str_offset[0], row.str_len[0] );
+        cur_cache.Write ( ColIndexCache[4], & row.mate_ref_pos, 1 );
+        cur_cache.Write ( ColIndexCache[5], text + row.str_offset[1], row.str_len[1] );
+        cur_cache.Write ( ColIndexCache[6], & row.rd_filter, 1 );
+        cur_cache.Write ( ColIndexCache[7], text + row.str_offset[2], row.str_len[2] );
+        if ( g_Params.cache_alignment_count )
+            cur_cache.Write ( ColIndexCache[8], & row.alignment_count, 1 );
+
+        cur_cache.CommitRow ();
+        cur_cache.CloseRow ();
+    }
+
+    // returns false if interrupted
+    bool WriteCacheRuns ( CacheRunQueue& q, VDBObjects::CVCursor& cursorCache, uint32_t const* ColIndexCache, KApp::CProgressBar& progress_bar )
+    {
+        int64_t prev_row_id = 0;
+        for ( size_t run_idx = 0; run_idx < q.run_count; ++run_idx )
+        {
+            CacheRun run;
+
+            q.lock.Acquire ();
+            while ( !q.aborted && !q.runs [ run_idx ].ready )
+                q.cond.Wait ( q.lock );
+            bool aborted = q.aborted;
+            run.rows.swap ( q.runs [ run_idx ].rows );
+            run.text.swap ( q.runs [ run_idx ].text );
+            q.lock.Unlock ();
+
+            if ( aborted )
+                return false;
+
+            char const* text = run.text.empty () ? NULL : & run.text [ 0 ];
+            for ( size_t i = 0; i < run.rows.size (); ++i )
+            {
+                CachedRow const& row = run.rows [ i ];
+                PrepareCacheRow ( cursorCache, prev_row_id, row.row_id );
+                WriteCachedRow ( cursorCache, ColIndexCache, row, text );
+                prev_row_id = row.row_id;
+            }
+            progress_bar.Process ( run.rows.size (), false );
+
+            q.lock.Acquire ();
+            ++ q.written_runs;
+            q.cond.Broadcast ();
+            q.lock.Unlock ();
+
+            if ( ::Quitting() )
+            {
+                LOGMSG ( klogWarn, "Interrupted" );
+                q.Abort ();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CachePrimaryAlignmentParallel (VDBObjects::CVDBManager& mgr, VDBObjects::CVDatabase const& vdb, size_t cache_size, std::vector<int64_t> const& ids, KApp::CProgressBar& progress_bar)
+    {
+        size_t const thread_count = g_Params.thread_count;
+        uint32_t ColumnIndexPrimaryAlignmentCache [ PA_COLUMN_COUNT ];
+
+        CacheRunQueue queue ( ids, thread_count * PARALLEL_RUNS_AHEAD );
+
+        // the cursors are opened here, the workers only read
+        VDBObjects::CVTable tablePA = vdb.OpenTable("PRIMARY_ALIGNMENT");
+        std::vector<CacheWorker> workers ( thread_count );
+        for ( size_t i = 0; i < thread_count; ++i )
+        {
+            workers [ i ].queue = & queue;
+            workers [ i ].cursor = OpenPrimaryAlignmentCursor ( tablePA, cache_size, workers [ i ].ColumnIndex );
+        }
+
+        VDBObjects::CVDatabase dbCache;
+        VDBObjects::CVTable tableCache;
+        VDBObjects::CVCursor cursorCache;
+        CreateCacheTable ( mgr, dbCache, tableCache, cursorCache, ColumnIndexPrimaryAlignmentCache );
+
+        progress_bar.Append (ids.size ());
+
+        bool completed = false;
+        rc_t rc = 0;
+        {
+            std::vector<KProc::CKThread> threads ( thread_count );
+            try
+            {
+                for ( size_t i = 0; i < thread_count; ++i )
+                    threads [ i ].Make ( CacheWorkerThread, & workers [ i ] );
+
+                completed = WriteCacheRuns ( queue, cursorCache, ColumnIndexPrimaryAlignmentCache, progress_bar );
+            }
+            catch (...)
+            {
+                queue.Abort ();
+                throw;
+            }
+            for ( size_t i = 0; i < thread_count; ++i )
+            {
+                rc_t rc_thread = threads [ i ].Wait ();
+                if ( rc == 0 )
+                    rc = rc_thread;
+            }
+        }
+        if ( rc )
+            throw Utils::CErrorMsg ( rc, "Reading PRIMARY_ALIGNMENT table" );
+
+        if ( completed )
+            cursorCache.Commit ();
+    }
+
     int create_cache_db_impl()
     {
         // Adding 0% mark at the very beginning of the program
@@ -388,14 +808,23 @@ namespace AlignCache
 
         VDBObjects::CVDatabase vdb = mgr.OpenDB (g_Params.dbPathSrc);
 
+        bool const parallel = g_Params.thread_count > 1;
+        size_t const parallel_cache_size = std::min ( g_Params.cursor_cache_size, PARALLEL_CURSOR_CACHE_SIZE );
+
         // Scan SEQUENCE table to find mate_alignment_ids that have to be cached
         KLib::CKVector vect;
-        size_t count = FillKVectorWithAlignIDs ( vdb, g_Params.cursor_cache_size, vect );
+        std::vector<int64_t> ids;
+        size_t count = parallel
+            ? CollectAlignIDsParallel ( vdb, parallel_cache_size, ids )
+            : FillKVectorWithAlignIDs ( vdb, g_Params.cursor_cache_size, vect );
 
         if ( count*2 >= g_Params.min_cache_count )
         {
             // For each id in vect cache the PRIMARY_ALIGNMENT record
-            CachePrimaryAlignment ( mgr, vdb, g_Params.cursor_cache_size, vect, count*2, progress_bar );
+            if ( parallel )
+                CachePrimaryAlignmentParallel ( mgr, vdb, parallel_cache_size, ids, progress_bar );
+            else
+                CachePrimaryAlignment ( mgr, vdb, g_Params.cursor_cache_size, vect, count*2, progress_bar );
         }
         else
         {
@@ -484,6 +913,9 @@ namespace AlignCache
             if (args.GetOptionCount (OPTION_MIN_CACHE_COUNT))
                 g_Params.min_cache_count = args.GetOptionValueUInt <size_t> ( OPTION_MIN_CACHE_COUNT, 0 );
 
+            if (args.GetOptionCount (OPTION_THREADS))
+                g_Params.thread_count = args.GetOptionValueUInt <uint32_t> ( OPTION_THREADS, 0 );
+
             return create_cache_db_impl_safe ();
         }
         catch (...) // here we handle only exceptions in CArgs or CXMLLogger
@@ -534,6 +966,7 @@ extern "C"
         HelpOptionLine (AlignCache::ALIAS_ID_SPREAD_THRESHOLD, AlignCache::OPTION_ID_SPREAD_THRESHOLD, "value", AlignCache::USAGE_ID_SPREAD_THRESHOLD);
         HelpOptionLine (NULL, AlignCache::OPTION_CURSOR_CACHE_SIZE, "value in MB", AlignCache::USAGE_CURSOR_CACHE_SIZE);
         HelpOptionLine (NULL, AlignCache::OPTION_MIN_CACHE_COUNT, "count", AlignCache::USAGE_MIN_CACHE_COUNT);
+        HelpOptionLine (NULL, AlignCache::OPTION_THREADS, "count", AlignCache::USAGE_THREADS);
         XMLLogger_Usage();
 
         printf ("\n");
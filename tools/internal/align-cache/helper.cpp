@@ -196,6 +196,95 @@ namespace KLib
 
 ///////////////////////////////////////////////////////////////
 
+namespace KProc
+{
+    CKLock::CKLock() : m_pSelf(NULL)
+    {
+        rc_t rc = ::KLockMake ( &m_pSelf );
+        if (rc)
+            throw Utils::CErrorMsg(rc, "KLockMake");
+    }
+
+    CKLock::~CKLock()
+    {
+        ::KLockRelease ( m_pSelf );
+    }
+
+    void CKLock::Acquire ()
+    {
+        rc_t rc = ::KLockAcquire ( m_pSelf );
+        if (rc)
+            throw Utils::CErrorMsg(rc, "KLockAcquire");
+    }
+
+    void CKLock::Unlock ()
+    {
+        rc_t rc = ::KLockUnlock ( m_pSelf );
+        if (rc)
+            throw Utils::CErrorMsg(rc, "KLockUnlock");
+    }
+
+    CKCondition::CKCondition() : m_pSelf(NULL)
+    {
+        rc_t rc = ::KConditionMake ( &m_pSelf );
+        if (rc)
+            throw Utils::CErrorMsg(rc, "KConditionMake");
+    }
+
+    CKCondition::~CKCondition()
+    {
+        ::KConditionRelease ( m_pSelf );
+    }
+
+    void CKCondition::Wait ( CKLock& lock )
+    {
+        rc_t rc = ::KConditionWait ( m_pSelf, lock.m_pSelf );
+        if (rc)
+            throw Utils::CErrorMsg(rc, "KConditionWait");
+    }
+
+    void CKCondition::Broadcast ()
+    {
+        rc_t rc = ::KConditionBroadcast ( m_pSelf );
+        if (rc)
+            throw Utils::CErrorMsg(rc, "KConditionBroadcast");
+    }
+
+    CKThread::CKThread() : m_pSelf(NULL)
+    {}
+
+    CKThread::~CKThread()
+    {
+        Wait ();
+    }
+
+    void CKThread::Make ( rc_t ( CC * run_thread ) ( ::KThread const* self, void* data ), void* data )
+    {
+        if (m_pSelf)
+            throw Utils::CErrorMsg (0, "Duplicated call to KThreadMake");
+
+        rc_t rc = ::KThreadMake ( &m_pSelf, run_thread, data );
+        if (rc)
+            throw Utils::CErrorMsg(rc, "KThreadMake");
+    }
+
+    rc_t CKThread::Wait ()
+    {
+        rc_t status = 0;
+        if (m_pSelf)
+        {
+            rc_t rc = ::KThreadWait ( m_pSelf, &status );
+            ::KThreadRelease ( m_pSelf );
+            m_pSelf = NULL;
+            if (rc)
+                status = rc;
+        }
+        return status;
+    }
+}
+
+///////////////////////////////////////////////////////////////
+
 namespace VDBObjects
 {
     CVCursor::CVCursor() : m_pSelf(NULL)
@@ -39,6 +39,9 @@
 #include <klib/vector.h>
 #include <kapp/args.h>
 #include <kapp/log-xml.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
 
 #include <loader/progressbar.h>
 
@@ -76,6 +79,60 @@ namespace KLib
     };
 }
 
+namespace KProc
+{
+    class CKLock
+    {
+    public:
+        friend class CKCondition;
+
+        CKLock();
+        ~CKLock();
+
+        void Acquire ();
+        void Unlock ();
+
+    private:
+        CKLock (CKLock const& x);
+        CKLock& operator= (CKLock const& x);
+
+        ::KLock* m_pSelf;
+    };
+
+    class CKCondition
+    {
+    public:
+        CKCondition();
+        ~CKCondition();
+
+        void Wait ( CKLock& lock );
+        void Broadcast ();
+
+    private:
+        CKCondition (CKCondition const& x);
+        CKCondition& operator= (CKCondition const& x);
+
+        ::KCondition* m_pSelf;
+    };
+
+    class CKThread
+    {
+    public:
+        CKThread();
+        ~CKThread();
+
+        void Make ( rc_t ( CC * run_thread ) ( ::KThread const* self, void* data ), void* data );
+        // returns the rc_t the thread function has returned, 0 if not started
+        rc_t Wait ();
+
+    private:
+        CKThread (CKThread const& x);
+        CKThread& operator= (CKThread const& x);
+
+        ::KThread* m_pSelf;
+    };
+}
+
 namespace Utils
 {
     class CErrorMsg : public std::exception
@@ -942,6 +942,33 @@ rc_t ccat_md5 ( CCTree *tree, const KFile *sf, KTime_t mtime,
     if ( no_md5 )
         return ccat_sz ( tree, sf, mtime, ntype, node, name );
 
+    /* digest in the background if there are threads for it */
+    if ( hashpool != NULL )
+    {
+        const KFile *md5;
+
+        rc = CCHashFileMakeRead ( & md5, sf, hashpool, node -> _md5 );
+        if ( rc != 0 )
+            PLOGERR ( klogInt,  (klogInt, rc, "failed to create md5 wrapper for '$(path)'", "path=%s", name ));
+        else
+        {
+            rc = ccat_sz ( tree, md5, mtime, ntype, node, name );
+
+            /* reads the rest of the file, the digest follows later */
+            orc = KFileRelease ( md5 );
+            if ( orc != 0 )
+            {
+                PLOGERR (klogInt,
+                         (klogInt, orc,
+                          "failure in release reference counting file for '$(path)'",
+                          "path=%s", name ));
+                if (rc == 0)
+                    rc = orc;
+            }
+        }
+        return rc;
+    }
+
     /* normal md5 path */
     rc = KMD5SumFmtMakeUpdate ( & fmt, fnull );
     if ( rc != 0 )
@@ -0,0 +1,539 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "copycat-priv.h"
+
+#include <klib/log.h>
+#include <klib/rc.h>
+#include <klib/checksum.h>
+#include <kfs/file.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <sysalloc.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* make it last include */
+#include "debug.h"
+
+/* ======================================================================
+ * CCHashPool
+ *
+ * the catalog walk reads every file exactly once, in order: the input is
+ * a single stream that is being tee'd into the destination.  what can
+ * run beside it is the MD5 of every file at every nesting level ( the
+ * tar, the gzip inside the tar, the file inside the gzip... ).
+ *
+ * each file being read gets a CCHashStream; the bytes read are queued
+ * onto the stream as chunks and a pool of worker threads digests them.
+ * a stream is owned by at most one worker at a time, so its chunks are
+ * digested in order, while different streams are digested concurrently.
+ * the walker never waits for a digest: it is written into the node when
+ * the last chunk has been digested.  nothing looks at the digests
+ * before CCHashPoolWait(), so the XML comes out as before.
+ */
+CCHashPool *hashpool = NULL;
+
+/* how many bytes may be queued before the reader has to wait */
+#define HASH_QUEUE_LIMIT ( 64 * 1024 * 1024 )
+
+typedef struct CCHashChunk CCHashChunk;
+struct CCHashChunk
+{
+    CCHashChunk * next;
+    size_t size;
+    uint8_t data [ 1 ];
+};
+
+typedef struct CCHashStream CCHashStream;
+struct CCHashStream
+{
+    CCHashStream * next_ready;  /* link in the ready-list of the pool */
+    CCHashChunk * head;         /* chunks not yet digested */
+    CCHashChunk * tail;
+    uint8_t * digest;           /* where the result goes */
+    MD5State md5;
+    bool scheduled;             /* in the ready-list or owned by a worker */
+    bool closed;                /* no more chunks will come */
+};
+
+struct CCHashPool
+{
+    KLock * lock;
+    KCondition * work;          /* signaled when a stream becomes ready */
+    KCondition * progress;      /* signaled when chunks or streams are done */
+    KThread ** threads;
+    uint32_t num_threads;
+    uint32_t open_streams;
+    uint64_t queued;
+    CCHashStream * ready_head;
+    CCHashStream * ready_tail;
+    bool quit;
+};
+
+
+/* called with the lock held */
+static
+void CCHashPoolSchedule (CCHashPool * self, CCHashStream * s)
+{
+    s->scheduled = true;
+    s->next_ready = NULL;
+    if (self->ready_tail == NULL)
+        self->ready_head = s;
+    else
+        self->ready_tail->next_ready = s;
+    self->ready_tail = s;
+    KConditionSignal (self->work);
+}
+
+/* called with the lock held */
+static
+void CCHashPoolFinish (CCHashPool * self, CCHashStream * s)
+{
+    MD5StateFinish (&s->md5, s->digest);
+    free (s);
+    --self->open_streams;
+    KConditionBroadcast (self->progress);
+}
+
+static
+rc_t CC CCHashPoolThread (const KThread * t, void * data)
+{
+    CCHashPool * self = data;
+    rc_t rc = KLockAcquire (self->lock);
+
+    while (rc == 0)
+    {
+        CCHashStream * s;
+        CCHashChunk * chunks;
+        uint64_t digested = 0;
+
+        while (!self->quit && self->ready_head == NULL)
+            KConditionWait (self->work, self->lock);
+
+        if (self->ready_head == NULL)
+            break;
+
+        /* take the stream and everything queued on it so far */
+        s = self->ready_head;
+        self->ready_head = s->next_ready;
+        if (self->ready_head == NULL)
+            self->ready_tail = NULL;
+        chunks = s->head;
+        s->head = s->tail = NULL;
+        KLockUnlock (self->lock);
+
+        while (chunks != NULL)
+        {
+            CCHashChunk * next = chunks->next;
+            MD5StateAppend (&s->md5, chunks->data, chunks->size);
+            digested += chunks->size;
+            free (chunks);
+            chunks = next;
+        }
+
+        rc = KLockAcquire (self->lock);
+        if (rc == 0)
+        {
+            self->queued -= digested;
+            KConditionBroadcast (self->progress);
+
+            if (s->head != NULL)
+                CCHashPoolSchedule (self, s);
+            else if (s->closed)
+                CCHashPoolFinish (self, s);
+            else
+                s->scheduled = false;
+        }
+    }
+    if (rc == 0)
+        KLockUnlock (self->lock);
+    return rc;
+}
+
+
+rc_t CCHashPoolMake (CCHashPool ** pself, uint32_t threads)
+{
+    rc_t rc;
+    CCHashPool * self;
+
+    assert (pself);
+    *pself = NULL;
+
+    self = calloc (1, sizeof * self);
+    if (self == NULL)
+        return RC (rcExe, rcThread, rcConstructing, rcMemory, rcExhausted);
+
+    self->threads = calloc (threads, sizeof self->threads[0]);
+    if (self->threads == NULL)
+        rc = RC (rcExe, rcThread, rcConstructing, rcMemory, rcExhausted);
+    else
+    {
+        rc = KLockMake (&self->lock);
+        if (rc == 0)
+            rc = KConditionMake (&self->work);
+        if (rc == 0)
+            rc = KConditionMake (&self->progress);
+        for (; rc == 0 && self->num_threads < threads; ++self->num_threads)
+            rc = KThreadMake (&self->threads[self->num_threads],
+                              CCHashPoolThread, self);
+        if (rc == 0)
+        {
+            *pself = self;
+            return 0;
+        }
+    }
+    LOGERR (klogInt, rc, "failed to create md5 thread pool");
+    CCHashPoolRelease (self);
+    return rc;
+}
+
+
+rc_t CCHashPoolWait (CCHashPool * self)
+{
+    rc_t rc = 0;
+    if (self != NULL)
+    {
+        rc = KLockAcquire (self->lock);
+        if (rc == 0)
+        {
+            while (self->open_streams > 0)
+                KConditionWait (self->progress, self->lock);
+            KLockUnlock (self->lock);
+        }
+    }
+    return rc;
+}
+
+
+rc_t CCHashPoolRelease (CCHashPool * self)
+{
+    rc_t rc = 0;
+    if (self != NULL)
+    {
+        uint32_t ix;
+
+        /* the digests may still be written into nodes: let them land */
+        if (self->lock != NULL)
+        {
+            rc = CCHashPoolWait (self);
+            if (KLockAcquire (self->lock) == 0)
+            {
+                self->quit = true;
+                if (self->work != NULL)
+                    KConditionBroadcast (self->work);
+                KLockUnlock (self->lock);
+            }
+        }
+        for (ix = 0; ix < self->num_threads; ++ix)
+        {
+            if (self->threads[ix] != NULL)
+            {
+                rc_t status, orc = KThreadWait (self->threads[ix], &status);
+                if (rc == 0)
+                    rc = (orc != 0) ? orc : status;
+                KThreadRelease (self->threads[ix]);
+            }
+        }
+        KConditionRelease (self->progress);
+        KConditionRelease (self->work);
+        KLockRelease (self->lock);
+        free (self->threads);
+        free (self);
+    }
+    return rc;
+}
+
+
+static
+rc_t CCHashStreamMake (CCHashPool * pool, CCHashStream ** ps, uint8_t * digest)
+{
+    rc_t rc;
+    CCHashStream * s = calloc (1, sizeof * s);
+    if (s == NULL)
+        return RC (rcExe, rcThread, rcConstructing, rcMemory, rcExhausted);
+
+    MD5StateInit (&s->md5);
+    s->digest = digest;
+
+    rc = KLockAcquire (pool->lock);
+    if (rc != 0)
+    {
+        free (s);
+        return rc;
+    }
+    ++pool->open_streams;
+    KLockUnlock (pool->lock);
+
+    *ps = s;
+    return 0;
+}
+
+static
+rc_t CCHashStreamPost (CCHashPool * pool, CCHashStream * s,
+                       const void * data, size_t size)
+{
+    rc_t rc;
+    CCHashChunk * c;
+
+    if (size == 0)
+        return 0;
+
+    c = malloc (sizeof * c - 1 + size);
+    if (c == NULL)
+        return RC (rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted);
+    c->next = NULL;
+    c->size = size;
+    memmove (c->data, data, size);
+
+    rc = KLockAcquire (pool->lock);
+    if (rc != 0)
+    {
+        free (c);
+        return rc;
+    }
+
+    /* let the reader not run away from the workers */
+    while (pool->queued > HASH_QUEUE_LIMIT && !pool->quit)
+        KConditionWait (pool->progress, pool->lock);
+
+    if (s->tail == NULL)
+        s->head = c;
+    else
+        s->tail->next = c;
+    s->tail = c;
+    pool->queued += size;
+
+    if (!s->scheduled)
+        CCHashPoolSchedule (pool, s);
+
+    KLockUnlock (pool->lock);
+    return 0;
+}
+
+/* no more chunks: the stream goes away once everything is digested */
+static
+void CCHashStreamClose (CCHashPool * pool, CCHashStream * s)
+{
+    if (KLockAcquire (pool->lock) == 0)
+    {
+        s->closed = true;
+        if (!s->scheduled)
+        {
+            if (s->head == NULL)
+                CCHashPoolFinish (pool, s);
+            else
+                CCHashPoolSchedule (pool, s);
+        }
+        KLockUnlock (pool->lock);
+    }
+}
+
+
+/* ======================================================================
+ * CCHashFile
+ *  a read-wrapper feeding everything read sequentially into a CCHashStream
+ */
+typedef struct CCHashFile CCHashFile;
+#define KFILE_IMPL struct CCHashFile
+#include <kfs/impl.h>
+
+struct CCHashFile
+{
+    KFile	dad;
+    const KFile * original;
+    CCHashPool * pool;
+    CCHashStream * stream;
+    uint64_t	position;	/* everything before this has been posted */
+};
+
+/* read and post the bytes between what has been posted and "end"
+ * or up to the end of the file if "end" is 0 */
+static
+rc_t CCHashFileCatchUp (CCHashFile * self, uint64_t end)
+{
+    rc_t rc = 0;
+    uint8_t buffer [ 32 * 1024 ];
+
+    while (rc == 0 && (end == 0 || self->position < end))
+    {
+        size_t to_read = sizeof buffer;
+        size_t num_read;
+
+        if (end != 0 && end - self->position < to_read)
+            to_read = (size_t)(end - self->position);
+
+        rc = KFileRead (self->original, self->position, buffer, to_read, &num_read);
+        if (rc == 0)
+        {
+            if (num_read == 0)
+                break;
+            rc = CCHashStreamPost (self->pool, self->stream, buffer, num_read);
+            self->position += num_read;
+        }
+    }
+    return rc;
+}
+
+static
+rc_t CC CCHashFileDestroy (CCHashFile *self)
+{
+    rc_t rc, orc;
+
+    /* the digest is of the whole file, even if the catalog did not look at all of it */
+    rc = CCHashFileCatchUp (self, 0);
+    CCHashStreamClose (self->pool, self->stream);
+
+    orc = KFileRelease (self->original);
+    if (rc == 0)
+        rc = orc;
+    free (self);
+    return rc;
+}
+
+static
+struct KSysFile *CC CCHashFileGetSysFile (const CCHashFile *self, uint64_t *offset)
+{
+    /* bytes could not be hashed if memory mapped so this is disallowed */
+    return NULL;
+}
+
+static
+rc_t CC CCHashFileRandomAccess (const CCHashFile *self)
+{
+    return KFileRandomAccess (self->original);
+}
+
+static
+uint32_t CC CCHashFileType (const CCHashFile *self)
+{
+    return KFileType (self->original);
+}
+
+static
+rc_t CC CCHashFileSize (const CCHashFile *self, uint64_t *size)
+{
+    return KFileSize (self->original, size);
+}
+
+static
+rc_t CC CCHashFileSetSize (CCHashFile *self, uint64_t size)
+{
+    return RC (rcExe, rcFile, rcUpdating, rcFile, rcReadonly);
+}
+
+static
+rc_t CC CCHashFileRead (const CCHashFile *cself, uint64_t pos,
+                        void *buffer, size_t bsize, size_t *num_read)
+{
+    CCHashFile * self = (CCHashFile *)cself;
+    rc_t rc = 0;
+
+    /* a read past what has been posted: fill the gap first */
+    if (pos > self->position)
+        rc = CCHashFileCatchUp (self, pos);
+
+    if (rc == 0)
+    {
+        rc = KFileRead (self->original, pos, buffer, bsize, num_read);
+        if (rc == 0 && pos <= self->position && pos + *num_read > self->position)
+        {
+            size_t skip = (size_t)(self->position - pos);
+            rc = CCHashStreamPost (self->pool, self->stream,
+                                   (const uint8_t*)buffer + skip, *num_read - skip);
+            self->position = pos + *num_read;
+        }
+    }
+    return rc;
+}
+
+static
+rc_t CC CCHashFileWrite (CCHashFile *self, uint64_t pos,
+                         const void *buffer, size_t bsize, size_t *num_writ)
+{
+    return RC (rcExe, rcFile, rcWriting, rcFile, rcReadonly);
+}
+
+static const KFile_vt_v1 vtCCHashFile =
+{
+    /* version */
+    1, 1,
+
+    /* 1.0 */
+    CCHashFileDestroy,
+    CCHashFileGetSysFile,
+    CCHashFileRandomAccess,
+    CCHashFileSize,
+    CCHashFileSetSize,
+    CCHashFileRead,
+    CCHashFileWrite,
+
+    /* 1.1 */
+    CCHashFileType
+};
+
+rc_t CCHashFileMakeRead (const KFile ** pself, const KFile * original,
+                         CCHashPool * pool, uint8_t * digest)
+{
+    CCHashFile * self;
+    rc_t rc;
+
+    assert (pself);
+    assert (original);
+    assert (pool);
+    assert (digest);
+
+    *pself = NULL;
+
+    self = calloc (1, sizeof * self);
+    if (self == NULL)
+        return RC (rcExe, rcFile, rcConstructing, rcMemory, rcExhausted);
+
+    rc = KFileInit (&self->dad, (const KFile_vt*)&vtCCHashFile,
+                    "CCHashFile", "no-name", true, false);
+    if (rc == 0)
+    {
+        rc = CCHashStreamMake (pool, &self->stream, digest);
+        if (rc == 0)
+        {
+            rc = KFileAddRef (original);
+            if (rc == 0)
+            {
+                self->original = original;
+                self->pool = pool;
+                *pself = &self->dad;
+                return 0;
+            }
+            CCHashStreamClose (pool, self->stream);
+        }
+    }
+    free (self);
+    return rc;
+}
+
+/* end of file cchash.c */
@@ -203,6 +203,32 @@ rc_t KFileMakeChunkRead (const struct KFile ** pself,
 			 uint32_t num_chunks,
 			 struct KTocChunk * chunks);
 
+/*--------------------------------------------------------------------------
+ * CCHashPool
+ *  worker threads calculating the md5 sums behind the catalog walk
+ */
+typedef struct CCHashPool CCHashPool;
+extern CCHashPool *hashpool;    /* NULL if md5 sums are calculated inline */
+
+rc_t CCHashPoolMake ( CCHashPool ** pool, uint32_t threads );
+
+/* waits until every digest has been written */
+rc_t CCHashPoolWait ( CCHashPool * self );
+
+/* waits, then stops the threads */
+rc_t CCHashPoolRelease ( CCHashPool * self );
+
+/* CCHashFileMakeRead
+ *  wraps "original" ( attaching a new reference to it );
+ *  what is read sequentially gets digested in the pool,
+ *  the rest of the file is read when the wrapper is released.
+ *
+ *  "digest" [ OUT ] - receives the 16 bytes of the md5 sum at
+ *  some point after the release, at the latest in CCHashPoolWait()
+ */
+rc_t CCHashFileMakeRead ( const struct KFile ** self, const struct KFile * original,
+                          CCHashPool * pool, uint8_t * digest );
+
 bool CCFileFormatIsNCBIEncrypted ( void  * buffer );
 bool CCFileFormatIsWGAEncrypted ( void  * buffer );
 /*
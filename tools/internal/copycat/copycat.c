@@ -78,6 +78,7 @@ bool xml_dir = false;
 bool extract_dir = false;
 bool no_bzip2 = false;
 bool no_md5 = false;
+uint32_t md5_threads = 4;
 void * dump_out;
 const char * xml_base = NULL;
 
@@ -202,6 +203,7 @@ KCreateMode cm = kcmParents | kcmCreate;
 #define OPTION_OUTBLOCK "output-buffer"
 #define OPTION_NOBZIP2 "no-bzip2"
 #define OPTION_NOMD5   "no-md5"
+#define OPTION_THREADS "threads"
 
 #define ALIAS_CACHE   "x"
 #define ALIAS_FORCE   "f"
@@ -216,6 +218,7 @@ KCreateMode cm = kcmParents | kcmCreate;
 #define ALIAS_OUTBLOCK ""
 #define ALIAS_NOBZIP2 ""
 #define ALIAS_NOMD5   ""
+#define ALIAS_THREADS ""
 
 
 
@@ -251,6 +254,9 @@ const char * no_bzip2_usage[] =
 { "do not decompress files compressed with bzip2", NULL };
 const char * no_md5_usage[] = 
 { "do not calculate md5 hashes", NULL };
+static
+const char * threads_usage[] = 
+{ "calculate md5 hashes on this many threads beside the reading", "(default 4, 0 calculates them inline)", NULL };
 
 
 const char UsageDefaultName [] = "copycat";
@@ -293,6 +299,7 @@ rc_t CC Usage (const Args * args)
     HelpOptionLine (ALIAS_OUTBLOCK,OPTION_OUTBLOCK, "size-in-KB", outblock_usage);
     HelpOptionLine (ALIAS_NOBZIP2,OPTION_NOBZIP2, NULL, no_bzip2_usage);
     HelpOptionLine (ALIAS_NOMD5,OPTION_NOMD5, NULL, no_md5_usage);
+    HelpOptionLine (ALIAS_THREADS,OPTION_THREADS, "count", threads_usage);
     HelpOptionsStandard ();
 
 
@@ -405,7 +412,8 @@ OptDef Options[] =
     { OPTION_INBLOCK, ALIAS_OUTBLOCK,NULL, inblock_usage, 1, true,  false },
     { OPTION_OUTBLOCK,ALIAS_OUTBLOCK,NULL, outblock_usage,1, true,  false },
     { OPTION_NOBZIP2, ALIAS_NOBZIP2, NULL, no_bzip2_usage,0, false, false },
-    { OPTION_NOMD5,   ALIAS_NOMD5,   NULL, no_md5_usage,  0, false, false }
+    { OPTION_NOMD5,   ALIAS_NOMD5,   NULL, no_md5_usage,  0, false, false },
+    { OPTION_THREADS, ALIAS_THREADS, NULL, threads_usage, 1, true,  false }
 };
 
 /* file2file
@@ -1075,6 +1083,25 @@ rc_t KMain ( int argc, char *argv [] )
                 no_md5 = true;
             }
 
+            rc = ArgsOptionCount (args, OPTION_THREADS, &pcount);
+            if (pcount == 1)
+            {
+                const char * start;
+                char * end;
+
+                rc = ArgsOptionValue (args, OPTION_THREADS, 0, (const void **)&start);
+                if (rc)
+                    break;
+
+                md5_threads = strtou32 (start, &end, 10);
+
+                if (*end != '\0')
+                {
+                    rc = RC (rcExe, rcArgv, rcAccessing, rcParam, rcInvalid);
+                    break;
+                }
+            }
+
             /* all parameters plus the possible dest option parameter */
             rc = ArgsParamCount (args, &pcount);
             if (rc)
@@ -1202,8 +1229,22 @@ rc_t KMain ( int argc, char *argv [] )
 
                                     dump_out = stdout; /* kludge */
 
-                                    rc = copycat_run (tree, &logs, mgr, cache,
-                                                      dp, extract, &params);
+                                    if (!no_md5 && md5_threads > 0)
+                                    {
+                                        DEBUG_STATUS(("%s: Start md5 threads\n",
+                                                      __func__));
+                                        rc = CCHashPoolMake (&hashpool, md5_threads);
+                                    }
+                                    if (rc == 0)
+                                        rc = copycat_run (tree, &logs, mgr, cache,
+                                                          dp, extract, &params);
+
+                                    /* the digests land in the tree: wait for them before dumping
+                                     * it, and even more so before whacking it */
+                                    orc = CCHashPoolRelease (hashpool), hashpool = NULL;
+                                    if (rc == 0)
+                                        rc = orc;
+
                                     if ( rc == 0 )
                                         rc = copycat_dump ( xml_dir ? etree : tree, &logs );
                                     DEBUG_STATUS(("%s: Output XML\n", __func__));
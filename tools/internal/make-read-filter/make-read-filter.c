@@ -31,96 +31,64 @@
  */
 
 #include "make-read-filter.h" /* contains mostly boilerplate code */
+#include "quality-rules.h" /* the filtering rules */
 
 /* NOTE: Needs to be in same order as Options array */
 enum OPTIONS {
     OPT_OUTPUT,     /* temp path */
     OPT_CACHE,      /* vdbcache path */
+    OPT_THREADS,    /* number of worker threads */
+    OPT_BATCH,      /* rows per batch with worker threads */
     OPTIONS_COUNT
 };
 
-/* NOTE: Rules for filtering
-    Quote:
-        Reads that have more than half of quality score values <20 will be
-        flagged ‘reject’.
-        Reads that begin or end with a run of more than 10 quality scores <20
-        are also flagged ‘reject’.
- */
-typedef enum FilterReason {
-    keep = 0,
-    low_quality_count = 1,
-    low_quality_back = 2,
-    low_quality_front = 4,
-    original_filter = 8,
-} FilterReason;
-
-/** @brief Apply the rules to determine if a read should be filtered
- **/
-static FilterReason shouldFilter(uint32_t const len, uint8_t const *const qual)
-{
-    uint32_t under = 0;
-    uint32_t lastgood = len;
-    uint32_t i;
-    FilterReason reason = keep;
-    
-    for (i = 0; i < len; ++i) {
-        int const qval = qual[i];
-        if (qval < 20)
-            ++under;
-        else
-            lastgood = i; /* last good value */
-    }
-    if (under * 2 > len)
-        reason |= low_quality_count;
-    if (len <= 10) /* if length <= 10, then rest of rules can't apply */
-        return reason;
-    
-    if (lastgood < len - 11)
-        reason |= low_quality_back;
+typedef struct Dispositions {
+    uint64_t count[6];
+    uint64_t baseCount[6];
+} Dispositions;
 
-    for (i = 0; i < len; ++i) {
-        int const qval = qual[i];
-        if (qval >= 20)
-            break;
-        if (i == 10) {
-            reason |= low_quality_front;
-            break;
-        }
-    }
-    return reason;
-}
+Dispositions disposition;
 
-uint64_t dispositionCount[6];
-uint64_t dispositionBaseCount[6];
-static void updateCounts(FilterReason const reason, uint32_t const length)
+static void updateCounts(Dispositions *const counts, FilterReason const reason, uint32_t const length)
 {
     if (reason == keep) {
-        dispositionCount[0] += 1;
-        dispositionBaseCount[0] += length;
+        counts->count[0] += 1;
+        counts->baseCount[0] += length;
     }
     else {
-        dispositionCount[1] += 1;
-        dispositionBaseCount[1] += length;
+        counts->count[1] += 1;
+        counts->baseCount[1] += length;
     }
     if ((reason & original_filter) != 0) {
-        dispositionCount[2] += 1;
-        dispositionBaseCount[2] += length;
+        counts->count[2] += 1;
+        counts->baseCount[2] += length;
     }
     if ((reason & low_quality_count) != 0) {
-        dispositionCount[3] += 1;
-        dispositionBaseCount[3] += length;
+        counts->count[3] += 1;
+        counts->baseCount[3] += length;
     }
     if ((reason & low_quality_front) != 0) {
-        dispositionCount[4] += 1;
-        dispositionBaseCount[4] += length;
+        counts->count[4] += 1;
+        counts->baseCount[4] += length;
     }
     if ((reason & low_quality_back) != 0) {
-        dispositionCount[5] += 1;
-        dispositionBaseCount[5] += length;
+        counts->count[5] += 1;
+        counts->baseCount[5] += length;
+    }
+}
+
+static void addCounts(Dispositions *const counts, Dispositions const *const other)
+{
+    int i;
+
+    for (i = 0; i < 6; ++i) {
+        counts->count[i] += other->count[i];
+        counts->baseCount[i] += other->baseCount[i];
     }
 }
 
 static void computeReadFilter(uint8_t *const out_filter
+                             , Dispositions *const counts
                              , CellData const *const filterData
                              , CellData const *const typeData
                              , CellData const *const startData
@@ -157,7 +125,7 @@ static void computeReadFilter(uint8_t *const out_filter
                 if (reason != keep)
                     filt = SRA_READ_FILTER_REJECT;
             }
-            updateCounts(reason, len[i]);
+            updateCounts(counts, reason, len[i]);
         }
         out_filter[i] = filt;
     }
@@ -197,15 +165,66 @@ static void invalidateRow(int64_t const row)
     invalidateRow(row);
 }
 
+typedef struct InputColumns {
+    uint32_t pr_id;
+    uint32_t read_filter;
+    uint32_t readstart;
+    uint32_t read_type;
+    uint32_t readlen;
+    uint32_t qual;
+} InputColumns;
+
+static InputColumns addInputColumns(VCursor const *const in, bool const haveCache)
+{
+    InputColumns cid;
+
+    cid.pr_id       = haveCache ? addColumn("PRIMARY_ALIGNMENT_ID", "I64" , in) : 0;
+    cid.read_filter = addColumn("READ_FILTER", "U8" , in);
+    cid.readstart   = addColumn("READ_START" , "I32", in);
+    cid.read_type   = addColumn("READ_TYPE"  , "U8" , in);
+    cid.readlen     = addColumn("READ_LEN"   , "U32", in);
+    cid.qual        = addColumn("QUALITY"    , "U8" , in);
+
+    return cid;
+}
+
+/** @brief Compute the new READ_FILTER of a row into out_filter
+ * @return the input READ_FILTER
+ **/
+static CellData computeRow(uint8_t **const out_filter
+                          , size_t *const out_filter_count
+                          , size_t const offset
+                          , Dispositions *const counts
+                          , InputColumns const *const cid
+                          , int64_t const row
+                          , VCursor const *const in)
+{
+    CellData const readfilter = cellData("READ_FILTER", cid->read_filter, row, in);
+    CellData const readstart  = cellData("READ_START" , cid->readstart  , row, in);
+    CellData const readtype   = cellData("READ_TYPE"  , cid->read_type  , row, in);
+    CellData const readlen    = cellData("READ_LEN"   , cid->readlen    , row, in);
+    CellData const quality    = cellData("QUALITY"    , cid->qual       , row, in);
+
+    if (*out_filter_count < offset + readfilter.count) {
+        /* grow geometrically; batches append row after row */
+        size_t const needed = offset + readfilter.count;
+        size_t const want = offset == 0 ? needed : needed < 2 * *out_filter_count ? 2 * *out_filter_count : needed;
+        uint8_t *const temp = realloc(*out_filter, want * sizeof(temp[0]));
+        if (temp == NULL)
+            OUT_OF_MEMORY();
+        if (offset == 0)
+            pLogMsg(klogInfo, "increasing max read count to $(max)", "max=%zu", want);
+        *out_filter = temp;
+        *out_filter_count = want;
+    }
+    computeReadFilter(*out_filter + offset, counts, &readfilter, &readtype, &readstart, &readlen, &quality, row);
+    return readfilter;
+}
+
 static void processCursors(VCursor *const out, VCursor const *const in, bool const haveCache)
 {
     /* MARK: input columns */
-    uint32_t const cid_pr_id       = haveCache ? addColumn("PRIMARY_ALIGNMENT_ID", "I64" , in) : 0;
-    uint32_t const cid_read_filter = addColumn("READ_FILTER", "U8" , in);
-    uint32_t const cid_readstart   = addColumn("READ_START" , "I32", in);
-    uint32_t const cid_read_type   = addColumn("READ_TYPE"  , "U8" , in);
-    uint32_t const cid_readlen     = addColumn("READ_LEN"   , "U32", in);
-    uint32_t const cid_qual        = addColumn("QUALITY"    , "U8" , in);
+    InputColumns const cid = addInputColumns(in, haveCache);
 
     /* MARK: output column */
     uint32_t const cid_rd_filter = addColumn("READ_FILTER", "U8", out);
@@ -220,27 +239,21 @@ static void processCursors(VCursor *const out, VCursor const *const in, bool con
     openCursor(in, "input");    
     openCursor(out, "output");
     
-    count = rowCount(in, &first, cid_qual);
+    count = rowCount(in, &first, cid.qual);
     assert(first == 1);
     pLogMsg(klogInfo, "progress: about to process $(rows) rows", "rows=%lu", count);
 
     /* MARK: Main loop over the input */
     for (r = 0; r < count; ++r) {
         int64_t const row = 1 + r;
-        CellData const readfilter = cellData("READ_FILTER", cid_read_filter, row, in);
-        CellData const readstart  = cellData("READ_START" , cid_readstart  , row, in);
-        CellData const readtype   = cellData("READ_TYPE"  , cid_read_type  , row, in);
-        CellData const readlen    = cellData("READ_LEN"   , cid_readlen    , row, in);
-        CellData const quality    = cellData("QUALITY"    , cid_qual       , row, in);
+        CellData const readfilter = computeRow(&out_filter, &out_filter_count, 0, &disposition, &cid, row, in);
 #if 0
         if ((row & 0xFFFF) == 0) {
             pLogMsg(klogInfo, "progress: $(row) rows", "row=%li", row);
         }
 #endif
-        out_filter = growFilterBuffer(out_filter, &out_filter_count, readfilter.count);
-        computeReadFilter(out_filter, &readfilter, &readtype, &readstart, &readlen, &quality, row);
         if (haveCache && didReadFilterChange(readfilter.count, out_filter, readfilter.data)) {
-            CellData const pridData = cellData("PRIMARY_ALIGNMENT_ID", cid_pr_id, row, in);
+            CellData const pridData = cellData("PRIMARY_ALIGNMENT_ID", cid.pr_id, row, in);
             int64_t const *prid = pridData.data;
             size_t i;
             for (i = 0; i < pridData.count; ++i) {
@@ -259,6 +272,215 @@ static void processCursors(VCursor *const out, VCursor const *const in, bool con
     VCursorRelease(in);
 }
 
+/* MARK: Parallel processing
+ * The rows are cut into batches of `batchRows` rows; worker threads, each with
+ * its own input cursor, claim the batches in order and compute their filters,
+ * the main thread writes them out in order. Batch k lives in slot k % slots,
+ * so at most `slots` batches are in memory at any time.
+ */
+#define ROWS_PER_BATCH (64 * 1024) /* default batch size */
+#define MAX_THREADS 64
+
+typedef struct Batch {
+    uint32_t *reads;        /* number of reads of each row */
+    uint8_t *filter;        /* new READ_FILTER of all rows, one after another */
+    size_t filterMax;
+    int64_t *changed;       /* PRIMARY_ALIGNMENT row ids to invalidate */
+    size_t changedCount;
+    size_t changedMax;
+    Dispositions counts;
+    bool ready;
+} Batch;
+
+typedef struct Pipeline {
+    KLock *lock;
+    KCondition *cond;       /* signals a batch became ready or a slot became free */
+    Batch *slot;
+    unsigned slots;
+    uint64_t rows;
+    uint64_t batchRows;
+    uint64_t batches;
+    uint64_t next;          /* next batch to be claimed by a worker */
+    uint64_t written;       /* number of batches written */
+    bool haveCache;
+} Pipeline;
+
+typedef struct Worker {
+    Pipeline *pipeline;
+    VCursor const *in;
+    InputColumns cid;
+    KThread *thread;
+} Worker;
+
+static void recordChanged(Batch *const batch, CellData const *const pridData)
+{
+    size_t const needed = batch->changedCount + pridData->count;
+    if (batch->changedMax < needed) {
+        size_t const want = needed < 2 * batch->changedMax ? 2 * batch->changedMax : needed;
+        int64_t *const temp = realloc(batch->changed, want * sizeof(temp[0]));
+        if (temp == NULL)
+            OUT_OF_MEMORY();
+        batch->changed = temp;
+        batch->changedMax = want;
+    }
+    memmove(batch->changed + batch->changedCount, pridData->data, pridData->count * sizeof(batch->changed[0]));
+    batch->changedCount = needed;
+}
+
+static void computeBatch(Batch *const batch, int64_t const first, uint32_t const rows, Worker const *const worker)
+{
+    bool const haveCache = worker->pipeline->haveCache;
+    size_t used = 0;
+    uint32_t r;
+
+    memset(&batch->counts, 0, sizeof(batch->counts));
+    batch->changedCount = 0;
+    for (r = 0; r < rows; ++r) {
+        int64_t const row = first + r;
+        CellData const readfilter = computeRow(&batch->filter, &batch->filterMax, used, &batch->counts, &worker->cid, row, worker->in);
+
+        if (haveCache && didReadFilterChange(readfilter.count, batch->filter + used, readfilter.data)) {
+            CellData const pridData = cellData("PRIMARY_ALIGNMENT_ID", worker->cid.pr_id, row, worker->in);
+            recordChanged(batch, &pridData);
+        }
+        batch->reads[r] = readfilter.count;
+        used += readfilter.count;
+    }
+}
+
+static rc_t CC processBatches(KThread const *self, void *data)
+{
+    Worker *const worker = data;
+    Pipeline *const pl = worker->pipeline;
+
+    for ( ; ; ) {
+        uint64_t k;
+        Batch *batch;
+
+        acquireLock(pl->lock);
+        while (pl->next < pl->batches && pl->next >= pl->written + pl->slots)
+            waitCondition(pl->cond, pl->lock);
+        k = pl->next;
+        if (k < pl->batches)
+            ++pl->next;
+        unlockLock(pl->lock);
+        if (k >= pl->batches)
+            return 0;
+
+        batch = &pl->slot[k % pl->slots];
+        {
+            uint64_t const first = k * pl->batchRows;
+            uint64_t const rows = pl->rows - first < pl->batchRows ? pl->rows - first : pl->batchRows;
+            computeBatch(batch, 1 + first, (uint32_t)rows, worker);
+        }
+
+        acquireLock(pl->lock);
+        batch->ready = true;
+        broadcastCondition(pl->cond);
+        unlockLock(pl->lock);
+    }
+}
+
+static void writeBatch(Batch const *const batch, int64_t const first, uint32_t const rows, uint32_t const cid, VCursor *const out)
+{
+    uint8_t const *filter = batch->filter;
+    uint32_t r;
+    size_t i;
+
+    for (r = 0; r < rows; ++r) {
+        int64_t const row = first + r;
+
+        openRow(row, out);
+        writeRow(row, batch->reads[r], filter, cid, out);
+        commitRow(row, out);
+        closeRow(row, out);
+        filter += batch->reads[r];
+    }
+    for (i = 0; i < batch->changedCount; ++i) {
+        invalidateRow(batch->changed[i]);
+    }
+}
+
+static void processCursorsParallel(VCursor *const out, unsigned const threads, uint32_t const batchRows, VCursor const **const in, bool const haveCache)
+{
+    uint32_t const cid_rd_filter = addColumn("READ_FILTER", "U8", out);
+    Worker *const worker = calloc(threads, sizeof(worker[0]));
+    Pipeline pl;
+    int64_t first = 0;
+    uint64_t k;
+    unsigned i;
+
+    if (worker == NULL)
+        OUT_OF_MEMORY();
+    memset(&pl, 0, sizeof(pl));
+    for (i = 0; i < threads; ++i) {
+        worker[i].pipeline = &pl;
+        worker[i].in = in[i];
+        worker[i].cid = addInputColumns(in[i], haveCache);
+        openCursor(in[i], "input");
+    }
+    openCursor(out, "output");
+
+    pl.rows = rowCount(in[0], &first, worker[0].cid.qual);
+    assert(first == 1);
+    pl.batchRows = batchRows;
+    pl.batches = (pl.rows + batchRows - 1) / batchRows;
+    pl.slots = 2 * threads;
+    pl.haveCache = haveCache;
+    pl.lock = makeLock();
+    pl.cond = makeCondition();
+    pl.slot = calloc(pl.slots, sizeof(pl.slot[0]));
+    if (pl.slot == NULL)
+        OUT_OF_MEMORY();
+    for (i = 0; i < pl.slots; ++i) {
+        pl.slot[i].reads = malloc(batchRows * sizeof(pl.slot[i].reads[0]));
+        if (pl.slot[i].reads == NULL)
+            OUT_OF_MEMORY();
+    }
+    pLogMsg(klogInfo, "progress: about to process $(rows) rows using $(threads) threads", "rows=%lu,threads=%u", pl.rows, threads);
+
+    for (i = 0; i < threads; ++i)
+        worker[i].thread = startThread(processBatches, &worker[i]);
+
+    /* MARK: Main loop over the batches, in order */
+    for (k = 0; k < pl.batches; ++k) {
+        Batch *const batch = &pl.slot[k % pl.slots];
+        uint64_t const start = k * batchRows;
+        uint64_t const rows = pl.rows - start < batchRows ? pl.rows - start : batchRows;
+
+        acquireLock(pl.lock);
+        while (!batch->ready)
+            waitCondition(pl.cond, pl.lock);
+        unlockLock(pl.lock);
+
+        writeBatch(batch, 1 + start, (uint32_t)rows, cid_rd_filter, out);
+        addCounts(&disposition, &batch->counts);
+
+        acquireLock(pl.lock);
+        batch->ready = false;
+        ++pl.written;
+        broadcastCondition(pl.cond);
+        unlockLock(pl.lock);
+    }
+    for (i = 0; i < threads; ++i) {
+        joinThread(worker[i].thread);
+        VCursorRelease(worker[i].in);
+    }
+    LogMsg(klogInfo, "progress: done");
+    commitCursor(out);
+    VCursorRelease(out);
+
+    for (i = 0; i < pl.slots; ++i) {
+        free(pl.slot[i].reads);
+        free(pl.slot[i].filter);
+        free(pl.slot[i].changed);
+    }
+    free(pl.slot);
+    KConditionRelease(pl.cond);
+    KLockRelease(pl.lock);
+    free(worker);
+}
+
 static void copyColumn(char const *const column, char const *const table, char const *const source, char const *const dest, VDBManager *const mgr)
 {
     VTable *tbl = table ? openUpdateDb(dest, table, mgr) : openUpdateTbl(dest, mgr);
@@ -305,17 +527,17 @@ static void saveCounts(char const *const table, char const *const dest, VDBManag
     /* write new STATS/QUALITY */
     {
         KMDataNode *const node = openChildNodeUpdate(stats, "QUALITY");
-        writeChildNode(node, "PHRED_3", sizeof(dispositionBaseCount[1]), &dispositionBaseCount[1]);
-        writeChildNode(node, "PHRED_30", sizeof(dispositionBaseCount[0]), &dispositionBaseCount[0]);
+        writeChildNode(node, "PHRED_3", sizeof(disposition.baseCount[1]), &disposition.baseCount[1]);
+        writeChildNode(node, "PHRED_30", sizeof(disposition.baseCount[0]), &disposition.baseCount[0]);
         KMDataNodeRelease(node);
     }
     /* record stats about the other changes made */
     {
         KMDataNode *node = openNodeUpdate(tbl, "READ_FILTER_CHANGES");
-        writeChildNode(node, "FILTERED_READS", sizeof(dispositionCount[1]), &dispositionCount[1]);
+        writeChildNode(node, "FILTERED_READS", sizeof(disposition.count[1]), &disposition.count[1]);
 #define writeCounts(NAME, N) \
-    writeChildNode(node, NAME "_BASES", sizeof(dispositionBaseCount[N]), &dispositionBaseCount[N]); \
-    writeChildNode(node, NAME "_READS", sizeof(dispositionCount[N]), &dispositionCount[N]);
+    writeChildNode(node, NAME "_BASES", sizeof(disposition.baseCount[N]), &disposition.baseCount[N]); \
+    writeChildNode(node, NAME "_READS", sizeof(disposition.count[N]), &disposition.count[N]);
 
         writeCounts("ORIGINAL_FILTERED", 2);
         writeCounts("TOTAL_LOW_QUALITY", 3);
@@ -561,6 +783,8 @@ static void updateCache(char const *const cachePath, char const *const inPath, V
 }
 
 static char const *temporaryDirectory(Args *const args);
+static unsigned threadCount(Args *const args);
+static uint32_t batchSize(Args *const args);
 static char const *absolutePath(char const *const path, char const *const wd);
 
 /* MARK: the main action starts here */
@@ -572,6 +796,8 @@ void main_1(int argc, char *argv[])
         char const *const input = getParameter(args, wd);
         char const *const cachePath = absolutePath(getOptArgValue(OPT_CACHE, args), wd);
         bool const isActiveCache = checkForActiveCache(cachePath, input);
+        unsigned const threads = threadCount(args);
+        uint32_t const batchRows = batchSize(args);
         char const *const tempDir = temporaryDirectory(args); // also cd's to temp dir
         VDBManager *const mgr = manager();
         VSchema *const schema = makeSchema(mgr); // this schema will get a copy of the input's schema
@@ -583,7 +809,7 @@ void main_1(int argc, char *argv[])
         if (isActiveCache) {
             pLogMsg(klogWarn, "vdbcache should NOT be named $(inpath).vdbcache; rename it or put it in a different directory!!!", "inpath=%s", input);
         }
-        processTables(out, in, cachePath != NULL);
+        processTables(out, in, cachePath != NULL, threads, batchRows);
         copyColumn("RD_FILTER", noDb ? NULL : "SEQUENCE", TEMP_MAIN_OBJECT_NAME, input, mgr);
         saveCounts(noDb ? NULL : "SEQUENCE", input, mgr);
         if (cachePath) {
@@ -607,10 +833,20 @@ void main_1(int argc, char *argv[])
     exit(EX_TEMPFAIL);
 }
 
-static void processTables(VTable *const output, VTable const *const input, bool const haveCache)
+static VCursor const *createInputCursor(VTable const *const input)
 {
-    VCursor *out = NULL;
     VCursor const *in = NULL;
+    rc_t const rc = VTableCreateCursorRead(input, &in);
+    if (rc == 0)
+        return in;
+
+    LogErr(klogFatal, rc, "Failed to create input cursor!");
+    exit(EX_NOINPUT);
+}
+
+static void processTables(VTable *const output, VTable const *const input, bool const haveCache, unsigned const threads, uint32_t const batchRows)
+{
+    VCursor *out = NULL;
     {
         rc_t const rc = VTableCreateCursorWrite(output, &out, kcmInsert);
         if (rc != 0) {
@@ -618,15 +854,20 @@ static void processTables(VTable *const output, VTable const *const input, bool
             exit(EX_CANTCREAT);
         }
     }
-    {
-        rc_t const rc = VTableCreateCursorRead(input, &in);
-        if (rc != 0) {
-            LogErr(klogFatal, rc, "Failed to create input cursor!");
-            exit(EX_NOINPUT);
-        }
+    if (threads > 1) {
+        VCursor const *in[MAX_THREADS];
+        unsigned i;
+
+        for (i = 0; i < threads; ++i)
+            in[i] = createInputCursor(input);
+        VTableRelease(input);
+        processCursorsParallel(out, threads, batchRows, in, haveCache);
+    }
+    else {
+        VCursor const *const in = createInputCursor(input);
+        VTableRelease(input);
+        processCursors(out, in, haveCache);
     }
-    VTableRelease(input);
-    processCursors(out, in, haveCache);
     VTableRelease(output);
 }
 
@@ -676,19 +917,6 @@ static VTable *createOutput(  Args *const args
     return out;
 }
 
-static uint8_t *growFilterBuffer(uint8_t *out_filter, size_t *const out_filter_count, size_t needed)
-{
-    if (*out_filter_count < needed) {
-        free(out_filter);
-        *out_filter_count = needed;
-        pLogMsg(klogInfo, "increasing max read count to $(max)", "max=%zu", needed);
-        out_filter = malloc(needed * sizeof(out_filter[0]));
-        if (out_filter == NULL)
-            OUT_OF_MEMORY();
-    }
-    return out_filter;
-}
-
 static void test(void)
 {
     uint8_t qual[30];
@@ -746,11 +974,15 @@ static void test(void)
 
 static char const *temp_help[] = { "temp directory to use for scratch space, default: $TMPDIR or $TEMPDIR or $TEMP or $TMP or /tmp", NULL };
 static char const *vdbcache_help[] = { "location of .vdbcache to update", NULL };
+static char const *threads_help[] = { "number of threads computing the filter, default: 1", NULL };
+static char const *batch_help[] = { "rows per batch with --threads, default: 65536", NULL };
 
 /* MARK: Options array */
 static OptDef Options [] = {
     { "temp", "t", NULL, temp_help, 1, true, false },
-    { "vdbcache", "", NULL, vdbcache_help, 1, true, false }
+    { "vdbcache", "", NULL, vdbcache_help, 1, true, false },
+    { "threads", "", NULL, threads_help, 1, true, false },
+    { "batch-rows", "", NULL, batch_help, 1, true, false }
 };
 
 /* MARK: Mostly boilerplate from here */
@@ -796,6 +1028,8 @@ rc_t CC Usage ( const Args *args )
     KOutMsg ("Options:\n");
     HelpOptionLine(Options[0].aliases, Options[0].name, "path", Options[0].help);
     HelpOptionLine(Options[1].aliases, Options[1].name, "path", Options[1].help);
+    HelpOptionLine(Options[2].aliases, Options[2].name, "count", Options[2].help);
+    HelpOptionLine(Options[3].aliases, Options[3].name, "rows", Options[3].help);
 
     KOutMsg ("Common options:\n");
     HelpOptionsStandard ();
@@ -844,6 +1078,32 @@ static char const *getOptArgValue(int opt, Args *const args)
     return NULL;
 }
 
+static unsigned threadCount(Args *const args)
+{
+    char const *const value = getOptArgValue(OPT_THREADS, args);
+    if (value) {
+        char *endp = NULL;
+        unsigned long const count = strtoul(value, &endp, 10);
+        if (endp != value && *endp == '\0' && count > 0)
+            return count < MAX_THREADS ? (unsigned)count : MAX_THREADS;
+        pLogMsg(klogWarn, "invalid thread count '$(value)', using 1", "value=%s", value);
+    }
+    return 1;
+}
+
+static uint32_t batchSize(Args *const args)
+{
+    char const *const value = getOptArgValue(OPT_BATCH, args);
+    if (value) {
+        char *endp = NULL;
+        unsigned long const count = strtoul(value, &endp, 10);
+        if (endp != value && *endp == '\0' && count > 0 && count <= UINT32_MAX)
+            return (uint32_t)count;
+        pLogMsg(klogWarn, "invalid batch size '$(value)', using $(default)", "value=%s,default=%u", value, ROWS_PER_BATCH);
+    }
+    return ROWS_PER_BATCH;
+}
+
 static char const *absolutePath(char const *const path, char const *const wd)
 {
     if (path == NULL) return NULL;
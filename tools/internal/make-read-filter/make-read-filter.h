@@ -40,6 +40,9 @@
 #include <klib/rc.h>
 #include <klib/data-buffer.h>
 #include <klib/printf.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
 #include <sra/sradb.h>
 
 #include <stdarg.h>
@@ -65,7 +68,6 @@ static uint32_t addColumn( char const *const name
                          , char const *const type
                          , VCursor const *const curs);
 static void openCursor(VCursor const *const curs, char const *const name);
-static uint8_t *growFilterBuffer(uint8_t *const out_filter, size_t *const out_filter_count, size_t needed);
 static void openRow(int64_t const row, VCursor const *const out);
 static void writeRow(int64_t const row
                     , uint32_t const reads
@@ -94,7 +96,7 @@ static VTable const *dbOpenTable(char const *const name
 static void tblSchemaInfo(VTable const *tbl, char const **name, VSchema *schema);
 static void dbSchemaInfo(VDatabase const *db, char const **name, VSchema *schema);
 static VTable const *openInput(char const *input, VDBManager const *mgr, bool *noDb, char const **schemaType, VSchema *schema);
-static void processTables(VTable *const output, VTable const *const input, bool const haveCache);
+static void processTables(VTable *const output, VTable const *const input, bool const haveCache, unsigned const threads, uint32_t const batchRows);
 static VTable *createOutput(Args *const args, VDBManager *const mgr, bool noDb, char const *schemaType, VSchema const *schema);
 static VSchema *makeSchema(VDBManager *mgr);
 
@@ -397,6 +399,86 @@ static void writeCell(  int64_t const row
     }
 }
 
+static KLock *makeLock()
+{
+    KLock *lock = NULL;
+    rc_t const rc = KLockMake(&lock);
+    if (rc == 0)
+        return lock;
+
+    LogErr(klogFatal, rc, "Failed to make a lock");
+    exit(EX_OSERR);
+}
+
+static KCondition *makeCondition()
+{
+    KCondition *cond = NULL;
+    rc_t const rc = KConditionMake(&cond);
+    if (rc == 0)
+        return cond;
+
+    LogErr(klogFatal, rc, "Failed to make a condition");
+    exit(EX_OSERR);
+}
+
+static void acquireLock(KLock *const lock)
+{
+    rc_t const rc = KLockAcquire(lock);
+    if (rc) {
+        LogErr(klogFatal, rc, "Failed to acquire lock");
+        exit(EX_SOFTWARE);
+    }
+}
+
+static void unlockLock(KLock *const lock)
+{
+    rc_t const rc = KLockUnlock(lock);
+    if (rc) {
+        LogErr(klogFatal, rc, "Failed to unlock lock");
+        exit(EX_SOFTWARE);
+    }
+}
+
+static void waitCondition(KCondition *const cond, KLock *const lock)
+{
+    rc_t const rc = KConditionWait(cond, lock);
+    if (rc) {
+        LogErr(klogFatal, rc, "Failed to wait on condition");
+        exit(EX_SOFTWARE);
+    }
+}
+
+static void broadcastCondition(KCondition *const cond)
+{
+    rc_t const rc = KConditionBroadcast(cond);
+    if (rc) {
+        LogErr(klogFatal, rc, "Failed to signal condition");
+        exit(EX_SOFTWARE);
+    }
+}
+
+static KThread *startThread(rc_t (CC *const run)(KThread const *self, void *data), void *const data)
+{
+    KThread *thread = NULL;
+    rc_t const rc = KThreadMake(&thread, run, data);
+    if (rc == 0)
+        return thread;
+
+    LogErr(klogFatal, rc, "Failed to start a thread");
+    exit(EX_OSERR);
+}
+
+static void joinThread(KThread *const thread)
+{
+    rc_t status = 0;
+    rc_t const rc = KThreadWait(thread, &status);
+    KThreadRelease(thread);
+    if (rc || status) {
+        LogErr(klogFatal, rc ? rc : status, "Worker thread failed");
+        exit(EX_SOFTWARE);
+    }
+}
+
 static KDirectory *rootDir()
 {
     KDirectory *ndir = NULL;
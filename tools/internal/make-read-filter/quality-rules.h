@@ -0,0 +1,156 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* The filtering rules, shared by make-read-filter and its benchmark.
+ * Everything is static inline; there is no library to link.
+ */
+
+#ifndef _h_make_read_filter_quality_rules_
+#define _h_make_read_filter_quality_rules_
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define QUALITY_RULES_SSE2 1
+#else
+#define QUALITY_RULES_SSE2 0
+#endif
+
+/* NOTE: Rules for filtering
+    Quote:
+        Reads that have more than half of quality score values <20 will be
+        flagged ‘reject’.
+        Reads that begin or end with a run of more than 10 quality scores <20
+        are also flagged ‘reject’.
+ */
+typedef enum FilterReason {
+    keep = 0,
+    low_quality_count = 1,
+    low_quality_back = 2,
+    low_quality_front = 4,
+    original_filter = 8,
+} FilterReason;
+
+#define LOW_QUALITY 20  /* quality values below this are low */
+#define LOW_QUALITY_RUN 10 /* a run of low quality longer than this rejects the read */
+
+/** @brief What the rules need to know about a read's quality
+ **/
+typedef struct QualityScan {
+    uint32_t under;     /* number of values < LOW_QUALITY */
+    uint32_t firstgood; /* index of first value >= LOW_QUALITY, len if none */
+    uint32_t lastgood;  /* index of last value >= LOW_QUALITY, len if none */
+} QualityScan;
+
+static inline void scanQualityScalar(QualityScan *const result, uint32_t const len, uint8_t const *const qual)
+{
+    uint32_t i;
+
+    result->under = 0;
+    result->firstgood = len;
+    result->lastgood = len;
+    for (i = 0; i < len; ++i) {
+        if (qual[i] < LOW_QUALITY)
+            ++result->under;
+        else {
+            if (result->firstgood == len)
+                result->firstgood = i;
+            result->lastgood = i;
+        }
+    }
+}
+
+#if QUALITY_RULES_SSE2
+/** @brief 16 values at a time: one byte compare, one movemask;
+ * the count is a popcount of the mask, the runs are its trailing/leading bits
+ **/
+static inline void scanQualitySSE2(QualityScan *const result, uint32_t const len, uint8_t const *const qual)
+{
+    __m128i const limit = _mm_set1_epi8(LOW_QUALITY - 1);
+    uint32_t i;
+
+    result->under = 0;
+    result->firstgood = len;
+    result->lastgood = len;
+    for (i = 0; i + 16 <= len; i += 16) {
+        __m128i const q = _mm_loadu_si128((__m128i const *)(qual + i));
+        /* unsigned q <= 19: max(q, 19) == 19 */
+        uint32_t const low = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(q, limit), limit));
+        uint32_t const good = ~low & 0xFFFF;
+
+        result->under += (uint32_t)__builtin_popcount(low);
+        if (good) {
+            if (result->firstgood == len)
+                result->firstgood = i + (uint32_t)__builtin_ctz(good);
+            result->lastgood = i + 31 - (uint32_t)__builtin_clz(good);
+        }
+    }
+    for ( ; i < len; ++i) {
+        if (qual[i] < LOW_QUALITY)
+            ++result->under;
+        else {
+            if (result->firstgood == len)
+                result->firstgood = i;
+            result->lastgood = i;
+        }
+    }
+}
+#define scanQuality scanQualitySSE2
+#else
+#define scanQuality scanQualityScalar
+#endif
+
+/** @brief Apply the rules to a scanned read
+ **/
+static inline FilterReason applyRules(uint32_t const len, QualityScan const *const scan)
+{
+    FilterReason reason = keep;
+
+    if (scan->under * 2 > len)
+        reason |= low_quality_count;
+    if (len <= LOW_QUALITY_RUN) /* if length <= 10, then rest of rules can't apply */
+        return reason;
+
+    /* NB. a read without any good value has lastgood == firstgood == len:
+     * the count and front rules fire, the back rule does not */
+    if (scan->lastgood < len - (LOW_QUALITY_RUN + 1))
+        reason |= low_quality_back;
+    if (scan->firstgood > LOW_QUALITY_RUN)
+        reason |= low_quality_front;
+    return reason;
+}
+
+/** @brief Apply the rules to determine if a read should be filtered
+ **/
+static inline FilterReason shouldFilter(uint32_t const len, uint8_t const *const qual)
+{
+    QualityScan scan;
+    scanQuality(&scan, len, qual);
+    return applyRules(len, &scan);
+}
+
+#endif /* _h_make_read_filter_quality_rules_ */
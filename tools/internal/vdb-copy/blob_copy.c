@@ -0,0 +1,214 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "blob_copy.h"
+#include "definitions.h"
+#include "copy_meta.h"
+
+#include <kapp/main.h>      /* for Quitting() */
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/* a growing buffer, big enough for the biggest blob seen so far */
+typedef struct blob_buffer
+{
+    uint8_t * data;
+    size_t size;
+} blob_buffer;
+
+
+static rc_t blob_buffer_resize( blob_buffer * bb, size_t needed )
+{
+    if ( bb->data == NULL || bb->size < needed )
+    {
+        void * tmp = realloc( bb->data, needed );
+        if ( tmp == NULL )
+            return RC( rcExe, rcBlob, rcCopying, rcMemory, rcExhausted );
+        bb->data = tmp;
+        bb->size = needed;
+    }
+    return 0;
+}
+
+
+/* reads the whole blob ( header, page-map and payload ) into the buffer */
+static rc_t blob_copy_read( const KColumnBlob * blob, blob_buffer * bb, size_t * blob_size )
+{
+    size_t num_read, remaining;
+    /* a read with a zero-length buffer tells us the size of the blob */
+    rc_t rc = KColumnBlobRead ( blob, 0, NULL, 0, &num_read, &remaining );
+    DISP_RC( rc, "blob_copy_read:KColumnBlobRead( size ) failed" );
+    if ( rc == 0 )
+    {
+        *blob_size = remaining;
+        rc = blob_buffer_resize( bb, remaining );
+        if ( rc == 0 )
+        {
+            size_t offset = 0;
+            while ( rc == 0 && offset < *blob_size )
+            {
+                rc = KColumnBlobRead ( blob, offset, bb->data + offset,
+                                       *blob_size - offset, &num_read, &remaining );
+                DISP_RC( rc, "blob_copy_read:KColumnBlobRead() failed" );
+                if ( rc == 0 && num_read == 0 )
+                    rc = RC( rcExe, rcBlob, rcReading, rcTransfer, rcIncomplete );
+                offset += num_read;
+            }
+        }
+    }
+    return rc;
+}
+
+
+/* writes the buffer as a new blob into the dst-column */
+static rc_t blob_copy_write( KColumn * dst_col, const blob_buffer * bb, size_t blob_size,
+                             int64_t first, uint32_t count )
+{
+    KColumnBlob * blob;
+    rc_t rc = KColumnCreateBlob ( dst_col, &blob );
+    DISP_RC( rc, "blob_copy_write:KColumnCreateBlob() failed" );
+    if ( rc == 0 )
+    {
+        rc = KColumnBlobAppend ( blob, bb->data, blob_size );
+        DISP_RC( rc, "blob_copy_write:KColumnBlobAppend() failed" );
+        if ( rc == 0 )
+        {
+            rc = KColumnBlobAssignRange ( blob, first, count );
+            DISP_RC( rc, "blob_copy_write:KColumnBlobAssignRange() failed" );
+        }
+        if ( rc == 0 )
+        {
+            rc = KColumnBlobCommit ( blob );
+            DISP_RC( rc, "blob_copy_write:KColumnBlobCommit() failed" );
+        }
+        KColumnBlobRelease ( blob );
+    }
+    return rc;
+}
+
+
+static rc_t blob_copy_all_blobs( const KColumn * src_col, KColumn * dst_col,
+                                 const char * name, blob_copy_stats * stats )
+{
+    int64_t first;
+    uint64_t count;
+    rc_t rc = KColumnIdRange( src_col, &first, &count );
+    DISP_RC( rc, "blob_copy_all_blobs:KColumnIdRange() failed" );
+    if ( rc == 0 && count > 0 )
+    {
+        blob_buffer bb = { NULL, 0 };
+        int64_t id = first;
+        int64_t end = first + count;
+        while ( rc == 0 && id < end )
+        {
+            const KColumnBlob * blob;
+            rc = KColumnOpenBlobRead( src_col, &blob, id );
+            if ( rc != 0 )
+            {
+                /* a sparse column can have gaps between it's blobs */
+                if ( GetRCState( rc ) == rcNotFound )
+                {
+                    rc = 0;
+                    id++;
+                }
+                else
+                {
+                    PLOGERR( klogInt, ( klogInt, rc,
+                             "KColumnOpenBlobRead( col:$(col_name) at row #$(row_nr) ) failed",
+                             "col_name=%s,row_nr=%ld", name, id ) );
+                }
+            }
+            else
+            {
+                int64_t blob_first;
+                uint32_t blob_count;
+                rc = KColumnBlobIdRange( blob, &blob_first, &blob_count );
+                DISP_RC( rc, "blob_copy_all_blobs:KColumnBlobIdRange() failed" );
+                if ( rc == 0 )
+                {
+                    size_t blob_size;
+                    rc = blob_copy_read( blob, &bb, &blob_size );
+                    if ( rc == 0 )
+                        rc = blob_copy_write( dst_col, &bb, blob_size, blob_first, blob_count );
+                    if ( rc == 0 )
+                    {
+                        stats->blobs++;
+                        stats->bytes += blob_size;
+                    }
+                    else
+                    {
+                        PLOGERR( klogInt, ( klogInt, rc,
+                                 "copy of blob( col:$(col_name) rows #$(row_nr).$(row_cnt) ) failed",
+                                 "col_name=%s,row_nr=%ld,row_cnt=%u", name, blob_first, blob_count ) );
+                    }
+                    id = blob_first + blob_count;
+                }
+                KColumnBlobRelease( blob );
+            }
+            if ( rc == 0 )
+                rc = Quitting();    /* to be able to cancel the loop by signal */
+        }
+        if ( bb.data != NULL )
+            free( bb.data );
+    }
+    return rc;
+}
+
+
+rc_t blob_copy_column( const KTable * src, KTable * dst, const char * name,
+                       KCreateMode cmode, KChecksum cs_mode,
+                       const bool show_meta, blob_copy_stats * stats )
+{
+    const KColumn * src_col;
+    rc_t rc;
+
+    if ( src == NULL || dst == NULL || name == NULL || stats == NULL )
+        return RC( rcExe, rcColumn, rcCopying, rcParam, rcNull );
+
+    rc = KTableOpenColumnRead( src, &src_col, "%s", name );
+    DISP_RC( rc, "blob_copy_column:KTableOpenColumnRead() failed" );
+    if ( rc == 0 )
+    {
+        KColumn * dst_col;
+        /* pgsize = 0 : use the default page-size */
+        rc = KTableCreateColumn( dst, &dst_col, cmode, cs_mode, 0, "%s", name );
+        DISP_RC( rc, "blob_copy_column:KTableCreateColumn() failed" );
+        if ( rc == 0 )
+        {
+            rc = blob_copy_all_blobs( src_col, dst_col, name, stats );
+            if ( rc == 0 )
+                rc = copy_column_meta( src_col, dst_col, show_meta );
+            if ( rc == 0 )
+                stats->columns++;
+            KColumnRelease( dst_col );
+        }
+        KColumnRelease( src_col );
+    }
+    return rc;
+}
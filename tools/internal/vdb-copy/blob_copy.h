@@ -0,0 +1,73 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_blob_copy_
+#define _h_blob_copy_
+
+#ifndef _h_vdb_copy_includes_
+#include "vdb-copy-includes.h"
+#endif
+
+#ifndef _h_kdb_table_
+#include <kdb/table.h>
+#endif
+
+#ifndef _h_kdb_column_
+#include <kdb/column.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+counters of a physical ( blob-level ) copy
+********************************************************************/
+typedef struct blob_copy_stats
+{
+    uint64_t columns;
+    uint64_t blobs;
+    uint64_t bytes;
+} blob_copy_stats;
+
+
+/*
+ * copies every blob of the physical column 'name' from the src-table
+ * into a new physical column of the same name in the dst-table
+ * the blobs are not decoded: their bytes ( including the page-map
+ * and the blob-header ) are appended as they are, and assigned
+ * to the same row-range as in the source
+ * the column-metadata is copied too
+*/
+rc_t blob_copy_column( const KTable * src, KTable * dst, const char * name,
+                       KCreateMode cmode, KChecksum cs_mode,
+                       const bool show_meta, blob_copy_stats * stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
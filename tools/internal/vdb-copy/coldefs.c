@@ -98,6 +98,7 @@ rc_t col_defs_destroy( col_defs* defs )
     if ( defs == NULL )
         return RC( rcVDB, rcNoTarg, rcDestroying, rcSelf, rcNull );
     VectorWhack( &(defs->cols), col_defs_destroy_node, NULL );
+    free( defs->redacted_ids );
     free( defs );
     return 0;
 }
@@ -89,6 +89,10 @@ typedef struct col_defs
 {
     Vector cols;
     int32_t filter_idx; /* index of READ_FILTER-column (-1 not in set...)*/
+    bool filter_scanned;    /* the blob-passthrough has read the filter-column,
+                               the row-loop does not need to read it again */
+    int64_t * redacted_ids; /* sorted row-id's of the redacted rows found by it */
+    uint64_t redacted_count;
 } col_defs;
 typedef col_defs* p_col_defs;
 
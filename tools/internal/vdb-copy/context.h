@@ -71,6 +71,7 @@ extern "C" {
 #define OPTION_FORCE             "force"
 #define OPTION_UNLOCK            "unlock"
 #define OPTION_BLOB_CHECKSUM     "blob_checksum"
+#define OPTION_PASSTHROUGH       "passthrough"
 
 
 #define ALIAS_TABLE             "T"
@@ -96,6 +97,7 @@ extern "C" {
 #define ALIAS_FORCE             "f"
 #define ALIAS_UNLOCK            "u"
 #define ALIAS_BLOB_CHECKSUM     "b"
+#define ALIAS_PASSTHROUGH       "P"
 
 
 /* *******************************************************************
@@ -127,6 +129,7 @@ typedef struct context
     uint8_t blob_checksum;
     bool force_kcmInit;
     bool force_unlock;
+    bool blob_passthrough;
 
     /* set by application */
     bool dont_remove_target;
@@ -31,6 +31,7 @@
 #include <klib/time.h>
 #include <kapp/main.h>      /* for KAppVersion()*/
 #include <kdb/meta.h>
+#include <kdb/column.h>
 #include <kdb/namelist.h>
 #include <sysalloc.h>
 #include <stdlib.h>
@@ -516,3 +517,81 @@ rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
     }
     return rc;
 }
+
+
+rc_t copy_table_meta_node ( const VTable *src_table, VTable *dst_table,
+                            const char * node_path, const bool show_meta )
+{
+    const KMetadata *src_meta;
+    rc_t rc;
+
+    if ( src_table == NULL || dst_table == NULL || node_path == NULL )
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+
+    rc = VTableOpenMetadataRead ( src_table, & src_meta );
+    DISP_RC( rc, "copy_table_meta_node:VTableOpenMetadataRead() failed" );
+    if ( rc == 0 )
+    {
+        const KMDataNode *src_root;
+        rc = KMetadataOpenNodeRead ( src_meta, & src_root, NULL );
+        DISP_RC( rc, "copy_table_meta_node:KMetadataOpenNodeRead() failed" );
+        if ( rc == 0 )
+        {
+            KMetadata *dst_meta;
+            rc = VTableOpenMetadataUpdate ( dst_table, & dst_meta );
+            DISP_RC( rc, "copy_table_meta_node:VTableOpenMetadataUpdate() failed" );
+            if ( rc == 0 )
+            {
+                KMDataNode *dst_root;
+                rc = KMetadataOpenNodeUpdate ( dst_meta, & dst_root, NULL );
+                DISP_RC( rc, "copy_table_meta_node:KMetadataOpenNodeUpdate() failed" );
+                if ( rc == 0 )
+                {
+                    rc = copy_metadata_child ( src_root, dst_root, node_path, show_meta );
+                    /* the source does not have to have this node */
+                    if ( GetRCState( rc ) == rcNotFound )
+                        rc = 0;
+                    KMDataNodeRelease ( dst_root );
+                }
+                KMetadataRelease ( dst_meta );
+            }
+            KMDataNodeRelease ( src_root );
+        }
+        KMetadataRelease ( src_meta );
+    }
+    return rc;
+}
+
+
+rc_t copy_column_meta ( const KColumn *src_col, KColumn *dst_col,
+                        const bool show_meta )
+{
+    const KMetadata *src_meta;
+    rc_t rc;
+
+    if ( src_col == NULL || dst_col == NULL )
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+
+    rc = KColumnOpenMetadataRead ( src_col, & src_meta );
+    DISP_RC( rc, "copy_column_meta:KColumnOpenMetadataRead() failed" );
+    if ( rc == 0 )
+    {
+        KMetadata *dst_meta;
+        rc = KColumnOpenMetadataUpdate ( dst_col, & dst_meta );
+        DISP_RC( rc, "copy_column_meta:KColumnOpenMetadataUpdate() failed" );
+        if ( rc == 0 )
+        {
+            if ( show_meta )
+                KOutMsg( "+++copy column metadata\n" );
+
+            rc = copy_stray_metadata ( src_meta, dst_meta, NULL, show_meta );
+
+            if ( show_meta )
+                KOutMsg( "+++end of copy column metadata\n" );
+
+            KMetadataRelease ( dst_meta );
+        }
+        KMetadataRelease ( src_meta );
+    }
+    return rc;
+}
@@ -39,6 +39,21 @@ rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
                           const char * excluded_nodes,
                           const bool show_meta );
 
+/*
+ * copies one node ( and all it's children ) of the table-metadata,
+ * used to bring over nodes which are normally excluded because a
+ * write-cursor would regenerate them ( f.i. STATS )
+*/
+rc_t copy_table_meta_node ( const VTable *src_table, VTable *dst_table,
+                            const char * node_path, const bool show_meta );
+
+/*
+ * copies the metadata of a physical column
+*/
+struct KColumn;
+rc_t copy_column_meta ( const struct KColumn *src_col, struct KColumn *dst_col,
+                        const bool show_meta );
+
 #ifdef __cplusplus
 }
 #endif
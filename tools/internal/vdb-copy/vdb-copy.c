@@ -33,9 +33,11 @@
 #include "copy_meta.h"
 #include "type_matcher.h"
 #include "redactval.h"
+#include "blob_copy.h"
 
 #include <kapp/main.h>
 #include <klib/progressbar.h>
+#include <klib/sort.h>
 #include <sysalloc.h>
 
 /*
@@ -71,6 +73,7 @@ static const char * md5mode_usage[] = { "MD5-mode def.: auto, '1'...forced ON, '
 static const char * blcmode_usage[] = { "Blob-checksum def.: auto, '1'...CRC32, 'M'...MD5, '0'...OFF)", NULL };
 static const char * force_usage[] = { "forces an existing target to be overwritten", NULL };
 static const char * unlock_usage[] = { "forces a locked target to be unlocked", NULL };
+static const char * passthrough_usage[] = { "copy unchanged columns blob by blob without decoding", NULL };
 
 OptDef MyOptions[] =
 {
@@ -96,7 +99,8 @@ OptDef MyOptions[] =
     { OPTION_MD5_MODE, ALIAS_MD5_MODE, NULL, md5mode_usage, 1, true, false },
     { OPTION_BLOB_CHECKSUM, ALIAS_BLOB_CHECKSUM, NULL, blcmode_usage, 1, true, false },
     { OPTION_FORCE, ALIAS_FORCE, NULL, force_usage, 1, false, false },
-    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false }
+    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false },
+    { OPTION_PASSTHROUGH, ALIAS_PASSTHROUGH, NULL, passthrough_usage, 1, false, false }
 };
 
 
@@ -152,6 +156,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( ALIAS_UNLOCK, OPTION_UNLOCK, NULL, unlock_usage );
     HelpOptionLine ( ALIAS_MD5_MODE, OPTION_MD5_MODE, NULL, md5mode_usage );
     HelpOptionLine ( ALIAS_BLOB_CHECKSUM, OPTION_BLOB_CHECKSUM, NULL, blcmode_usage );
+    HelpOptionLine ( ALIAS_PASSTHROUGH, OPTION_PASSTHROUGH, NULL, passthrough_usage );
 
     HelpOptionsStandard ();
 
@@ -365,6 +370,35 @@ static rc_t vdb_copy_read_row_flags( const p_context ctx,
 }
 
 
+/* the filter-flags of a row, taken from the scan of the blob-passthrough
+   if there was one, rejected rows did not make it to this point then */
+static rc_t vdb_copy_row_flags( const p_context ctx,
+                                const VCursor *cursor,
+                                const col_defs *columns,
+                                const uint32_t src_idx,
+                                const int64_t row_id,
+                                bool *pass,
+                                bool *redact )
+{
+    if ( columns->filter_scanned )
+    {
+        uint64_t lo = 0, hi = columns->redacted_count;
+        while ( lo < hi )
+        {
+            uint64_t mid = lo + ( hi - lo ) / 2;
+            if ( columns->redacted_ids[ mid ] < row_id )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if ( !ctx->ignore_redact )
+            *redact = ( lo < columns->redacted_count && columns->redacted_ids[ lo ] == row_id );
+        return 0;
+    }
+    return vdb_copy_read_row_flags( ctx, cursor, src_idx, pass, redact );
+}
+
+
 static rc_t vdb_copy_row_loop( const p_context ctx,
                                const VCursor * src_cursor,
                                VCursor * dst_cursor,
@@ -380,7 +414,8 @@ static rc_t vdb_copy_row_loop( const p_context ctx,
     redact_buffer rbuf;
     struct progressbar * progress = NULL;
 
-    if ( columns->filter_idx != -1 )
+    /* there is nothing to decide if the filter-values are ignored */
+    if ( columns->filter_idx != -1 && !( ctx->ignore_reject && ctx->ignore_redact ) )
         filter_col_def = col_defs_get( columns, columns->filter_idx );
 
     rc = num_gen_iterator_make( ctx->row_generator, &iter );
@@ -419,8 +454,8 @@ static rc_t vdb_copy_row_loop( const p_context ctx,
                     bool redact_flag = false;
 
                     if ( filter_col_def != NULL )
-                        vdb_copy_read_row_flags( ctx, src_cursor,
-                                    filter_col_def->src_idx, &pass_flag, &redact_flag );
+                        vdb_copy_row_flags( ctx, src_cursor, columns, filter_col_def->src_idx,
+                                            row_id, &pass_flag, &redact_flag );
                     if ( pass_flag )
                         rc = vdb_copy_row( src_cursor, dst_cursor,
                                            columns, row_id,
@@ -475,6 +510,287 @@ static rc_t vdb_copy_row_loop( const p_context ctx,
 }
 
 
+/* ----------------------------------------------------------------------------------- */
+static rc_t vdb_copy_add_redacted( col_defs * columns, const int64_t row_id, uint64_t * capacity )
+{
+    if ( columns->redacted_count == *capacity )
+    {
+        uint64_t new_capacity = ( *capacity == 0 ) ? 1024 : *capacity * 2;
+        int64_t * temp = realloc( columns->redacted_ids, new_capacity * sizeof *temp );
+        if ( temp == NULL )
+            return RC( rcExe, rcNoTarg, rcReading, rcMemory, rcExhausted );
+        columns->redacted_ids = temp;
+        *capacity = new_capacity;
+    }
+    columns->redacted_ids[ columns->redacted_count++ ] = row_id;
+    return 0;
+}
+
+
+static int64_t CC vdb_copy_cmp_row_id( const void * a, const void * b, void * data )
+{
+    int64_t ra = *( const int64_t * )a;
+    int64_t rb = *( const int64_t * )b;
+    return ( ra < rb ) ? -1 : ( ra > rb );
+}
+
+
+/* scans the filter-column of the requested rows, counts rejected and redacted rows,
+   the row-id's of the redacted rows are kept in columns for the row-loop,
+   the scan stops at the first rejected row if rejected rows are not ignored */
+static rc_t vdb_copy_scan_filter( const p_context ctx,
+                                  const VCursor * src_cursor,
+                                  col_defs * columns,
+                                  const uint32_t src_idx,
+                                  uint64_t * rejected,
+                                  uint64_t * redacted )
+{
+    const struct num_gen_iter * iter;
+    int64_t row_id;
+    uint64_t capacity = 0;
+    rc_t rc = num_gen_iterator_make( ctx->row_generator, &iter );
+    DISP_RC( rc, "vdb_copy_scan_filter:num_gen_iterator_make() failed" );
+    if ( rc != 0 ) return rc;
+
+    *rejected = 0;
+    *redacted = 0;
+    columns->redacted_count = 0;
+    while ( rc == 0 && num_gen_iterator_next( iter, &row_id, &rc ) )
+    {
+        if ( rc == 0 )
+            rc = Quitting();    /* to be able to cancel the loop by signal */
+        if ( rc == 0 )
+        {
+            uint64_t filter;
+            rc = helper_read_vdb_int( src_cursor, row_id, src_idx, &filter );
+            if ( rc == 0 )
+            {
+                switch( filter )
+                {
+                case SRA_READ_FILTER_REJECT   : ( *rejected )++; break;
+                case SRA_READ_FILTER_REDACTED : ( *redacted )++;
+                                                rc = vdb_copy_add_redacted( columns, row_id, &capacity );
+                                                break;
+                }
+                if ( *rejected > 0 && !ctx->ignore_reject )
+                    break;
+            }
+        }
+    }
+
+    /* set rc to zero for num_gen_iterator_next() reached last id */
+    if ( GetRCModule( rc ) == rcVDB && 
+         GetRCTarget( rc ) == rcNoTarg && 
+         GetRCContext( rc ) == rcReading &&
+         GetRCObject( rc ) == rcId &&
+         GetRCState( rc ) == rcInvalid )
+        rc = 0;
+
+    num_gen_iterator_destroy( iter );
+    return rc;
+}
+
+
+/* the blob-passthrough writes the physical columns of the src-table unchanged
+   into the dst-table, that is only possible if:
+   - the dst-table uses the same schema ( no legacy-conversion )
+   - all columns and all rows are copied ( no column-selection, no row-range )
+   - no column changes it's type on the way
+*/
+static bool vdb_copy_passthrough_possible( const p_context ctx,
+                                           const VCursor * src_cursor,
+                                           col_defs * columns,
+                                           const bool is_legacy )
+{
+    int64_t first;
+    uint64_t count;
+    uint32_t idx, len;
+    rc_t rc;
+
+    if ( !ctx->blob_passthrough )
+        return false;
+
+    if ( is_legacy )
+    {
+        LOGMSG( klogInfo, "blob-passthrough not possible: legacy-schema in use" );
+        return false;
+    }
+
+    if ( ( ctx->columns != NULL && nlt_strcmp( ctx->columns, "*" ) != 0 ) ||
+         ctx->excluded_columns != NULL )
+    {
+        LOGMSG( klogInfo, "blob-passthrough not possible: columns selected" );
+        return false;
+    }
+
+    rc = VCursorIdRange( src_cursor, 0, &first, &count );
+    DISP_RC( rc, "vdb_copy_passthrough_possible:VCursorIdRange() failed" );
+    if ( rc == 0 )
+    {
+        const struct num_gen_iter * iter;
+        rc = num_gen_iterator_make( ctx->row_generator, &iter );
+        DISP_RC( rc, "vdb_copy_passthrough_possible:num_gen_iterator_make() failed" );
+        if ( rc == 0 )
+        {
+            uint64_t requested;
+            rc = num_gen_iterator_count( iter, &requested );
+            DISP_RC( rc, "vdb_copy_passthrough_possible:num_gen_iterator_count() failed" );
+            if ( rc == 0 && requested != count )
+            {
+                LOGMSG( klogInfo, "blob-passthrough not possible: row-range selected" );
+                rc = RC( rcExe, rcNoTarg, rcCopying, rcRange, rcInvalid );
+            }
+            num_gen_iterator_destroy( iter );
+        }
+    }
+    if ( rc != 0 )
+        return false;
+
+    len = VectorLength( &(columns->cols) );
+    for ( idx = 0; idx < len; ++idx )
+    {
+        p_col_def col = (p_col_def) VectorGet ( &(columns->cols), idx );
+        if ( col != NULL && col->to_copy )
+        {
+            if ( nlt_strcmp( col->src_cast, col->dst_cast ) != 0 )
+            {
+                PLOGMSG( klogInfo, ( klogInfo,
+                         "blob-passthrough not possible: type-change for $(col_name)",
+                         "col_name=%s", col->name ));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+static rc_t vdb_copy_passthrough_columns( const p_context ctx,
+                                          const KTable * src_ktab,
+                                          KTable * dst_ktab,
+                                          KCreateMode cmode,
+                                          blob_copy_stats * stats )
+{
+    KChecksum cs_mode = helper_assemble_ChecksumMode( ctx->blob_checksum );
+    KNamelist * names;
+    rc_t rc = KTableListCol( src_ktab, &names );
+    DISP_RC( rc, "vdb_copy_passthrough_columns:KTableListCol() failed" );
+    if ( rc == 0 )
+    {
+        uint32_t idx, count;
+        rc = KNamelistCount( names, &count );
+        DISP_RC( rc, "vdb_copy_passthrough_columns:KNamelistCount() failed" );
+        for ( idx = 0; idx < count && rc == 0; ++idx )
+        {
+            const char * name;
+            rc = KNamelistGet( names, idx, &name );
+            DISP_RC( rc, "vdb_copy_passthrough_columns:KNamelistGet() failed" );
+            if ( rc == 0 )
+            {
+                if ( ctx->show_progress )
+                    KOutMsg( "passthrough of >%s<\n", name );
+                rc = blob_copy_column( src_ktab, dst_ktab, name, cmode, cs_mode,
+                                       ctx->show_meta, stats );
+            }
+        }
+        KNamelistRelease( names );
+    }
+    return rc;
+}
+
+
+/* copies all physical columns of the table blob by blob, if that is possible
+   the columns are removed from the write-cursor ( to_copy = false ) and
+   the cursor-based row-loop can be skipped ( *all_copied = true ) */
+static rc_t vdb_copy_passthrough( const p_context ctx,
+                                  const VTable * src_table,
+                                  VTable * dst_table,
+                                  const VCursor * src_cursor,
+                                  col_defs * columns,
+                                  KCreateMode cmode,
+                                  const bool is_legacy,
+                                  bool * all_copied )
+{
+    rc_t rc = 0;
+    const KTable * src_ktab;
+    uint32_t idx, len;
+
+    *all_copied = false;
+    if ( !vdb_copy_passthrough_possible( ctx, src_cursor, columns, is_legacy ) )
+        return 0;
+
+    if ( columns->filter_idx != -1 && !( ctx->ignore_reject && ctx->ignore_redact ) )
+    {
+        p_col_def filter_col_def = col_defs_get( columns, columns->filter_idx );
+        uint64_t rejected, redacted;
+        rc = vdb_copy_scan_filter( ctx, src_cursor, columns, filter_col_def->src_idx,
+                                   &rejected, &redacted );
+        if ( rc != 0 ) return rc;
+
+        if ( rejected > 0 && !ctx->ignore_reject )
+        {
+            /* dropping rows shifts the row-id's: blobs cannot be used as they are */
+            LOGMSG( klogInfo, "blob-passthrough not possible: rows are rejected" );
+            return 0;
+        }
+
+        /* the row-id's come sorted for the whole table, but the row-generator does not promise that */
+        ksort( columns->redacted_ids, columns->redacted_count, sizeof columns->redacted_ids[ 0 ],
+               vdb_copy_cmp_row_id, NULL );
+        columns->filter_scanned = true;
+
+        if ( redacted > 0 && !ctx->ignore_redact )
+        {
+            /* the data of a redacted column can be stored in other physical columns
+               ( ALTREAD ... ) and in metadata: only the row-loop redacts all of it */
+            LOGMSG( klogInfo, "blob-passthrough not possible: rows are redacted" );
+            return 0;
+        }
+    }
+
+    rc = VTableOpenKTableRead( src_table, &src_ktab );
+    DISP_RC( rc, "vdb_copy_passthrough:VTableOpenKTableRead() failed" );
+    if ( rc != 0 ) return rc;
+
+    {
+        KTable * dst_ktab;
+        rc = VTableOpenKTableUpdate( dst_table, &dst_ktab );
+        DISP_RC( rc, "vdb_copy_passthrough:VTableOpenKTableUpdate() failed" );
+        if ( rc == 0 )
+        {
+            blob_copy_stats stats;
+            memset( &stats, 0, sizeof stats );
+            rc = vdb_copy_passthrough_columns( ctx, src_ktab, dst_ktab, cmode, &stats );
+            if ( rc == 0 )
+            {
+                PLOGMSG( klogInfo, ( klogInfo,
+                         "$(cols) columns ( $(blobs) blobs / $(bytes) bytes ) copied blob by blob",
+                         "cols=%lu,blobs=%lu,bytes=%lu",
+                         stats.columns, stats.blobs, stats.bytes ));
+            }
+            KTableRelease( dst_ktab );
+        }
+    }
+    KTableRelease( src_ktab );
+
+    if ( rc == 0 )
+    {
+        len = VectorLength( &(columns->cols) );
+        for ( idx = 0; idx < len; ++idx )
+        {
+            p_col_def col = (p_col_def) VectorGet ( &(columns->cols), idx );
+            if ( col != NULL )
+                col->to_copy = false;
+        }
+        *all_copied = true;
+
+        /* without a write-cursor nobody regenerates the statistics */
+        rc = copy_table_meta_node( src_table, dst_table, "STATS", ctx->show_meta );
+    }
+    return rc;
+}
+
+
 static rc_t vdb_copy_make_dst_table( const p_context ctx,
                                      VDBManager * vdb_mgr, 
                                      const VSchema * src_schema,
@@ -536,12 +852,17 @@ static rc_t vdb_copy_make_dst_table( const p_context ctx,
 
 static rc_t vdb_copy_open_dest_table( const p_context ctx,
                                       const VTable * src_table,
+                                      const VCursor * src_cursor,
                                       VTable * dst_table,
                                       VCursor ** dst_cursor,
                                       col_defs * columns,
+                                      KCreateMode cmode,
                                       bool is_legacy )
 {
     rc_t rc;
+    bool all_copied;
+
+    *dst_cursor = NULL;
 
     /* copy the metadata */
     rc = copy_table_meta( src_table, dst_table, 
@@ -554,6 +875,11 @@ static rc_t vdb_copy_open_dest_table( const p_context ctx,
     DISP_RC( rc, "vdb_copy_open_dest_table:col_defs_mark_writable_columns() failed" );
     if ( rc != 0 ) return rc;
 
+    /* copy what can be copied blob by blob, no cursor needed if that was all */
+    rc = vdb_copy_passthrough( ctx, src_table, dst_table, src_cursor, columns,
+                               cmode, is_legacy, &all_copied );
+    if ( rc != 0 || all_copied ) return rc;
+
     /* make a writable cursor */
     rc = VTableCreateCursorWrite( dst_table, dst_cursor, kcmInsert );
     DISP_RC( rc, "vdb_copy_open_dest_table:VTableCreateCursorWrite(dst) failed" );
@@ -858,17 +1184,20 @@ static rc_t vdb_copy_table2( const p_context ctx,
     if ( rc == 0 )
     {
         VCursor * dst_cursor;
-        rc = vdb_copy_open_dest_table( ctx, src_table, dst_table, &dst_cursor, columns, 
-                                       is_legacy );
+
+        /* this function does not fail, because it is ok to not find
+           filter-column, redactable types and excluded columns */
+        vdb_copy_find_filter_and_redact_columns( src_schema,
+                               columns, &(ctx->config), type_matcher );
+
+        rc = vdb_copy_open_dest_table( ctx, src_table, src_cursor, dst_table, &dst_cursor,
+                                       columns, cmode, is_legacy );
         if ( rc == 0 )
         {
-            /* this function does not fail, because it is ok to not find
-               filter-column, redactable types and excluded columns */
-            vdb_copy_find_filter_and_redact_columns( src_schema,
-                                   columns, &(ctx->config), type_matcher );
-
-            rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
-                                    columns, ctx->rvals );
+            /* dst_cursor is NULL if all columns have been copied blob by blob */
+            if ( dst_cursor != NULL )
+                rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
+                                        columns, ctx->rvals );
 
             VCursorRelease( dst_cursor );
             if ( rc == 0 )
@@ -937,6 +1266,8 @@ static rc_t vdb_copy_table( const p_context ctx,
 
 /*-----------------------------------------------------------------------------*/
 static rc_t vdb_copy_cur_2_cur( const p_context ctx,
+                                const VTable * src_tab,
+                                VTable * dst_tab,
                                 const VCursor * src_cursor,
                                 VCursor * dst_cursor,
                                 const VSchema * schema,
@@ -948,45 +1279,55 @@ static rc_t vdb_copy_cur_2_cur( const p_context ctx,
     DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_apply_casts() failed" );
     if ( rc == 0 )
     {
-        rc = col_defs_add_to_wr_cursor( columns, dst_cursor, false );
-        DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_wr_cursor(dst) failed" );
+        rc = col_defs_add_to_rd_cursor( columns, src_cursor, false );
+        DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_rd_cursor() failed" );
         if ( rc == 0 )
         {
-            rc = VCursorOpen( dst_cursor );
-            DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(dst) failed" );
+            rc = VCursorOpen( src_cursor );
+            DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(src) failed" );
             if ( rc == 0 )
             {
-                rc = col_defs_add_to_rd_cursor( columns, src_cursor, false );
-                DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_rd_cursor() failed" );
+                /* set the row-range in ctx to cover the whole table */
+                rc = vdb_copy_set_range( ctx, src_cursor );
+                DISP_RC( rc, "vdb_copy_cur_2_cur:vdb_copy_check_range(src) failed" );
                 if ( rc == 0 )
                 {
-                    rc = VCursorOpen( src_cursor );
-                    DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(src) failed" );
-                    if ( rc == 0 )
-                    {
-                        /* set the row-range in ctx to cover the whole table */
-                        rc = vdb_copy_set_range( ctx, src_cursor );
-                        DISP_RC( rc, "vdb_copy_cur_2_cur:vdb_copy_check_range(src) failed" );
-                        if ( rc == 0 )
-                        {
-                            /* it is ok to not find a filter-column: no error in this case */
-                            col_defs_detect_filter_col( columns,
-                                                        ctx->config.filter_col_name );
+                    bool all_copied = false;
+
+                    /* it is ok to not find a filter-column: no error in this case */
+                    col_defs_detect_filter_col( columns,
+                                                ctx->config.filter_col_name );
 
-                            /* it is ok to not find columns excluded from redacting: no error in this case */
-                            col_defs_unmark_do_not_redact_columns( columns,
-                                            ctx->config.do_not_redact_columns );
+                    /* it is ok to not find columns excluded from redacting: no error in this case */
+                    col_defs_unmark_do_not_redact_columns( columns,
+                                    ctx->config.do_not_redact_columns );
 
-                            if ( ctx->show_progress )
-                                KOutMsg( "copy of >%s<\n", tab_name );
+                    if ( ctx->show_progress )
+                        KOutMsg( "copy of >%s<\n", tab_name );
 
-                            vdb_copy_find_filter_and_redact_columns( schema,
-                                                   columns, &(ctx->config), type_matcher );
+                    vdb_copy_find_filter_and_redact_columns( schema,
+                                           columns, &(ctx->config), type_matcher );
 
-                            /**************************************************/
-                            rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
-                                                    columns, ctx->rvals );
-                            /**************************************************/
+                    /* copy what can be copied blob by blob */
+                    rc = vdb_copy_passthrough( ctx, src_tab, dst_tab, src_cursor, columns,
+                                               helper_assemble_CreateMode( src_tab,
+                                                    ctx->force_kcmInit, ctx->md5_mode ),
+                                               false, &all_copied );
+                    if ( rc == 0 && !all_copied )
+                    {
+                        rc = col_defs_add_to_wr_cursor( columns, dst_cursor, false );
+                        DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_wr_cursor(dst) failed" );
+                        if ( rc == 0 )
+                        {
+                            rc = VCursorOpen( dst_cursor );
+                            DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(dst) failed" );
+                            if ( rc == 0 )
+                            {
+                                /**************************************************/
+                                rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
+                                                        columns, ctx->rvals );
+                                /**************************************************/
+                            }
                         }
                     }
                 }
@@ -1044,7 +1385,8 @@ static rc_t vdb_copy_tab_2_tab( const p_context ctx,
                                     if ( rc == 0 )
                                     {
                                         /*****************************************************/
-                                        rc = vdb_copy_cur_2_cur( ctx, src_cursor, dst_cursor,
+                                        rc = vdb_copy_cur_2_cur( ctx, src_tab, dst_tab,
+                                                                 src_cursor, dst_cursor,
                                                                  schema, columns, type_matcher,
                                                                  tab_name );
                                         /*****************************************************/
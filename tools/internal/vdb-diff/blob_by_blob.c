@@ -0,0 +1,915 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "blob_by_blob.h"
+
+#include <klib/log.h>
+#include <klib/out.h>
+#include <klib/num-gen.h>
+#include <klib/namelist.h>
+#include <klib/text.h>
+#include <kdb/table.h>
+#include <kdb/column.h>
+#include <kdb/namelist.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <vdb/cursor.h>
+
+#include "coldefs.h"
+#include "namelist_tools.h"
+#include "cmn.h"
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+rc_t Quitting( void );  /* because we cannot include <kapp/main.h> where it is defined! */
+
+/* ----------------------------------------------------------------------------------- */
+
+void bbb_ranges_init( bbb_ranges * self )
+{
+    self -> ranges = NULL;
+    self -> count = 0;
+    self -> capacity = 0;
+    self -> all = false;
+}
+
+void bbb_ranges_release( bbb_ranges * self )
+{
+    if ( self -> ranges != NULL )
+        free( self -> ranges );
+    bbb_ranges_init( self );
+}
+
+bool bbb_ranges_empty( const bbb_ranges * self )
+{
+    return ( !self -> all && self -> count == 0 );
+}
+
+static rc_t bbb_ranges_add( bbb_ranges * self, int64_t first, uint64_t count )
+{
+    if ( self -> count >= self -> capacity )
+    {
+        uint32_t new_capacity = ( self -> capacity == 0 ) ? 64 : self -> capacity * 2;
+        bbb_range * tmp = realloc( self -> ranges, new_capacity * sizeof * tmp );
+        if ( tmp == NULL )
+        {
+            rc_t rc = RC( rcExe, rcVector, rcInserting, rcMemory, rcExhausted );
+            LOGERR ( klogInt, rc, "bbb_ranges_add() failed" );
+            return rc;
+        }
+        self -> ranges = tmp;
+        self -> capacity = new_capacity;
+    }
+    self -> ranges[ self -> count ] . first = first;
+    self -> ranges[ self -> count ] . count = count;
+    self -> count++;
+    return 0;
+}
+
+static rc_t bbb_ranges_append( bbb_ranges * self, const bbb_ranges * other )
+{
+    rc_t rc = 0;
+    uint32_t i;
+    if ( other -> all )
+        self -> all = true;
+    for ( i = 0; rc == 0 && i < other -> count; ++i )
+        rc = bbb_ranges_add( self, other -> ranges[ i ] . first, other -> ranges[ i ] . count );
+    return rc;
+}
+
+static int CC bbb_range_cmp( const void * a, const void * b )
+{
+    const bbb_range * ra = a;
+    const bbb_range * rb = b;
+    if ( ra -> first < rb -> first ) return -1;
+    if ( ra -> first > rb -> first ) return 1;
+    return 0;
+}
+
+/* sort the ranges and merge the overlapping/adjacent ones */
+static void bbb_ranges_normalize( bbb_ranges * self )
+{
+    if ( self -> count > 1 )
+    {
+        uint32_t src, dst = 0;
+        qsort( self -> ranges, self -> count, sizeof self -> ranges[ 0 ], bbb_range_cmp );
+        for ( src = 1; src < self -> count; ++src )
+        {
+            bbb_range * last = &( self -> ranges[ dst ] );
+            const bbb_range * cur = &( self -> ranges[ src ] );
+            int64_t last_end = last -> first + last -> count;
+            if ( cur -> first <= last_end )
+            {
+                int64_t cur_end = cur -> first + cur -> count;
+                if ( cur_end > last_end )
+                    last -> count = cur_end - last -> first;
+            }
+            else
+                self -> ranges[ ++dst ] = *cur;
+        }
+        self -> count = dst + 1;
+    }
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+/* runs the same thread-function n times in parallel, waits for all of them */
+static rc_t bbb_run_workers( uint32_t num_workers,
+                             rc_t ( CC * run_thread ) ( const KThread * self, void * data ),
+                             void * data )
+{
+    rc_t rc = 0;
+    uint32_t i, started = 0;
+    KThread ** threads = calloc( num_workers, sizeof * threads );
+    if ( threads == NULL )
+    {
+        rc = RC( rcExe, rcThread, rcCreating, rcMemory, rcExhausted );
+        LOGERR ( klogInt, rc, "bbb_run_workers() failed" );
+        return rc;
+    }
+    for ( i = 0; rc == 0 && i < num_workers; ++i )
+    {
+        rc = KThreadMake( &( threads[ i ] ), run_thread, data );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "KThreadMake() failed" );
+        }
+        else
+            started++;
+    }
+    for ( i = 0; i < started; ++i )
+    {
+        rc_t status = 0;
+        rc_t rc2 = KThreadWait( threads[ i ], &status );
+        if ( rc == 0 ) rc = ( rc2 != 0 ) ? rc2 : status;
+        KThreadRelease( threads[ i ] );
+    }
+    free( threads );
+    return rc;
+}
+
+static uint32_t bbb_num_workers( const struct diff_ctx * dctx, uint32_t jobs )
+{
+    uint32_t res = dctx -> threads;
+    if ( res == 0 ) res = 1;
+    if ( res > jobs ) res = jobs;
+    return res;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+typedef struct bbb_buffer
+{
+    uint8_t * data;
+    size_t size;
+} bbb_buffer;
+
+/* reads the whole blob ( header, page-map and payload ) as it is stored */
+static rc_t bbb_read_blob( const KColumnBlob * blob, bbb_buffer * buf, size_t * blob_size )
+{
+    size_t num_read, remaining;
+    /* a read with a zero-length buffer tells us the size of the blob */
+    rc_t rc = KColumnBlobRead ( blob, 0, NULL, 0, &num_read, &remaining );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "KColumnBlobRead() failed" );
+    }
+    else
+    {
+        *blob_size = remaining;
+        if ( buf -> size < remaining )
+        {
+            void * tmp = realloc( buf -> data, remaining );
+            if ( tmp == NULL )
+                rc = RC( rcExe, rcBlob, rcReading, rcMemory, rcExhausted );
+            else
+            {
+                buf -> data = tmp;
+                buf -> size = remaining;
+            }
+        }
+        if ( rc == 0 )
+        {
+            size_t offset = 0;
+            while ( rc == 0 && offset < *blob_size )
+            {
+                rc = KColumnBlobRead ( blob, offset, buf -> data + offset,
+                                       *blob_size - offset, &num_read, &remaining );
+                if ( rc == 0 && num_read == 0 )
+                    rc = RC( rcExe, rcBlob, rcReading, rcTransfer, rcIncomplete );
+                offset += num_read;
+            }
+        }
+    }
+    return rc;
+}
+
+static bool bbb_blobs_equal( const bbb_buffer * buf_1, size_t size_1,
+                             const bbb_buffer * buf_2, size_t size_2 )
+{
+    if ( size_1 != size_2 ) return false;
+    if ( size_1 == 0 ) return true;
+    return ( memcmp( buf_1 -> data, buf_2 -> data, size_1 ) == 0 );
+}
+
+static bool bbb_not_found( rc_t rc )
+{
+    return ( GetRCState( rc ) == rcNotFound );
+}
+
+/* walks the blobs of both physical columns in parallel */
+static rc_t bbb_scan_blobs( const KColumn * col_1, const KColumn * col_2,
+                            int64_t first, uint64_t count,
+                            const char * name, bbb_ranges * suspects )
+{
+    rc_t rc = 0;
+    bbb_buffer buf_1 = { NULL, 0 };
+    bbb_buffer buf_2 = { NULL, 0 };
+    int64_t id = first;
+    int64_t end = first + count;
+
+    while ( rc == 0 && id < end )
+    {
+        const KColumnBlob * blob_1 = NULL;
+        const KColumnBlob * blob_2 = NULL;
+        rc_t rc1 = KColumnOpenBlobRead( col_1, &blob_1, id );
+        rc_t rc2 = KColumnOpenBlobRead( col_2, &blob_2, id );
+
+        if ( rc1 != 0 && rc2 != 0 && bbb_not_found( rc1 ) && bbb_not_found( rc2 ) )
+        {
+            /* a gap in both columns */
+            id++;
+        }
+        else if ( rc1 != 0 && !bbb_not_found( rc1 ) )
+        {
+            rc = rc1;
+            PLOGERR( klogInt, ( klogInt, rc, "KColumnOpenBlobRead( #1 [$(col)].$(row) ) failed",
+                                "col=%s,row=%ld", name, id ) );
+        }
+        else if ( rc2 != 0 && !bbb_not_found( rc2 ) )
+        {
+            rc = rc2;
+            PLOGERR( klogInt, ( klogInt, rc, "KColumnOpenBlobRead( #2 [$(col)].$(row) ) failed",
+                                "col=%s,row=%ld", name, id ) );
+        }
+        else
+        {
+            int64_t first_1 = id, first_2 = id;
+            uint32_t count_1 = 1, count_2 = 1;
+            if ( blob_1 != NULL )
+                rc = KColumnBlobIdRange( blob_1, &first_1, &count_1 );
+            if ( rc == 0 && blob_2 != NULL )
+                rc = KColumnBlobIdRange( blob_2, &first_2, &count_2 );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "KColumnBlobIdRange() failed" );
+            }
+            else if ( blob_1 != NULL && blob_2 != NULL &&
+                      first_1 == first_2 && count_1 == count_2 )
+            {
+                /* same row-range in both: compare the stored bytes */
+                size_t size_1, size_2;
+                rc = bbb_read_blob( blob_1, &buf_1, &size_1 );
+                if ( rc == 0 )
+                    rc = bbb_read_blob( blob_2, &buf_2, &size_2 );
+                if ( rc == 0 && !bbb_blobs_equal( &buf_1, size_1, &buf_2, size_2 ) )
+                    rc = bbb_ranges_add( suspects, first_1, count_1 );
+                id = first_1 + count_1;
+            }
+            else
+            {
+                /* different blob-boundaries ( or a blob missing on one side ):
+                   the union of both row-ranges has to be compared cell by cell */
+                int64_t lo = ( first_1 < first_2 ) ? first_1 : first_2;
+                int64_t end_1 = first_1 + count_1;
+                int64_t end_2 = first_2 + count_2;
+                int64_t hi = ( end_1 > end_2 ) ? end_1 : end_2;
+                rc = bbb_ranges_add( suspects, lo, hi - lo );
+                id = hi;
+            }
+        }
+        if ( blob_1 != NULL ) KColumnBlobRelease( blob_1 );
+        if ( blob_2 != NULL ) KColumnBlobRelease( blob_2 );
+        if ( rc == 0 ) rc = Quitting();    /* to be able to cancel the loop by signal */
+    }
+
+    if ( buf_1.data != NULL ) free( buf_1.data );
+    if ( buf_2.data != NULL ) free( buf_2.data );
+    return rc;
+}
+
+static rc_t bbb_scan_column( const KTable * ktab_1, const KTable * ktab_2,
+                             const char * name, bbb_ranges * suspects )
+{
+    const KColumn * col_1;
+    rc_t rc = KTableOpenColumnRead( ktab_1, &col_1, "%s", name );
+    if ( rc != 0 )
+    {
+        PLOGERR( klogInt, ( klogInt, rc, "KTableOpenColumnRead( #1 [$(col)] ) failed", "col=%s", name ) );
+    }
+    else
+    {
+        const KColumn * col_2;
+        rc = KTableOpenColumnRead( ktab_2, &col_2, "%s", name );
+        if ( rc != 0 )
+        {
+            PLOGERR( klogInt, ( klogInt, rc, "KTableOpenColumnRead( #2 [$(col)] ) failed", "col=%s", name ) );
+        }
+        else
+        {
+            int64_t first_1, first_2;
+            uint64_t count_1, count_2;
+            rc = KColumnIdRange( col_1, &first_1, &count_1 );
+            if ( rc == 0 )
+                rc = KColumnIdRange( col_2, &first_2, &count_2 );
+            if ( rc != 0 )
+            {
+                PLOGERR( klogInt, ( klogInt, rc, "KColumnIdRange( [$(col)] ) failed", "col=%s", name ) );
+            }
+            else if ( first_1 != first_2 || count_1 != count_2 )
+            {
+                PLOGMSG( klogInfo, ( klogInfo, "physical column $(col) has different row-ranges", "col=%s", name ) );
+                suspects -> all = true;
+            }
+            else
+            {
+                /* ******************************************************************* */
+                rc = bbb_scan_blobs( col_1, col_2, first_1, count_1, name, suspects );
+                /* ******************************************************************* */
+            }
+            KColumnRelease( col_2 );
+        }
+        KColumnRelease( col_1 );
+    }
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+typedef struct bbb_scan_shared
+{
+    const KTable * ktab_1;
+    const KTable * ktab_2;
+    const KNamelist * names;
+    uint32_t count;
+    uint32_t next;
+    KLock * lock;
+    bbb_ranges * suspects;
+} bbb_scan_shared;
+
+static rc_t CC bbb_scan_thread( const KThread * self, void * data )
+{
+    bbb_scan_shared * shared = data;
+    rc_t rc = 0;
+    bool done = false;
+    while ( rc == 0 && !done )
+    {
+        uint32_t idx;
+        rc = KLockAcquire( shared -> lock );
+        if ( rc == 0 )
+        {
+            idx = shared -> next++;
+            done = ( idx >= shared -> count || shared -> suspects -> all );
+            KLockUnlock( shared -> lock );
+        }
+        if ( rc == 0 && !done )
+        {
+            const char * name;
+            rc = KNamelistGet( shared -> names, idx, &name );
+            if ( rc == 0 )
+            {
+                bbb_ranges local;
+                bbb_ranges_init( &local );
+                /* ****************************************************************** */
+                rc = bbb_scan_column( shared -> ktab_1, shared -> ktab_2, name, &local );
+                /* ****************************************************************** */
+                if ( rc == 0 )
+                {
+                    rc = KLockAcquire( shared -> lock );
+                    if ( rc == 0 )
+                    {
+                        rc = bbb_ranges_append( shared -> suspects, &local );
+                        KLockUnlock( shared -> lock );
+                    }
+                }
+                bbb_ranges_release( &local );
+            }
+        }
+    }
+    return rc;
+}
+
+static rc_t bbb_scan_ktables( const KTable * ktab_1, const KTable * ktab_2,
+                              const struct diff_ctx * dctx, bbb_ranges * suspects )
+{
+    KNamelist * cols_1;
+    rc_t rc = KTableListCol( ktab_1, &cols_1 );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "KTableListCol( acc #1 ) failed" );
+    }
+    else
+    {
+        KNamelist * cols_2;
+        rc = KTableListCol( ktab_2, &cols_2 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "KTableListCol( acc #2 ) failed" );
+        }
+        else
+        {
+            if ( !nlt_compare_namelists( cols_1, cols_2, NULL ) )
+            {
+                LOGMSG( klogInfo, "the 2 tables have not the same set of physical columns" );
+                suspects -> all = true;
+            }
+            else
+            {
+                bbb_scan_shared shared;
+                memset( &shared, 0, sizeof shared );
+                shared . ktab_1 = ktab_1;
+                shared . ktab_2 = ktab_2;
+                shared . names = cols_1;
+                shared . suspects = suspects;
+                rc = KNamelistCount( cols_1, &shared . count );
+                if ( rc == 0 && shared . count > 0 )
+                {
+                    rc = KLockMake( &shared . lock );
+                    if ( rc != 0 )
+                    {
+                        LOGERR ( klogInt, rc, "KLockMake() failed" );
+                    }
+                    else
+                    {
+                        /* ************************************************************************ */
+                        rc = bbb_run_workers( bbb_num_workers( dctx, shared . count ),
+                                              bbb_scan_thread, &shared );
+                        /* ************************************************************************ */
+                        KLockRelease( shared . lock );
+                    }
+                }
+            }
+            KNamelistRelease( cols_2 );
+        }
+        KNamelistRelease( cols_1 );
+    }
+    return rc;
+}
+
+rc_t bbb_scan_table( const VTable * tab_1, const VTable * tab_2,
+                     const struct diff_ctx * dctx, bbb_ranges * suspects )
+{
+    char ts_1[ 1024 ], ts_2[ 1024 ];
+    rc_t rc = VTableTypespec( tab_1, ts_1, sizeof ts_1 );
+    if ( rc == 0 )
+        rc = VTableTypespec( tab_2, ts_2, sizeof ts_2 );
+    if ( rc != 0 || strcmp( ts_1, ts_2 ) != 0 )
+    {
+        /* different schemas: the physical encoding may differ even if the data does not */
+        LOGMSG( klogInfo, "the 2 tables have not the same schema" );
+        suspects -> all = true;
+        return 0;
+    }
+    else
+    {
+        const KTable * ktab_1;
+        rc = VTableOpenKTableRead( tab_1, &ktab_1 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VTableOpenKTableRead( acc #1 ) failed" );
+        }
+        else
+        {
+            const KTable * ktab_2;
+            rc = VTableOpenKTableRead( tab_2, &ktab_2 );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "VTableOpenKTableRead( acc #2 ) failed" );
+            }
+            else
+            {
+                rc = bbb_scan_ktables( ktab_1, ktab_2, dctx, suspects );
+                KTableRelease( ktab_2 );
+            }
+            KTableRelease( ktab_1 );
+        }
+    }
+    if ( rc == 0 )
+        bbb_ranges_normalize( suspects );
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+typedef struct bbb_table_scan
+{
+    char * name;
+    bbb_ranges suspects;
+} bbb_table_scan;
+
+static void CC bbb_table_scan_whack( void * item, void * data )
+{
+    bbb_table_scan * ts = item;
+    if ( ts != NULL )
+    {
+        free( ts -> name );
+        bbb_ranges_release( &( ts -> suspects ) );
+        free( ts );
+    }
+}
+
+static rc_t bbb_scan_db_table( const VDatabase * db_1, const VDatabase * db_2,
+                               const struct diff_ctx * dctx, const char * tablename,
+                               bbb_db_scan * scan )
+{
+    const VTable * tab_1;
+    rc_t rc = VDatabaseOpenTableRead ( db_1, &tab_1, "%s", tablename );
+    if ( rc != 0 )
+    {
+        PLOGERR( klogInt, ( klogInt, rc, "VDatabaseOpenTableRead( #1 $(tab) ) failed", "tab=%s", tablename ) );
+    }
+    else
+    {
+        const VTable * tab_2;
+        rc = VDatabaseOpenTableRead ( db_2, &tab_2, "%s", tablename );
+        if ( rc != 0 )
+        {
+            PLOGERR( klogInt, ( klogInt, rc, "VDatabaseOpenTableRead( #2 $(tab) ) failed", "tab=%s", tablename ) );
+        }
+        else
+        {
+            bbb_table_scan * ts = calloc( 1, sizeof * ts );
+            if ( ts == NULL )
+                rc = RC( rcExe, rcTable, rcReading, rcMemory, rcExhausted );
+            else
+            {
+                bbb_ranges_init( &( ts -> suspects ) );
+                ts -> name = string_dup_measure( tablename, NULL );
+                /* ********************************************************** */
+                rc = bbb_scan_table( tab_1, tab_2, dctx, &( ts -> suspects ) );
+                /* ********************************************************** */
+                if ( rc == 0 )
+                    rc = VectorAppend( &( scan -> tables ), NULL, ts );
+                if ( rc != 0 )
+                    bbb_table_scan_whack( ts, NULL );
+            }
+            VTableRelease( tab_2 );
+        }
+        VTableRelease( tab_1 );
+    }
+    return rc;
+}
+
+rc_t bbb_scan_database( const VDatabase * db_1, const VDatabase * db_2,
+                        const struct diff_ctx * dctx, bbb_db_scan * scan )
+{
+    KNamelist * tables_1;
+    rc_t rc;
+
+    VectorInit( &( scan -> tables ), 0, 8 );
+    rc = VDatabaseListTbl( db_1, &tables_1 );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "VDatabaseListTbl( acc #1 ) failed" );
+    }
+    else
+    {
+        KNamelist * tables_2;
+        rc = VDatabaseListTbl( db_2, &tables_2 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VDatabaseListTbl( acc #2 ) failed" );
+        }
+        else
+        {
+            uint32_t idx, count;
+            rc = KNamelistCount( tables_1, &count );
+            for ( idx = 0; rc == 0 && idx < count; ++idx )
+            {
+                const char * tablename;
+                rc = KNamelistGet( tables_1, idx, &tablename );
+                if ( rc == 0 && nlt_is_name_in_namelist( tables_2, tablename ) )
+                {
+                    rc = KOutMsg( "scanning blobs of table: %s\n", tablename );
+                    if ( rc == 0 )
+                        rc = bbb_scan_db_table( db_1, db_2, dctx, tablename, scan );
+                }
+            }
+            KNamelistRelease( tables_2 );
+        }
+        KNamelistRelease( tables_1 );
+    }
+    return rc;
+}
+
+void bbb_db_scan_release( bbb_db_scan * scan )
+{
+    VectorWhack( &( scan -> tables ), bbb_table_scan_whack, NULL );
+}
+
+void bbb_db_scan_get( const bbb_db_scan * scan, const char * tablename,
+                      bbb_ranges * suspects )
+{
+    const bbb_table_scan * own = NULL;
+    bool others_differ = false;
+    uint32_t idx, count = VectorLength( &( scan -> tables ) );
+
+    for ( idx = 0; idx < count; ++idx )
+    {
+        const bbb_table_scan * ts = VectorGet( &( scan -> tables ), idx );
+        if ( ts != NULL )
+        {
+            if ( nlt_strcmp( ts -> name, tablename ) == 0 )
+                own = ts;
+            else if ( !bbb_ranges_empty( &( ts -> suspects ) ) )
+                others_differ = true;
+        }
+    }
+
+    if ( own == NULL || others_differ )
+        suspects -> all = true;
+    else if ( bbb_ranges_append( suspects, &( own -> suspects ) ) != 0 )
+        suspects -> all = true;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+typedef struct bbb_diff_shared
+{
+    const col_defs * defs;
+    const VTable * tab_1;
+    const VTable * tab_2;
+    const struct diff_ctx * dctx;
+    const char * tablename;
+    const bbb_ranges * suspects;
+    uint32_t count;
+    uint32_t next;
+    KLock * lock;           /* protects next, diffs and the output */
+    unsigned long int * diffs;
+} bbb_diff_shared;
+
+static bool bbb_enough_diffs( bbb_diff_shared * shared )
+{
+    bool res = true;
+    if ( KLockAcquire( shared -> lock ) == 0 )
+    {
+        res = ( *( shared -> diffs ) >= shared -> dctx -> max_err );
+        KLockUnlock( shared -> lock );
+    }
+    return res;
+}
+
+static rc_t bbb_diff_rows( bbb_diff_shared * shared, const col_pair * pair,
+                           const VCursor * cur_1, const VCursor * cur_2,
+                           const struct num_gen * rows,
+                           uint64_t * rows_checked, uint64_t * rows_different )
+{
+    const struct num_gen_iter * iter = NULL;
+    rc_t rc = num_gen_iterator_make( rows, &iter );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
+    }
+    else if ( iter != NULL )
+    {
+        int64_t row_id;
+        bool stop = false;
+        while ( rc == 0 && !stop && num_gen_iterator_next( iter, &row_id, &rc ) )
+        {
+            if ( rc == 0 ) rc = Quitting();    /* to be able to cancel the loop by signal */
+            if ( rc == 0 )
+            {
+                bool col_equal;
+                rc = cmn_cells_equal( pair, cur_1, cur_2, row_id, &col_equal );
+                if ( rc == 0 && !col_equal )
+                {
+                    /* report it the same way the other modes do, but only one worker at a time */
+                    rc = KLockAcquire( shared -> lock );
+                    if ( rc == 0 )
+                    {
+                        if ( *( shared -> diffs ) < shared -> dctx -> max_err )
+                        {
+                            /* only what cmn_diff_column() reports is counted */
+                            rc = cmn_diff_column( pair, cur_1, cur_2, row_id, &col_equal );
+                            if ( rc == 0 && !col_equal )
+                            {
+                                rc = KOutMsg( "\n" );
+                                ( *( shared -> diffs ) )++;
+                                ( *rows_different )++;
+                            }
+                        }
+                        stop = ( *( shared -> diffs ) >= shared -> dctx -> max_err );
+                        KLockUnlock( shared -> lock );
+                    }
+                }
+                ( *rows_checked )++;
+            }
+        }
+        num_gen_iterator_destroy( iter );
+    }
+    return rc;
+}
+
+static rc_t bbb_diff_column( bbb_diff_shared * shared, col_pair * pair,
+                             const VCursor * cur_1, const VCursor * cur_2 )
+{
+    uint64_t rows_checked = 0;
+    uint64_t rows_different = 0;
+    struct num_gen * rows = NULL;
+    rc_t rc = cmn_make_num_gen( cur_1, cur_2, pair -> idx[ 0 ], pair -> idx[ 1 ],
+                                shared -> dctx -> rows, &rows );
+    if ( rc == 0 && rows != NULL )
+    {
+        if ( shared -> suspects -> all )
+        {
+            rc = bbb_diff_rows( shared, pair, cur_1, cur_2, rows, &rows_checked, &rows_different );
+        }
+        else
+        {
+            /* only the suspect ranges, clipped by the rows given at the commandline */
+            uint32_t i;
+            for ( i = 0; rc == 0 && i < shared -> suspects -> count && !bbb_enough_diffs( shared ); ++i )
+            {
+                const bbb_range * r = &( shared -> suspects -> ranges[ i ] );
+                struct num_gen * clipped = NULL;
+                rc = num_gen_copy( rows, &clipped );
+                if ( rc == 0 )
+                {
+                    rc = num_gen_trim( clipped, r -> first, r -> count );
+                    if ( rc == 0 && !num_gen_empty( clipped ) )
+                        rc = bbb_diff_rows( shared, pair, cur_1, cur_2, clipped,
+                                            &rows_checked, &rows_different );
+                    num_gen_destroy( clipped );
+                }
+            }
+        }
+        num_gen_destroy( rows );
+    }
+    if ( rc == 0 )
+    {
+        rc = KLockAcquire( shared -> lock );
+        if ( rc == 0 )
+        {
+            rc = KOutMsg( "column '%s.%s': %,lu rows checked, %,lu rows differ\n",
+                          shared -> tablename, pair -> name, rows_checked, rows_different );
+            KLockUnlock( shared -> lock );
+        }
+    }
+    return rc;
+}
+
+static rc_t bbb_open_pair( bbb_diff_shared * shared, col_pair * pair )
+{
+    const VCursor * cur_1;
+    rc_t rc = VTableCreateCursorRead( shared -> tab_1, &cur_1 );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #1 ) failed" );
+    }
+    else
+    {
+        const VCursor * cur_2;
+        rc = VTableCreateCursorRead( shared -> tab_2, &cur_2 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #2 ) failed" );
+        }
+        else
+        {
+            rc = VCursorAddColumn( cur_1, &( pair -> idx[ 0 ] ), "%s", pair -> name );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "VCursorAddColumn( acc #1 ) failed" );
+            }
+            else
+            {
+                rc = VCursorAddColumn( cur_2, &( pair -> idx[ 1 ] ), "%s", pair -> name );
+                if ( rc != 0 )
+                {
+                    LOGERR ( klogInt, rc, "VCursorAddColumn( acc #2 ) failed" );
+                }
+            }
+            if ( rc == 0 )
+            {
+                rc = VCursorOpen( cur_1 );
+                if ( rc != 0 )
+                {
+                    LOGERR ( klogInt, rc, "VCursorOpen( acc #1 ) failed" );
+                }
+                else
+                {
+                    rc = VCursorOpen( cur_2 );
+                    if ( rc != 0 )
+                    {
+                        LOGERR ( klogInt, rc, "VCursorOpen( acc #2 ) failed" );
+                    }
+                    else
+                    {
+                        /* *************************************************** */
+                        rc = bbb_diff_column( shared, pair, cur_1, cur_2 );
+                        /* *************************************************** */
+                    }
+                }
+            }
+            VCursorRelease( cur_2 );
+        }
+        VCursorRelease( cur_1 );
+    }
+    return rc;
+}
+
+static rc_t CC bbb_diff_thread( const KThread * self, void * data )
+{
+    bbb_diff_shared * shared = data;
+    rc_t rc = 0;
+    bool done = false;
+    while ( rc == 0 && !done )
+    {
+        uint32_t idx;
+        rc = KLockAcquire( shared -> lock );
+        if ( rc == 0 )
+        {
+            idx = shared -> next++;
+            done = ( idx >= shared -> count ||
+                     *( shared -> diffs ) >= shared -> dctx -> max_err );
+            KLockUnlock( shared -> lock );
+        }
+        if ( rc == 0 && !done )
+        {
+            col_pair * pair = VectorGet( &( shared -> defs -> cols ), idx );
+            if ( pair != NULL )
+                rc = bbb_open_pair( shared, pair );
+        }
+    }
+    return rc;
+}
+
+rc_t bbb_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                       const struct diff_ctx * dctx, const char * tablename,
+                       const bbb_ranges * suspects, unsigned long int *diffs )
+{
+    rc_t rc = 0;
+    if ( bbb_ranges_empty( suspects ) )
+    {
+        rc = KOutMsg( "all blobs of table '%s' are identical\n", tablename );
+    }
+    else
+    {
+        bbb_diff_shared shared;
+        memset( &shared, 0, sizeof shared );
+        shared . defs = defs;
+        shared . tab_1 = tab_1;
+        shared . tab_2 = tab_2;
+        shared . dctx = dctx;
+        shared . tablename = tablename;
+        shared . suspects = suspects;
+        shared . count = VectorLength( &( defs -> cols ) );
+        shared . diffs = diffs;
+
+        if ( !suspects -> all )
+            rc = KOutMsg( "%u row-ranges of table '%s' with different blobs\n",
+                          suspects -> count, tablename );
+        if ( rc == 0 && shared . count > 0 )
+        {
+            rc = KLockMake( &shared . lock );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "KLockMake() failed" );
+            }
+            else
+            {
+                /* ************************************************************************ */
+                rc = bbb_run_workers( bbb_num_workers( dctx, shared . count ),
+                                      bbb_diff_thread, &shared );
+                /* ************************************************************************ */
+                KLockRelease( shared . lock );
+            }
+        }
+    }
+    return rc;
+}
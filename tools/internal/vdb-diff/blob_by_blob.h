@@ -0,0 +1,112 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_blob_by_blob_
+#define _h_blob_by_blob_
+
+#include <klib/rc.h>
+#include <vdb/table.h>
+#include <vdb/database.h>
+#include "vdb-diff-context.h"
+#include "coldefs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+a set of row-ranges, which have to be compared cell by cell
+********************************************************************/
+typedef struct bbb_range
+{
+    int64_t first;
+    uint64_t count;
+} bbb_range;
+
+typedef struct bbb_ranges
+{
+    bbb_range * ranges;
+    uint32_t count;
+    uint32_t capacity;
+    bool all;           /* the blobs cannot be trusted: compare every row */
+} bbb_ranges;
+
+void bbb_ranges_init( bbb_ranges * self );
+void bbb_ranges_release( bbb_ranges * self );
+bool bbb_ranges_empty( const bbb_ranges * self );
+
+/*
+ * compares all physical columns of the 2 tables blob by blob,
+ * ( not only the ones requested, because a readable column can be
+ *   computed from several physical columns )
+ * the columns are processed concurrently by dctx->threads workers
+ * the row-ranges of all blobs which are not byte-identical in both
+ * tables end up in 'suspects'
+ * suspects->all is set if the tables have different schemas,
+ * different sets of physical columns or different row-ranges
+*/
+rc_t bbb_scan_table( const VTable * tab_1, const VTable * tab_2,
+                     const struct diff_ctx * dctx, bbb_ranges * suspects );
+
+/********************************************************************
+the result of scanning all tables of 2 databases
+********************************************************************/
+typedef struct bbb_db_scan
+{
+    Vector tables;      /* bbb_table_scan */
+} bbb_db_scan;
+
+/*
+ * scans all tables, which exist in both databases ( see bbb_scan_table() )
+*/
+rc_t bbb_scan_database( const VDatabase * db_1, const VDatabase * db_2,
+                        const struct diff_ctx * dctx, bbb_db_scan * scan );
+
+void bbb_db_scan_release( bbb_db_scan * scan );
+
+/*
+ * returns the suspect row-ranges of this table,
+ * a readable column can pull data from other tables ( f.i. cSRA ),
+ * the ranges of one table are only to be trusted if all other
+ * tables are identical, if not suspects->all is set
+*/
+void bbb_db_scan_get( const bbb_db_scan * scan, const char * tablename,
+                      bbb_ranges * suspects );
+
+/*
+ * compares the given columns cell by cell, but only in the suspect row-ranges
+ * the columns are processed concurrently by dctx->threads workers,
+ * each one with it's own pair of cursors
+*/
+rc_t bbb_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                       const struct diff_ctx * dctx, const char * tablename,
+                       const bbb_ranges * suspects, unsigned long int *diffs );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,6 +28,41 @@
 #include <klib/log.h>
 #include <klib/out.h>
 
+/* compares two bit-strings, VDB packs bits starting with the most significant one */
+static bool cmn_bits_equal( const void * base_1, uint32_t boff_1,
+                            const void * base_2, uint32_t boff_2, uint64_t num_bits )
+{
+    const uint8_t * b_1 = ( const uint8_t * )base_1 + ( boff_1 >> 3 );
+    const uint8_t * b_2 = ( const uint8_t * )base_2 + ( boff_2 >> 3 );
+    uint64_t i;
+
+    boff_1 &= 7;
+    boff_2 &= 7;
+    if ( boff_1 == 0 && boff_2 == 0 )
+    {
+        uint64_t num_bytes = ( num_bits >> 3 );
+        uint32_t rem = ( uint32_t )( num_bits & 7 );
+        if ( memcmp( b_1, b_2, num_bytes ) != 0 )
+            return false;
+        if ( rem == 0 )
+            return true;
+        {
+            uint8_t mask = ( uint8_t )( 0xFF << ( 8 - rem ) );
+            return ( ( b_1[ num_bytes ] ^ b_2[ num_bytes ] ) & mask ) == 0;
+        }
+    }
+    for ( i = 0; i < num_bits; ++i )
+    {
+        uint64_t p_1 = boff_1 + i;
+        uint64_t p_2 = boff_2 + i;
+        bool bit_1 = ( ( b_1[ p_1 >> 3 ] >> ( 7 - ( p_1 & 7 ) ) ) & 1 ) != 0;
+        bool bit_2 = ( ( b_2[ p_2 >> 3 ] >> ( 7 - ( p_2 & 7 ) ) ) & 1 ) != 0;
+        if ( bit_1 != bit_2 )
+            return false;
+    }
+    return true;
+}
+
 rc_t cmn_diff_column( const col_pair * pair,
                       const VCursor * cur_1, const VCursor * cur_2,
                       int64_t row_id,  bool * res )
@@ -71,31 +106,15 @@ rc_t cmn_diff_column( const col_pair * pair,
                     rc = KOutMsg( "%s[ %ld ].row_len %u != %u\n", pair->name, row_id, row_len_1, row_len_2 );
             }
 
-            if ( boff_1 != 0 || boff_2 != 0 )
-            {
-                *res = false;
-                if ( rc == 0 )
-                    rc = KOutMsg( "%s[ %ld ].bit_offset: %u, %u\n", pair->name, row_id, boff_1, boff_2 );
-            }
-            
+            /* bit-packed cells ( offset or length not on a byte-boundary ) are compared bit by bit */
             if ( *res )
             {
-                size_t num_bits = ( row_len_1 * elem_bits_1 );
-                if ( num_bits & 0x07 )
+                uint64_t num_bits = ( ( uint64_t )row_len_1 * elem_bits_1 );
+                if ( !cmn_bits_equal( base_1, boff_1, base_2, boff_2, num_bits ) )
                 {
                     if ( rc == 0 )
-                        rc = KOutMsg( "%s[ %ld ].bits_total %% 8 = %u\n", pair->name, row_id, ( num_bits % 8 ) );
-                }
-                else
-                {
-                    size_t num_bytes = ( num_bits >> 3 );
-                    int cmp = memcmp ( base_1, base_2, num_bytes );
-                    if ( cmp != 0 )
-                    {
-                        if ( rc == 0 )
-                            rc = KOutMsg( "%s[ %ld ] differ\n", pair->name, row_id );
-                        *res = false;
-                    }
+                        rc = KOutMsg( "%s[ %ld ] differ\n", pair->name, row_id );
+                    *res = false;
                 }
             }
         }
@@ -104,6 +123,34 @@ rc_t cmn_diff_column( const col_pair * pair,
     return rc;
 }
 
+/* same comparison as cmn_diff_column(), but without any output:
+   used by the worker-threads, which report under a lock only if the cells differ */
+rc_t cmn_cells_equal( const col_pair * pair,
+                      const VCursor * cur_1, const VCursor * cur_2,
+                      int64_t row_id,  bool * res )
+{
+    uint32_t elem_bits_1, boff_1, row_len_1;
+    const void * base_1;
+    rc_t rc = VCursorCellDataDirect ( cur_1, row_id, pair->idx[ 0 ], 
+                                    &elem_bits_1, &base_1, &boff_1, &row_len_1 );
+    *res = false;
+    if ( rc == 0 )
+    {
+        uint32_t elem_bits_2, boff_2, row_len_2;
+        const void * base_2;
+        rc = VCursorCellDataDirect ( cur_2, row_id, pair->idx[ 1 ], 
+                                    &elem_bits_2, &base_2, &boff_2, &row_len_2 );
+        if ( rc == 0 &&
+             elem_bits_1 == elem_bits_2 &&
+             row_len_1 == row_len_2 )
+        {
+            *res = cmn_bits_equal( base_1, boff_1, base_2, boff_2,
+                                   ( uint64_t )row_len_1 * elem_bits_1 );
+        }
+    }
+    return rc;
+}
+
 static bool is_range_empty( rc_t rc )
 {
     if ( rcVDB != GetRCModule( rc ) ) return false;
@@ -41,6 +41,10 @@ rc_t cmn_diff_column( const col_pair * pair,
                       const VCursor * cur_1, const VCursor * cur_2,
                       int64_t row_id,  bool * res );
 
+rc_t cmn_cells_equal( const col_pair * pair,
+                      const VCursor * cur_1, const VCursor * cur_2,
+                      int64_t row_id,  bool * res );
+
 rc_t cmn_make_num_gen( const VCursor * cur_1, const VCursor * cur_2,
                        int idx_1, int idx_2,
                        const struct num_gen * src, struct num_gen ** dst );
@@ -62,6 +62,14 @@ extern "C" {
 #define OPTION_COLUMNWISE   "col-by-col"
 #define ALIAS_COLUMNWISE    "c"
 
+#define OPTION_BLOBWISE     "blob-by-blob"
+#define ALIAS_BLOBWISE      "b"
+
+#define OPTION_THREADS      "threads"
+#define ALIAS_THREADS       "t"
+
+#define DEFAULT_THREADS     4
+
 struct diff_ctx
 {
     const char * src1;
@@ -75,6 +83,8 @@ struct diff_ctx
 	bool show_progress;
 	bool intersect;
     bool columnwise;
+    bool blobwise;
+    uint32_t threads;
 };
 
 void init_diff_ctx( struct diff_ctx * dctx );
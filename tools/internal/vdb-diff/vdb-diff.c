@@ -45,6 +45,7 @@
 #include "vdb-diff-context.h"
 #include "row_by_row.h"
 #include "col_by_col.h"
+#include "blob_by_blob.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -57,6 +58,8 @@ static const char * maxerr_usage[] = { "max errors im comparing (default = 1)",
 static const char * intersect_usage[] = { "intersect column-set from both runs", NULL };
 static const char * exclude_usage[] = { "exclude these columns from comapring", NULL };
 static const char * columnwise_usage[] = { "exclude these columns from comapring", NULL };
+static const char * blobwise_usage[] = { "compare physical blobs first, check cells only where blobs differ", NULL };
+static const char * threads_usage[] = { "number of columns compared in parallel in blob-by-blob mode (default = 4)", NULL };
 
 OptDef MyOptions[] =
 {
@@ -67,7 +70,9 @@ OptDef MyOptions[] =
 	{ OPTION_MAXERR, 		ALIAS_MAXERR,		NULL, 	maxerr_usage,		1, 	true, 	false },
 	{ OPTION_INTERSECT,		ALIAS_INTERSECT,	NULL, 	intersect_usage,	1, 	false, 	false },
 	{ OPTION_EXCLUDE,		ALIAS_EXCLUDE,		NULL, 	exclude_usage,		1, 	true, 	false },
-    { OPTION_COLUMNWISE,    ALIAS_COLUMNWISE,   NULL,   columnwise_usage,   1,  false,  false }
+    { OPTION_COLUMNWISE,    ALIAS_COLUMNWISE,   NULL,   columnwise_usage,   1,  false,  false },
+    { OPTION_BLOBWISE,      ALIAS_BLOBWISE,     NULL,   blobwise_usage,     1,  false,  false },
+    { OPTION_THREADS,       ALIAS_THREADS,      NULL,   threads_usage,      1,  true,   false }
 };
 
 const char UsageDefaultName[] = "vdb-diff";
@@ -106,6 +111,8 @@ rc_t CC Usage ( const Args * args )
 	HelpOptionLine ( ALIAS_INTERSECT, 	OPTION_INTERSECT,   NULL,			intersect_usage );
 	HelpOptionLine ( ALIAS_EXCLUDE, 	OPTION_EXCLUDE,   	"column-set",	exclude_usage );
 	HelpOptionLine ( ALIAS_COLUMNWISE, 	OPTION_COLUMNWISE, 	NULL,	        columnwise_usage );
+	HelpOptionLine ( ALIAS_BLOBWISE, 	OPTION_BLOBWISE, 	NULL,	        blobwise_usage );
+	HelpOptionLine ( ALIAS_THREADS, 	OPTION_THREADS, 	"count",	    threads_usage );
 
     HelpOptionsStandard ();
     HelpVersion ( fullpath, KAppVersion() );
@@ -113,9 +120,26 @@ rc_t CC Usage ( const Args * args )
     return rc;
 }
 
+static rc_t perform_blob_diff( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                               const struct diff_ctx * dctx, const char * tablename,
+                               const bbb_db_scan * scan, unsigned long int *diffs )
+{
+    rc_t rc = 0;
+    bbb_ranges suspects;
+    bbb_ranges_init( &suspects );
+    if ( scan != NULL )
+        bbb_db_scan_get( scan, tablename, &suspects );  /* the database has been scanned already */
+    else
+        rc = bbb_scan_table( tab_1, tab_2, dctx, &suspects );
+    if ( rc == 0 )
+        rc = bbb_diff_columns( defs, tab_1, tab_2, dctx, tablename, &suspects, diffs );
+    bbb_ranges_release( &suspects );
+    return rc;
+}
+
 static rc_t perform_table_diff( const VTable * tab_1, const VTable * tab_2,
                                 const struct diff_ctx * dctx, const char * tablename,
-                                unsigned long int *diffs  )
+                                const bbb_db_scan * scan, unsigned long int *diffs  )
 {
     KNamelist * cols_1;
     rc_t rc = VTableListReadableColumns( tab_1, &cols_1 );
@@ -162,7 +186,9 @@ static rc_t perform_table_diff( const VTable * tab_1, const VTable * tab_2,
                     if ( rc == 0 )
                     {
                         /* ******************************************* */
-                        if ( dctx -> columnwise )
+                        if ( dctx -> blobwise )
+                            rc = perform_blob_diff( defs, tab_1, tab_2, dctx, tablename, scan, diffs );
+                        else if ( dctx -> columnwise )
                             rc = cbc_diff_columns( defs, tab_1, tab_2, dctx, tablename, diffs );
                         else
                             rc = rbr_diff_columns( defs, tab_1, tab_2, dctx, diffs );
@@ -183,7 +209,7 @@ static rc_t perform_table_diff( const VTable * tab_1, const VTable * tab_2,
 
 static rc_t perform_database_diff_on_this_table( const VDatabase * db_1, const VDatabase * db_2,
 												 const struct diff_ctx * dctx, const char * table_name,
-                                                 unsigned long int *diffs )
+                                                 const bbb_db_scan * scan, unsigned long int *diffs )
 {
 	/* we want to compare only the table wich name was given at the commandline */
 	const VTable * tab_1;
@@ -207,7 +233,7 @@ static rc_t perform_database_diff_on_this_table( const VDatabase * db_1, const V
 		else
 		{
 			/* ******************************************* */
-			rc = perform_table_diff( tab_1, tab_2, dctx, table_name, diffs );
+			rc = perform_table_diff( tab_1, tab_2, dctx, table_name, scan, diffs );
 			/* ******************************************* */
 			VTableRelease( tab_2 );
 		}
@@ -221,11 +247,26 @@ static rc_t perform_database_diff( const VDatabase * db_1, const VDatabase * db_
                                    const struct diff_ctx * dctx, unsigned long int *diffs )
 {
 	rc_t rc = 0;
-	if ( dctx -> table != NULL )
+	bbb_db_scan db_scan;
+	const bbb_db_scan * scan = NULL;
+
+	if ( dctx -> blobwise )
+	{
+		/* the blobs of all tables have to be scanned, even if only one table is compared */
+		rc = bbb_scan_database( db_1, db_2, dctx, &db_scan );
+		if ( rc == 0 )
+			scan = &db_scan;
+	}
+
+	if ( rc != 0 )
+	{
+		/* nothing to do, error has been logged already */
+	}
+	else if ( dctx -> table != NULL )
 	{
 		/* we want to compare only the table wich name was given at the commandline */
 		/* ************************************************************************** */
-		rc = perform_database_diff_on_this_table( db_1, db_2, dctx, dctx -> table, diffs );
+		rc = perform_database_diff_on_this_table( db_1, db_2, dctx, dctx -> table, scan, diffs );
 		/* ************************************************************************** */
 	}
 	else
@@ -273,7 +314,7 @@ static rc_t perform_database_diff( const VDatabase * db_1, const VDatabase * db_
 								if ( rc == 0 )
 								{
 									/* ********************************************************************* */
-									rc = perform_database_diff_on_this_table( db_1, db_2, dctx, table_name, diffs );
+									rc = perform_database_diff_on_this_table( db_1, db_2, dctx, table_name, scan, diffs );
 									/* ********************************************************************* */									
 								}
 							}
@@ -290,6 +331,9 @@ static rc_t perform_database_diff( const VDatabase * db_1, const VDatabase * db_
 			KNamelistRelease( table_set_1 );
 		}
 	}
+
+	if ( dctx -> blobwise )
+		bbb_db_scan_release( &db_scan );
 	return rc;
 }
 
@@ -354,7 +398,7 @@ static rc_t perform_diff( const struct diff_ctx * dctx, unsigned long int * diff
 						if ( rc == 0 )
 						{
 							/* ******************************************** */
-							rc = perform_table_diff( tab_1, tab_2, dctx, "SEQ", diffs );
+							rc = perform_table_diff( tab_1, tab_2, dctx, "SEQ", NULL, diffs );
 							/* ******************************************** */
 							VTableRelease( tab_2 );
 						}
@@ -96,6 +96,7 @@ struct BAM_File {
     unsigned bufCurrent;        /* location in uncompressed buffer of read head */
     bool eof;
     bool isSAM;
+    bool readingDeferred;       /* BAM_FileReadRecords is past the end of the file and reads the deferred records */
     zlib_block_t buffer;        /* uncompressed buffer */
 };
 
@@ -2031,7 +2031,7 @@ static rc_t BAM_FileReadSAM(BAM_File *const self, BAM_Alignment **const rslt)
             ctx.refSeqs = self->refSeqs;
             ctx.depth = 0;
             
-            parser = SAM2BAM_Parser_parse(data.base, offsets.elem_count, offsets.base, self->buffer, sizeof(self->buffer), BAM_FileRefNameIncrementalLookup, &ctx, &rc);
+            parser = SAM2BAM_Parser_parse(data.base, offsets.elem_count, offsets.base, self->buffer, sizeof(self->buffer), BAM_FileRefNameIncrementalLookup, &ctx, true, &rc);
         }
     }
     if (parser) {
@@ -2200,6 +2200,338 @@ rc_t BAM_FileRead(const BAM_File *cself, const BAM_Alignment **rhs)
     abort();
 }
 
+/* MARK: BAM record batches */
+
+static rc_t readRecordsDefer(BAM_File *const self, KDataBuffer *const records,
+                             size_t const used, uint32_t *const datasize)
+{
+    uint8_t len[4];
+    size_t nread = 0;
+    rc_t rc;
+
+    if (self->defer == NULL)
+        return SILENT_RC(rcAlign, rcFile, rcReading, rcRow, rcNotFound);
+
+    rc = KFileReadAll(self->defer, self->deferPos, len, 4, &nread);
+    if (rc) return rc;
+    if (nread == 0) {
+        KFileRelease(self->defer);
+        self->defer = NULL;
+        return SILENT_RC(rcAlign, rcFile, rcReading, rcRow, rcNotFound);
+    }
+    assert(nread == 4);
+    *datasize = LE2HUI32(len);
+
+    rc = KDataBufferResize(records, used + 4 + *datasize);
+    if (rc) return rc;
+    memmove((uint8_t *)records->base + used, len, 4);
+    rc = KFileReadAll(self->defer, self->deferPos + 4, (uint8_t *)records->base + used + 4, *datasize, &nread);
+    if (rc) return rc;
+    assert(nread == *datasize);
+    self->deferPos += 4 + *datasize;
+    return 0;
+}
+
+static rc_t readRecordsBAM(BAM_File *const self, KDataBuffer *const records,
+                           size_t const used, uint32_t *const datasize)
+{
+    uint8_t len[4];
+    rc_t rc;
+
+    if (self->bufCurrent >= self->bufSize && self->eof)
+        return SILENT_RC(rcAlign, rcFile, rcReading, rcRow, rcNotFound);
+
+    rc = BAM_FileReadn(self, 4, len);
+    if (rc) {
+        if ((int)GetRCObject(rc) == rcData && GetRCState(rc) == rcInsufficient) {
+            self->eof = true;
+            rc = SILENT_RC(rcAlign, rcFile, rcReading, rcRow, rcNotFound);
+        }
+        return rc;
+    }
+    {
+        int32_t const i32 = LE2HI32(len);
+        if (i32 <= 0)
+            return RC(rcAlign, rcFile, rcReading, rcData, rcInvalid);
+        *datasize = i32;
+    }
+    rc = KDataBufferResize(records, used + 4 + *datasize);
+    if (rc) return rc;
+    memmove((uint8_t *)records->base + used, len, 4);
+    return BAM_FileReadn(self, *datasize, (uint8_t *)records->base + used + 4);
+}
+
+/* SAM lines are stored with the fields NUL-terminated in place of the tabs,
+ * the record length has this bit set to tell them from the BAM records,
+ * that are deferred and read back as BAM */
+#define SAM_TEXT_RECORD ((uint32_t)1 << 31)
+
+static rc_t readRecordsSAMAppend(KDataBuffer *const records, size_t const used,
+                                 uint32_t *const datasize,
+                                 void const *const data, size_t const size)
+{
+    size_t const need = used + 4 + *datasize + size;
+
+    if (need - used - 4 >= SAM_TEXT_RECORD)
+        return RC(rcAlign, rcFile, rcReading, rcData, rcExcessive);
+    if (need > records->elem_count) {
+        rc_t const rc = KDataBufferResize(records, need + need / 2);
+        if (rc) return rc;
+    }
+    memmove((uint8_t *)records->base + used + 4 + *datasize, data, size);
+    *datasize += size;
+    return 0;
+}
+
+/* the same lines as BAM_FileReadSAM_1 does, but the buffered data is
+ * searched for the line ends and copied instead of going char by char;
+ * a line with a CR in it is finished by SAMFileRead1, so the CRs come
+ * out exactly as they do there */
+static rc_t readRecordsSAM(BAM_File *const self, KDataBuffer *const records,
+                           size_t const used, uint32_t *const datasize)
+{
+    SAMFile *const file = &self->file.sam;
+    BufferedFile *const buf = &file->file;
+    /* from ProcessSAMHeader, a char can be put back */
+    bool bychar = file->putback != -1;
+    bool eol = false;
+    rc_t rc = 0;
+
+    if (self->eof)
+        return SILENT_RC(rcAlign, rcFile, rcReading, rcRow, rcNotFound);
+
+    *datasize = 0;
+    while (!eol) {
+        if (bychar) {
+            int const ch = SAMFileRead1(file);
+            char const c = ch;
+
+            if (ch < 0) {
+                if (file->last) return file->last;
+                break;
+            }
+            rc = readRecordsSAMAppend(records, used, datasize, &c, 1);
+            if (rc) return rc;
+            eol = ch == '\n';
+        }
+        else {
+            char const *const base = (char const *)buf->buf + buf->bpos;
+            size_t const avail = buf->bmax - buf->bpos;
+            char const *const endp = avail > 0 ? memchr(base, '\n', avail) : NULL;
+            size_t size = endp ? (size_t)(endp - base) + 1 : avail;
+            char const *const cr = size > 0 ? memchr(base, '\r', size) : NULL;
+
+            if (cr) {
+                size = (size_t)(cr - base);
+                bychar = true;
+            }
+            if (size > 0) {
+                rc = readRecordsSAMAppend(records, used, datasize, base, size);
+                if (rc) return rc;
+                buf->bpos += size;
+                eol = !bychar && endp != NULL;
+            }
+            else if (!bychar) {
+                rc = BufferedFileRead(buf);
+                file->last = rc;
+                if (rc) return rc;
+                if (buf->bmax == 0)
+                    break;
+            }
+        }
+    }
+    if (!eol) {
+        self->eof = true;
+        /* EOF at start of line is OK */
+        return *datasize == 0 ? SILENT_RC(rcAlign, rcFile, rcReading, rcRow, rcNotFound)
+                              : RC(rcAlign, rcFile, rcReading, rcFile, rcTooShort);
+    }
+    {
+        char *const line = (char *)records->base + used + 4;
+        char *const last = line + *datasize - 1;
+        char *tab = line;
+
+        *last = '\0';
+        while ((tab = memchr(tab, '\t', last - tab)) != NULL)
+            *tab++ = '\0';
+    }
+    {
+        uint32_t const len = *datasize | SAM_TEXT_RECORD;
+        uint8_t *const dst = (uint8_t *)records->base + used;
+
+        dst[0] = len; dst[1] = len >> 8; dst[2] = len >> 16; dst[3] = len >> 24;
+    }
+    return 0;
+}
+
+rc_t BAM_FileReadRecords(const BAM_File *cself, KDataBuffer *records,
+                         size_t max_bytes, unsigned *count)
+{
+    BAM_File *const self = (BAM_File *)cself;
+    size_t used = 0;
+    rc_t rc = 0;
+
+    if (self == NULL || records == NULL || count == NULL)
+        return RC(rcAlign, rcFile, rcReading, rcParam, rcNull);
+
+    *count = 0;
+    while (used < max_bytes) {
+        uint32_t datasize = 0;
+
+        if (self->readingDeferred)
+            rc = readRecordsDefer(self, records, used, &datasize);
+        else {
+            rc = (self->isSAM ? readRecordsSAM : readRecordsBAM)(self, records, used, &datasize);
+            if (rc != 0 && GetRCObject(rc) == rcRow && GetRCState(rc) == rcNotFound) {
+                /* the next call goes on with the deferred records */
+                self->readingDeferred = true;
+                self->deferPos = 0;
+            }
+        }
+        if (rc)
+            break;
+        used += 4 + datasize;
+        ++*count;
+    }
+    return rc;
+}
+
+static rc_t decodeRecordSAM(BAM_File *const self, char const *const line,
+                            uint32_t const linesize, bool const log,
+                            const BAM_Alignment **const rslt)
+{
+    unsigned offsets_buffer[64];
+    unsigned *offsets = offsets_buffer;
+    unsigned fields = 0;
+    unsigned maxFields = sizeof(offsets_buffer) / sizeof(offsets_buffer[0]);
+    char const *fld = line;
+    char const *const endp = line + linesize;
+    SAM2BAM_Parser *parser;
+    RefNameLookupContext ctx;
+    rc_t rc = 0;
+
+    /* offsets are to the start of the next field, as BAM_FileReadSAM_SplitLine makes them */
+    while (fld < endp) {
+        char const *const nul = memchr(fld, '\0', endp - fld);
+
+        assert(nul != NULL);
+        if (fields == maxFields) {
+            unsigned *const tmp = malloc(2 * maxFields * sizeof(offsets[0]));
+
+            if (tmp == NULL) {
+                rc = RC(rcAlign, rcFile, rcReading, rcMemory, rcExhausted);
+                break;
+            }
+            memmove(tmp, offsets, fields * sizeof(offsets[0]));
+            if (offsets != offsets_buffer)
+                free(offsets);
+            offsets = tmp;
+            maxFields *= 2;
+        }
+        offsets[fields++] = (unsigned)(nul - line) + 1;
+        fld = nul + 1;
+    }
+    if (rc == 0) {
+        ctx.refSeq = self->refSeq;
+        ctx.refSeqs = self->refSeqs;
+        ctx.depth = 0;
+
+        parser = SAM2BAM_Parser_parse(line, fields, offsets, NULL, 0, BAM_FileRefNameIncrementalLookup, &ctx, log, &rc);
+        if (parser) {
+            if (rc == 0) {
+                unsigned const numExtra = parser->field - 11;
+                BAM_Alignment *const y = malloc(BAM_ALIGNMENT_SIZE(numExtra) + parser->rslt_size);
+
+                if (y == NULL)
+                    rc = RC(rcAlign, rcFile, rcReading, rcMemory, rcExhausted);
+                else {
+                    memmove(&y->extra[numExtra], parser->rslt, parser->rslt_size);
+                    if (!BAM_AlignmentInit(y, BAM_ALIGNMENT_SIZE(numExtra), parser->rslt_size, &y->extra[numExtra])) {
+                        free(y);
+                        rc = RC(rcAlign, rcFile, rcReading, rcRow, rcInvalid);
+                    }
+                    else {
+                        y->parent = self;
+                        *rslt = y;
+                        if (BAM_AlignmentIsEmpty(y))
+                            rc = RC(rcAlign, rcFile, rcReading, rcRow, rcEmpty);
+                    }
+                }
+            }
+            free(parser->rslt);
+            free(parser);
+        }
+    }
+    if (offsets != offsets_buffer)
+        free(offsets);
+    return rc;
+}
+
+rc_t BAM_FileDecodeRecord(const BAM_File *cself, const void *record, bool log,
+                          const BAM_Alignment **rslt)
+{
+    BAM_File *const self = (BAM_File *)cself;
+    unsigned datasize;
+    void const *data;
+    int numExtra;
+    BAM_Alignment *y;
+    rc_t rc = 0;
+
+    if (self == NULL || record == NULL || rslt == NULL)
+        return RC(rcAlign, rcFile, rcReading, rcParam, rcNull);
+
+    *rslt = NULL;
+    datasize = LE2HUI32(record);
+    data = (uint8_t const *)record + 4;
+    if ((datasize & SAM_TEXT_RECORD) != 0)
+        return decodeRecordSAM(self, data, datasize & ~SAM_TEXT_RECORD, log, rslt);
+
+    numExtra = BAM_AlignmentNumExtraFromData(datasize, data);
+    if (numExtra < 0) {
+        if (log) {
+            BAM_Alignment temp;
+
+            BAM_AlignmentInit(&temp, sizeof(temp), datasize, data);
+            BAM_AlignmentLogParseError(&temp);
+        }
+        return RC(rcAlign, rcFile, rcReading, rcRow, rcInvalid);
+    }
+    /* the same layout as BAM_AlignmentCopy makes */
+    y = malloc(BAM_ALIGNMENT_SIZE(numExtra) + datasize);
+    if (y == NULL)
+        return RC(rcAlign, rcFile, rcReading, rcMemory, rcExhausted);
+    memmove(&y->extra[numExtra], data, datasize);
+    BAM_AlignmentInit(y, BAM_ALIGNMENT_SIZE(numExtra), datasize, &y->extra[numExtra]);
+    y->parent = self;
+
+    if (BAM_AlignmentIsEmpty(y)) {
+        rc = RC(rcAlign, rcFile, rcReading, rcRow, rcEmpty);
+        if (log)
+            LOGERR(klogWarn, rc, "BAM Record contains no alignment or sequence data");
+    }
+    *rslt = y;
+    return rc;
+}
+
+rc_t BAM_FileDeferRecord(const BAM_File *cself, const BAM_Alignment *algn,
+                         bool *deferred)
+{
+    BAM_File *const self = (BAM_File *)cself;
+    rc_t rc;
+
+    if (self == NULL || algn == NULL || deferred == NULL)
+        return RC(rcAlign, rcFile, rcWriting, rcParam, rcNull);
+
+    *deferred = false;
+    if (self->defer == NULL || self->readingDeferred || !BAM_AlignmentShouldDefer(algn))
+        return 0;
+
+    rc = writeDefer(self, algn);
+    if (rc == 0)
+        *deferred = true;
+    return rc;
+}
+
 /* MARK: BAM File header info accessor */
 
 rc_t BAM_FileGetRefSeqById(const BAM_File *cself, int32_t id, const BAMRefSeq **rhs)
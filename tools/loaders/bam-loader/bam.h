@@ -564,6 +564,60 @@ float BAM_FileGetProportionalPosition ( const BAM_File *self );
 rc_t BAM_FileRead2 ( const BAM_File *self, const BAM_Alignment **result );
 rc_t BAM_FileRead3 ( const BAM_File *self, const BAM_Alignment **result );
 
+/* ReadRecords
+ *  read a batch of alignment records without parsing them
+ *  the records are parsed by BAM_FileDecodeRecord, which may be called
+ *  on other threads, so the parsing is done apart from the decompression
+ *
+ *  "records" [ OUT ] - receives the records as they are stored in BAM,
+ *   each one is a 32-bit little endian length followed by the record data;
+ *   for SAM files, the record is the text of the line with the fields
+ *   NUL-terminated and the top bit of the length is set
+ *
+ *  "max_bytes" [ IN ] - no more records are added once this size is reached
+ *
+ *  "count" [ OUT ] - number of records in "records", it is set also when
+ *   an error is returned, the records read before the error are valid
+ *
+ *  returns:
+ *    RC(..., ..., ..., rcRow, rcNotFound) at end; if secondary alignments are
+ *      deferred, the following calls return the deferred records, all the records
+ *      read before have to be passed to BAM_FileDeferRecord by then
+ */
+rc_t BAM_FileReadRecords ( const BAM_File *self, struct KDataBuffer *records,
+    size_t max_bytes, unsigned *count );
+
+/* DecodeRecord
+ *  parse and validate a record returned by BAM_FileReadRecords
+ *  does not change the file and can be called concurrently
+ *
+ *  "record" [ IN ] - the record length followed by the record data
+ *
+ *  "log" [ IN ] - log the parsing errors the way BAM_FileRead2 does
+ *
+ *  "result" [ OUT ] - return param for BAM_Alignment object, it owns a copy
+ *   of the data and must be released with BAM_AlignmentRelease
+ *
+ *  returns:
+ *    RC(..., ..., ..., rcRow, rcInvalid) if the record cannot be parsed
+ *    RC(..., ..., ..., rcRow, rcEmpty) with "result" set if the record
+ *      has no alignment or sequence data
+ */
+rc_t BAM_FileDecodeRecord ( const BAM_File *self, const void *record, bool log,
+    const BAM_Alignment **result );
+
+/* DeferRecord
+ *  BAM_FileRead2 sets secondary alignments aside to return them after
+ *  the end of the file, when the file is made with a deferral file;
+ *  this does the same for the records read with BAM_FileReadRecords,
+ *  it is called in the file order for the records decoded without errors
+ *
+ *  "deferred" [ OUT ] - true if the alignment was set aside, the caller
+ *   releases it and goes on to the next one
+ */
+rc_t BAM_FileDeferRecord ( const BAM_File *self, const BAM_Alignment *algn,
+    bool *deferred );
+
 /* GetRefSeqCount
  *  get the number of Reference Sequences refered to in the header
  *  this is not necessarily the number of Reference Sequences referenced
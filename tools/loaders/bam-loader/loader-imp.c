@@ -105,6 +105,7 @@ extern "C" {
 #include <spdlog/stopwatch.h> 
 
 #include <fstream>
+#include <deque>
 #include "data_frame.hpp"
 #include <taskflow/taskflow.hpp>
 #include <taskflow/algorithm/sort.hpp>
@@ -1580,71 +1581,180 @@ static rc_t BAM_FileReadDetached(BAM_File const *self, BAM_Alignment **rec)
     return rc;
 }
 
-static rc_t run_bamread_thread(const KThread *self, void *const file)
+/* looks up the spot of the record and passes it to the main thread */
+static rc_t EnqueueRecord(BAM_File const *const bam, BAM_Alignment *const rec)
 {
     rc_t rc = 0;
-    size_t NR = 0;
-    auto bam = (const BAM_File*)file;
-    while (rc == 0) {
-        if (rw_done)
-            break;
-        BAM_Alignment *rec = NULL;
-        ++NR;
-        rc = BAM_FileReadDetached(bam, &rec);
-        if ((int)GetRCObject(rc) == rcRow && (int)GetRCState(rc) == rcEmpty) {
-            rc = CheckLimitAndLogError();
-            continue;
-        }
-        if ((int)GetRCObject(rc) == rcRow && (int)GetRCState(rc) == rcNotFound) {
-            /* EOF */
-            rc = 0;
-            --NR;
-            break;
-        }
-        if (rc) break;
 #if defined(NEW_QUEUE)
-        queue_rec_t queue_rec;
+    queue_rec_t queue_rec;
 #else
-        queue_rec_t* queue_rec = new queue_rec_t;
+    queue_rec_t* queue_rec = new queue_rec_t;
 #endif        
 
-        {
-            static char const dummy[] = "";
-            char const *spotGroup;
-            char const *name;
-            size_t namelen;
+    {
+        static char const dummy[] = "";
+        char const *spotGroup;
+        char const *name;
+        size_t namelen;
 
-            BAM_AlignmentGetReadName2(rec, &name, &namelen);
-            BAM_AlignmentGetReadGroupName(rec, &spotGroup);
+        BAM_AlignmentGetReadName2(rec, &name, &namelen);
+        BAM_AlignmentGetReadGroupName(rec, &spotGroup);
 #if defined(NEW_QUEUE)
-            queue_rec.alignment = rec;
-            queue_rec.metadata = nullptr;
-            rc = GetKeyID(&GlobalContext, bam, queue_rec, spotGroup ? spotGroup : dummy, name, namelen);
+        queue_rec.alignment = rec;
+        queue_rec.metadata = nullptr;
+        rc = GetKeyID(&GlobalContext, bam, queue_rec, spotGroup ? spotGroup : dummy, name, namelen);
 #else
-            queue_rec->alignment = rec;
-            queue_rec->metadata = nullptr;
-            rc = GetKeyID(&GlobalContext, bam, *queue_rec, spotGroup ? spotGroup : dummy, name, namelen);
+        queue_rec->alignment = rec;
+        queue_rec->metadata = nullptr;
+        rc = GetKeyID(&GlobalContext, bam, *queue_rec, spotGroup ? spotGroup : dummy, name, namelen);
 #endif            
-            if (rc) break;
-        }
+        if (rc) return rc;
+    }
 
-        for ( ; ; ) {
+    for ( ; ; ) {
 #ifdef NEW_QUEUE            
-            if (rw_queue.try_enqueue(move(queue_rec))) {
-                break;
-            }
-            if (rw_done) 
-                break;
+        if (rw_queue.try_enqueue(move(queue_rec))) {
+            break;
+        }
+        if (rw_done) 
+            break;
 
 #else                
-            timeout_t tm;
-            TimeoutInit(&tm, 1000);
-            rc = KQueuePush(bamq, queue_rec, &tm);
-            if (rc == 0 || (int)GetRCObject(rc) != rcTimeout)
-                break;
+        timeout_t tm;
+        TimeoutInit(&tm, 1000);
+        rc = KQueuePush(bamq, queue_rec, &tm);
+        if (rc == 0 || (int)GetRCObject(rc) != rcTimeout)
+            break;
 #endif                
+    }
+    return rc;
+}
+
+/**
+ * @brief Batch of BAM records, decoded on the executor
+ */
+typedef struct record_batch_t
+{
+    KDataBuffer records;                        ///< Records as read by BAM_FileReadRecords
+    unsigned count = 0;                         ///< Number of records
+    vector<rc_t> rcs;                           ///< Decoding result of each record
+    vector<BAM_Alignment const*> alignments;    ///< Decoded records, released once passed on
+    tf::Future<void> decoded;                   ///< Completion of the decoding
+
+    record_batch_t() { KDataBufferMakeBytes(&records, 0); }
+    ~record_batch_t() {
+        if (decoded.valid())
+            decoded.wait();
+        for (auto rec : alignments)
+            BAM_AlignmentRelease(rec);
+        KDataBufferWhack(&records);
+    }
+} record_batch_t;
+
+static uint32_t RecordSize(uint8_t const *const record)
+{
+    /* the top bit tells SAM text from BAM */
+    return 4 + (record[0] | (record[1] << 8) | (record[2] << 16) | ((uint32_t)(record[3] & 0x7F) << 24));
+}
+
+static void DecodeRecords(BAM_File const *const bam, record_batch_t *const batch)
+{
+    auto record = (uint8_t const *)batch->records.base;
+
+    batch->rcs.resize(batch->count);
+    batch->alignments.resize(batch->count, nullptr);
+    for (unsigned i = 0; i < batch->count; ++i) {
+        batch->rcs[i] = BAM_FileDecodeRecord(bam, record, false, &batch->alignments[i]);
+        record += RecordSize(record);
+    }
+}
+
+/* passes the decoded records of the batch on in the file order */
+static rc_t ProcessRecords(BAM_File const *const bam, record_batch_t *const batch, size_t *const NR)
+{
+    auto record = (uint8_t const *)batch->records.base;
+    rc_t rc = 0;
+
+    batch->decoded.wait();
+    for (unsigned i = 0; i < batch->count && rc == 0 && !rw_done; record += RecordSize(record), ++i) {
+        auto rec = (BAM_Alignment *)batch->alignments[i];
+
+        batch->alignments[i] = nullptr;
+        ++*NR;
+        rc = batch->rcs[i];
+        if (rc) {
+            /* decode again to log the problem in order with the other messages */
+            BAM_Alignment const *logged = NULL;
+
+            BAM_AlignmentRelease(rec);
+            BAM_FileDecodeRecord(bam, record, true, &logged);
+            BAM_AlignmentRelease(logged);
+            if ((int)GetRCObject(rc) == rcRow && (int)GetRCState(rc) == rcEmpty)
+                rc = CheckLimitAndLogError();
+            continue;
+        }
+        {
+            bool deferred = false;
+
+            rc = BAM_FileDeferRecord(bam, rec, &deferred);
+            if (rc || deferred) {
+                BAM_AlignmentRelease(rec);
+                --*NR;
+                continue;
+            }
+        }
+        rc = EnqueueRecord(bam, rec);
+    }
+    return rc;
+}
+
+/* reads the records in batches and decodes them on the executor,
+ * up to 2 batches per thread are decoded while the oldest is passed on
+ */
+static rc_t ReadRecordBatches(BAM_File const *const bam, size_t *const NR)
+{
+    static size_t const batchBytes = 4u * 1024u * 1024u;
+    auto& executor = *GlobalContext.m_executor;
+    size_t const maxPending = 2 * max<size_t>(executor.num_workers(), 1);
+    deque<unique_ptr<record_batch_t>> pending;
+    bool readingDeferred = false;
+    rc_t rc = 0;
+
+    while (rc == 0 && !rw_done) {
+        auto batch = make_unique<record_batch_t>();
+        rc_t const rc_read = BAM_FileReadRecords(bam, &batch->records, batchBytes, &batch->count);
+
+        if (batch->count > 0) {
+            auto const p = batch.get();
+            batch->decoded = executor.async([bam, p]() { DecodeRecords(bam, p); });
+            pending.push_back(move(batch));
+        }
+        /* at the end of the file, all the records have to be passed on
+         * before the deferred records are read */
+        while (rc == 0 && !pending.empty() && (rc_read != 0 || pending.size() >= maxPending)) {
+            rc = ProcessRecords(bam, pending.front().get(), NR);
+            pending.pop_front();
+        }
+        if (rc == 0 && rc_read != 0) {
+            if ((int)GetRCObject(rc_read) == rcRow && (int)GetRCState(rc_read) == rcNotFound) {
+                if (readingDeferred)
+                    break;
+                readingDeferred = true;
+            }
+            else
+                rc = rc_read;
         }
     }
+    return rc;
+}
+
+static rc_t run_bamread_thread(const KThread *self, void *const file)
+{
+    rc_t rc = 0;
+    size_t NR = 0;
+    auto bam = (const BAM_File*)file;
+
+    rc = ReadRecordBatches(bam, &NR);
 
 #ifndef NEW_QUEUE                
     KQueueSeal(bamq);
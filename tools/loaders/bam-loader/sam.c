@@ -392,8 +392,9 @@ DECL_PARSER_FUNCTION(NAME)
     while ((void)(self->field_in_size = data < endp ? (data - value) + 1 : (endp - value)), parse_ ## NAME ## _inline (self, data < endp ? *data : ch, rc)) {    \
         if (data < endp) { ++data; } else { return true; }                      \
     }                                                                           \
-    (void)PLOGERR(klogErr, (klogErr, *rc, "Parsing SAM " # NAME ": $(value)",   \
-                                "value=%s", value));                            \
+    if (!self->quiet)                                                           \
+        (void)PLOGERR(klogErr, (klogErr, *rc, "Parsing SAM " # NAME ": $(value)", \
+                                    "value=%s", value));                        \
     self->parser = PARSER_FUNCTION(NEXT);                                       \
     return false;                                                               \
 }
@@ -893,7 +894,8 @@ DECL_PARSER_FUNCTION(EXTRA)
                 continue;
             return self->parser(self, ch, rc, data, endp);
         }
-        (void)PLOGERR(klogErr, (klogErr, *rc, "Parsing SAM EXTRA: $(value)", "value=%s", value));
+        if (!self->quiet)
+            (void)PLOGERR(klogErr, (klogErr, *rc, "Parsing SAM EXTRA: $(value)", "value=%s", value));
         self->parser = PARSER_FUNCTION(EXTRA);
         return false;
     }
@@ -1117,7 +1119,8 @@ DECL_PARSER_FUNCTION(EXTRA_B)
                 continue;
             return self->parser(self, ch, rc, data, endp);
         }
-        (void)PLOGERR(klogErr, (klogErr, *rc, "Parsing SAM EXTRA_B: $(value)", "value=%s", value));
+        if (!self->quiet)
+            (void)PLOGERR(klogErr, (klogErr, *rc, "Parsing SAM EXTRA_B: $(value)", "value=%s", value));
         self->parser = PARSER_FUNCTION(EXTRA);
         return false;
     }
@@ -1360,6 +1363,7 @@ static SAM2BAM_Parser *parse(  char const *const data
                              , size_t const buffer_size
                              , RefNameLookupFunction lookup
                              , RefNameLookupContext *lookup_ctx
+                             , bool log
                              , rc_t *rc
                              )
 {
@@ -1370,6 +1374,7 @@ static SAM2BAM_Parser *parse(  char const *const data
 
     if (init(self, static_buffer, buffer_size, lookup, lookup_ctx) == NULL)
         goto OUT_OF_MEMORY;
+    self->quiet = !log;
     
     // LogSAM(klogErr, data, fields, offsets);
     self->record_chars = offsets[fields - 1] - 1;
@@ -1395,8 +1400,10 @@ static SAM2BAM_Parser *parse(  char const *const data
     
     if (*rc == 0) {
         *rc = RC(rcAlign, rcFile, rcReading, rcData, rcTooShort);
-        (void)LOGERR(klogErr, *rc, "Parsing SAM:");
-        LogSAM(klogInfo, data, fields, offsets);
+        if (!self->quiet) {
+            (void)LOGERR(klogErr, *rc, "Parsing SAM:");
+            LogSAM(klogInfo, data, fields, offsets);
+        }
     }
     if (self->rslt != static_buffer)
         free(self->rslt);
@@ -1416,10 +1423,11 @@ SAM2BAM_Parser *SAM2BAM_Parser_parse(  char const *const data
                                      , size_t const buffer_size
                                      , RefNameLookupFunction lookup
                                      , RefNameLookupContext *lookup_ctx
+                                     , bool log
                                      , rc_t *rc
                                      )
 {
-    return parse(data, fields, offsets, static_buffer, buffer_size, lookup, lookup_ctx, rc);
+    return parse(data, fields, offsets, static_buffer, buffer_size, lookup, lookup_ctx, log, rc);
 }
 
 SAM2BAM_Parser *SAM2BAM_Parser_initialize(  SAM2BAM_Parser *const self
@@ -61,6 +61,7 @@ struct SAM2BAM_Parser {
     int field;
     int state;  /**< each parser has its own idea of state; state is always 0 at start of field **/
     bool cr;
+    bool quiet; /**< parsing errors are not logged **/
 
     size_t extraArrayCountPos;
     number_parser numeric;
@@ -70,6 +71,9 @@ struct SAM2BAM_Parser {
 
 SAM2BAM_Parser *SAM2BAM_Parser_initialize(SAM2BAM_Parser *const self, void *const static_buffer, size_t const buffer_size, RefNameLookupFunction lookup, RefNameLookupContext *lookup_ctx);
 
+/** \brief parses one record, the fields are NUL-terminated and "offsets" has the start of the field following each one;
+ * with "log" false, the parsing errors are only returned; this allows parsing on several threads at once
+ **/
 SAM2BAM_Parser *SAM2BAM_Parser_parse(  char const *const data
                                      , unsigned const fields
                                      , unsigned const *const offsets
@@ -77,5 +81,6 @@ SAM2BAM_Parser *SAM2BAM_Parser_parse(  char const *const data
                                      , size_t const buffer_size
                                      , RefNameLookupFunction lookup
                                      , RefNameLookupContext *lookup_ctx
+                                     , bool log
                                      , rc_t *rc
                                      );
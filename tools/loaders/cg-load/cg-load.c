@@ -37,6 +37,9 @@
 
 #include <kfs/arc.h> /* KDirectoryOpenArcDirRead */
 #include <kfs/tar.h> /* KArcParseTAR */
+#include <kproc/queue.h> /* KQueueMake */
+#include <kproc/thread.h> /* KThreadMake */
+#include <kproc/timeout.h> /* TimeoutInit */
 
 #include <klib/out.h> /* OUTMSG */
 #include <klib/printf.h> /* string_printf */
@@ -74,6 +77,7 @@ typedef struct SParam_struct
     uint32_t force_refw;
     uint32_t force_readw;
     uint32_t no_read_ahead;
+    uint32_t parse_threads;
     const char* qual_quant;
     uint32_t no_spot_group;
     uint32_t min_mapq;
@@ -343,6 +347,8 @@ typedef struct FGroupMAP_struct {
     const CGLoaderFile* seq;
     const CGLoaderFile* align;
     const CGLoaderFile* tagLfr;
+    /* first SEQUENCE row of the group when it was parsed on a separate thread */
+    int64_t start_rowid;
 } FGroupMAP;
 
 static
@@ -414,6 +420,10 @@ bool CC FGroupMAP_FindRowId( BSTNode *node, void *data )
     const FGroupMAP* n = (const FGroupMAP*)node;
 
     if( FGroupMAP_Cmp(&d->key, node) == 0 ) {
+        if( n->start_rowid != 0 ) {
+            d->rowid = n->start_rowid;
+            return true;
+        }
         if( CGLoaderFile_GetStartRow(n->seq, &d->rowid) == 0 ) {
             return true;
         }
@@ -724,6 +734,381 @@ bool CC FGroupMAP_LoadReads( BSTNode *node, void *data )
     return d->rc != 0;
 }
 
+/* Parallel parsing of the reads groups:
+ * up to SParam::parse_threads groups are parsed ahead of the writer, each on
+ * its own thread, into batches of records queued per group. The groups are
+ * written one after another in the tree order used by FGroupMAP_LoadReads,
+ * so the database does not depend on the number of threads.
+ */
+#define PARSE_BATCH_RECORDS 4096
+#define PARSE_QUEUE_BATCHES 8
+
+typedef struct FGroupMAP_Record_struct {
+    uint32_t reads_format;
+    uint16_t flags;
+    uint16_t map_qty;
+    char read[CG_READS15_SPOT_LEN + 1];
+    char qual[CG_READS15_SPOT_LEN + 1];
+    uint64_t read_len;
+    uint64_t qual_len;
+    uint32_t spot_len;
+    /* offset and length in FGroupMAP_Batch::spot_group */
+    uint32_t spot_group;
+    uint32_t spot_group_len;
+    /* first mapping in FGroupMAP_Batch::map */
+    uint32_t map;
+} FGroupMAP_Record;
+
+typedef struct FGroupMAP_Batch_struct {
+    uint32_t qty;
+    uint32_t map_qty;
+    uint32_t map_max;
+    uint32_t spot_group_size;
+    uint32_t spot_group_max;
+    TMappingsData_map* map;
+    char* spot_group;
+    FGroupMAP_Record rec[PARSE_BATCH_RECORDS];
+} FGroupMAP_Batch;
+
+static
+void FGroupMAP_BatchWhack(FGroupMAP_Batch* b)
+{
+    if( b != NULL ) {
+        free(b->map);
+        free(b->spot_group);
+        free(b);
+    }
+}
+
+static
+rc_t FGroupMAP_BatchAdd(FGroupMAP_Batch* b, const TReadsData* reads, const TMappingsData* mappings)
+{
+    FGroupMAP_Record* r = &b->rec[b->qty];
+    const FGroupMAP_Record* prev = b->qty > 0 ? &b->rec[b->qty - 1] : NULL;
+    uint32_t sg_len = (uint32_t)reads->seq.spot_group.elements;
+
+    assert(b->qty < PARSE_BATCH_RECORDS);
+    if( b->map_qty + mappings->map_qty > b->map_max ) {
+        uint32_t max = b->map_max ? b->map_max : PARSE_BATCH_RECORDS;
+        TMappingsData_map* tmp;
+
+        while( max < b->map_qty + mappings->map_qty ) {
+            max *= 2;
+        }
+        if( (tmp = realloc(b->map, max * sizeof(*b->map))) == NULL ) {
+            return RC(rcExe, rcQueue, rcInserting, rcMemory, rcExhausted);
+        }
+        b->map = tmp;
+        b->map_max = max;
+    }
+    /* the spot group buffer belongs to the parser and the tag LFR parser
+       rewrites it with every record, so keep a copy unless it did not change */
+    if( sg_len == 0 ) {
+        r->spot_group = 0;
+    }
+    else if( prev != NULL && prev->spot_group_len == sg_len &&
+             memcmp(&b->spot_group[prev->spot_group], reads->seq.spot_group.buffer, sg_len) == 0 ) {
+        r->spot_group = prev->spot_group;
+    }
+    else {
+        if( b->spot_group_size + sg_len > b->spot_group_max ) {
+            uint32_t max = b->spot_group_max ? b->spot_group_max : 1024;
+            char* tmp;
+
+            while( max < b->spot_group_size + sg_len ) {
+                max *= 2;
+            }
+            if( (tmp = realloc(b->spot_group, max)) == NULL ) {
+                return RC(rcExe, rcQueue, rcInserting, rcMemory, rcExhausted);
+            }
+            b->spot_group = tmp;
+            b->spot_group_max = max;
+        }
+        memmove(&b->spot_group[b->spot_group_size], reads->seq.spot_group.buffer, sg_len);
+        r->spot_group = b->spot_group_size;
+        b->spot_group_size += sg_len;
+    }
+    r->spot_group_len = sg_len;
+    r->reads_format = reads->reads_format;
+    r->flags = reads->flags;
+    memmove(r->read, reads->read, sizeof(r->read));
+    memmove(r->qual, reads->qual, sizeof(r->qual));
+    r->read_len = reads->seq.sequence.elements;
+    r->qual_len = reads->seq.quality.elements;
+    r->spot_len = reads->seq.spot_len;
+    r->map = b->map_qty;
+    r->map_qty = mappings->map_qty;
+    memmove(&b->map[b->map_qty], mappings->map, mappings->map_qty * sizeof(*b->map));
+    b->map_qty += mappings->map_qty;
+    b->qty++;
+    return 0;
+}
+
+static
+void FGroupMAP_BatchGet(const FGroupMAP_Batch* b, uint32_t i, TReadsData* reads, TMappingsData* mappings)
+{
+    const FGroupMAP_Record* r = &b->rec[i];
+
+    reads->reads_format = r->reads_format;
+    reads->flags = r->flags;
+    memmove(reads->read, r->read, sizeof(reads->read));
+    memmove(reads->qual, r->qual, sizeof(reads->qual));
+    /* clear cache, set in algnment writer */
+    reads->reverse[0] = '\0';
+    reads->reverse[r->spot_len / 2] = '\0';
+    reads->seq.sequence.elements = r->read_len;
+    reads->seq.quality.elements = r->qual_len;
+    reads->seq.spot_len = r->spot_len;
+    if( r->spot_group_len != 0 ) {
+        reads->seq.spot_group.buffer = &b->spot_group[r->spot_group];
+        reads->seq.spot_group.elements = r->spot_group_len;
+    }
+    mappings->map_qty = r->map_qty;
+    memmove(mappings->map, &b->map[r->map], r->map_qty * sizeof(*mappings->map));
+}
+
+typedef struct FGroupMAP_Parser_struct {
+    FGroupMAP* group;
+    KThread* thread;
+    KQueue* queue;
+    /* private reads and mappings, d.rc is the parsing result */
+    FGroupMAP_LoadData d;
+} FGroupMAP_Parser;
+
+static
+rc_t FGroupMAP_ParserPush(FGroupMAP_Parser* p, FGroupMAP_Batch* b)
+{
+    rc_t rc;
+
+    do {
+        timeout_t tm;
+
+        TimeoutInit(&tm, 10000);
+        rc = KQueuePush(p->queue, b, &tm);
+    } while( rc != 0 && GetRCObject(rc) == (enum RCObject)rcTimeout && (rc = Quitting()) == 0 );
+    return rc;
+}
+
+static
+rc_t CC FGroupMAP_ParseThread(const KThread* self, void* data)
+{
+    FGroupMAP_Parser* p = (FGroupMAP_Parser*)data;
+    FGroupMAP* n = p->group;
+    FGroupMAP_LoadData* d = &p->d;
+    FGroupMAP_Batch* b = NULL;
+    bool done = false, abandoned = false;
+
+    DEBUG_MSG(5, (" parsing started\n", FGroupKey_Validate(&n->key)));
+    while( !done && d->rc == 0 ) {
+        TCtx ctx = eCtxRead;
+
+        if( b == NULL && (b = calloc(1, sizeof(*b))) == NULL ) {
+            d->rc = RC(rcExe, rcQueue, rcAllocating, rcMemory, rcExhausted);
+            break;
+        }
+        d->rc = CGLoaderFile_GetRead(n->seq, d->db.reads);
+        if( d->rc == 0 && n->tagLfr != NULL ) {
+            ctx = eCtxLfr;
+            d->rc = CGLoaderFile_GetTagLfr(n->tagLfr, d->db.reads);
+        }
+        if( d->rc == 0 ) {
+            if ((d->db.reads->flags
+                   & (cg_eLeftHalfDnbNoMatches | cg_eLeftHalfDnbMapOverflow))
+                &&
+                (d->db.reads->flags
+                   & (cg_eRightHalfDnbNoMatches | cg_eRightHalfDnbMapOverflow)))
+            {
+                d->db.mappings->map_qty = 0;
+            } else {
+                ctx = eCtxMapping;
+                d->rc = CGLoaderFile_GetMapping(n->align, d->db.mappings);
+            }
+            if( d->rc == 0 ) {
+                d->rc = FGroupMAP_BatchAdd(b, d->db.reads, d->db.mappings);
+            }
+        }
+        done = _FGroupMAPDone(n, ctx, d);
+        d->rc = d->rc ? d->rc : Quitting();
+        if( d->rc == 0 && b->qty > 0 && (done || b->qty == PARSE_BATCH_RECORDS) ) {
+            if( (d->rc = FGroupMAP_ParserPush(p, b)) == 0 ) {
+                b = NULL;
+            } else {
+                /* the writer has failed and sealed the queue */
+                abandoned = true;
+            }
+        }
+    }
+    FGroupMAP_BatchWhack(b);
+    KQueueSeal(p->queue);
+    if( d->rc != 0 && !abandoned ) {
+        CGLoaderFile_LOG(n->seq, klogErr, d->rc, NULL, NULL);
+        CGLoaderFile_LOG(n->align, klogErr, d->rc, NULL, NULL);
+    }
+    FGroupMAP_CloseFiles(n);
+    return d->rc;
+}
+
+static
+rc_t FGroupMAP_ParserStart(FGroupMAP_Parser* p, FGroupMAP* group, const SParam* param)
+{
+    rc_t rc;
+
+    memset(p, 0, sizeof(*p));
+    p->group = group;
+    p->d.param = param;
+    if( (p->d.db.reads = calloc(1, sizeof(*p->d.db.reads))) == NULL ||
+        (p->d.db.mappings = calloc(1, sizeof(*p->d.db.mappings))) == NULL ) {
+        rc = RC(rcExe, rcThread, rcCreating, rcMemory, rcExhausted);
+    }
+    else if( (rc = KQueueMake(&p->queue, PARSE_QUEUE_BATCHES)) != 0 ) {
+        LOGERR(klogErr, rc, "failed to create parsed records queue");
+    }
+    else if( (rc = KThreadMake(&p->thread, FGroupMAP_ParseThread, p)) != 0 ) {
+        LOGERR(klogErr, rc, "failed to start parsing thread");
+    }
+    return rc;
+}
+
+/* waits for the parsing thread and returns its result,
+   a parser which is not done yet is stopped */
+static
+rc_t FGroupMAP_ParserFinish(FGroupMAP_Parser* p)
+{
+    rc_t rc = 0;
+
+    if( p->queue != NULL ) {
+        KQueueSeal(p->queue);
+    }
+    if( p->thread != NULL ) {
+        rc_t rc1 = KThreadWait(p->thread, &rc);
+        rc = rc ? rc : rc1;
+        KThreadRelease(p->thread);
+    }
+    if( p->queue != NULL ) {
+        void* b = NULL;
+        timeout_t tm;
+
+        TimeoutInit(&tm, 0);
+        while( KQueuePop(p->queue, &b, &tm) == 0 ) {
+            FGroupMAP_BatchWhack(b);
+        }
+        KQueueRelease(p->queue);
+    }
+    free(p->d.db.reads);
+    free(p->d.db.mappings);
+    memset(p, 0, sizeof(*p));
+    return rc;
+}
+
+static
+rc_t FGroupMAP_WriteParsed(FGroupMAP_Parser* p, FGroupMAP_LoadData* d)
+{
+    rc_t rc = 0;
+    FGroupMAP* n = p->group;
+
+    n->start_rowid = d->db.reads->rowid;
+    while( rc == 0 ) {
+        void* item = NULL;
+        timeout_t tm;
+
+        TimeoutInit(&tm, 10000);
+        if( (rc = KQueuePop(p->queue, &item, &tm)) == 0 ) {
+            const FGroupMAP_Batch* b = item;
+            uint32_t i;
+
+            for(i = 0; rc == 0 && i < b->qty; i++) {
+                FGroupMAP_BatchGet(b, i, d->db.reads, d->db.mappings);
+/* alignment written 1st than sequence -> primary_alignment_id must be set!! */
+                if( (rc = CGWriterAlgn_Write(d->db.walgn, d->db.reads)) == 0 ) {
+                    rc = CGWriterSeq_Write(d->db.wseq);
+                }
+            }
+            FGroupMAP_BatchWhack(item);
+            if( rc != 0 ) {
+                CGLoaderFile_LOG(n->seq, klogErr, rc, NULL, NULL);
+                CGLoaderFile_LOG(n->align, klogErr, rc, NULL, NULL);
+            }
+            rc = rc ? rc : Quitting();
+        }
+        else if( GetRCObject(rc) == (enum RCObject)rcTimeout ) {
+            rc = Quitting();
+        }
+        else if( GetRCState(rc) == rcDone ) {
+            /* the queue is sealed and empty */
+            rc = 0;
+            break;
+        }
+    }
+    return rc;
+}
+
+typedef struct FGroupMAP_List_struct {
+    FGroupMAP** group;
+    uint32_t qty;
+} FGroupMAP_List;
+
+static
+void CC FGroupMAP_Collect(BSTNode *node, void *data)
+{
+    FGroupMAP_List* l = (FGroupMAP_List*)data;
+
+    if( l->group != NULL ) {
+        l->group[l->qty] = (FGroupMAP*)node;
+    }
+    l->qty++;
+}
+
+static
+rc_t FGroupMAP_LoadReadsParallel(const BSTree* slides, FGroupMAP_LoadData* d)
+{
+    rc_t rc = 0;
+    uint32_t threads = d->param->parse_threads;
+    FGroupMAP_List list;
+    FGroupMAP_Parser* parser;
+
+    memset(&list, 0, sizeof(list));
+    BSTreeForEach(slides, false, FGroupMAP_Collect, &list);
+    if( list.qty == 0 ) {
+        return 0;
+    }
+    if( threads > list.qty ) {
+        threads = list.qty;
+    }
+    list.group = malloc(list.qty * sizeof(*list.group));
+    parser = calloc(threads, sizeof(*parser));
+    if( list.group == NULL || parser == NULL ) {
+        rc = RC(rcExe, rcThread, rcCreating, rcMemory, rcExhausted);
+    }
+    else {
+        uint32_t i, next = 0;
+
+        list.qty = 0;
+        BSTreeForEach(slides, false, FGroupMAP_Collect, &list);
+        for(i = 0; rc == 0 && i < list.qty; i++) {
+            FGroupMAP_Parser* p = &parser[i % threads];
+            rc_t rc1;
+
+            /* keep the following groups parsing while this one is written */
+            while( rc == 0 && next < list.qty && next < i + threads ) {
+                rc = FGroupMAP_ParserStart(&parser[next % threads], list.group[next], d->param);
+                next++;
+            }
+            if( rc == 0 ) {
+                rc = FGroupMAP_WriteParsed(p, d);
+            }
+            rc1 = FGroupMAP_ParserFinish(p);
+            rc = rc ? rc : rc1;
+        }
+        /* stop the groups parsed ahead after a failure */
+        for(i = 0; i < threads; i++) {
+            FGroupMAP_ParserFinish(&parser[i]);
+        }
+    }
+    free(parser);
+    free(list.group);
+    return rc;
+}
+
 bool CC FGroupMAP_LoadEvidence( BSTNode *node, void *data )
 {
     FGroupMAP* n = (FGroupMAP*)node;
@@ -893,7 +1278,10 @@ static rc_t Load( SParam* param )
                     rc = DB_Init( param, &data.db );
                     if ( rc == 0 )
                     {
-                        BSTreeDoUntil( &slides, false, FGroupMAP_LoadReads, &data );
+                        if ( param->parse_threads > 0 )
+                            data.rc = FGroupMAP_LoadReadsParallel( &slides, &data );
+                        else
+                            BSTreeDoUntil( &slides, false, FGroupMAP_LoadReads, &data );
                         rc = data.rc;
                         if ( rc == 0 )
                         {
@@ -967,6 +1355,7 @@ const char* single_mate_usage[] = {"if secondary mates have duplicates preserve
 const char* cluster_size_usage[] = {"defines cluster window on the reference, records only 1 placement from given cluster size; default is zero which means ignore", NULL};
 const char* no_read_ahead_usage[] = {"disable input files threaded caching", NULL};
 const char* library_usage[] = {"copy extra file/directory into output", NULL};
+const char* parse_threads_usage[] = {"number of reads groups parsed ahead on separate threads while writing; default is zero which means parse and write on one thread", NULL};
 
 /* this enum must have same order as MainArgs array below */
 enum OptDefIndex {
@@ -989,7 +1378,8 @@ enum OptDefIndex {
     eopt_SingleMate,
     eopt_ClusterSize,
     eopt_noReadAhead,
-    eopt_Library
+    eopt_Library,
+    eopt_ParseThreads
 };
 
 OptDef MainArgs[] =
@@ -1015,7 +1405,8 @@ OptDef MainArgs[] =
     { "single-mate",      NULL, NULL, single_mate_usage,    1, false, false },
     { "cluster-size",     NULL, NULL, cluster_size_usage,   1, true,  false },
     { "input-no-threads", "t",  NULL, no_read_ahead_usage,  1, false, false },
-    { "library",          "l",  NULL, library_usage,        1, true,  false }
+    { "library",          "l",  NULL, library_usage,        1, true,  false },
+    { "parse-threads",    NULL, NULL, parse_threads_usage,  1, true,  false }
 };
 const size_t MainArgsQty = sizeof(MainArgs) / sizeof(MainArgs[0]);
 
@@ -1070,7 +1461,7 @@ rc_t CC KMain( int argc, char* argv[] )
 {
     rc_t rc = 0;
     Args* args = NULL;
-    const char* errmsg = NULL, *refseq_chunk = NULL, *min_mapq = NULL, *cluster_size = NULL;
+    const char* errmsg = NULL, *refseq_chunk = NULL, *min_mapq = NULL, *cluster_size = NULL, *parse_threads = NULL;
     const XMLLogger* xml_logger = NULL;
     SParam params;
     memset(&params, 0, sizeof(params));
@@ -1177,6 +1568,12 @@ rc_t CC KMain( int argc, char* argv[] )
         } else if( (rc = ArgsOptionCount(args, MainArgs[eopt_SingleMate].name, &params.single_mate)) != 0 ) {
             errmsg = MainArgs[eopt_SingleMate].name;
 
+        } else if( (rc = ArgsOptionCount(args, MainArgs[eopt_ParseThreads].name, &count)) != 0 || count > 1 ) {
+            rc = rc ? rc : RC(rcExe, rcArgv, rcParsing, rcParam, rcExcessive);
+            errmsg = MainArgs[eopt_ParseThreads].name;
+        } else if( count > 0 && (rc = ArgsOptionValue(args, MainArgs[eopt_ParseThreads].name, 0, (const void **)&parse_threads)) != 0 ) {
+            errmsg = MainArgs[eopt_ParseThreads].name;
+
         } else {
             do {
                 long val = 0;
@@ -1217,6 +1614,17 @@ rc_t CC KMain( int argc, char* argv[] )
                     params.min_mapq = val;
                 }
 
+                if( parse_threads != NULL ) {
+                    errno = 0;
+                    val = strtol(parse_threads, &end, 10);
+                    if( errno != 0 || parse_threads == end || *end != '\0' || val < 0 || val > 64 ) {
+                        rc = RC(rcExe, rcArgv, rcReading, rcParam, rcInvalid);
+                        errmsg = MainArgs[eopt_ParseThreads].name;
+                        break;
+                    }
+                    params.parse_threads = val;
+                }
+
                 if ( cluster_size )
                     params.cluster_size = atoi( cluster_size );
                 else
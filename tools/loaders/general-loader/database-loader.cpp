@@ -42,18 +42,306 @@
 
 #include <kapp/main.h>
 
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+
 #include <loader/loader-meta.h>
 
 #include <algorithm>
+#include <cstring>
 
 using namespace std;
 
+///////////// GeneralLoader::DatabaseLoader::TableWriter
+
+GeneralLoader :: DatabaseLoader :: TableWriter :: TableWriter ( VCursor * p_cursor )
+:   m_cursor ( p_cursor ),
+    m_thread ( 0 ),
+    m_lock ( 0 ),
+    m_cond ( 0 ),
+    m_current ( new Batch () ),
+    m_busy ( false ),
+    m_stopping ( false ),
+    m_rc ( 0 )
+{
+}
+
+GeneralLoader :: DatabaseLoader :: TableWriter :: ~TableWriter ()
+{
+    if ( m_thread != 0 )
+    {   // not finished: drop whatever is still queued
+        KLockAcquire ( m_lock );
+        m_stopping = true;
+        for ( vector < Batch * > :: iterator it = m_queue . begin (); it != m_queue . end (); ++it )
+        {
+            delete *it;
+        }
+        m_queue . clear ();
+        KConditionBroadcast ( m_cond );
+        KLockUnlock ( m_lock );
+
+        rc_t status;
+        KThreadWait ( m_thread, & status );
+        KThreadRelease ( m_thread );
+    }
+    for ( vector < Batch * > :: iterator it = m_free . begin (); it != m_free . end (); ++it )
+    {
+        delete *it;
+    }
+    delete m_current;
+    KConditionRelease ( m_cond );
+    KLockRelease ( m_lock );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Start ()
+{
+    rc_t rc = KLockMake ( & m_lock );
+    if ( rc == 0 )
+    {
+        rc = KConditionMake ( & m_cond );
+        if ( rc == 0 )
+        {
+            rc = KThreadMake ( & m_thread, ThreadFunc, this );
+        }
+    }
+    return rc;
+}
+
+rc_t CC
+GeneralLoader :: DatabaseLoader :: TableWriter :: ThreadFunc ( const KThread * p_self, void * p_data )
+{
+    return static_cast < TableWriter * > ( p_data ) -> Run ();
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Run ()
+{
+    rc_t rc = KLockAcquire ( m_lock );
+    while ( rc == 0 )
+    {
+        while ( m_queue . empty () && ! m_stopping )
+        {
+            KConditionWait ( m_cond, m_lock );
+        }
+        if ( m_queue . empty () )
+        {
+            break;
+        }
+
+        Batch * batch = m_queue . front ();
+        m_queue . erase ( m_queue . begin () );
+        m_busy = true;
+        bool failed = ( m_rc != 0 );
+        KLockUnlock ( m_lock );
+
+        // after an error, batches are only drained
+        rc_t rc2 = failed ? 0 : Execute ( * batch );
+        batch -> commands . clear ();
+        batch -> data . clear ();
+
+        rc = KLockAcquire ( m_lock );
+        if ( rc == 0 )
+        {
+            if ( m_rc == 0 )
+            {
+                m_rc = rc2;
+            }
+            m_free . push_back ( batch );
+            m_busy = false;
+            KConditionBroadcast ( m_cond );
+        }
+    }
+    if ( rc == 0 )
+    {
+        KLockUnlock ( m_lock );
+    }
+    return rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Execute ( const Batch& p_batch )
+{
+    rc_t rc = 0;
+    for ( vector < Command > :: const_iterator it = p_batch . commands . begin (); rc == 0 && it != p_batch . commands . end (); ++it )
+    {
+        const void * data = it -> offset == NoData ? 0 : & p_batch . data [ it -> offset ];
+        switch ( it -> type )
+        {
+        case cmdWrite:
+            rc = VCursorWrite ( m_cursor, it -> columnIdx, it -> elemBits, data, 0, it -> count );
+            break;
+        case cmdDefault:
+            rc = VCursorDefault ( m_cursor, it -> columnIdx, it -> elemBits, data, 0, it -> count );
+            break;
+        case cmdNextRow:
+            for ( uint64_t i = 0; rc == 0 && i < it -> count; ++i )
+            {
+                rc = VCursorCommitRow ( m_cursor );
+                if ( rc == 0 )
+                {
+                    rc = VCursorCloseRow ( m_cursor );
+                    if ( rc == 0 )
+                    {
+                        rc = VCursorOpenRow ( m_cursor );
+                    }
+                }
+            }
+            break;
+        case cmdCommit:
+            rc = VCursorCloseRow ( m_cursor );
+            if ( rc == 0 )
+            {
+                rc = VCursorCommit ( m_cursor );
+            }
+            break;
+        }
+    }
+    return rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Add ( CommandType p_type, const Column* p_col, const void* p_data, size_t p_elemCount )
+{
+    Command cmd;
+    cmd . type      = p_type;
+    cmd . columnIdx = p_col == 0 ? 0 : p_col -> columnIdx;
+    cmd . elemBits  = p_col == 0 ? 0 : p_col -> elemBits;
+    cmd . count     = p_elemCount;
+    cmd . offset    = NoData;
+
+    if ( p_col != 0 && p_data != 0 )
+    {   // the parser's buffer will be gone by the time this gets written
+        size_t bytes = ( ( size_t ) p_col -> elemBits * p_elemCount + 7 ) / 8;
+        cmd . offset = m_current -> data . size ();
+        m_current -> data . resize ( cmd . offset + bytes );
+        if ( bytes != 0 )
+        {
+            memmove ( & m_current -> data [ cmd . offset ], p_data, bytes );
+        }
+    }
+    m_current -> commands . push_back ( cmd );
+
+    if ( m_current -> data . size () + m_current -> commands . size () * sizeof ( Command ) >= BatchBytes )
+    {
+        return Submit ();
+    }
+    return 0;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Submit ()
+{
+    rc_t rc = KLockAcquire ( m_lock );
+    if ( rc == 0 )
+    {
+        while ( m_queue . size () >= MaxQueued && m_rc == 0 )
+        {
+            KConditionWait ( m_cond, m_lock );
+        }
+        rc = m_rc;
+        if ( rc == 0 && ! m_current -> commands . empty () )
+        {
+            m_queue . push_back ( m_current );
+            if ( m_free . empty () )
+            {
+                m_current = 0;
+            }
+            else
+            {
+                m_current = m_free . back ();
+                m_free . pop_back ();
+            }
+            KConditionBroadcast ( m_cond );
+        }
+        KLockUnlock ( m_lock );
+
+        if ( m_current == 0 )
+        {
+            m_current = new Batch ();
+        }
+    }
+    return rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Write ( const Column& p_col, const void* p_data, size_t p_elemCount )
+{
+    return Add ( cmdWrite, & p_col, p_data, p_elemCount );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Default ( const Column& p_col, const void* p_data, size_t p_elemCount )
+{
+    return Add ( cmdDefault, & p_col, p_data, p_elemCount );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: NextRow ( uint64_t p_count )
+{
+    return Add ( cmdNextRow, 0, 0, p_count );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Flush ()
+{
+    rc_t rc = Submit ();
+    if ( rc == 0 )
+    {
+        rc = KLockAcquire ( m_lock );
+        if ( rc == 0 )
+        {
+            while ( ( ! m_queue . empty () || m_busy ) && m_rc == 0 )
+            {
+                KConditionWait ( m_cond, m_lock );
+            }
+            rc = m_rc;
+            KLockUnlock ( m_lock );
+        }
+    }
+    return rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Finish ()
+{
+    rc_t rc = Add ( cmdCommit, 0, 0, 0 );
+    if ( rc == 0 )
+    {
+        rc = Flush ();
+    }
+
+    rc_t rc2 = KLockAcquire ( m_lock );
+    if ( rc2 == 0 )
+    {
+        m_stopping = true;
+        KConditionBroadcast ( m_cond );
+        KLockUnlock ( m_lock );
+
+        rc_t status;
+        rc2 = KThreadWait ( m_thread, & status );
+        if ( rc2 == 0 )
+        {
+            rc2 = status;
+        }
+        KThreadRelease ( m_thread );
+        m_thread = 0;
+    }
+    if ( rc == 0 )
+    {
+        rc = rc2;
+    }
+    return rc;
+}
+
 ///////////// GeneralLoader::DatabaseLoader
 
 GeneralLoader :: DatabaseLoader :: DatabaseLoader ( const std::string&  p_programName,
                                                     const Paths&        p_includePaths,
                                                     const Paths&        p_schemas,
-                                                    const std::string&  p_dbNameOverride )
+                                                    const std::string&  p_dbNameOverride,
+                                                    bool                p_parallelTables )
 :   m_includePaths ( p_includePaths ),
     m_schemas ( p_schemas ),
     m_programName ( p_programName ),
@@ -61,14 +349,18 @@ GeneralLoader :: DatabaseLoader :: DatabaseLoader ( const std::string&  p_progra
     m_softwareVersion ( 0 ),
     m_mgr ( 0 ),
     m_schema ( 0 ),
-    m_databaseNameOverridden ( ! m_databaseName.empty() )
+    m_databaseNameOverridden ( ! m_databaseName.empty() ),
+    m_parallelTables ( p_parallelTables )
 {
     m_databases . insert ( Databases :: value_type ( 0, (VDatabase*)0 ) ); // reserve root database
 }
 
 GeneralLoader :: DatabaseLoader :: ~DatabaseLoader ()
 {
+    DeleteWriters ();
+
     m_tables . clear();
+    m_columnIndex . clear ();
     m_columns . clear ();
 
     for ( Cursors::iterator it = m_cursors . begin(); it != m_cursors . end(); ++it )
@@ -95,7 +387,7 @@ GeneralLoader :: DatabaseLoader :: ~DatabaseLoader ()
 }
 
 const GeneralLoader :: DatabaseLoader :: Column*
-GeneralLoader :: DatabaseLoader :: GetColumn ( uint32_t p_columnId ) const
+GeneralLoader :: DatabaseLoader :: FindColumn ( uint32_t p_columnId ) const
 {
     Columns::const_iterator curIt = m_columns . find ( p_columnId );
     if ( curIt != m_columns . end () )
@@ -319,6 +611,14 @@ GeneralLoader :: DatabaseLoader :: NewColumn ( uint32_t p_columnId, uint32_t p_t
                 col . elemBits  = p_elemBits;
                 col . flagBits  = p_flagBits;
                 m_columns [ p_columnId ] = col;
+                if ( p_columnId < MaxIndexedColumnId )
+                {
+                    if ( p_columnId >= m_columnIndex . size () )
+                    {
+                        m_columnIndex . resize ( p_columnId + 1, 0 );
+                    }
+                    m_columnIndex [ p_columnId ] = & m_columns [ p_columnId ];
+                }
                 pLogMsg ( klogDebug,
                           "database-loader: tableId = $(t), added column '$(c)', columnIdx = $(i1), elemBits = $(i2), flagBits = $(i3)",
                           "t=%u,c=%s,i1=%u,i2=%u,i3=%u",
@@ -449,7 +749,12 @@ GeneralLoader :: DatabaseLoader :: DBMetadataNode ( uint32_t p_objId, const stri
               "n=%s,v=%s,i=%u",
               p_metadata_node . c_str(), p_value.c_str(), p_objId );
 
-    rc_t rc = 0;
+    rc_t rc = FlushWriters ();
+    if ( rc != 0 )
+    {
+        return rc;
+    }
+
     Databases::iterator it = m_databases . find ( p_objId );
     if ( it != m_databases . end() )
     {
@@ -487,6 +792,14 @@ GeneralLoader :: DatabaseLoader :: TblMetadataNode ( uint32_t p_objId, const str
     {
         struct VTable* tbl;
         assert ( m_cursors [ it -> second . cursorIdx ] );
+        if ( ! m_writers . empty () )
+        {   // the table must not be written to while its metadata is updated
+            rc = m_writers [ it -> second . cursorIdx ] -> Flush ();
+            if ( rc != 0 )
+            {
+                return rc;
+            }
+        }
         rc = VCursorOpenParentUpdate ( m_cursors [ it -> second . cursorIdx ], &tbl );
         if ( rc == 0 )
         {
@@ -603,9 +916,55 @@ GeneralLoader :: DatabaseLoader :: SaveColumnMetadata ( const Column& p_col )
     return rc;
 }
 
+rc_t
+GeneralLoader :: DatabaseLoader :: StartWriters ()
+{
+    assert ( m_writers . empty () );
+    for ( Cursors::iterator it = m_cursors . begin(); it != m_cursors . end(); ++it )
+    {
+        TableWriter * writer = new TableWriter ( *it );
+        m_writers . push_back ( writer );
+        rc_t rc = writer -> Start ();
+        if ( rc != 0 )
+        {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: FlushWriters ()
+{
+    rc_t rc = 0;
+    for ( Writers::iterator it = m_writers . begin(); it != m_writers . end(); ++it )
+    {
+        rc_t rc2 = ( *it ) -> Flush ();
+        if ( rc == 0 )
+        {
+            rc = rc2;
+        }
+    }
+    return rc;
+}
+
+void
+GeneralLoader :: DatabaseLoader :: DeleteWriters ()
+{
+    for ( Writers::iterator it = m_writers . begin(); it != m_writers . end(); ++it )
+    {
+        delete *it;
+    }
+    m_writers . clear ();
+}
+
 rc_t
 GeneralLoader :: DatabaseLoader :: CursorWrite ( const struct Column& p_col, const void* p_data, size_t p_size )
 {
+    if ( ! m_writers . empty () )
+    {
+        return m_writers [ p_col . cursorIdx ] -> Write ( p_col, p_data, p_size );
+    }
     return VCursorWrite ( m_cursors [ p_col . cursorIdx ],
                           p_col . columnIdx,
                           p_col . elemBits,
@@ -617,6 +976,10 @@ GeneralLoader :: DatabaseLoader :: CursorWrite ( const struct Column& p_col, con
 rc_t
 GeneralLoader :: DatabaseLoader :: CursorDefault ( const struct Column& p_col, const void* p_data, size_t p_size )
 {
+    if ( ! m_writers . empty () )
+    {
+        return m_writers [ p_col . cursorIdx ] -> Default ( p_col, p_data, p_size );
+    }
     return VCursorDefault ( m_cursors [ p_col . cursorIdx ],
                             p_col . columnIdx,
                             p_col . elemBits,
@@ -628,22 +991,22 @@ GeneralLoader :: DatabaseLoader :: CursorDefault ( const struct Column& p_col, c
 rc_t
 GeneralLoader :: DatabaseLoader :: CellData ( uint32_t p_columnId, const void* p_data, size_t p_elemCount )
 {
-    rc_t rc = 0;
-    Columns::const_iterator curIt = m_columns . find ( p_columnId );
-    if ( curIt != m_columns . end () )
+    const Column* col = GetColumn ( p_columnId );
+    if ( col == 0 )
     {
-        const Column& col = curIt -> second;
-        pLogMsg ( klogDebug,
-                  "database-loader: columnIdx = $(i), elem size=$(s) bits, elem count=$(c)",
-                  "i=%u,s=%u,c=%u",
-                  col . columnIdx, col . elemBits, p_elemCount );
-        rc = CursorWrite ( col, p_data, p_elemCount );
-    }
-    else
-    {
-        rc = RC ( rcExe, rcFile, rcReading, rcColumn, rcNotFound );
+        return RC ( rcExe, rcFile, rcReading, rcColumn, rcNotFound );
     }
-    return rc;
+    return CellData ( *col, p_data, p_elemCount );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: CellData ( const Column& p_col, const void* p_data, size_t p_elemCount )
+{   // the column has been looked up by the parser already
+    PLOGMSG ( klogDebug, ( klogDebug,
+              "database-loader: columnIdx = $(i), elem size=$(s) bits, elem count=$(c)",
+              "i=%u,s=%u,c=%u",
+              p_col . columnIdx, p_col . elemBits, p_elemCount ) );
+    return CursorWrite ( p_col, p_data, p_elemCount );
 }
 
 rc_t
@@ -740,6 +1103,10 @@ GeneralLoader :: DatabaseLoader :: OpenStream ()
                 break;
             }
         }
+        if ( rc == 0 && m_parallelTables )
+        {
+            rc = StartWriters ();
+        }
     }
     return rc;
 }
@@ -750,30 +1117,52 @@ GeneralLoader :: DatabaseLoader :: CloseStream ()
     rc_t rc = 0;
     rc_t rc2 = 0;
 
+    bool committed = false;
+    if ( ! m_writers . empty () )
+    {   // the writers close the last row and commit on their own threads, all tables at once
+        for ( Writers::iterator it = m_writers . begin(); it != m_writers . end(); ++it )
+        {
+            rc2 = ( *it ) -> Finish ();
+            if ( rc == 0 )
+            {
+                rc = rc2;
+            }
+        }
+        DeleteWriters ();
+        if ( rc != 0 )
+        {
+            return rc;
+        }
+        committed = true;
+    }
+
     for ( Cursors::iterator it = m_cursors . begin(); it != m_cursors . end(); ++it )
     {
-        rc = VCursorCloseRow ( *it );
+        if ( ! committed )
+        {
+            rc = VCursorCloseRow ( *it );
+            if ( rc == 0 )
+            {
+                rc = VCursorCommit ( *it );
+            }
+        }
         if ( rc == 0 )
         {
-            rc = VCursorCommit ( *it );
+            struct VTable* table;
+            rc = VCursorOpenParentUpdate ( *it, &table );
             if ( rc == 0 )
             {
-                struct VTable* table;
-                rc = VCursorOpenParentUpdate ( *it, &table );
-                if ( rc == 0 )
-                {
-                    rc = VCursorRelease ( *it );
-                    if ( rc == 0 )
-                    {
-                        rc = VTableReindex ( table );
-                    }
-                }
-                rc2 = VTableRelease ( table );
+                rc = VCursorRelease ( *it );
                 if ( rc == 0 )
                 {
-                    rc = rc2;
+                    rc = VTableReindex ( table );
                 }
             }
+            rc2 = VTableRelease ( table );
+            if ( rc == 0 )
+            {
+                rc = rc2;
+            }
         }
         if ( rc != 0 )
         {
@@ -808,7 +1197,11 @@ GeneralLoader :: DatabaseLoader :: NextRow ( uint32_t p_tableId )
 {
     rc_t rc = 0;
     Tables::const_iterator table = m_tables . find ( p_tableId );
-    if ( table != m_tables . end() )
+    if ( table != m_tables . end() && ! m_writers . empty () )
+    {
+        rc = m_writers [ table -> second . cursorIdx ] -> NextRow ( 1 );
+    }
+    else if ( table != m_tables . end() )
     {
         VCursor * cursor = m_cursors [ table -> second . cursorIdx ];
         rc = VCursorCommitRow ( cursor );
@@ -833,7 +1226,11 @@ GeneralLoader :: DatabaseLoader :: MoveAhead ( uint32_t p_tableId, uint64_t p_co
 {
     rc_t rc = 0;
     Tables::const_iterator table = m_tables . find ( p_tableId );
-    if ( table != m_tables . end() )
+    if ( table != m_tables . end() && ! m_writers . empty () )
+    {
+        rc = m_writers [ table -> second . cursorIdx ] -> NextRow ( p_count );
+    }
+    else if ( table != m_tables . end() )
     {
         VCursor * cursor = m_cursors [ table -> second . cursorIdx ];
         for ( uint64_t i = 0; i < p_count; ++i )
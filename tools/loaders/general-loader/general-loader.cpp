@@ -35,14 +35,22 @@
 
 #include <general-writer/general-writer.h>
 
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
 using namespace std;
 
 ///////////// GeneralLoader::Reader
 
 GeneralLoader::Reader::Reader( const struct KStream& p_input )
 :   m_input ( p_input ),
+    m_block ( 0 ),
+    m_blockPos ( 0 ),
+    m_blockEnd ( 0 ),
     m_buffer ( 0 ),
     m_bufSize ( 0 ),
+    m_data ( 0 ),
     m_readCount ( 0 )
 {
     KStreamAddRef ( & m_input );
@@ -51,39 +59,121 @@ GeneralLoader::Reader::Reader( const struct KStream& p_input )
 GeneralLoader::Reader::~Reader()
 {
     KStreamRelease ( & m_input );
+    free ( m_block );
     free ( m_buffer );
 }
 
+rc_t
+GeneralLoader::Reader::Fill( size_t p_size )
+{
+    assert ( p_size <= BlockSize );
+
+    if ( m_block == 0 )
+    {
+        m_block = ( uint8_t * ) malloc ( BlockSize );
+        if ( m_block == 0 )
+        {
+            return RC ( rcExe, rcFile, rcReading, rcMemory, rcExhausted );
+        }
+    }
+
+    // move the unconsumed tail to the front
+    size_t avail = Available ();
+    if ( m_blockPos != 0 )
+    {
+        memmove ( m_block, m_block + m_blockPos, avail );
+        m_blockPos = 0;
+        m_blockEnd = avail;
+    }
+
+    // take whatever the stream has, but do not wait for more than is needed
+    while ( m_blockEnd < p_size )
+    {
+        size_t num_read;
+        rc_t rc = KStreamRead ( & m_input, m_block + m_blockEnd, BlockSize - m_blockEnd, & num_read );
+        if ( rc != 0 )
+        {
+            return rc;
+        }
+        if ( num_read == 0 )
+        {
+            return RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+        }
+        m_blockEnd += num_read;
+    }
+    return 0;
+}
+
 rc_t
 GeneralLoader::Reader::Read( void * p_buffer, size_t p_size )
 {
-    pLogMsg ( klogDebug,
+    PLOGMSG ( klogDebug, ( klogDebug,
              "general-loader: reading $(s) bytes, offset=$(o)",
              "s=%u,o=%lu",
-             ( unsigned int ) p_size, m_readCount );
+             ( unsigned int ) p_size, m_readCount ) );
+
+    if ( Available () < p_size )
+    {
+        if ( p_size > BlockSize )
+        {   // drain the block, the rest goes straight to the caller
+            size_t avail = Available ();
+            if ( avail != 0 )
+            {
+                memmove ( p_buffer, m_block + m_blockPos, avail );
+            }
+            m_blockPos = m_blockEnd = 0;
+            m_readCount += p_size;
+            return KStreamReadExactly ( & m_input, ( uint8_t * ) p_buffer + avail, p_size - avail );
+        }
+
+        rc_t rc = Fill ( p_size );
+        if ( rc != 0 )
+        {
+            return rc;
+        }
+    }
 
+    memmove ( p_buffer, m_block + m_blockPos, p_size );
+    m_blockPos += p_size;
     m_readCount += p_size;
-    return KStreamReadExactly ( & m_input, p_buffer, p_size );
+    return 0;
 }
 
 rc_t
 GeneralLoader::Reader::Read( size_t p_size )
 {
+    PLOGMSG ( klogDebug, ( klogDebug, "general-loader: reading $(s) bytes", "s=%u", ( unsigned int ) p_size ) );
+
+    if ( p_size <= BlockSize )
+    {
+        if ( Available () < p_size )
+        {
+            rc_t rc = Fill ( p_size );
+            if ( rc != 0 )
+            {
+                return rc;
+            }
+        }
+        // hand out the bytes where they are
+        m_data = m_block + m_blockPos;
+        m_blockPos += p_size;
+        m_readCount += p_size;
+        return 0;
+    }
+
     if ( p_size > m_bufSize )
     {
-        m_buffer = realloc ( m_buffer, p_size );
-        if ( m_buffer == 0 )
+        void * buffer = realloc ( m_buffer, p_size );
+        if ( buffer == 0 )
         {
-            m_bufSize = 0;
-            m_readCount = 0;
             return RC ( rcExe, rcFile, rcReading, rcMemory, rcExhausted );
         }
+        m_buffer = buffer;
+        m_bufSize = p_size;
     }
 
-    pLogMsg ( klogDebug, "general-loader: reading $(s) bytes", "s=%u", ( unsigned int ) p_size );
-
-    m_readCount += p_size;
-    return KStreamReadExactly ( & m_input, m_buffer, p_size );
+    m_data = m_buffer;
+    return Read ( m_buffer, p_size );
 }
 
 void
@@ -100,7 +190,8 @@ GeneralLoader::Reader::Align( uint8_t p_bytes )
 
 GeneralLoader::GeneralLoader ( const std::string& p_programName, const struct KStream& p_input )
 :   m_programName ( p_programName ),
-    m_reader ( p_input )
+    m_reader ( p_input ),
+    m_parallelTables ( false )
 {
 }
 
@@ -147,7 +238,7 @@ GeneralLoader::Run()
     rc_t rc = ReadHeader ( packed );
     if ( rc == 0 )
     {
-        DatabaseLoader loader ( m_programName, m_includePaths, m_schemas, m_targetOverride );
+        DatabaseLoader loader ( m_programName, m_includePaths, m_schemas, m_targetOverride, m_parallelTables );
         if ( packed )
         {
             PackedProtocolParser p;
@@ -34,6 +34,9 @@
 #include <map>
 
 struct KStream;
+struct KThread;
+struct KLock;
+struct KCondition;
 struct VCursor;
 struct VDatabase;
 struct VDBManager;
@@ -53,6 +56,7 @@ public:
     void AddSchemaIncludePath( const std::string& p_path );
     void AddSchemaFile( const std::string& p_file );
     void SetTargetOverride( const std::string& p_path );
+    void SetParallelTables( bool p_parallel ) { m_parallelTables = p_parallel; }
     
     rc_t Run ();
     
@@ -72,18 +76,36 @@ private:
         rc_t Read( void * p_buffer, size_t p_size ); 
         
         // if rc == 0, there are p_size bytes available through GetBuffer until the next call to Read
+        // unless p_size exceeds the read-ahead block, they are not copied
         rc_t Read( size_t p_size ); 
         
-        const void* GetBuffer() const { return m_buffer; }
+        const void* GetBuffer() const { return m_data; }
         
         void Align( uint8_t p_bytes = 4 );
         
         uint64_t GetReadCount() { return m_readCount; }
         
+    private:
+        static const size_t BlockSize = 1024 * 1024;
+
+        size_t Available () const { return m_blockEnd - m_blockPos; }
+
+        // make sure there are at least p_size bytes in the read-ahead block
+        rc_t Fill( size_t p_size );
+
     private:
         const struct KStream& m_input;
+
+        // read-ahead block, events are parsed straight out of it
+        uint8_t* m_block;
+        size_t m_blockPos;
+        size_t m_blockEnd;
+
+        // payloads too big for the block are assembled here
         void* m_buffer;
         size_t m_bufSize;
+
+        const void* m_data;
         uint64_t m_readCount;
     };
     
@@ -114,7 +136,11 @@ private:
         };
 
     public:
-        DatabaseLoader ( const std :: string& p_programName, const Paths& p_includePaths, const Paths& p_schemas, const std::string& p_dbNameOverride = std::string() );
+        DatabaseLoader ( const std :: string& p_programName, 
+                         const Paths& p_includePaths, 
+                         const Paths& p_schemas, 
+                         const std::string& p_dbNameOverride = std::string(),
+                         bool p_parallelTables = false );
         ~DatabaseLoader();
     
         rc_t UseSchema ( const std :: string& p_file, const std :: string& p_name );
@@ -135,6 +161,7 @@ private:
         rc_t AddMbrTbl ( uint32_t p_objId, uint32_t p_parentId, const std :: string &mbr_name, const std :: string &db_name, uint8_t p_create_mode );
         
         rc_t CellData    ( uint32_t p_columnId, const void* p_data, size_t p_elemCount );
+        rc_t CellData    ( const Column& p_col, const void* p_data, size_t p_elemCount );
         rc_t CellDefault ( uint32_t p_columnId, const void* p_data, size_t p_elemCount );
         rc_t NextRow ( uint32_t p_tableId );
         rc_t MoveAhead ( uint32_t p_tableId, uint64_t p_count );
@@ -145,18 +172,95 @@ private:
         rc_t CloseStream ();
         
         const std :: string& GetDatabaseName() const { return m_databaseName; }
-        const Column* GetColumn ( uint32_t p_columnId ) const; 
+        const Column* GetColumn ( uint32_t p_columnId ) const
+        {   // every data event looks up its column: go through the dense index if the id is small enough
+            if ( p_columnId < MaxIndexedColumnId )
+            {
+                return p_columnId < m_columnIndex . size () ? m_columnIndex [ p_columnId ] : 0;
+            }
+            return FindColumn ( p_columnId );
+        }
         
     private:
+        // Writes into one table's cursor on its own thread. The parse thread queues the
+        // cell and row events in batches; a bounded number of batches are in flight.
+        class TableWriter
+        {
+        public:
+            TableWriter ( struct VCursor * p_cursor );
+            ~TableWriter ();
+            
+            rc_t Start ();
+            
+            rc_t Write ( const Column& p_col, const void* p_data, size_t p_elemCount );
+            rc_t Default ( const Column& p_col, const void* p_data, size_t p_elemCount );
+            rc_t NextRow ( uint64_t p_count );
+            
+            // waits until everything queued has been written; returns the first error of the writer
+            rc_t Flush ();
+            
+            // closes the row, commits the cursor and ends the thread
+            rc_t Finish ();
+            
+        private:
+            static const size_t BatchBytes = 4 * 1024 * 1024;
+            static const size_t MaxQueued  = 4;
+            static const size_t NoData     = ( size_t ) -1;
+            
+            enum CommandType { cmdWrite, cmdDefault, cmdNextRow, cmdCommit };
+            
+            struct Command
+            {
+                CommandType type;
+                uint32_t    columnIdx;
+                uint32_t    elemBits;
+                uint64_t    count;      // elements or rows
+                size_t      offset;     // into Batch::data
+            };
+            
+            struct Batch
+            {
+                std::vector < Command > commands;
+                std::vector < uint8_t > data;
+            };
+            
+            static rc_t CC ThreadFunc ( const struct KThread * p_self, void * p_data );
+            
+            rc_t Add ( CommandType p_type, const Column* p_col, const void* p_data, size_t p_elemCount );
+            rc_t Submit ();
+            rc_t Execute ( const Batch& p_batch );
+            rc_t Run ();
+            
+        private:
+            struct VCursor *        m_cursor;
+            struct KThread *        m_thread;
+            struct KLock *          m_lock;
+            struct KCondition *     m_cond;     // queue changed, in either direction
+            
+            Batch *                 m_current;  // being filled by the parse thread
+            std::vector < Batch * > m_queue;    // FIFO, handed to the writer
+            std::vector < Batch * > m_free;
+            bool                    m_busy;
+            bool                    m_stopping;
+            rc_t                    m_rc;
+        };
+        
         // Active Cursors
         typedef std::vector < struct VCursor * > Cursors;
         
+        // Writers, parallel to Cursors; empty unless tables are written in parallel
+        typedef std::vector < TableWriter * > Writers;
+        
         // from TableId to Table
         typedef std::map < uint32_t, Table > Tables; 
         
         // from ColumnId to Column
         typedef std::map < uint32_t, Column > Columns; 
         
+        // from ColumnId to Column, for ids below MaxIndexedColumnId; points into Columns
+        typedef std::vector < const Column * > ColumnIndex;
+        static const uint32_t MaxIndexedColumnId = 64 * 1024;
+        
         // From database id to VDatabase. id == 0 for the root database.
         typedef std::map < uint32_t, VDatabase* > Databases; 
         
@@ -164,10 +268,14 @@ private:
         typedef std::map < uint32_t, uint32_t > DatabaseToParent; 
         
     private:
+        const Column* FindColumn ( uint32_t p_columnId ) const; 
         rc_t MakeDatabase ( uint32_t p_id );
         rc_t CursorWrite   ( const Column& p_col, const void* p_data, size_t p_size );
         rc_t CursorDefault ( const Column& p_col, const void* p_data, size_t p_size );
         rc_t SaveColumnMetadata ( const Column& p_col );
+        rc_t StartWriters ();
+        rc_t FlushWriters ();
+        void DeleteWriters ();
 
     private:
         Paths                   m_includePaths;
@@ -181,8 +289,10 @@ private:
         ver_t                   m_softwareVersion;
     
         Cursors                 m_cursors;
+        Writers                 m_writers;
         Tables                  m_tables;
         Columns                 m_columns;
+        ColumnIndex             m_columnIndex;
         Databases               m_databases;    
         DatabaseToParent        m_dbParents;    
         
@@ -190,6 +300,7 @@ private:
         struct VSchema*         m_schema;
         
         bool                    m_databaseNameOverridden;
+        bool                    m_parallelTables;
     };
 
     class ProtocolParser
@@ -210,6 +321,8 @@ private:
     class PackedProtocolParser : public ProtocolParser
     {
     public:
+        PackedProtocolParser () : m_unpackedSize ( 0 ) {}
+        
         virtual rc_t ParseEvents ( Reader&, DatabaseLoader& );
         
     private:
@@ -219,7 +332,8 @@ private:
         
         rc_t ParseData ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId, uint32_t p_dataSize );
         
-        std::vector<uint8_t>    m_unpackingBuf;
+        std::vector<uint8_t>    m_unpackingBuf;     // only grows
+        size_t                  m_unpackedSize;     // bytes used in m_unpackingBuf
     };
     
 private:    
@@ -238,6 +352,7 @@ private:
     Paths                   m_includePaths;
     Paths                   m_schemas;
     std::string             m_targetOverride;
+    bool                    m_parallelTables;
 };
 
 #endif
@@ -74,6 +74,16 @@ char const * target_usage[] =
     NULL
 };
 
+static char const option_parallel[] = "parallel-tables";
+#define OPTION_PARALLEL option_parallel
+#define ALIAS_PARALLEL  "p"
+static
+char const * parallel_usage[] = 
+{
+    "Write every table on its own thread, parsing only demultiplexes the events",
+    NULL
+};
+
 OptDef Options[] = 
 {
     /* order here is same as in param array below!!! */                 
@@ -81,6 +91,7 @@ OptDef Options[] =
     { OPTION_INCLUDE_PATHS, ALIAS_INCLUDE_PATHS,    NULL, include_paths_usage,  0,  true,        false },
     { OPTION_SCHEMAS,       ALIAS_SCHEMAS,          NULL, schemas_usage,        0,  true,        false },
     { OPTION_TARGET,        ALIAS_TARGET,           NULL, target_usage,         1,  true,        false },
+    { OPTION_PARALLEL,      ALIAS_PARALLEL,         NULL, parallel_usage,       1,  false,       false },
 };
 
 const char* OptHelpParam[] =
@@ -89,6 +100,7 @@ const char* OptHelpParam[] =
     "path(s)",
     "path(s)",
     "path",
+    NULL,
     "",
 };
 
@@ -215,6 +227,15 @@ rc_t CC KMain (int argc, char * argv[])
                                 }
                             }
                             
+                            if ( rc == 0 )
+                            {
+                                rc = ArgsOptionCount (args, OPTION_PARALLEL, &pcount);
+                                if ( rc == 0 && pcount > 0 )
+                                {
+                                    loader . SetParallelTables ( true );
+                                }
+                            }
+                            
                             if ( rc == 0 )
                             {
                                 rc = loader . Run();
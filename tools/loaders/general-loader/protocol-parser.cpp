@@ -32,6 +32,8 @@
 #include <general-writer/general-writer.h>
 #include <general-writer/utf8-like-int-codec.h>
 
+#include <cstring>
+
 using namespace std;
 
 ///////////// GeneralLoader::ProtocolParser
@@ -289,7 +291,7 @@ GeneralLoader :: UnpackedProtocolParser :: ParseEvents ( Reader& p_reader, Datab
         case evt_cell_data:
             {
                 uint32_t columnId = ncbi :: id ( evt_header );
-                pLogMsg ( klogDebug, "protocol-parser event: Cell-Data, id=$(i)", "i=%u", columnId );
+                PLOGMSG ( klogDebug, ( klogDebug, "protocol-parser event: Cell-Data, id=$(i)", "i=%u", columnId ) );
 
                 gw_data_evt_v1 evt;
                 rc = ReadEvent ( p_reader, evt );
@@ -302,7 +304,7 @@ GeneralLoader :: UnpackedProtocolParser :: ParseEvents ( Reader& p_reader, Datab
                         rc = p_reader . Read ( ( col -> elemBits * elem_count + 7 ) / 8 );
                         if ( rc == 0 )
                         {
-                            rc = p_dbLoader . CellData ( columnId, p_reader. GetBuffer (), elem_count );
+                            rc = p_dbLoader . CellData ( *col, p_reader. GetBuffer (), elem_count );
                         }
                     }
                     else
@@ -360,7 +362,7 @@ GeneralLoader :: UnpackedProtocolParser :: ParseEvents ( Reader& p_reader, Datab
         case evt_next_row:
             {
                 uint32_t tableId = ncbi :: id ( evt_header );
-                pLogMsg ( klogDebug, "protocol-parser event: Next-Row, id=$(i)", "i=%u", tableId );
+                PLOGMSG ( klogDebug, ( klogDebug, "protocol-parser event: Next-Row, id=$(i)", "i=%u", tableId ) );
                 rc = p_dbLoader . NextRow ( tableId );
             }
             break;
@@ -462,10 +464,14 @@ template < typename T_uintXX >
 rc_t
 GeneralLoader :: PackedProtocolParser :: UncompressInt (  Reader& p_reader, uint32_t p_dataSize, int (*p_decode) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded )  )
 {
-    m_unpackingBuf . clear();
-    // reserve enough for the best-packed case, when each element is represented with 1 byte
-    m_unpackingBuf . reserve ( sizeof ( T_uintXX ) * p_dataSize );
+    // make room for the best-packed case, when each element is represented with 1 byte
+    size_t maxSize = sizeof ( T_uintXX ) * p_dataSize;
+    if ( m_unpackingBuf . size () < maxSize )
+    {
+        m_unpackingBuf . resize ( maxSize );
+    }
 
+    uint8_t* out = m_unpackingBuf . data ();
     const uint8_t* buf_begin = reinterpret_cast<const uint8_t*> ( p_reader . GetBuffer() );
     const uint8_t* buf_end   = buf_begin + p_dataSize;
     while ( buf_begin < buf_end )
@@ -478,13 +484,12 @@ GeneralLoader :: PackedProtocolParser :: UncompressInt (  Reader& p_reader, uint
             return RC ( rcExe, rcFile, rcReading, rcData, rcCorrupt );
         }
 
-        for ( size_t i = 0; i < sizeof ( T_uintXX ); ++i )
-        {
-            m_unpackingBuf . push_back ( reinterpret_cast<const uint8_t*> ( & ret_decoded ) [ i ] );
-        }
+        memmove ( out, & ret_decoded, sizeof ( T_uintXX ) );
+        out += sizeof ( T_uintXX );
 
         buf_begin += numRead;
     }
+    m_unpackedSize = out - m_unpackingBuf . data ();
 
     return 0;
 }
@@ -519,12 +524,12 @@ GeneralLoader :: PackedProtocolParser :: ParseData ( Reader& p_reader, DatabaseL
                 }
                 if ( rc == 0 )
                 {
-                    rc = p_dbLoader . CellData ( p_columnId, m_unpackingBuf . data(), m_unpackingBuf . size() * 8 / col -> elemBits );
+                    rc = p_dbLoader . CellData ( *col, m_unpackingBuf . data(), m_unpackedSize * 8 / col -> elemBits );
                 }
             }
             else
-            {
-                rc = p_dbLoader . CellData ( p_columnId, p_reader. GetBuffer (), p_dataSize * 8 / col -> elemBits );
+            {   // straight out of the reader's buffer
+                rc = p_dbLoader . CellData ( *col, p_reader. GetBuffer (), p_dataSize * 8 / col -> elemBits );
             }
         }
     }
@@ -842,7 +847,7 @@ GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, Database
         case evt_cell_data:
             {
                 uint32_t columnId = ncbi :: id ( evt_header );
-                pLogMsg ( klogDebug, "protocol-parser event: Cell-Data (packed), id=$(i)", "i=%u", columnId );
+                PLOGMSG ( klogDebug, ( klogDebug, "protocol-parser event: Cell-Data (packed), id=$(i)", "i=%u", columnId ) );
 
                 gwp_data_evt_v1 evt;
                 rc = ReadEvent ( p_reader, evt );
@@ -856,7 +861,7 @@ GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, Database
         case evt_cell_data2:
             {
                 uint32_t columnId = ncbi :: id ( evt_header );
-                pLogMsg ( klogDebug, "protocol-parser event: Cell-Data2, id=$(i)", "i=%u", columnId );
+                PLOGMSG ( klogDebug, ( klogDebug, "protocol-parser event: Cell-Data2, id=$(i)", "i=%u", columnId ) );
 
                 gwp_data_evt_U16_v1 evt;
                 rc = ReadEvent ( p_reader, evt );
@@ -932,7 +937,7 @@ GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, Database
         case evt_next_row:
             {
                 uint32_t tableId = ncbi :: id ( evt_header );
-                pLogMsg ( klogDebug, "protocol-parser event: Next-Row (packed), id=$(i)", "i=%u", tableId );
+                PLOGMSG ( klogDebug, ( klogDebug, "protocol-parser event: Next-Row (packed), id=$(i)", "i=%u", tableId ) );
                 rc = p_dbLoader . NextRow ( tableId );
             }
             break;
@@ -0,0 +1,202 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Throughput benchmark for General Loader: loads captured general-writer streams
+* ( f.i. the .gl files in input/ produced by makeinputs, or the output of a tool run with its
+* general-writer output redirected into a file ) and reports MB/s for each of them.
+*
+* bench-protocol-parser [ -I include-path ] [ -n iterations ] stream.gl ...
+*/
+
+#include "../general-loader.hpp"
+
+#include <sysalloc.h>
+
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <klib/out.h>
+#include <klib/rc.h>
+#include <klib/log.h>
+#include <klib/time.h>
+
+#include <kfs/directory.h>
+#include <kfs/file.h>
+
+#include <kns/stream.h>
+
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+static const char * ScratchDb = "./db/bench-protocol-parser";
+
+static char const option_include_paths[] = "include";
+static char const option_iterations[]    = "iterations";
+
+static char const * include_paths_usage[] = { "Directories to search for schema include files, separated by ':'", NULL };
+static char const * iterations_usage[]    = { "How many times to load every stream (default 5)", NULL };
+
+OptDef Options[] =
+{
+    { option_include_paths, "I", NULL, include_paths_usage, 0, true, false },
+    { option_iterations,    "n", NULL, iterations_usage,    1, true, false },
+};
+
+char const UsageDefaultName[] = "bench-protocol-parser";
+
+rc_t UsageSummary ( char const * progname )
+{
+    return KOutMsg ( "Usage:\n\t%s [ -I path ] [ -n iterations ] stream.gl ...\n\n", progname );
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    UsageSummary ( UsageDefaultName );
+    HelpOptionLine ( "I", option_include_paths, "path(s)", include_paths_usage );
+    HelpOptionLine ( "n", option_iterations, "count", iterations_usage );
+    HelpOptionsStandard ();
+    return 0;
+}
+
+static
+rc_t
+LoadOnce ( KDirectory * p_wd, const char * p_argv0, const char * p_path, const string & p_includes, uint64_t & p_bytes )
+{
+    const KFile * file;
+    rc_t rc = KDirectoryOpenFileRead ( p_wd, & file, "%s", p_path );
+    if ( rc == 0 )
+    {
+        rc = KFileSize ( file, & p_bytes );
+        if ( rc == 0 )
+        {
+            struct KStream * stream;
+            rc = KStreamFromKFilePair ( & stream, file, 0 );
+            if ( rc == 0 )
+            {
+                GeneralLoader loader ( p_argv0, * stream );
+                if ( ! p_includes . empty () )
+                {
+                    loader . AddSchemaIncludePath ( p_includes );
+                }
+                loader . SetTargetOverride ( ScratchDb );
+                rc = loader . Run ();
+                KStreamRelease ( stream );
+            }
+        }
+        KFileRelease ( file );
+    }
+    KDirectoryRemove ( p_wd, true, "%s", ScratchDb );
+    return rc;
+}
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    Args * args;
+    rc_t rc = ArgsMakeAndHandle ( & args, argc, argv, 1, Options, sizeof Options / sizeof ( OptDef ) );
+    if ( rc == 0 )
+    {
+        string includes;
+        uint32_t iterations = 5;
+        uint32_t count;
+
+        rc = ArgsOptionCount ( args, option_include_paths, & count );
+        for ( uint32_t i = 0; rc == 0 && i < count; ++i )
+        {
+            const char * value;
+            rc = ArgsOptionValue ( args, option_include_paths, i, ( const void ** ) & value );
+            if ( rc == 0 )
+            {
+                if ( ! includes . empty () )
+                {
+                    includes += ":";
+                }
+                includes += value;
+            }
+        }
+        if ( rc == 0 )
+        {
+            rc = ArgsOptionCount ( args, option_iterations, & count );
+            if ( rc == 0 && count > 0 )
+            {
+                const char * value;
+                rc = ArgsOptionValue ( args, option_iterations, 0, ( const void ** ) & value );
+                if ( rc == 0 )
+                {
+                    iterations = atoi ( value );
+                }
+            }
+        }
+
+        KDirectory * wd;
+        if ( rc == 0 )
+        {
+            rc = KDirectoryNativeDir ( & wd );
+        }
+        if ( rc == 0 )
+        {
+            rc = ArgsParamCount ( args, & count );
+            for ( uint32_t i = 0; rc == 0 && i < count; ++i )
+            {
+                const char * path;
+                rc = ArgsParamValue ( args, i, ( const void ** ) & path );
+                if ( rc != 0 )
+                {
+                    break;
+                }
+
+                uint64_t bytes = 0;
+                KTimeMs_t best = 0;
+                for ( uint32_t it = 0; rc == 0 && it < iterations; ++it )
+                {
+                    KTimeMs_t start = KTimeMsStamp ();
+                    rc = LoadOnce ( wd, argv [ 0 ], path, includes, bytes );
+                    KTimeMs_t elapsed = KTimeMsStamp () - start;
+                    if ( it == 0 || elapsed < best )
+                    {
+                        best = elapsed;
+                    }
+                }
+                if ( rc == 0 )
+                {
+                    double mb = ( double ) bytes / ( 1024 * 1024 );
+                    KOutMsg ( "%s: %lu bytes, best of %u: %lu ms, %.2f MB/s\n",
+                              path, bytes, iterations, ( uint64_t ) best,
+                              best == 0 ? 0.0 : mb * 1000 / best );
+                }
+                else
+                {
+                    pLogErr ( klogErr, rc, "failed to load '$(p)'", "p=%s", path );
+                }
+            }
+            KDirectoryRelease ( wd );
+        }
+        ArgsWhack ( args );
+    }
+    return rc;
+}
@@ -1416,6 +1416,48 @@ FIXTURE_TEST_CASE ( MultipleTables_Multiple_Columns_MultipleRows, GeneralLoaderF
     REQUIRE_EQ ( t2c2v2,    GetValue<uint8_t>   ( Table2, U8Column, 2 ) );
 }
 
+FIXTURE_TEST_CASE ( MultipleTables_ParallelWriters, GeneralLoaderFixture )
+{
+    SetUpStream ( GetName() );
+
+    m_source . NewTableEvent ( 100, DefaultTable );
+    m_source . NewColumnEvent ( 1, 100, DefaultColumn, 8 );
+
+    m_source . NewTableEvent ( 200, Table2 );
+    m_source . NewColumnEvent ( 2, 200, U32Column, 32 );
+
+    m_source . OpenStreamEvent();
+
+    string dflt = "default";
+    m_source . CellDefaultEvent( 1, dflt );
+
+    const uint32_t RowCount = 1000;
+    for ( uint32_t i = 0; i < RowCount; ++i )
+    {
+        m_source . CellDataEvent( 1, string ( "t1v" ) );
+        m_source . NextRowEvent ( 100 );
+
+        m_source . CellDataEvent( 2, i );
+        m_source . NextRowEvent ( 200 );
+    }
+    m_source . MoveAheadEvent ( 100, 3 );
+
+    m_source . CloseStreamEvent();
+
+    {
+        GeneralLoader* gl = MakeLoader ( m_source . MakeSource () );
+        gl -> SetParallelTables ( true );
+        REQUIRE ( RunLoader ( *gl, 0 ) );
+        delete gl;
+    }
+
+    REQUIRE_EQ ( string ( "t1v" ),  GetValue<string>    ( DefaultTable, DefaultColumn, 1 ) );
+    REQUIRE_EQ ( string ( "t1v" ),  GetValue<string>    ( DefaultTable, DefaultColumn, RowCount ) );
+    REQUIRE_EQ ( dflt,              GetValue<string>    ( DefaultTable, DefaultColumn, RowCount + 3 ) );
+    REQUIRE_EQ ( ( uint32_t ) 0,    GetValue<uint32_t>  ( Table2, U32Column, 1 ) );
+    REQUIRE_EQ ( RowCount - 1,      GetValue<uint32_t>  ( Table2, U32Column, RowCount ) );
+}
+
 FIXTURE_TEST_CASE ( AdditionalSchemaIncludePaths_Single, GeneralLoaderFixture )
 {
     string schemaPath = "schema";
@@ -55,6 +55,7 @@
 
 #include "kar+.h"
 #include "kar+args.h"
+#include "kar-copy.h"
 
 
 /*******************************************************************************
@@ -66,6 +67,7 @@ static uint64_t max_offset = 0;
 
 
 static rc_t kar_scan_directory ( const KDirectory *dir, KARDir *kar_dir, const char *path );
+static rc_t kar_repack ( KDirectory * wd, KFile * archive, KARDir * the_dir, const Params * p );
 
 
 /*******************************************************************************
@@ -1156,8 +1158,78 @@ void kar_write_file ( KARArchiveFile *af, const KDirectory *wd, const KARFile *f
     KFileRelease ( f );
 }
 
+/********** repack: data copied from the source archive  */
+
+typedef struct KARRepack KARRepack;
+struct KARRepack
+{
+    const KFile * src;
+    uint64_t src_file_offset;
+
+    /* native descriptors for in-kernel copies, -1 if not available */
+    int src_fd;
+    int dst_fd;
+
+    char * buffer;
+    size_t bsize;
+};
+
 static
-rc_t kar_make ( const KDirectory * wd, KFile *archive, KARDir *kar_dir, const char * root_dir, const Params * params )
+void kar_repack_file ( KARArchiveFile *af, const KARRepack *rp, const KARFile *file )
+{
+    rc_t rc = 0;
+    size_t align_size;
+    char align_buffer [ 4 ] = "0000";
+    uint64_t src_pos = rp -> src_file_offset + file -> src_offset;
+
+    if ( file -> byte_size == 0 )
+        return;
+
+    STATUS ( STAT_QA, "repacking file '%s' from offset %lu", file -> dad . name, src_pos );
+
+    /* establish current position */
+    align_size = align_offset ( af -> pos, 4 ) - af -> pos;
+    if ( align_size != 0  )
+        rc = KFileWriteAll ( af -> archive, af -> pos, align_buffer, align_size, NULL );
+
+    af -> pos = af -> starting_pos + file -> byte_offset;
+
+    if ( rc == 0 )
+    {
+        if ( rp -> src_fd >= 0 && rp -> dst_fd >= 0 )
+            rc = kar_copy_range ( rp -> src_fd, src_pos, rp -> dst_fd, af -> pos,
+                                  file -> byte_size, rp -> buffer, rp -> bsize );
+        else
+        {
+            uint64_t pos;
+            size_t num_read;
+
+            for ( pos = 0; rc == 0 && pos < file -> byte_size; pos += num_read )
+            {
+                size_t to_read = rp -> bsize;
+                if ( pos + to_read > file -> byte_size )
+                    to_read = ( size_t ) ( file -> byte_size - pos );
+
+                rc = KFileReadAll ( rp -> src, src_pos + pos, rp -> buffer, to_read, & num_read );
+                if ( rc == 0 && num_read == 0 )
+                    rc = RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+                if ( rc == 0 )
+                    rc = KFileWriteAll ( af -> archive, af -> pos + pos, rp -> buffer, num_read, NULL );
+            }
+        }
+    }
+
+    if ( rc != 0 )
+    {
+        pLogErr ( klogInt, rc, "Failed to repack file $(fname)", "fname=%s", file -> dad . name );
+        exit ( 6 );
+    }
+
+    af -> pos += file -> byte_size;
+}
+
+static
+rc_t kar_make ( const KDirectory * wd, KFile *archive, KARDir *kar_dir, const char * root_dir, const Params * params, const KARRepack * rp )
 {
     rc_t rc = 0;
     KARWek * Files = 0;
@@ -1186,7 +1258,10 @@ rc_t kar_make ( const KDirectory * wd, KFile *archive, KARDir *kar_dir, const ch
         {
             KARFile * File = ( KARFile * ) kar_wek_get ( Files, i );
             STATUS ( STAT_QA, "writing file %u: '%s'", i, File -> dad . name );
-            kar_write_file ( & af, wd, File, root_dir );
+            if ( rp != NULL && File -> in_src )
+                kar_repack_file ( & af, rp, File );
+            else
+                kar_write_file ( & af, wd, File, root_dir );
         }
         
         kar_wek_dispose ( Files );
@@ -1235,12 +1310,18 @@ rc_t kar_create ( const Params *p )
 
                 /* build contents by walking input directory if given,
                    and adding the individual members if given */
-                if ( p -> dir_count != 0 )
+                if ( p -> repack_path != NULL )
+                {
+                    rc = kar_repack ( wd, archive, & the_dir, p );
+                    if ( rc != 0 )
+                        LogErr ( klogInt, rc, "Failed to repack archive" );
+                }
+                else if ( p -> dir_count != 0 )
                 {
                     rc = kar_scan_directory ( wd, & the_dir, p -> directory_path );
                     if ( rc == 0 )
                     {   
-                        rc = kar_make ( wd, archive, & the_dir, p -> directory_path, p );
+                        rc = kar_make ( wd, archive, & the_dir, p -> directory_path, p, NULL );
                         if ( rc != 0 )
                             LogErr ( klogInt, rc, "Failed to build archive" );
                     }
@@ -2169,6 +2250,169 @@ rc_t kar_test_extract ( const Params *p )
     return rc;
 }
 
+/*******************************************************************************
+ * Repack
+ *
+ *  Creates a new archive from an existing one without unpacking it.
+ *  Without a directory the members of the source archive are filtered
+ *  by 'keep' and 'drop' and streamed across by offset.
+ *  With a directory, usually the one the source was extracted into and
+ *  then edited, the directory defines the contents: a file that has the
+ *  same path, size and modification time as a member of the source is
+ *  taken from the source, everything else is read from the directory.
+ */
+
+static
+void kar_repack_link_parent ( BSTNode *node, void *data )
+{
+    KAREntry * entry = ( KAREntry * ) node;
+
+    entry -> parentDir = ( KARDir * ) data;
+
+    if ( entry -> type == kptDir )
+        BSTreeForEach ( & ( ( KARDir * ) entry ) -> contents, false, kar_repack_link_parent, entry );
+}
+
+static
+void CC kar_repack_use_source ( const KAREntry * Entry, void * Data )
+{
+    if ( Entry -> type == kptFile ) {
+        KARFile * File = ( KARFile * ) Entry;
+
+        File -> in_src = true;
+        File -> src_offset = File -> byte_offset;
+    }
+}   /* kar_repack_use_source () */
+
+static
+void CC kar_repack_match_source ( const KAREntry * Entry, void * Data )
+{
+    const char * Path;
+    KAREntry * Src;
+
+    if ( Entry -> type != kptFile ) {
+        return;
+    }
+
+    if ( kar_entry_path ( & Path, ( KAREntry * ) Entry ) != 0 ) {
+        return;
+    }
+
+    Src = kar_p2e_find ( ( BSTree * ) Data, Path );
+    if ( Src != NULL && Src -> type == kptFile ) {
+        KARFile * File = ( KARFile * ) Entry;
+        const KARFile * SrcFile = ( const KARFile * ) Src;
+
+        if ( SrcFile -> byte_size == File -> byte_size
+            && Src -> mod_time == Entry -> mod_time
+        ) {
+            File -> in_src = true;
+            File -> src_offset = SrcFile -> byte_offset;
+        }
+    }
+
+    free ( ( char * ) Path );
+}   /* kar_repack_match_source () */
+
+static
+rc_t kar_repack ( KDirectory * wd, KFile * archive, KARDir * the_dir, const Params * p )
+{
+    rc_t rc;
+    KARRepack rp;
+
+    memset ( & rp, 0, sizeof rp );
+    rp . src_fd = -1;
+    rp . dst_fd = -1;
+
+    rc = kar_open_file_read ( wd, & rp . src, p -> repack_path );
+    if ( rc != 0 )
+    {
+        pLogErr ( klogErr, rc, "Failed to open archive $(archive)",
+                  "archive=%s", p -> repack_path );
+    }
+    else
+    {
+        KARDir src_root;
+        KSraHeader hdr;
+        uint64_t toc_pos, toc_size;
+
+        toc_pos = kar_verify_header ( rp . src, &hdr );
+        rp . src_file_offset = hdr . u . v1 . file_offset;
+        toc_size = rp . src_file_offset - toc_pos;
+
+        memset ( & src_root, 0, sizeof src_root );
+        src_root . dad . type = kptDir;
+        src_root . dad . eff_type = ktocentrytype_dir;
+        BSTreeInit ( & src_root . contents );
+
+        STATUS ( STAT_QA, "extracting toc of '%s'", p -> repack_path );
+        rc = kar_extract_toc ( rp . src, & src_root . contents, &toc_pos, toc_size );
+        if ( rc == 0 )
+        {
+            if ( p -> dir_count == 0 )
+            {
+                /* the source toc becomes the new one */
+                the_dir -> contents = src_root . contents;
+                BSTreeInit ( & src_root . contents );
+
+                BSTreeForEach ( & the_dir -> contents, false, kar_repack_link_parent, the_dir );
+                kar_entry_for_each ( & the_dir -> dad, kar_repack_use_source, NULL );
+            }
+            else
+            {
+                rc = kar_scan_directory ( wd, the_dir, p -> directory_path );
+                if ( rc == 0 )
+                {
+                    BSTree p2e;
+
+                    BSTreeForEach ( & src_root . contents, false, kar_repack_link_parent, & src_root );
+                    rc = kar_p2e_init ( & p2e, & src_root . dad );
+                    if ( rc == 0 )
+                    {
+                        kar_entry_for_each ( & the_dir -> dad, kar_repack_match_source, & p2e );
+                        kar_p2e_whack ( & p2e );
+                    }
+                }
+            }
+        }
+
+        if ( rc == 0 )
+        {
+            rp . bsize = 16 * 1024 * 1024;
+            rp . buffer = malloc ( rp . bsize );
+            if ( rp . buffer == NULL )
+            {
+                rc = RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+                LogErr ( klogErr, rc, "Failed to allocate copy buffer" );
+            }
+        }
+
+        if ( rc == 0 )
+        {
+            /* in-kernel copies between two local files, unless the
+               output has to pass through the md5 calculation */
+            if ( ! p -> md5sum
+                 && ( KDirectoryPathType ( wd, "%s", p -> repack_path ) & ~ kptAlias ) == kptFile )
+            {
+                rp . src_fd = kar_copy_open_native ( wd, false, p -> repack_path );
+                if ( rp . src_fd >= 0 )
+                    rp . dst_fd = kar_copy_open_native ( wd, true, p -> archive_path );
+            }
+
+            rc = kar_make ( wd, archive, the_dir, p -> directory_path, p, & rp );
+        }
+
+        kar_copy_close_native ( rp . dst_fd );
+        kar_copy_close_native ( rp . src_fd );
+        free ( rp . buffer );
+
+        BSTreeWhack ( & src_root . contents, kar_entry_whack, NULL );
+        KFileRelease ( rp . src );
+    }
+
+    return rc;
+}   /* kar_repack () */
+
 /*******************************************************************************
  * Startup
  */
@@ -75,6 +75,11 @@ struct KARFile
         /* Chunked entries */
     KTocChunk * chunks;
     uint32_t nun_chunks;
+
+        /* Repack : the data is taken from the source archive
+         * at src_offset ( relative to its first file ) */
+    bool in_src;
+    uint64_t src_offset;
 };
 
 typedef KARFile **KARFilePtrArray;
@@ -69,6 +69,14 @@ static const char * kdfile_usage[] =
   "Wnere <path> is a path to entry to keep/drop."
   "<directive> is  one of 'keep' or 'drop'.",
   NULL };
+static const char * repack_usage[] = 
+{ "The next token on the command line is the path",
+  "to an existing archive. Under create mode its members",
+  "are streamed into the new archive without unpacking,",
+  "after applying 'keep' and 'drop'. With 'directory'",
+  "the directory gives the contents, and only the files",
+  "changed since they were extracted are read from it",
+  NULL };
 static const char * stdout_usage[] = { "Direct output to stdout", NULL }; 
 static const char * md5_usage[] = { "create md5sum-compatible checksum file", NULL }; 
 
@@ -85,7 +93,8 @@ OptDef Options [] =
     { OPTION_MD5,       NULL,            NULL, md5_usage, 1, false,  false },
     { OPTION_KEEP,      NULL,            NULL, keep_usage, 0, true,  false },
     { OPTION_DROP,      NULL,            NULL, drop_usage, 0, true,  false },
-    { OPTION_KDFILE,    NULL,            NULL, kdfile_usage, 1, true,  false }
+    { OPTION_KDFILE,    NULL,            NULL, kdfile_usage, 1, true,  false },
+    { OPTION_REPACK,    NULL,            NULL, repack_usage, 1, true,  false }
 };
 
 const char UsageDefaultName[] = "kar";
@@ -159,6 +168,7 @@ rc_t CC Usage (const Args * args)
     HelpOptionLine ( NULL, OPTION_KEEP, NULL, keep_usage);
     HelpOptionLine ( NULL, OPTION_DROP, NULL, drop_usage);
     HelpOptionLine ( NULL, OPTION_KDFILE, NULL, kdfile_usage);
+    HelpOptionLine ( NULL, OPTION_REPACK, archive, repack_usage);
 
     OUTMSG (("\n"
              "Use examples:"
@@ -419,6 +429,23 @@ rc_t parse_params_int ( Params *p, const Args *args )
         }
     }
 
+    rc = ArgsOptionCount ( args, OPTION_REPACK, & tr_count );
+    if ( rc != 0 )
+    {
+        pLogErr ( klogFatal, rc, "Failed to verify '$(name)' option", "name=%s", OPTION_REPACK );
+        return rc;
+    }
+
+    if ( tr_count > 0 )
+    {
+        rc = ArgsOptionValue (args, OPTION_REPACK, 0, (const void **) & p -> repack_path );
+        if ( rc != 0 )
+        {
+            pLogErr ( klogFatal, rc, "Failed to access '$(name)' archive path", "name=%s", OPTION_REPACK );
+            return rc;
+        }
+    }
+
     return rc;
 }
 
@@ -443,6 +470,7 @@ rc_t parse_params ( Params *p, struct Args ** args, int argc, char * argv [] )
     p -> keep = NULL;
     p -> drop = NULL;
     p -> kdfile = NULL;
+    p -> repack_path = NULL;
 
     rc = ArgsMakeAndHandle ( args, argc, argv, 1,
         Options, sizeof Options / sizeof ( Options [ 0 ] ) );
@@ -484,6 +512,7 @@ rc_t whack_params ( Params * p )
         }
 
         p -> kdfile = NULL;
+        p -> repack_path = NULL;
 
         memset ( p, 0, sizeof ( Params ) );
     }
@@ -522,10 +551,18 @@ rc_t validate_params ( Params *p )
         }
     }
 
-    /* if creating, must have a directory OR member count > 0 */
+    /* repacking is a way of creating */
+    if ( p -> repack_path != NULL && p -> c_count == 0 )
+    {
+        rc = RC ( rcApp, rcArgv, rcParsing, rcParam, rcInvalid );
+        LogErr ( klogErr, rc, "Must use create option with repack" );
+        return rc;
+    }
+
+    /* if creating, must have a directory OR member count > 0 OR an archive to repack */
     if ( p -> c_count != 0 )
     {
-        if ( ! ( p -> mem_count != 0 || p -> dir_count != 0 ) )
+        if ( ! ( p -> mem_count != 0 || p -> dir_count != 0 || p -> repack_path != NULL ) )
         {
             rc = RC ( rcApp, rcArgv, rcParsing, rcParam, rcInsufficient );           
             LogErr ( klogErr, rc, "Must provide an input directory or file paths when creating " );
@@ -41,6 +41,7 @@
 #define OPTION_KEEP      "keep"
 #define OPTION_DROP      "drop"
 #define OPTION_KDFILE    "kdfile"
+#define OPTION_REPACK    "repack"
 /*TBD - add alignment option */
 
 
@@ -97,6 +98,10 @@ struct Params
     struct VNamelist * keep;
     struct VNamelist * drop;
     const char * kdfile;
+
+    /* create mode: take the contents from this archive instead of
+       unpacking it, NULL if not given */
+    const char * repack_path;
 };
 
 
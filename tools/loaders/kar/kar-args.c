@@ -33,6 +33,8 @@
 
 #include <kapp/main.h>
 
+#include <stdlib.h>
+
 
 static const char * create_usage[] = { "Create a new archive.", NULL };
 static const char * test_usage[] = { "Check the structural validity of an archive", NULL };
@@ -53,6 +55,9 @@ static const char * directory_usage[] =
   "from", NULL };
 static const char * stdout_usage[] = { "Direct output to stdout", NULL }; 
 static const char * md5_usage[] = { "create md5sum-compatible checksum file", NULL }; 
+static const char * threads_usage[] =
+{ "copy member files with this many threads,",
+  "using in-kernel copies between local files", NULL };
 
 
 OptDef Options [] = 
@@ -64,7 +69,8 @@ OptDef Options [] =
     { OPTION_LONGLIST,  ALIAS_LONGLIST,  NULL, longlist_usage, 0, false, false },
     { OPTION_DIRECTORY, ALIAS_DIRECTORY, NULL, directory_usage, 1, true,  false },
     { OPTION_STDOUT,    ALIAS_STDOUT,    NULL, stdout_usage, 1, true,  false },
-    { OPTION_MD5,       NULL,            NULL, md5_usage, 1, false,  false }
+    { OPTION_MD5,       NULL,            NULL, md5_usage, 1, false,  false },
+    { OPTION_THREADS,   NULL,            NULL, threads_usage, 1, true,  false }
 };
 
 const char UsageDefaultName[] = "kar";
@@ -134,6 +140,7 @@ rc_t CC Usage (const Args * args)
 
     HelpOptionLine (ALIAS_STDOUT, OPTION_STDOUT, NULL, stdout_usage);
     HelpOptionLine ( NULL, OPTION_MD5, NULL, md5_usage);
+    HelpOptionLine ( NULL, OPTION_THREADS, "count", threads_usage);
 
     OUTMSG (("\n"
              "Use examples:"
@@ -222,6 +229,24 @@ rc_t parse_params_int ( Params *p, const Args *args )
     if ( rc == 0 && count != 0 )
         p -> md5sum = true;    
 
+    rc = ArgsOptionCount ( args, OPTION_THREADS, &count );
+    if ( rc == 0 && count != 0 )
+    {
+        const char *value;
+        rc = ArgsOptionValue ( args, OPTION_THREADS, 0, ( const void ** ) &value );
+        if ( rc != 0 )
+        {
+            LogErr ( klogFatal, rc, "Failed to access 'threads' value" );
+            return rc;
+        }
+
+        p -> threads = ( uint32_t ) strtoul ( value, NULL, 10 );
+        if ( p -> threads == 0 )
+            p -> threads = 1;
+        else if ( p -> threads > 64 )
+            p -> threads = 64;
+    }
+
     /* Options */
     rc = ArgsOptionCount ( args, OPTION_CREATE, & p -> c_count );
     if ( rc != 0 )
@@ -313,6 +338,8 @@ rc_t parse_params ( Params *p, Args *args, int argc, char * argv [] )
     p -> long_list = false;
     p -> force = false;
     p -> stdout = false;
+    p -> md5sum = false;
+    p -> threads = 0;
 
     rc = ArgsMakeAndHandle ( &args, argc, argv, 1,
         Options, sizeof Options / sizeof ( Options [ 0 ] ) );
@@ -0,0 +1,341 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+#include "kar-copy.h"
+
+#include <klib/rc.h>
+#include <klib/log.h>
+#include <kfs/directory.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#if defined __GLIBC__ && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27 ) )
+#define HAVE_COPY_FILE_RANGE 1
+#endif
+#endif
+
+/* the largest single kernel transfer, keeps sendfile() within ssize_t */
+#define KAR_COPY_CHUNK ( 1024 * 1024 * 1024 )
+
+#ifdef _WIN32
+
+/* no native descriptors: everything goes through KFile */
+int kar_copy_open_native ( const KDirectory * dir, bool update, const char * path )
+{
+    return -1;
+}
+
+void kar_copy_close_native ( int fd )
+{
+}
+
+rc_t kar_copy_range ( int src_fd, uint64_t src_pos, int dst_fd, uint64_t dst_pos,
+                      uint64_t size, void * buffer, size_t bsize )
+{
+    return RC ( rcExe, rcFile, rcCopying, rcFunction, rcUnsupported );
+}
+
+#else
+
+int kar_copy_open_native ( const KDirectory * dir, bool update, const char * path )
+{
+    char native [ 4096 ];
+    rc_t rc = KDirectoryResolvePath ( dir, true, native, sizeof native, "%s", path );
+    if ( rc != 0 )
+        return -1;
+
+    return open ( native, update ? O_WRONLY : O_RDONLY );
+}
+
+void kar_copy_close_native ( int fd )
+{
+    if ( fd >= 0 )
+        close ( fd );
+}
+
+static
+rc_t kar_copy_errno ( enum RCContext ctx )
+{
+    switch ( errno )
+    {
+    case ENOSPC:
+        return RC ( rcExe, rcFile, ctx, rcStorage, rcExhausted );
+    case EIO:
+        return RC ( rcExe, rcFile, ctx, rcTransfer, rcUnknown );
+    }
+    return RC ( rcExe, rcFile, ctx, rcFile, rcUnknown );
+}
+
+/* errors that only mean this transfer mechanism is not supported here */
+static
+bool kar_copy_unsupported ( int err )
+{
+    return err == ENOSYS || err == EXDEV || err == EINVAL
+        || err == EOPNOTSUPP || err == EBADF;
+}
+
+static
+rc_t kar_copy_buffered ( int src_fd, uint64_t src_pos, int dst_fd, uint64_t dst_pos,
+                         uint64_t size, void * buffer, size_t bsize )
+{
+    while ( size != 0 )
+    {
+        size_t to_read = size > bsize ? bsize : ( size_t ) size;
+        size_t total;
+
+        ssize_t num_read = pread ( src_fd, buffer, to_read, ( off_t ) src_pos );
+        if ( num_read < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            return kar_copy_errno ( rcReading );
+        }
+        if ( num_read == 0 )
+            return RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+
+        for ( total = 0; total < ( size_t ) num_read; )
+        {
+            ssize_t num_writ = pwrite ( dst_fd, ( const char * ) buffer + total,
+                                        ( size_t ) num_read - total, ( off_t ) ( dst_pos + total ) );
+            if ( num_writ < 0 )
+            {
+                if ( errno == EINTR )
+                    continue;
+                return kar_copy_errno ( rcWriting );
+            }
+            total += ( size_t ) num_writ;
+        }
+
+        src_pos += ( uint64_t ) num_read;
+        dst_pos += ( uint64_t ) num_read;
+        size -= ( uint64_t ) num_read;
+    }
+
+    return 0;
+}
+
+rc_t kar_copy_range ( int src_fd, uint64_t src_pos, int dst_fd, uint64_t dst_pos,
+                      uint64_t size, void * buffer, size_t bsize )
+{
+#ifdef __linux__
+    bool use_sendfile = true;
+#if HAVE_COPY_FILE_RANGE
+    while ( size != 0 )
+    {
+        loff_t in = ( loff_t ) src_pos;
+        loff_t out = ( loff_t ) dst_pos;
+        size_t to_copy = size > KAR_COPY_CHUNK ? KAR_COPY_CHUNK : ( size_t ) size;
+
+        ssize_t num_copied = copy_file_range ( src_fd, & in, dst_fd, & out, to_copy, 0 );
+        if ( num_copied < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            if ( ! kar_copy_unsupported ( errno ) )
+                return kar_copy_errno ( rcCopying );
+            break;
+        }
+        if ( num_copied == 0 )
+            return RC ( rcExe, rcFile, rcCopying, rcTransfer, rcIncomplete );
+
+        src_pos += ( uint64_t ) num_copied;
+        dst_pos += ( uint64_t ) num_copied;
+        size -= ( uint64_t ) num_copied;
+    }
+#endif
+
+    /* sendfile() writes at the current position of "dst_fd" */
+    if ( size != 0 && lseek ( dst_fd, ( off_t ) dst_pos, SEEK_SET ) < 0 )
+        use_sendfile = false;
+
+    while ( use_sendfile && size != 0 )
+    {
+        off_t in = ( off_t ) src_pos;
+        size_t to_copy = size > KAR_COPY_CHUNK ? KAR_COPY_CHUNK : ( size_t ) size;
+
+        ssize_t num_copied = sendfile ( dst_fd, src_fd, & in, to_copy );
+        if ( num_copied < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            if ( ! kar_copy_unsupported ( errno ) )
+                return kar_copy_errno ( rcCopying );
+            break;
+        }
+        if ( num_copied == 0 )
+            return RC ( rcExe, rcFile, rcCopying, rcTransfer, rcIncomplete );
+
+        src_pos += ( uint64_t ) num_copied;
+        dst_pos += ( uint64_t ) num_copied;
+        size -= ( uint64_t ) num_copied;
+    }
+#endif
+
+    return kar_copy_buffered ( src_fd, src_pos, dst_fd, dst_pos, size, buffer, bsize );
+}
+
+#endif /* _WIN32 */
+
+/********** thread pool  */
+
+typedef struct kar_copy_pool kar_copy_pool;
+struct kar_copy_pool
+{
+    KLock * lock;
+
+    kar_copy_job job;
+    void * data;
+
+    size_t count;
+    size_t next;
+    size_t bsize;
+
+    rc_t rc;
+};
+
+typedef struct kar_copy_worker kar_copy_worker;
+struct kar_copy_worker
+{
+    kar_copy_pool * pool;
+    KThread * thread;
+    uint32_t id;
+};
+
+static
+bool kar_copy_pool_next ( kar_copy_pool * self, size_t * idx )
+{
+    bool found = false;
+
+    KLockAcquire ( self -> lock );
+    if ( self -> rc == 0 && self -> next < self -> count )
+    {
+        * idx = self -> next ++;
+        found = true;
+    }
+    KLockUnlock ( self -> lock );
+
+    return found;
+}
+
+static
+void kar_copy_pool_fail ( kar_copy_pool * self, rc_t rc )
+{
+    KLockAcquire ( self -> lock );
+    if ( self -> rc == 0 )
+        self -> rc = rc;
+    KLockUnlock ( self -> lock );
+}
+
+static
+rc_t CC kar_copy_worker_run ( const KThread * self, void * data )
+{
+    kar_copy_worker * w = data;
+    kar_copy_pool * pool = w -> pool;
+    rc_t rc = 0;
+    size_t idx;
+
+    void * buffer = malloc ( pool -> bsize );
+    if ( buffer == NULL )
+        rc = RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+
+    while ( rc == 0 && kar_copy_pool_next ( pool, & idx ) )
+        rc = pool -> job ( w -> id, idx, buffer, pool -> bsize, pool -> data );
+
+    if ( rc != 0 )
+        kar_copy_pool_fail ( pool, rc );
+
+    free ( buffer );
+    return rc;
+}
+
+rc_t kar_copy_pool_run ( uint32_t threads, size_t count, size_t bsize,
+                         kar_copy_job job, void * data )
+{
+    rc_t rc;
+    uint32_t i, started;
+    kar_copy_pool pool;
+    kar_copy_worker * workers;
+
+    if ( threads == 0 )
+        threads = 1;
+    if ( ( size_t ) threads > count )
+        threads = count == 0 ? 1 : ( uint32_t ) count;
+
+    memset ( & pool, 0, sizeof pool );
+    pool . job = job;
+    pool . data = data;
+    pool . count = count;
+    pool . bsize = bsize;
+
+    rc = KLockMake ( & pool . lock );
+    if ( rc != 0 )
+        return rc;
+
+    workers = calloc ( threads, sizeof * workers );
+    if ( workers == NULL )
+    {
+        KLockRelease ( pool . lock );
+        return RC ( rcExe, rcThread, rcAllocating, rcMemory, rcExhausted );
+    }
+
+    /* worker 0 is the calling thread */
+    for ( started = 1; started < threads; ++ started )
+    {
+        workers [ started ] . pool = & pool;
+        workers [ started ] . id = started;
+        rc = KThreadMake ( & workers [ started ] . thread, kar_copy_worker_run, & workers [ started ] );
+        if ( rc != 0 )
+        {
+            LogErr ( klogWarn, rc, "failed to start copy thread, continuing with fewer" );
+            break;
+        }
+    }
+
+    workers [ 0 ] . pool = & pool;
+    kar_copy_worker_run ( NULL, & workers [ 0 ] );
+
+    for ( i = 1; i < started; ++ i )
+    {
+        rc_t status = 0;
+        KThreadWait ( workers [ i ] . thread, & status );
+        KThreadRelease ( workers [ i ] . thread );
+    }
+
+    free ( workers );
+    KLockRelease ( pool . lock );
+
+    return pool . rc;
+}
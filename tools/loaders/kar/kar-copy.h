@@ -0,0 +1,67 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+#ifndef _h_kar_copy_
+#define _h_kar_copy_
+
+#ifndef _h_kfs_defs_
+#include <kfs/defs.h>
+#endif
+
+struct KDirectory;
+
+/********** member payload transfer, zero-copy where the platform allows  */
+
+/* kar_copy_open_native
+ *  open "path" relative to native directory "dir" as a POSIX descriptor
+ *  returns -1 if the path is not a native file,
+ *  in which case the caller has to fall back to KFile
+ */
+int kar_copy_open_native ( const struct KDirectory * dir, bool update, const char * path );
+
+void kar_copy_close_native ( int fd );
+
+/* kar_copy_range
+ *  copy "size" bytes from "src_fd" at "src_pos" to "dst_fd" at "dst_pos"
+ *  inside the kernel with copy_file_range() or sendfile() on Linux,
+ *  through "buffer" with pread()/pwrite() everywhere else or if those refuse.
+ *  the file position of "dst_fd" is changed, so it must not be shared
+ *  between threads
+ */
+rc_t kar_copy_range ( int src_fd, uint64_t src_pos, int dst_fd, uint64_t dst_pos,
+                      uint64_t size, void * buffer, size_t bsize );
+
+/* kar_copy_pool_run
+ *  call "job" once for every index below "count" on up to "threads" threads,
+ *  giving each thread its "worker" number and its own buffer of "bsize" bytes.
+ *  no new indices are handed out after a job failed; returns the first failure
+ */
+typedef rc_t ( CC * kar_copy_job ) ( uint32_t worker, size_t idx,
+                                     void * buffer, size_t bsize, void * data );
+
+rc_t kar_copy_pool_run ( uint32_t threads, size_t count, size_t bsize,
+                         kar_copy_job job, void * data );
+
+#endif /* _h_kar_copy_ */
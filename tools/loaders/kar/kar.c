@@ -25,6 +25,7 @@
  */
 
 #include "kar-args.h"
+#include "kar-copy.h"
 
 #include <klib/rc.h>
 #include <klib/namelist.h>
@@ -37,12 +38,16 @@
 #include <klib/text.h>
 #include <klib/printf.h>
 #include <klib/time.h>
+#include <klib/checksum.h>
 #include <sysalloc.h>
 #include <kfs/directory.h>
 #include <kfs/file.h>
 #include <kfs/toc.h>
 #include <kfs/sra.h>
 #include <kfs/md5.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
 
 #include <kapp/main.h>
 
@@ -1315,6 +1320,329 @@ rc_t kar_make ( const KDirectory * wd, KFile *archive, const BSTree *tree, const
     return rc;
 }
 
+/********** parallel write  */
+
+/* with --threads the member files are copied concurrently, each one
+   straight into its final offset, in-kernel when both ends are local.
+   the archive comes out byte-identical to the sequential one: every
+   non-empty file but the last carries the '0' padding that the sequential
+   writer would put in front of its successor. an md5 requested together
+   with --threads is computed by a separate thread reading back the part
+   of the archive that is complete so far */
+
+typedef struct kar_parallel kar_parallel;
+struct kar_parallel
+{
+    const KDirectory * wd;
+    KFile * archive;
+    const char * archive_path;
+    const char * root_dir;
+    KARFilePtrArray file_array;
+    uint64_t starting_pos;
+    KCreateMode md5_mode;
+
+    /* completion watermark, only maintained for the md5 thread */
+    KLock * lock;
+    KCondition * cond;
+    bool * done;
+    uint64_t next_done;
+    uint64_t ready;
+    bool finished;
+    bool failed;
+};
+
+static
+uint64_t kar_parallel_file_end ( const kar_parallel * self, uint64_t idx )
+{
+    const KARFile * file = self -> file_array [ idx ];
+    uint64_t end = self -> starting_pos + file -> byte_offset + file -> byte_size;
+
+    if ( file -> byte_size != 0 && idx + 1 < num_files )
+        end = align_offset ( end, 4 );
+
+    return end;
+}
+
+static
+void kar_parallel_mark_done ( kar_parallel * self, uint64_t idx )
+{
+    if ( self -> lock == NULL )
+        return;
+
+    KLockAcquire ( self -> lock );
+    self -> done [ idx ] = true;
+    while ( self -> next_done < num_files && self -> done [ self -> next_done ] )
+        self -> ready = kar_parallel_file_end ( self, self -> next_done ++ );
+    KConditionSignal ( self -> cond );
+    KLockUnlock ( self -> lock );
+}
+
+static
+void kar_parallel_finish ( kar_parallel * self, bool failed )
+{
+    if ( self -> lock == NULL )
+        return;
+
+    KLockAcquire ( self -> lock );
+    self -> finished = true;
+    self -> failed = failed;
+    KConditionSignal ( self -> cond );
+    KLockUnlock ( self -> lock );
+}
+
+static
+rc_t CC kar_write_file_job ( uint32_t worker, size_t idx, void *buffer, size_t bsize, void *data )
+{
+    rc_t rc = 0;
+    kar_parallel * self = data;
+    const KARFile * file = self -> file_array [ idx ];
+    uint64_t dst_pos = self -> starting_pos + file -> byte_offset;
+    uint64_t end = kar_parallel_file_end ( self, idx );
+
+    if ( file -> byte_size != 0 )
+    {
+        int src_fd, dst_fd;
+        char filename [ 4096 ];
+        size_t path_size = kar_entry_full_path ( & file -> dad, self -> root_dir, filename, sizeof filename );
+        if ( path_size == sizeof filename )
+        {
+            rc = RC ( rcExe, rcFile, rcWriting, rcMemory, rcExhausted );
+            LogErr ( klogInt, rc, "File path was too long" );
+            return rc;
+        }
+
+        STATUS ( STAT_QA, "writing file '%s' on thread %u", filename, worker );
+
+        src_fd = kar_copy_open_native ( self -> wd, false, filename );
+        dst_fd = kar_copy_open_native ( self -> wd, true, self -> archive_path );
+        if ( src_fd >= 0 && dst_fd >= 0 )
+        {
+            rc = kar_copy_range ( src_fd, 0, dst_fd, dst_pos, file -> byte_size, buffer, bsize );
+            if ( rc != 0 )
+                pLogErr ( klogInt, rc, "Failed to copy file $(fname)", "fname=%s", filename );
+        }
+        else
+        {
+            const KFile *f;
+            rc = KDirectoryOpenFileRead ( self -> wd, &f, "%s", filename );
+            if ( rc != 0 )
+                pLogErr ( klogInt, rc, "Failed to open file $(fname)", "fname=%s", filename );
+            else
+            {
+                uint64_t pos;
+                size_t num_read;
+
+                for ( pos = 0; rc == 0 && pos < file -> byte_size; pos += num_read )
+                {
+                    size_t to_read = bsize;
+                    if ( pos + to_read > file -> byte_size )
+                        to_read = ( size_t ) ( file -> byte_size - pos );
+
+                    rc = KFileReadAll ( f, pos, buffer, to_read, & num_read );
+                    if ( rc == 0 && num_read == 0 )
+                        rc = RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+                    if ( rc == 0 )
+                        rc = KFileWriteAll ( self -> archive, dst_pos + pos, buffer, num_read, NULL );
+                }
+
+                if ( rc != 0 )
+                    pLogErr ( klogInt, rc, "Failed to copy file $(fname)", "fname=%s", filename );
+
+                KFileRelease ( f );
+            }
+        }
+
+        kar_copy_close_native ( dst_fd );
+        kar_copy_close_native ( src_fd );
+
+        /* the alignment the sequential writer puts before the next file */
+        dst_pos += file -> byte_size;
+        if ( rc == 0 && end > dst_pos )
+        {
+            char align_buffer [ 4 ] = "0000";
+            rc = KFileWriteAll ( self -> archive, dst_pos, align_buffer, ( size_t ) ( end - dst_pos ), NULL );
+            if ( rc != 0 )
+                LogErr ( klogInt, rc, "Failed to write alignment" );
+        }
+    }
+
+    if ( rc == 0 )
+        kar_parallel_mark_done ( self, idx );
+
+    return rc;
+}
+
+static
+rc_t CC kar_parallel_md5 ( const KThread *t, void *data )
+{
+    rc_t rc;
+    kar_parallel * self = data;
+    const KFile * archive;
+
+    rc = KDirectoryOpenFileRead ( self -> wd, &archive, "%s", self -> archive_path );
+    if ( rc != 0 )
+        pLogErr ( klogErr, rc, "Failed to reopen archive $(archive)", "archive=%s", self -> archive_path );
+    else
+    {
+        MD5State md5;
+        uint64_t hashed = 0;
+        size_t bsize = 4 * 1024 * 1024;
+        char * buffer = malloc ( bsize );
+
+        if ( buffer == NULL )
+            rc = RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+
+        MD5StateInit ( & md5 );
+        while ( rc == 0 )
+        {
+            uint64_t ready;
+            bool finished;
+
+            KLockAcquire ( self -> lock );
+            while ( self -> ready == hashed && ! self -> finished )
+                KConditionWait ( self -> cond, self -> lock );
+            ready = self -> ready;
+            finished = self -> finished;
+            if ( self -> failed )
+                rc = RC ( rcExe, rcFile, rcWriting, rcTransfer, rcCanceled );
+            KLockUnlock ( self -> lock );
+
+            if ( rc != 0 || ( ready == hashed && finished ) )
+                break;
+
+            while ( rc == 0 && hashed < ready )
+            {
+                size_t num_read, to_read = bsize;
+                if ( hashed + to_read > ready )
+                    to_read = ( size_t ) ( ready - hashed );
+
+                rc = KFileReadAll ( archive, hashed, buffer, to_read, & num_read );
+                if ( rc == 0 && num_read == 0 )
+                    rc = RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+                if ( rc == 0 )
+                {
+                    MD5StateAppend ( & md5, buffer, num_read );
+                    hashed += num_read;
+                }
+            }
+        }
+
+        if ( rc == 0 )
+        {
+            uint8_t digest [ 16 ];
+            KFile *md5_f;
+
+            MD5StateFinish ( & md5, digest );
+
+            rc = KDirectoryCreateFile ( ( KDirectory * ) self -> wd, &md5_f, false, 0664,
+                                        self -> md5_mode, "%s.md5", self -> archive_path );
+            if ( rc != 0 )
+                PLOGERR (klogFatal, (klogFatal, rc, "unable to create md5 file [$(A).md5]", PLOG_S(A), self -> archive_path));
+            else
+            {
+                KMD5SumFmt *fmt;
+                rc = KMD5SumFmtMakeUpdate ( &fmt, md5_f );
+                if ( rc != 0 )
+                {
+                    LOGERR (klogErr, rc, "failed to make KMD5SumFmt");
+                    KFileRelease ( md5_f );
+                }
+                else
+                {
+                    size_t size = string_size ( self -> archive_path );
+                    const char *fname = string_rchr ( self -> archive_path, size, '/' );
+                    if ( fname ++ == NULL )
+                        fname = self -> archive_path;
+
+                    rc = KMD5SumFmtUpdate ( fmt, fname, digest, false );
+                    if ( rc != 0 )
+                        LOGERR (klogErr, rc, "failed to write md5 file");
+
+                    KMD5SumFmtRelease ( fmt );
+                }
+            }
+        }
+
+        free ( buffer );
+        KFileRelease ( archive );
+    }
+
+    return rc;
+}
+
+static
+rc_t kar_make_parallel ( const KDirectory * wd, KFile *archive, const BSTree *tree, const Params *p )
+{
+    rc_t rc = 0;
+
+    KARFilePtrArray file_array;
+
+    rc = kar_prepare_toc ( tree, &file_array );
+    if ( rc == 0 )
+    {
+        KARArchiveFile af;
+        kar_parallel par;
+        KThread * md5_thread = NULL;
+
+        af . starting_pos = 0;
+        af . pos = 0;
+        af . archive = archive;
+
+        kar_write_header_v1 ( & af, kar_eval_toc_size ( tree ) );
+        kar_write_toc ( & af, tree );
+
+        memset ( & par, 0, sizeof par );
+        par . wd = wd;
+        par . archive = archive;
+        par . archive_path = p -> archive_path;
+        par . root_dir = p -> directory_path;
+        par . file_array = file_array;
+        par . starting_pos = af . starting_pos;
+        par . ready = af . starting_pos;
+        par . md5_mode = ( p -> force ? kcmInit : kcmCreate ) | kcmParents;
+
+        if ( p -> md5sum )
+        {
+            par . done = calloc ( num_files + 1, sizeof par . done [ 0 ] );
+            if ( par . done == NULL )
+                rc = RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+            if ( rc == 0 )
+                rc = KLockMake ( & par . lock );
+            if ( rc == 0 )
+                rc = KConditionMake ( & par . cond );
+            if ( rc == 0 )
+                rc = KThreadMake ( & md5_thread, kar_parallel_md5, & par );
+            if ( rc != 0 )
+                LogErr ( klogInt, rc, "Failed to start md5 thread" );
+        }
+
+        if ( rc == 0 )
+        {
+            STATUS ( STAT_QA, "about to write %u files on %u threads", num_files, p -> threads );
+            rc = kar_copy_pool_run ( p -> threads, ( size_t ) num_files, 16 * 1024 * 1024,
+                                     kar_write_file_job, & par );
+        }
+
+        if ( md5_thread != NULL )
+        {
+            rc_t md5_rc = 0;
+
+            kar_parallel_finish ( & par, rc != 0 );
+            KThreadWait ( md5_thread, & md5_rc );
+            KThreadRelease ( md5_thread );
+            if ( rc == 0 )
+                rc = md5_rc;
+        }
+
+        KConditionRelease ( par . cond );
+        KLockRelease ( par . lock );
+        free ( par . done );
+        free ( file_array );
+    }
+
+    return rc;
+}
+
 
 /********** main create execution  */
 
@@ -1342,7 +1670,8 @@ rc_t kar_create ( const Params *p )
         }
         else
         {
-            if ( p -> md5sum )
+            /* the parallel writer computes the md5 on its own */
+            if ( p -> md5sum && p -> threads == 0 )
                 rc = kar_md5 ( wd, &archive, p -> archive_path, mode );
  
             if ( rc == 0 )
@@ -1365,7 +1694,10 @@ rc_t kar_create ( const Params *p )
                         {
                             BSTreeForEach ( &tree, false, kar_entry_link_parent_dir, NULL );
                             
-                            rc = kar_make ( wd, archive, &tree, p -> directory_path );
+                            if ( p -> threads != 0 )
+                                rc = kar_make_parallel ( wd, archive, &tree, p );
+                            else
+                                rc = kar_make ( wd, archive, &tree, p -> directory_path );
                             if ( rc != 0 )
                                 LogErr ( klogInt, rc, "Failed to build archive" );
                         }
@@ -2029,6 +2361,10 @@ struct extract_block
 
     rc_t rc;
 
+    /* with --threads: worker count and the archive as a local descriptor,
+       -1 when the archive is not a local file */
+    uint32_t threads;
+    int archive_fd;
 };
 
 static bool CC kar_extract ( BSTNode *node, void *data );
@@ -2115,6 +2451,60 @@ rc_t store_extracted_file ( stored_file * sf, const extract_block * eb )
     return rc;
 }   /* store_extracted_file () */
 
+static
+rc_t CC store_extracted_file_job ( uint32_t worker, size_t idx, void *buffer, size_t bsize, void *data )
+{
+    const extract_block * eb = data;
+    stored_file * sf = eb -> depot -> depot + idx;
+    uint64_t src_pos = SF_SF(sf,byte_offset) + eb -> extract_pos;
+    int dst_fd = -1;
+    KFile *dst;
+
+    rc_t rc = KDirectoryCreateFile ( sf -> cdir, &dst, false, 0200,
+                                     kcmCreate, "%s", SF_SE(sf,name) );
+    if ( rc != 0 )
+    {
+        pLogErr (klogErr, rc, "failed extract to file '$(fname)'", "fname=%s", SF_SE(sf,name) );
+        return rc;
+    }
+
+    STATUS ( STAT_QA, "extracting file '%s' on thread %u", SF_SE(sf,name), worker );
+
+    if ( eb -> archive_fd >= 0 && SF_SF(sf,byte_size) != 0 )
+        dst_fd = kar_copy_open_native ( sf -> cdir, true, SF_SE(sf,name) );
+
+    if ( dst_fd >= 0 )
+    {
+        rc = kar_copy_range ( eb -> archive_fd, src_pos, dst_fd, 0, SF_SF(sf,byte_size), buffer, bsize );
+        kar_copy_close_native ( dst_fd );
+    }
+    else
+    {
+        uint64_t total;
+        size_t num_read;
+
+        for ( total = 0; rc == 0 && total < SF_SF(sf,byte_size); total += num_read )
+        {
+            size_t to_read = bsize;
+            if ( total + to_read > SF_SF(sf,byte_size) )
+                to_read = ( size_t ) ( SF_SF(sf,byte_size) - total );
+
+            rc = KFileReadAll ( eb -> archive, src_pos + total, buffer, to_read, &num_read );
+            if ( rc == 0 && num_read == 0 )
+                rc = RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+            if ( rc == 0 )
+                rc = KFileWriteAll ( dst, total, buffer, num_read, NULL );
+        }
+    }
+
+    if ( rc != 0 )
+        pLogErr (klogErr, rc, "failed to extract file '$(fname)'", "fname=%s", SF_SE(sf,name) );
+
+    KFileRelease ( dst );
+
+    return rc;
+}   /* store_extracted_file_job () */
+
 int64_t CC
 store_extracted_files_comparator (
                                     const void * l,
@@ -2143,6 +2533,16 @@ rc_t store_extracted_files ( const extract_block * eb )
             NULL
             );
 
+    if ( eb -> threads != 0 ) {
+        rc = kar_copy_pool_run ( eb -> threads, fb -> qty, 16 * 1024 * 1024,
+                                 store_extracted_file_job, ( void * ) eb );
+        if ( rc != 0 ) {
+            pLogErr (klogErr, rc, "failed to store extracted files", "" );
+            exit ( 4 );
+        }
+        return rc;
+    }
+
     for ( size_t llp = 0; llp < fb -> qty; llp ++ ) {
         stored_file * sf = fb -> depot + llp;
         rc = store_extracted_file ( sf, eb );
@@ -2356,6 +2756,17 @@ rc_t kar_test_extract ( const Params *p )
                     eb . archive = archive;
                     eb . extract_pos = file_offset;
                     eb . rc = 0;
+                    eb . threads = p -> threads;
+                    eb . archive_fd = -1;
+
+                    /* only a local archive can be read concurrently and in-kernel */
+                    if ( p -> threads != 0 )
+                    {
+                        if ( ( KDirectoryPathType ( wd, "%s", p -> archive_path ) & ~ kptAlias ) == kptFile )
+                            eb . archive_fd = kar_copy_open_native ( wd, false, p -> archive_path );
+                        if ( eb . archive_fd < 0 )
+                            eb . threads = 1;
+                    }
 
                     rc = file_depot_make ( & eb . depot, 256 );
                     if ( rc == 0 )
@@ -2393,6 +2804,8 @@ rc_t kar_test_extract ( const Params *p )
 
                         file_depot_dispose ( eb . depot );
                     }
+
+                    kar_copy_close_native ( eb . archive_fd );
                 }
             }
 
@@ -814,6 +814,9 @@ EOF
         ICMD="$ICMD --force"
     fi
 
+    ## The whole archive is still unpacked here: make-read-filter and
+    ## kar+meta need the database open for update. Export repacks from
+    ## the original archive, reading only the files changed in between
     dpec__ 62; exec_cmd_exit $ICMD --extract $ORIG_KAR_FILE --directory $DATABASE_DIR
 
     if [ -e "$ORIG_CACHE_FILE" ]
@@ -1384,6 +1387,13 @@ kar_new ()
         TCNT=$(( $TCNT + 1 ))
     done
 
+    ## Members which delite did not touch are streamed from original
+    ## archive, only modified files are read from database directory
+    if [ -f "$ORIG_KAR_FILE" ]
+    then
+        TCMD="$TCMD --repack $ORIG_KAR_FILE"
+    fi
+
     TCMD="$TCMD --create $NEW_KAR_FILE --directory $DATABASE_DIR"
 
     dpec__ 62; exec_cmd_exit $TCMD
@@ -1398,6 +1408,11 @@ kar_new ()
             TCMD="$TCMD -f"
         fi
 
+        if [ -f "$ORIG_CACHE_FILE" ]
+        then
+            TCMD="$TCMD --repack $ORIG_CACHE_FILE"
+        fi
+
         TCMD="$TCMD --create $NEW_CACHE_FILE --directory $DATABASE_CACHE_DIR"
 
         dpec__ 62; exec_cmd_exit $TCMD
@@ -72,6 +72,13 @@ struct HDF5ArrayFile
 };
 
 
+/* the hdf5-library is not built threadsafe by default:
+   every call into it is serialized by a process-wide lock,
+   it is recursive because H5Literate calls back into hdf5dir.c */
+void HDF5Lock ( void );
+void HDF5Unlock ( void );
+
+
 #ifdef __cplusplus
 }
 #endif
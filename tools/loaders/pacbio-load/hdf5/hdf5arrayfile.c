@@ -121,7 +121,9 @@ rc_t HDF5ArrayFile_close ( HDF5ArrayFile * self )
 static
 rc_t CC HDF5ArrayFileDestroy ( HDF5ArrayFile *self )
 {
+    HDF5Lock ();
     HDF5ArrayFile_close ( self );
+    HDF5Unlock ();
     free ( self );
     return 0;
 }
@@ -315,7 +317,9 @@ rc_t CC HDF5ArrayFileRead ( const HDF5ArrayFile *self, uint8_t dim,
     if ( rc != 0 )
         return rc;
 
+    HDF5Lock ();
     rc = HDF5ArrayFileRead_intern ( self, hf_ofs, buffer, hf_count );
+    HDF5Unlock ();
     if ( rc == 0 )
     {
         uint8_t i;
@@ -427,7 +431,9 @@ rc_t CC HDF5ArrayFileRead_v ( const HDF5ArrayFile *self, uint8_t dim,
     for ( i = 0; i < dim; ++i )
         hf_ofs[ i ] = ( hsize_t )pos[ i ];
 
+    HDF5Lock ();
     rc = HDF5ArrayFileRead_v_intern ( self, dim, hf_ofs, buffer, buffer_size, num_read );
+    HDF5Unlock ();
 
     free( hf_ofs );
 
@@ -506,7 +512,9 @@ rc_t CC HDF5ArrayFileWrite ( HDF5ArrayFile *self, uint8_t dim,
     rc = HDF5ArrayMakeRdWrOfsCnt( dim, pos, elem_count, &hf_ofs, &hf_count );
     if ( rc != 0 )
         return rc;
+    HDF5Lock ();
     rc = HDF5ArrayFileWrite_intern ( self, hf_ofs, buffer, hf_count );
+    HDF5Unlock ();
     if ( rc == 0 )
     {
         uint8_t i;
@@ -533,7 +541,10 @@ rc_t CC HDF5ArrayFileGetMeta ( const HDF5ArrayFile *self, const char *key,
     const KNamelist **list )
 {
     rc_t rc;
-    hid_t attr = H5Aopen_by_name( self->dataset_handle, ".", key, H5P_DEFAULT, H5P_DEFAULT );
+    hid_t attr;
+
+    HDF5Lock ();
+    attr = H5Aopen_by_name( self->dataset_handle, ".", key, H5P_DEFAULT, H5P_DEFAULT );
     if ( attr < 0 )
         rc = RC( rcFS, rcFile, rcReading, rcTransfer, rcInvalid );
     else
@@ -594,6 +605,7 @@ rc_t CC HDF5ArrayFileGetMeta ( const HDF5ArrayFile *self, const char *key,
         }
         H5Aclose( attr );
     }
+    HDF5Unlock ();
     return rc;
 }
 
@@ -643,7 +655,9 @@ rc_t HDF5ArrayFileMake ( struct HDF5ArrayFile **fp,
     if ( rc == 0 )
     {
         f -> parent = parent;
+        HDF5Lock ();
         rc = HDF5ArrayFile_open ( f, dataset_handle );
+        HDF5Unlock ();
         if ( rc == 0 )
         {
             * fp = f;
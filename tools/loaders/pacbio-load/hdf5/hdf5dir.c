@@ -33,6 +33,7 @@ typedef struct HDF5Dir HDF5Dir;
 #include <kfs/extern.h> /* may need to be changed */
 #include <kfs/impl.h>
 #include <hdf5.h>
+#include "hdf5arrayfile-priv.h"
 #include <klib/rc.h>
 #include <klib/namelist.h>
 #include <klib/text.h>
@@ -44,6 +45,7 @@ typedef struct HDF5Dir HDF5Dir;
 #include <string.h>
 #include <assert.h>
 #include <stdarg.h>
+#include <pthread.h>
 
 
 #if 0 /* These directives merely serve to limit portability. */
@@ -59,6 +61,35 @@ typedef struct HDF5File HDF5File;
 rc_t CC HDF5FileMake ( HDF5File **fp, hid_t dataset_handle,
         bool read_enabled, bool write_enabled );
 
+/* the lock behind HDF5Lock / HDF5Unlock ( hdf5arrayfile-priv.h ),
+   a pthread-mutex because KLock is not recursive */
+static pthread_mutex_t hdf5_lock;
+static pthread_once_t hdf5_lock_once = PTHREAD_ONCE_INIT;
+
+static
+void hdf5_lock_init ( void )
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init ( &attr );
+    pthread_mutexattr_settype ( &attr, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init ( &hdf5_lock, &attr );
+    pthread_mutexattr_destroy ( &attr );
+}
+
+
+void HDF5Lock ( void )
+{
+    pthread_once ( &hdf5_lock_once, hdf5_lock_init );
+    pthread_mutex_lock ( &hdf5_lock );
+}
+
+
+void HDF5Unlock ( void )
+{
+    pthread_mutex_unlock ( &hdf5_lock );
+}
+
+
 /* object structure */
 struct HDF5Dir
 {
@@ -103,6 +134,7 @@ static
 rc_t CC HDF5DirDestroy ( HDF5Dir *self )
 {
     KDirectoryRelease ( ( KDirectory* ) self -> parent );
+    HDF5Lock ();
     if ( self->h5root )
     {
         H5Fclose( self->hdf5_handle );
@@ -110,6 +142,7 @@ rc_t CC HDF5DirDestroy ( HDF5Dir *self )
     }
     else
         H5Oclose( self->hdf5_handle );
+    HDF5Unlock ();
     free( self );
     return 0;
 }
@@ -177,8 +210,10 @@ rc_t CC HDF5DirList ( const HDF5Dir *self, struct KNamelist **list,
             ctx.dir = self;
             ctx.f = f;
             ctx.data = data;
+            HDF5Lock ();
             H5Literate( self->hdf5_handle, H5_INDEX_NAME, H5_ITER_INC,
                         NULL, dir_list_cb, &ctx );
+            HDF5Unlock ();
             rc = VNamelistToNamelist ( ctx.groups, list );
             VNamelistRelease ( ctx.groups );
         }
@@ -292,7 +327,11 @@ rc_t CC HDF5DirVisitUpdate ( HDF5Dir *self, bool recurse,
 static uint32_t HDF5DirPathTypeOnBuffer( const HDF5Dir *self, const char *buffer )
 {
     H5O_info_t obj_info;
-    herr_t h5e = H5Oget_info_by_name( self->hdf5_handle, buffer, &obj_info, H5P_DEFAULT );
+    herr_t h5e;
+
+    HDF5Lock ();
+    h5e = H5Oget_info_by_name( self->hdf5_handle, buffer, &obj_info, H5P_DEFAULT );
+    HDF5Unlock ();
     if ( h5e >= 0 )
     {
         switch( obj_info.type )
@@ -520,7 +559,9 @@ rc_t CC HDF5DirOpenFileRead ( const HDF5Dir *self,
     if ( path_type != kptDataset )
         return RC( rcFS, rcDirectory, rcAccessing, rcInterface, rcUnsupported );
 
+    HDF5Lock ();
     dataset_handle = H5Dopen2( self->hdf5_handle, buffer, H5P_DEFAULT );
+    HDF5Unlock ();
     if ( dataset_handle < 0 )
         return RC( rcFS, rcDirectory, rcAccessing, rcInterface, rcUnsupported );
 
@@ -698,7 +739,9 @@ rc_t CC HDF5DirOpenDirRead ( const HDF5Dir *self,
     rc = HDF5DirInit ( new_dir, rcOpening, 0, buffer, buffer_size, false, false );
     if ( rc == 0 )
     {
+        HDF5Lock ();
         new_dir -> hdf5_handle = H5Gopen( self -> hdf5_handle, buffer, H5P_DEFAULT );
+        HDF5Unlock ();
         if ( new_dir -> hdf5_handle >= 0 )
         {
             new_dir -> parent = (KDirectory *)&self->dad;
@@ -845,7 +888,9 @@ LIB_EXPORT rc_t CC MakeHDF5RootDir ( KDirectory * self, KDirectory ** hdf5_dir,
     }
 
     /* mute the error stack */
+    HDF5Lock ();
     H5Eset_auto( H5E_DEFAULT, NULL, NULL );
+    HDF5Unlock ();
 
     new_dir = HDF5DirMake ( path_size );
     if ( new_dir == NULL )
@@ -855,6 +900,7 @@ LIB_EXPORT rc_t CC MakeHDF5RootDir ( KDirectory * self, KDirectory ** hdf5_dir,
     rc = HDF5DirInit ( new_dir, rcAccessing, 0, resolved, path_size, false, false );
     if ( rc == 0 )
     {
+        HDF5Lock ();
         /* create a access-property list for file-access */
         new_dir -> file_access_property_list = H5Pcreate( H5P_FILE_ACCESS );
         /* set the property-list to use the stdio (buffered) VFL-driver */
@@ -863,6 +909,7 @@ LIB_EXPORT rc_t CC MakeHDF5RootDir ( KDirectory * self, KDirectory ** hdf5_dir,
         new_dir -> hdf5_handle = H5Fopen( resolved, 
                                           H5F_ACC_RDONLY, 
                                           new_dir -> file_access_property_list /*H5P_DEFAULT*/ );
+        HDF5Unlock ();
         if ( new_dir -> hdf5_handle >= 0 )
         {
             new_dir -> parent = self;
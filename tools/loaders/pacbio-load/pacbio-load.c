@@ -58,6 +58,8 @@
 
 #include <kfs/arrayfile.h>
 
+#include <kproc/thread.h>
+
 #include <loader/loader-meta.h>
 
 #include <sysalloc.h>
@@ -86,6 +88,8 @@ static const char* tabs_usage[] = { "load only these tabs (SCPM), dflt=all",
                                      " P...Passes",
                                      " M...Metrics", NULL };
 static const char* progress_usage[] = { "show load-progress", NULL };
+static const char* pipeline_usage[] = { "load the tables in parallel, each on its own thread,",
+                                        "reading the HDF5-source ahead in large chunks", NULL };
 
 
 rc_t CC Usage ( const Args * args )
@@ -112,6 +116,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( ALIAS_TABS, OPTION_TABS, "tabs", tabs_usage );
     HelpOptionLine ( ALIAS_WITH_PROGRESS, OPTION_WITH_PROGRESS,
                      "load-progress", progress_usage );
+    HelpOptionLine ( ALIAS_PIPELINE, OPTION_PIPELINE, NULL, pipeline_usage );
     XMLLogger_Usage();
     HelpOptionsStandard ();
     HelpVersion ( fullpath, KAppVersion() );
@@ -293,6 +298,143 @@ static rc_t pacbio_load_src( context *ctx, seq_con_pas_met * dst, KDirectory * s
 }
 
 
+/* pipeline-mode: every table is loaded by its own writer-thread */
+enum
+{
+    pl_writer_sequence = 0,
+    pl_writer_consensus,
+    pl_writer_passes,
+    pl_writer_metrics,
+    pl_writer_count
+};
+
+
+typedef struct pl_writer
+{
+    KThread * thread;
+    seq_con_pas_met * dst;
+    KDirectory * src;
+    ld_context lctx;        /* private copy: every table has its own progress-bar */
+    uint32_t table;
+    rc_t rc;
+} pl_writer;
+
+
+static ld_context ** pl_writer_lctx( seq_con_pas_met * dst, uint32_t table )
+{
+    switch( table )
+    {
+    case pl_writer_sequence  : return &dst->sequence.lctx;
+    case pl_writer_consensus : return &dst->consensus.lctx;
+    case pl_writer_passes    : return &dst->passes.lctx;
+    default                  : return &dst->metrics.lctx;
+    }
+}
+
+
+static rc_t CC pl_writer_thread( const KThread *self, void *data )
+{
+    pl_writer * w = data;
+    switch( w->table )
+    {
+    case pl_writer_sequence  : return load_seq_src( &w->dst->sequence, w->src ); /* pl-sequence.c */
+    case pl_writer_consensus : return load_consensus_src( &w->dst->consensus, w->src ); /* pl-consensus.c */
+    case pl_writer_passes    : return load_passes_src( &w->dst->passes, w->src ); /* pl-passes.c */
+    case pl_writer_metrics   : return load_metrics_src( &w->dst->metrics, w->src ); /* pl-metrics.c */
+    }
+    return RC( rcExe, rcThread, rcExecuting, rcParam, rcInvalid );
+}
+
+
+/* the tables are independent of each other, the cursors have been opened
+   by pacbio_prepare(), access to the HDF5-source is serialized by the hdf5-dir */
+static rc_t pacbio_load_src_pipelined( context *ctx, seq_con_pas_met * dst, KDirectory * src, bool * consensus_present )
+{
+    pl_writer w[ pl_writer_count ];
+    bool run[ pl_writer_count ];
+    ld_context * lctx = dst->sequence.lctx;
+    bool con_group = ( KDirectoryPathType ( src, "PulseData/ConsensusBaseCalls" ) == kptDir );
+    uint32_t idx;
+    rc_t rc = progress_lock_make(); /* pl-tools.c */
+
+    /* passes and metrics are only loaded together with consensus */
+    run[ pl_writer_sequence ]  = ctx_ld_sequence( ctx );
+    run[ pl_writer_consensus ] = ctx_ld_consensus( ctx );
+    run[ pl_writer_passes ]    = ctx_ld_passes( ctx ) &&
+                                 ( *consensus_present || ( run[ pl_writer_consensus ] && con_group ) );
+    run[ pl_writer_metrics ]   = ctx_ld_metrics( ctx ) &&
+                                 ( *consensus_present || ( run[ pl_writer_consensus ] && con_group ) );
+
+    for ( idx = 0; idx < pl_writer_count; ++idx )
+    {
+        w[ idx ].thread = NULL;
+        w[ idx ].rc = 0;
+        if ( run[ idx ] && rc == 0 )
+        {
+            w[ idx ].dst = dst;
+            w[ idx ].src = src;
+            w[ idx ].table = idx;
+            w[ idx ].lctx = *lctx;
+            w[ idx ].lctx.xml_progress = NULL;
+            /* only one progressbar on the console */
+            w[ idx ].lctx.with_progress = ( lctx->with_progress && idx == pl_writer_sequence );
+            *pl_writer_lctx( dst, idx ) = &w[ idx ].lctx;
+            rc = KThreadMake ( &w[ idx ].thread, pl_writer_thread, &w[ idx ] );
+            if ( rc != 0 )
+            {
+                LOGERR( klogErr, rc, "cannot start writer-thread" );
+                w[ idx ].thread = NULL;
+                run[ idx ] = false;
+            }
+        }
+        else
+            run[ idx ] = false;
+    }
+
+    for ( idx = 0; idx < pl_writer_count; ++idx )
+    {
+        if ( w[ idx ].thread != NULL )
+        {
+            rc_t rc2 = KThreadWait ( w[ idx ].thread, &w[ idx ].rc );
+            if ( rc2 != 0 )
+                w[ idx ].rc = rc2;
+            KThreadRelease ( w[ idx ].thread );
+        }
+        if ( run[ idx ] )
+        {
+            *pl_writer_lctx( dst, idx ) = lctx;
+            if ( w[ idx ].lctx.xml_progress != NULL )
+                KLoadProgressbar_Release( w[ idx ].lctx.xml_progress, false );
+        }
+    }
+    progress_lock_release(); /* pl-tools.c */
+
+    if ( run[ pl_writer_sequence ] )
+    {
+        lctx->total_seq_bases = w[ pl_writer_sequence ].lctx.total_seq_bases;
+        lctx->total_seq_spots = w[ pl_writer_sequence ].lctx.total_seq_spots;
+        if ( rc == 0 )
+            rc = w[ pl_writer_sequence ].rc;
+    }
+
+    if ( run[ pl_writer_consensus ] )
+    {
+        if ( w[ pl_writer_consensus ].rc == 0 )
+            *consensus_present = true;
+        else
+            LOGMSG( klogWarn, "the consensus-group is missing" );
+    }
+
+    if ( run[ pl_writer_passes ] && w[ pl_writer_passes ].rc != 0 )
+        LOGMSG( klogWarn, "the passes-table is missing" );
+
+    if ( run[ pl_writer_metrics ] && w[ pl_writer_metrics ].rc != 0 )
+        LOGMSG( klogWarn, "the metrics-table is missing" );
+
+    return rc;
+}
+
+
 static rc_t pacbio_finish( seq_con_pas_met * dst )
 {
     rc_t rc = finish_seq( &dst->sequence ); /* pl-sequence.c */
@@ -377,7 +519,10 @@ static rc_t pacbio_load_multipart( context * ctx, KDirectory * wd, VDatabase * d
     rc_t rc = pacbio_prepare( database, &dst, *hdf5_src, lctx );
     while ( idx < count && rc == 0 )
     {
-        rc = pacbio_load_src( ctx, &dst, *hdf5_src, consensus_present );
+        if ( ctx->pipeline )
+            rc = pacbio_load_src_pipelined( ctx, &dst, *hdf5_src, consensus_present );
+        else
+            rc = pacbio_load_src( ctx, &dst, *hdf5_src, consensus_present );
         idx++;
         if ( rc == 0 && idx < count )
         {
@@ -582,6 +727,7 @@ OptDef MyOptions[] =
     { OPTION_FORCE, ALIAS_FORCE, NULL, force_usage, 1, false, false },
     { OPTION_WITH_PROGRESS, ALIAS_WITH_PROGRESS, NULL, progress_usage, 1, false, false },
     { OPTION_TABS, ALIAS_TABS, NULL, tabs_usage, 1, true, false },
+    { OPTION_PIPELINE, ALIAS_PIPELINE, NULL, pipeline_usage, 1, false, false },
     { OPTION_OUTPUT, ALIAS_OUTPUT, NULL, output_usage, 1, true, true }
 };
 
@@ -629,6 +775,7 @@ rc_t CC KMain ( int argc, char *argv [] )
                         lctx.dst_path = ctx.dst_path;
                         lctx.cache_content = false;
                         lctx.check_src_obj = false;
+                        lctx.pipeline = ctx.pipeline;
 
                         rc = KLoadProgressbar_Make( &lctx.xml_progress, 0 );
                         if ( rc != 0 )
@@ -95,3 +95,34 @@ rc_t open_BaseCalls_cmn( const KDirectory *hdf5_dir, BaseCalls_cmn *tab,
         close_BaseCalls_cmn( tab ); /* releases only initialized elements */
     return rc;
 }
+
+
+rc_t prefetch_BaseCalls_cmn( BaseCalls_cmn *tab, const uint64_t offset, const uint64_t count )
+{
+    rc_t rc = array_file_prefetch( &tab->Basecall, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->QualityValue, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->DeletionQV, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->DeletionTag, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->InsertionQV, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->SubstitutionQV, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->SubstitutionTag, offset, count );
+    return rc;
+}
+
+
+void swap_BaseCalls_cmn( BaseCalls_cmn *tab )
+{
+    array_file_swap( &tab->Basecall );
+    array_file_swap( &tab->QualityValue );
+    array_file_swap( &tab->DeletionQV );
+    array_file_swap( &tab->DeletionTag );
+    array_file_swap( &tab->InsertionQV );
+    array_file_swap( &tab->SubstitutionQV );
+    array_file_swap( &tab->SubstitutionTag );
+}
@@ -53,6 +53,10 @@ rc_t open_BaseCalls_cmn( const KDirectory *hdf5_dir, BaseCalls_cmn *tab,
                          const bool num_passes, const char * path,
                          bool cache_content, bool supress_err_msg );
 
+/* pipeline-mode: prefetch / swap the windows of all base-columns */
+rc_t prefetch_BaseCalls_cmn( BaseCalls_cmn *tab, const uint64_t offset, const uint64_t count );
+void swap_BaseCalls_cmn( BaseCalls_cmn *tab );
+
 #ifdef __cplusplus
 }
 #endif
@@ -419,6 +419,19 @@ rc_t prepare_consensus( VDatabase * database, con_ctx * sctx, ld_context *lctx )
 }
 
 
+/* pipeline-mode: prefetch the events of the next zmw-block on the reader-thread */
+static rc_t consensus_prefetch( void * data, const uint64_t offset, const uint64_t count )
+{
+    return prefetch_BaseCalls_cmn( (BaseCalls_cmn *)data, offset, count );
+}
+
+
+static void consensus_swap( void * data )
+{
+    swap_BaseCalls_cmn( (BaseCalls_cmn *)data );
+}
+
+
 rc_t load_consensus_src( con_ctx * sctx, KDirectory * hdf5_src )
 {
     BaseCalls_cmn ConsensusTab;
@@ -444,6 +457,11 @@ rc_t load_consensus_src( con_ctx * sctx, KDirectory * hdf5_src )
 
         if ( !check_Consensus_totalcount( &ConsensusTab, total_bases ) )
             rc = RC( rcExe, rcNoTarg, rcAllocating, rcParam, rcInvalid );
+        else if ( sctx->lctx->pipeline )
+            rc = zmw_for_each_pipelined( &ConsensusTab.zmw, &sctx->lctx->xml_progress, sctx->cursor,
+                               sctx->lctx->with_progress, sctx->col_idx, NULL,
+                               true, consensus_load_spot, consensus_prefetch, consensus_swap,
+                               &ConsensusTab );
         else
             rc = zmw_for_each( &ConsensusTab.zmw, &sctx->lctx->xml_progress, sctx->cursor,
                                sctx->lctx->with_progress, sctx->col_idx, NULL,
@@ -114,6 +114,7 @@ rc_t ctx_init( const Args * args, context *ctx )
     ctx->tabs = NULL;
     ctx->force = false;
     ctx->with_progress = false;
+    ctx->pipeline = false;
 
     rc = VNamelistMake ( &ctx->src_paths, 5 );
     if ( rc == 0 )
@@ -123,6 +124,7 @@ rc_t ctx_init( const Args * args, context *ctx )
         {
             ctx->force = ctx_get_bool( args, OPTION_FORCE, false );
             ctx->with_progress = ctx_get_bool( args, OPTION_WITH_PROGRESS, false );
+            ctx->pipeline = ctx_get_bool( args, OPTION_PIPELINE, false );
             ctx->schema_name = ctx_set_str( ctx_get_str( args, OPTION_SCHEMA, DFLT_SCHEMA ), DFLT_SCHEMA );
             ctx->dst_path = ctx_set_str( ctx_get_str( args, OPTION_OUTPUT, NULL ), NULL );
             ctx->tabs = ctx_set_str( ctx_get_str( args, OPTION_TABS, NULL ), NULL );
@@ -172,6 +174,8 @@ rc_t ctx_show( context * ctx )
         LOGMSG( klogInfo, "   force   : 'no'" );
     if ( ctx->tabs != NULL )
         PLOGMSG( klogInfo, ( klogInfo, "   tabs    : '$(SRC)'", "SRC=%s", ctx->tabs ));
+    if ( ctx->pipeline )
+        LOGMSG( klogInfo, "   pipeline: 'yes'" );
 
     KLogLevelSet( tmp_lvl );
     return rc;
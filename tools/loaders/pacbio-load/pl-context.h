@@ -45,12 +45,14 @@ extern "C" {
 #define OPTION_TABS         "tabs"
 #define OPTION_WITH_PROGRESS  "with_progressbar"
 #define OPTION_OUTPUT       "output"
+#define OPTION_PIPELINE     "pipeline"
 
 #define ALIAS_SCHEMA        "S"
 #define ALIAS_FORCE         "f"
 #define ALIAS_TABS          "t"
 #define ALIAS_WITH_PROGRESS "p"
 #define ALIAS_OUTPUT        "o"
+#define ALIAS_PIPELINE      NULL
 
 #define DFLT_SCHEMA         "sra/pacbio.vschema"
 #define PACBIO_SCHEMA_DB    "NCBI:SRA:PacBio:smrt:db"
@@ -67,6 +69,7 @@ typedef struct context
     VNamelist * src_paths;  /* list of source-paths */
     bool force;         /* if true", overwrite eventually existing output-db */
     bool with_progress; /* if true", use the pl_progressbar */
+    bool pipeline;      /* if true", load the tables in parallel and read ahead */
 } context;
 
 
@@ -567,6 +567,31 @@ static rc_t seq_load_spot( VCursor *cursor, const uint32_t *col_idx,
 }
 
 
+/* pipeline-mode: prefetch the events of the next zmw-block on the reader-thread */
+static rc_t seq_prefetch( void * data, const uint64_t offset, const uint64_t count )
+{
+    BaseCalls *tab = (BaseCalls *)data;
+    rc_t rc = prefetch_BaseCalls_cmn( &tab->cmn, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->PreBaseFrames, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->PulseIndex, offset, count );
+    if ( rc == 0 )
+        rc = array_file_prefetch( &tab->WidthInFrames, offset, count );
+    return rc;
+}
+
+
+static void seq_swap( void * data )
+{
+    BaseCalls *tab = (BaseCalls *)data;
+    swap_BaseCalls_cmn( &tab->cmn );
+    array_file_swap( &tab->PreBaseFrames );
+    array_file_swap( &tab->PulseIndex );
+    array_file_swap( &tab->WidthInFrames );
+}
+
+
 static void seq_load_info( regions_stat * stat )
 {
     KLogLevel tmp_lvl = KLogLevelGet();
@@ -890,7 +915,12 @@ rc_t load_seq_src( seq_ctx * sctx, KDirectory * hdf5_src )
                     mapping_ptr = &mapping;
 
                 /* call for every spot the function >seq_load_spot< */
-                rc = zmw_for_each( &sctx->BaseCallsTab.cmn.zmw, &sctx->lctx->xml_progress, sctx->cursor,
+                if ( sctx->lctx->pipeline )
+                    rc = zmw_for_each_pipelined( &sctx->BaseCallsTab.cmn.zmw, &sctx->lctx->xml_progress,
+                                   sctx->cursor, sctx->lctx->with_progress, sctx->col_idx, mapping_ptr, false,
+                                   seq_load_spot, seq_prefetch, seq_swap, &sctx->BaseCallsTab );
+                else
+                    rc = zmw_for_each( &sctx->BaseCallsTab.cmn.zmw, &sctx->lctx->xml_progress, sctx->cursor,
                                    sctx->lctx->with_progress, sctx->col_idx, mapping_ptr, false,
                                    seq_load_spot, &sctx->BaseCallsTab );
             }
@@ -31,6 +31,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <kproc/lock.h>
+
 #include <kdb/database.h>
 #include <vdb/database.h>
 #include <vdb/vdb-priv.h>
@@ -43,6 +45,7 @@ void lctx_init( ld_context * lctx )
     lctx->total_printed = false;
     lctx->cache_content = false;
     lctx->check_src_obj = false;
+    lctx->pipeline = false;
     lctx->total_seq_bases = 0;
     lctx->total_seq_spots = 0;
 }
@@ -124,6 +127,8 @@ void init_array_file( af_data * af )
     af->extents = NULL;
     af->rc = -1;
     af->content = NULL;
+    memset( af->window, 0, sizeof af->window );
+    af->front = 0;
 }
 
 
@@ -149,6 +154,11 @@ void free_array_file( af_data * af )
         free( af->content );
         af->content = NULL;
     }
+    if ( af->window[ 0 ].data != NULL )
+        free( af->window[ 0 ].data );
+    if ( af->window[ 1 ].data != NULL )
+        free( af->window[ 1 ].data );
+    memset( af->window, 0, sizeof af->window );
 }
 
 
@@ -342,6 +352,67 @@ rc_t open_element( const KDirectory *hdf5_dir,
 }
 
 
+/* returns a pointer into the front-window if it covers the requested elements */
+static const void * array_file_window( const af_data * af, const uint64_t pos,
+                                       const uint64_t count )
+{
+    const af_window * w = &af->window[ af->front ];
+    if ( w->data != NULL && pos >= w->pos && ( pos + count ) <= ( w->pos + w->count ) )
+        return ( const char * )w->data + ( af->element_bits >> 3 ) * ( pos - w->pos );
+    return NULL;
+}
+
+
+rc_t array_file_prefetch( af_data * af, const uint64_t pos, const uint64_t count )
+{
+    rc_t rc = 0;
+    af_window * w = &af->window[ af->front ^ 1 ];
+
+    w->count = 0;
+    if ( af->af == NULL || af->content != NULL || af->dimensionality != 1 || count == 0 )
+        return 0;
+
+    if ( ( pos + count ) > af->extents[ 0 ] )
+        rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInconsistent );
+    else
+    {
+        size_t num = ( af->element_bits >> 3 ) * count;
+        if ( num > w->allocated )
+        {
+            void * p = realloc( w->data, num );
+            if ( p == NULL )
+                rc = RC ( rcExe, rcNoTarg, rcAllocating, rcMemory, rcExhausted );
+            else
+            {
+                w->data = p;
+                w->allocated = num;
+            }
+        }
+        if ( rc == 0 )
+        {
+            uint64_t n_read;
+            rc = KArrayFileRead ( af->af, 1, &pos, w->data, &count, &n_read );
+            if ( rc == 0 && n_read != count )
+                rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInsufficient );
+            if ( rc == 0 )
+            {
+                w->pos = pos;
+                w->count = count;
+            }
+        }
+    }
+    if ( rc != 0 )
+        LOGERR( klogErr, rc, "error prefetching arrayfile-data" );
+    return rc;
+}
+
+
+void array_file_swap( af_data * af )
+{
+    af->front ^= 1;
+}
+
+
 /* we are reading data from an array-file,
    the underlying array-file knows the size of an element */
 rc_t array_file_read_dim1( af_data * af, const uint64_t pos,
@@ -349,7 +420,13 @@ rc_t array_file_read_dim1( af_data * af, const uint64_t pos,
                            uint64_t *n_read )
 {
     rc_t rc = 0;
-    if ( af->content == NULL )
+    const void * window = array_file_window( af, pos, count );
+    if ( window != NULL )
+    {
+        memmove( dst, window, ( af->element_bits >> 3 ) * count );
+        *n_read = count;
+    }
+    else if ( af->content == NULL )
         rc = KArrayFileRead ( af->af, 1, &pos, dst, &count, n_read );
     else
     {
@@ -456,7 +533,20 @@ rc_t transfer_bits( VCursor *cursor, const uint32_t col_idx,
     const uint32_t n_bits, const char * explanation )
 {
     uint64_t n_read;
-    rc_t rc = array_file_read_dim1( src, offset, buffer, count, &n_read );
+    rc_t rc;
+
+    /* in pipeline-mode the data is already in memory, no need to copy it */
+    const void * window = array_file_window( src, offset, count );
+    if ( window != NULL )
+    {
+        rc = VCursorWrite( cursor, col_idx, n_bits, window, 0, count );
+        if ( rc != 0 )
+            PLOGERR( klogErr, ( klogErr, rc, "cannot write data to vdb for '$(name)'",
+                                "name=%s", explanation ) );
+        return rc;
+    }
+
+    rc = array_file_read_dim1( src, offset, buffer, count, &n_read );
     if ( rc == 0 )
     {
         if ( count != n_read )
@@ -570,9 +660,47 @@ rc_t load_table( VDatabase * database, KDirectory * hdf5_src, ld_context *lctx,
 }
 
 
+/* the progressbars of libloader share a global list of jobs,
+   in pipeline-mode the tables report their progress from different threads */
+static KLock * progress_lock = NULL;
+
+rc_t progress_lock_make( void )
+{
+    rc_t rc = KLockMake( &progress_lock );
+    if ( rc != 0 )
+    {
+        LOGERR( klogErr, rc, "cannot make progress-lock" );
+        progress_lock = NULL;
+    }
+    return rc;
+}
+
+
+void progress_lock_release( void )
+{
+    KLockRelease( progress_lock );
+    progress_lock = NULL;
+}
+
+
+static void progress_acquire( void )
+{
+    if ( progress_lock != NULL )
+        KLockAcquire( progress_lock );
+}
+
+
+static void progress_unlock( void )
+{
+    if ( progress_lock != NULL )
+        KLockUnlock( progress_lock );
+}
+
+
 rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chunk )
 {
     rc_t rc;
+    progress_acquire();
     /* release the old progressbar... */
     if ( *xml_progress != NULL )
     {
@@ -585,16 +713,21 @@ rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chun
     else
         LOGERR( klogErr, rc, "cannot make KLoadProgressbar" );
 
+    progress_unlock();
     return rc;
 }
 
 
 rc_t progress_step( const KLoadProgressbar * xml_progress )
 {
+    rc_t rc = 0;
     if ( xml_progress != NULL )
-       return KLoadProgressbar_Process( xml_progress, 1, false );
-    else
-        return 0;
+    {
+        progress_acquire();
+        rc = KLoadProgressbar_Process( xml_progress, 1, false );
+        progress_unlock();
+    }
+    return rc;
 }
 
 
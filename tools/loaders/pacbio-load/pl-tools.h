@@ -184,6 +184,7 @@ typedef struct ld_context
     bool total_printed;
     bool cache_content;
     bool check_src_obj;
+    bool pipeline;
 } ld_context;
 
 
@@ -196,6 +197,15 @@ rc_t check_src_objects( const KDirectory *hdf5_dir,
                         const char **tables,
                         bool show_not_found );
 
+typedef struct af_window
+{
+    void * data;                /* a contiguous range of elements read in one go */
+    uint64_t pos;               /* the first element in data */
+    uint64_t count;             /* how many elements are in data */
+    size_t allocated;           /* how many bytes data can hold */
+} af_window;
+
+
 typedef struct af_data
 {
     struct KFile const *f;      /* the fake "file" from a HDF5-dir */
@@ -205,6 +215,8 @@ typedef struct af_data
     uint64_t * extents;         /* the extension in every dimension */
     uint64_t element_bits;      /* how big in bits is the element */
     void * content;             /* read the whole thing into memory */
+    af_window window[ 2 ];      /* pipeline-mode: the front-window is read from, */
+    uint32_t front;             /* the back-window is filled by the reader-thread */
 } af_data;
 
 
@@ -238,6 +250,15 @@ rc_t array_file_read_dim2( af_data * af, const uint64_t pos,
                            void *dst, const uint64_t count,
                            const uint64_t ext2, uint64_t *n_read );
 
+/* reads the elements pos...pos+count-1 of a 1-dimensional array-file
+   with one read into the back-window, does nothing if the array-file
+   is not open or its content is cached */
+rc_t array_file_prefetch( af_data * af, const uint64_t pos, const uint64_t count );
+
+/* makes the back-window the front-window, array_file_read_dim1()
+   and transfer_bits() are served from the front-window if it covers the request */
+void array_file_swap( af_data * af );
+
 rc_t add_columns( VCursor * cursor, uint32_t count, int32_t exclude_this,
                   uint32_t * idx_vector, const char ** names );
 
@@ -276,6 +297,11 @@ rc_t load_table( VDatabase * database, KDirectory * hdf5_src, ld_context *lctx,
                  const char * template_name, const char * table_name,
                  loader_func func );
 
+/* progress_lock_make() before the writer-threads of the pipeline-mode start,
+   progress_lock_release() after they have been joined */
+rc_t progress_lock_make( void );
+void progress_lock_release( void );
+
 rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chunk );
 rc_t progress_step( const KLoadProgressbar * xml_progress );
 
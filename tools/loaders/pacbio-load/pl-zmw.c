@@ -25,7 +25,9 @@
 */
 
 #include "pl-zmw.h"
+#include <kproc/thread.h>
 #include <sysalloc.h>
+#include <stdlib.h>
 
 void zmw_init( zmw_tab *tab )
 {
@@ -219,3 +221,168 @@ rc_t zmw_for_each( zmw_tab *tab, const KLoadProgressbar ** xml_progress, VCursor
     }
     return rc;
 }
+
+
+typedef struct zmw_reader
+{
+    zmw_tab *tab;
+    zmw_block *block;
+    uint64_t total_rows;
+    uint64_t pos;
+    uint64_t offset;
+    bool with_num_passes;
+    zmw_on_block on_block;
+    void * data;
+} zmw_reader;
+
+
+static rc_t zmw_read_ahead( zmw_reader * reader )
+{
+    rc_t rc = zmw_read_block( reader->tab, reader->block, reader->total_rows,
+                              reader->pos, reader->with_num_passes );
+    if ( rc == 0 )
+    {
+        uint64_t i, count = 0;
+        for ( i = 0; i < reader->block->n_read; ++i )
+            count += reader->block->NumEvent[ i ];
+        rc = reader->on_block( reader->data, reader->offset, count );
+    }
+    return rc;
+}
+
+
+static rc_t CC zmw_reader_thread( const KThread *self, void *data )
+{
+    return zmw_read_ahead( data );
+}
+
+
+rc_t zmw_for_each_pipelined( zmw_tab *tab, const KLoadProgressbar ** xml_progress, VCursor * cursor,
+                   bool with_progress, const uint32_t *col_idx, region_type_mapping *mapping,
+                   const bool with_num_passes, zmw_on_row on_row,
+                   zmw_on_block on_block, zmw_on_swap on_swap, void * data )
+{
+    zmw_block *blocks;
+    zmw_reader reader;
+    zmw_row row;
+    pl_progress *progress;
+    uint32_t cur = 0;
+    uint64_t pos = 0;
+    uint64_t total_rows = tab->NumEvent.extents[0];
+
+    rc_t rc = progress_chunk( xml_progress, total_rows );
+    if ( rc != 0 )
+        return rc;
+
+    /* 2 blocks: the reader-thread fills one while the other one is written */
+    blocks = malloc( 2 * sizeof *blocks );
+    if ( blocks == NULL )
+    {
+        rc = RC( rcExe, rcNoTarg, rcAllocating, rcMemory, rcExhausted );
+        LOGERR( klogErr, rc, "cannot allocate ZMW-blocks" );
+        return rc;
+    }
+    blocks[ 0 ].n_read = 0;
+
+    reader.tab = tab;
+    reader.total_rows = total_rows;
+    reader.with_num_passes = with_num_passes;
+    reader.on_block = on_block;
+    reader.data = data;
+
+    if ( with_progress )
+        pl_progress_make( &progress, total_rows );
+    row.spot_nr = 0;
+    row.offset = 0;
+
+    /* the first block is read on this thread, there is nothing to overlap with yet */
+    if ( total_rows > 0 )
+    {
+        reader.block = &blocks[ 0 ];
+        reader.pos = 0;
+        reader.offset = 0;
+        rc = zmw_read_ahead( &reader );
+        if ( rc == 0 )
+            on_swap( data );
+    }
+
+    while ( rc == 0 && blocks[ cur ].n_read > 0 )
+    {
+        zmw_block * block = &blocks[ cur ];
+        KThread * thread = NULL;
+        uint64_t next_pos = pos + block->n_read;
+        uint64_t next_offset = row.offset;
+        uint32_t i;
+
+        for ( i = 0; i < block->n_read; ++i )
+            next_offset += block->NumEvent[ i ];
+
+        blocks[ cur ^ 1 ].n_read = 0;
+        if ( next_pos < total_rows )
+        {
+            reader.block = &blocks[ cur ^ 1 ];
+            reader.pos = next_pos;
+            reader.offset = next_offset;
+            rc = KThreadMake( &thread, zmw_reader_thread, &reader );
+            if ( rc != 0 )
+            {
+                LOGERR( klogErr, rc, "cannot start ZMW-reader-thread" );
+                thread = NULL;
+            }
+        }
+
+        for ( i = 0; i < block->n_read && rc == 0; ++i )
+        {
+            rc = Quitting();
+            if ( rc == 0 )
+            {
+                zmw_block_row( block, &row, i );
+                rc = on_row( cursor, col_idx, mapping, &row, data );
+                if ( rc == 0 )
+                {
+                    rc = progress_step( *xml_progress );
+                    if ( with_progress )
+                        pl_progress_increment( progress, 1 );
+                }
+                row.offset += block->NumEvent[ i ];
+                row.spot_nr ++;
+            }
+            else
+                LOGERR( klogErr, rc, "...loading ZMW-table interrupted" );
+        }
+
+        if ( thread != NULL )
+        {
+            rc_t rc_thread;
+            rc_t rc2 = KThreadWait( thread, &rc_thread );
+            if ( rc2 == 0 )
+                rc2 = rc_thread;
+            if ( rc == 0 )
+                rc = rc2;
+            KThreadRelease( thread );
+        }
+        if ( rc == 0 )
+            on_swap( data );
+
+        pos = next_pos;
+        cur ^= 1;
+    }
+
+    if ( rc == 0 && pos < total_rows )
+    {
+        rc = RC( rcExe, rcNoTarg, rcReading, rcData, rcInsufficient );
+        LOGERR( klogErr, rc, "cannot read all rows of the ZMW-table" );
+    }
+
+    if ( with_progress )
+        pl_progress_destroy( progress );
+    free( blocks );
+
+    if ( rc == 0 )
+    {
+        rc = VCursorCommit( cursor );
+        if ( rc != 0 )
+            LOGERR( klogErr, rc, "cannot commit vdb-cursor on ZMW-table" );
+    }
+    return rc;
+}
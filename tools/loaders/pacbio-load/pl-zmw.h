@@ -76,6 +76,15 @@ typedef rc_t (*zmw_on_row)( VCursor *cursor, const uint32_t *col_idx,
                             region_type_mapping *mapping,
                             zmw_row *row, void * data );
 
+/* pipeline-mode: called on the reader-thread to prefetch the events
+   offset...offset+count-1 of the next block into the back-windows */
+typedef rc_t (*zmw_on_block)( void * data, const uint64_t offset,
+                              const uint64_t count );
+
+/* pipeline-mode: called after the reader-thread has finished, to make
+   the prefetched back-windows the front-windows */
+typedef void (*zmw_on_swap)( void * data );
+
 
 void zmw_init( zmw_tab *tab );
 void zmw_close( zmw_tab *tab );
@@ -98,6 +107,13 @@ rc_t zmw_for_each( zmw_tab *tab, const KLoadProgressbar ** xml_progress, VCursor
                    bool with_progress, const uint32_t *col_idx, region_type_mapping *mapping,
                    const bool with_num_passes, zmw_on_row on_row, void * data );
 
+/* like zmw_for_each, but the next block of the zmw-table and its events
+   are read on a reader-thread while the current block is written */
+rc_t zmw_for_each_pipelined( zmw_tab *tab, const KLoadProgressbar ** xml_progress, VCursor * cursor,
+                   bool with_progress, const uint32_t *col_idx, region_type_mapping *mapping,
+                   const bool with_num_passes, zmw_on_row on_row,
+                   zmw_on_block on_block, zmw_on_swap on_swap, void * data );
+
 #ifdef __cplusplus
 }
 #endif
@@ -100,8 +100,10 @@ private:
     vector<char> mReadTypes;            ///< ReadType paramter value
     using TInputFiles = vector<string>;
     vector<TInputFiles> mInputBatches;  ///< List of input batches
+    opened_streams mOpenedStreams;      ///< Input streams opened before the main parse
     bool mDiscardNames{false};          ///< If set spot names are not written in the db, the same effect as mNameColumn = 'NONE'
     bool mAllowEarlyFileEnd{false};     ///< Flag to continue if one of the streams ends
+    bool mIncrementalCheck{false};      ///< Check spot names for duplicates while parsing
     int mQuality{-1};                   ///< quality score interpretation (0, 33, 64)
     int mDigest{0};                     ///< Number of digest lines to produce
     string mTelemetryFile;              ///< Telemetry report file name
@@ -174,6 +176,8 @@ int CFastqParseApp::AppMain(int argc, const char* argv[])
 
         app.add_flag("--allowEarlyFileEnd", mAllowEarlyFileEnd, "Complete load at early end of one of the files");
 
+        app.add_flag("--incremental-collation-check", mIncrementalCheck, "Check spot names for duplicates while parsing (all names are kept in memory, compressed)");
+
         bool print_errors = false;
         app.add_flag("--help_errors,--help-errors", print_errors, "Print error codes and descriptions");
 
@@ -282,7 +286,8 @@ int CFastqParseApp::AppMain(int argc, const char* argv[])
             } else {
                 stable_sort(input_files.begin(), input_files.end());
                 xCheckInputFiles(input_files);
-                fastq_reader::cluster_files(input_files, mInputBatches);
+                // the digest mode does not parse, no need to keep the streams
+                fastq_reader::cluster_files(input_files, mInputBatches, mDigest == 0 ? &mOpenedStreams : nullptr);
             }
         }
         ret_code = Run();
@@ -463,7 +468,7 @@ int CFastqParseApp::xRunDigest()
     json j;
     string error;
     try {
-        get_digest(j, mInputBatches, [this](fastq_error& e) { CFastqParseApp::xCheckErrorLimits(e);}, mDigest);
+        get_digest(j, mInputBatches, [this](fastq_error& e) { CFastqParseApp::xCheckErrorLimits(e);}, mDigest, nullptr, max<size_t>(mMaxErrCount, 1));
     } catch (fastq_error& e) {
         error = e.Message();
     } catch(std::exception const& e) {
@@ -486,9 +491,12 @@ int CFastqParseApp::xRun()
     fastq_parser<fastq_writer> parser(m_writer);
     if (!mDebug)
         parser.set_spot_file(mSpotFile);
+    // the spot_file needs all the names in one vector
+    if (mIncrementalCheck && (mDebug || mSpotFile.empty()))
+        parser.set_incremental_collation_check();
     parser.set_allow_early_end(mAllowEarlyFileEnd);
     json data;
-    get_digest(data, mInputBatches, [this](fastq_error& e) { CFastqParseApp::xCheckErrorLimits(e);});
+    get_digest(data, mInputBatches, [this](fastq_error& e) { CFastqParseApp::xCheckErrorLimits(e);}, 250000, &mOpenedStreams, max<size_t>(mMaxErrCount, 1));
     xProcessDigest(data);
     mErrorCount = 0; //Reset error counts after initial digets
 
@@ -499,7 +507,7 @@ int CFastqParseApp::xRun()
     m_writer->open();
     auto err_checker = [this](fastq_error& e) { CFastqParseApp::xCheckErrorLimits(e);};
     for (auto& group : data["groups"]) {
-        parser.set_readers(group);
+        parser.set_readers(group, &mOpenedStreams);
         if (!group["files"].empty()) {
             switch ((int)group["files"].front()["quality_encoding"]) {
                 case 0:
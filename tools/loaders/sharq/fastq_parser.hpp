@@ -58,7 +58,14 @@
 #include <chrono>
 #include <json.hpp>
 #include <set>
+#include <map>
 #include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <atomic>
 
 #include "fastq_defline_parser.hpp"
 
@@ -86,6 +93,123 @@ struct validator_options
     static constexpr int max_score() { return max_score_; }   ///< Flag for presence of counts
 };
 
+/**
+ * @brief Input stream that keeps what is read from the beginning of its source
+ *
+ * The file opened and partially decompressed while the input is clustered and digested
+ * can be rewound and parsed again instead of being reopened and decompressed twice.
+ * Up to max_kept bytes are kept, once more than that is read the stream cannot be rewound
+ */
+class rewindable_istream : public istream
+{
+public:
+    rewindable_istream(shared_ptr<istream> source, size_t max_kept)
+        : istream(nullptr)
+        , m_buf(source, max_kept)
+    {
+        rdbuf(&m_buf);
+    }
+
+    /**
+     * @brief Restarts reading from the beginning of the source
+     *
+     * @param[in] keep if false the kept data is released once it is read again
+     * @return false if too much was read and the stream cannot be rewound
+     */
+    bool rewind(bool keep = true)
+    {
+        if (!m_buf.rewind(keep))
+            return false;
+        clear();
+        return true;
+    }
+
+    bool can_rewind() const { return m_buf.m_keeping; }     ///< Returns true if all that was read is kept
+
+    istream& source() { return *m_buf.m_source; }           ///< Returns the underlying stream
+
+    /**
+     * @brief Returns the underlying stream of a possibly rewindable stream
+     */
+    static istream& source(istream& is)
+    {
+        auto rs = dynamic_cast<rewindable_istream*>(&is);
+        return rs ? rs->source() : is;
+    }
+
+    /**
+     * @brief Returns limit of kept data per stream when num_streams are kept at the same time
+     */
+    static size_t max_kept(size_t num_streams)
+    {
+        static const size_t cMaxKeptTotal = (size_t)256 << 20;
+        static const size_t cMinKept = (size_t)1 << 20;
+        return max(cMinKept, cMaxKeptTotal / max<size_t>(num_streams, 1));
+    }
+
+private:
+    struct keeping_buf : public streambuf
+    {
+        static const size_t cChunkSize = 64 * 1024;
+
+        keeping_buf(shared_ptr<istream> source, size_t max_kept)
+            : m_source(source)
+            , m_max_kept(max_kept)
+        {
+            // let decompression errors reach the reader instead of looking like the end of file
+            m_source->exceptions(std::ifstream::badbit);
+        }
+
+        bool rewind(bool keep)
+        {
+            if (!m_keeping)
+                return false;
+            m_keeping = keep;
+            setg(&m_kept[0], &m_kept[0], &m_kept[0] + m_kept.size());
+            return true;
+        }
+
+        int_type underflow() override
+        {
+            if (gptr() < egptr())
+                return traits_type::to_int_type(*gptr());
+            if (m_keeping) {
+                size_t pos = m_kept.size();
+                if (pos + cChunkSize <= m_max_kept) {
+                    m_kept.resize(pos + cChunkSize);
+                    m_source->read(&m_kept[pos], cChunkSize);
+                    m_kept.resize(pos + m_source->gcount());
+                    if (m_kept.size() == pos)
+                        return traits_type::eof();
+                    setg(&m_kept[0], &m_kept[pos], &m_kept[0] + m_kept.size());
+                    return traits_type::to_int_type(*gptr());
+                }
+                m_keeping = false;
+            }
+            if (!m_kept.empty())
+                string().swap(m_kept);
+            m_chunk.resize(cChunkSize * 16);
+            m_source->read(m_chunk.data(), m_chunk.size());
+            auto n = m_source->gcount();
+            if (n == 0)
+                return traits_type::eof();
+            setg(m_chunk.data(), m_chunk.data(), m_chunk.data() + n);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        shared_ptr<istream> m_source;   ///< Opened file
+        size_t m_max_kept;              ///< Limit of kept data
+        bool m_keeping = true;          ///< True while everything read from m_source is in m_kept
+        string m_kept;                  ///< Data read from the beginning of m_source
+        vector<char> m_chunk;           ///< Read buffer once the data is no longer kept
+    };
+    keeping_buf m_buf;
+};
+
+/// Rewindable streams opened before the main parse by file name
+using opened_streams = map<string, shared_ptr<rewindable_istream>>;
+
+
 class fastq_reader
 /// FASTQ reader
 {
@@ -176,6 +300,14 @@ public:
     template<typename ScoreValidator = validator_options<>>
     bool get_spot(const string& spot_name, vector<CFastqRead>& reads);
 
+    /**
+     * @brief Reads the next spot ahead, the following get_next_spot returns it
+     *
+     * @return false if readers reaches EOF
+     */
+    template<typename ScoreValidator = validator_options<>>
+    bool prefetch_spot();
+
 
     bool eof() const { return m_buffered_spot.empty() && m_stream->eof();}  ///< Returns true if file has no more reads
 
@@ -190,7 +322,7 @@ public:
      *
      */
     bool is_compressed() const {
-        auto fstream = dynamic_cast<bxz::ifstream*>(&*m_stream);
+        auto fstream = dynamic_cast<bxz::ifstream*>(&rewindable_istream::source(*m_stream));
         return fstream ? fstream->compression() != bxz::plaintext : false;
     }
 
@@ -200,8 +332,9 @@ public:
      * @return size_t
      */
     size_t tellg() const {
-        auto fstream = dynamic_cast<bxz::ifstream*>(&*m_stream);
-        return fstream ? fstream->compressed_tellg() : m_stream->tellg();
+        auto& source = rewindable_istream::source(*m_stream);
+        auto fstream = dynamic_cast<bxz::ifstream*>(&source);
+        return fstream ? fstream->compressed_tellg() : source.tellg();
     }
 
     const set<string>& AllDeflineTypes() const { return m_defline_parser.AllDeflineTypes(); } ///< retruns set of defline types processed by the reader
@@ -211,8 +344,9 @@ public:
      *
      * @param[in] files list of input files
      * @param[out] batches  batches of files grouped by common top spot
+     * @param[out] streams if not null, receives the opened streams to be rewound by the next pass
      */
-    static void cluster_files(const vector<string>& files, vector<vector<string>>& batches);
+    static void cluster_files(const vector<string>& files, vector<vector<string>>& batches, opened_streams* streams = nullptr);
 
     template<typename ScoreValidator>
     void num_qual_validator(CFastqRead& read);   ///< Numeric quality score validatot
@@ -247,6 +381,74 @@ shared_ptr<istream> s_OpenStream(const string& filename, size_t buffer_size)
     return is;
 }
 
+/**
+ * @brief Runs task(i, cancelled) for every i in [0, count) on a bounded number of threads
+ *
+ * consume(i) is called on the calling thread in the order of i as soon as task(i) is done,
+ * so the results are reported the same way as if the tasks were run one after another.
+ * If a task or consume throws, the remaining tasks are cancelled and the exception is passed on,
+ * the running tasks can check the cancelled flag to stop early
+ */
+template<typename Task, typename Consume>
+void s_RunOrdered(size_t count, Task&& task, Consume&& consume)
+{
+    static const size_t cMaxThreads = 8;
+    if (count == 0)
+        return;
+    size_t num_threads = min<size_t>({count, cMaxThreads, max(1u, thread::hardware_concurrency())});
+
+    mutex done_mutex;
+    condition_variable done_cv;
+    vector<uint8_t> done(count, 0);
+    vector<exception_ptr> errors(count);
+    atomic<size_t> next{0};
+    atomic<bool> cancelled{false};
+    vector<thread> threads;
+    threads.reserve(num_threads);
+
+    auto worker = [&]() {
+        size_t i;
+        while (!cancelled && (i = next++) < count) {
+            try {
+                task(i, cancelled);
+            } catch (...) {
+                errors[i] = current_exception();
+            }
+            {
+                lock_guard<mutex> lock(done_mutex);
+                done[i] = 1;
+            }
+            done_cv.notify_all();
+        }
+    };
+    auto join = [&]() {
+        for (auto& t : threads)
+            t.join();
+    };
+
+    try {
+        for (size_t t = 0; t < num_threads; ++t)
+            threads.emplace_back(worker);
+        for (size_t i = 0; i < count; ++i) {
+            {
+                unique_lock<mutex> lock(done_mutex);
+                done_cv.wait(lock, [&]() { return done[i] != 0; });
+            }
+            if (errors[i])
+                rethrow_exception(errors[i]);
+            consume(i);
+        }
+    } catch (...) {
+        cancelled = true;
+        join();
+        throw;
+    }
+    join();
+}
+
+
+
+class spot_name_stream_check;
 
 template<typename TWriter>
 class fastq_parser
@@ -270,8 +472,9 @@ public:
      * @brief Set up readers from prepared digest data
      *
      * @param data[in[
+     * @param streams[in,out] if not null, the files found there are rewound instead of reopened
      */
-    void set_readers(json& data);
+    void set_readers(json& data, opened_streams* streams = nullptr);
 
     /**
      * @brief Set allow early end
@@ -293,6 +496,17 @@ public:
      */
     void set_spot_file(const string& spot_file) { m_spot_file = spot_file; }
 
+    /**
+     * @brief Set incremental collation check
+     *
+     * Spot names are checked for duplicates on a background thread
+     * while parsing instead of in a pass after parsing,
+     * the names are not collected in m_spot_names
+     *
+     * @param[in]  incremental
+     */
+    void set_incremental_collation_check(bool incremental = true);
+
     /**
      * @brief read from a group of readers, assembles the spot and send it to the writer
      *
@@ -370,6 +584,7 @@ private:
     bool                 m_allow_early_end{false};     ///< Allow early file end flag
     string               m_spot_file;                  ///< Optional file name for spot_name dictionary
     str_sv_type::back_insert_iterator m_spot_names_bi; ///< Internal back_inserter for spot_names collection
+    shared_ptr<spot_name_stream_check> m_stream_check; ///< Incremental collation check, if requested
 };
 
 
@@ -565,6 +780,20 @@ bool fastq_reader::get_spot(const string& spot_name, vector<CFastqRead>& reads)
     return false;
 }
 
+//  ----------------------------------------------------------------------------
+template<typename ScoreValidator>
+bool fastq_reader::prefetch_spot()
+{
+    if (!m_buffered_spot.empty())
+        return true;
+    string spot;
+    vector<CFastqRead> reads;
+    if (!get_next_spot<ScoreValidator>(spot, reads))
+        return false;
+    swap(m_buffered_spot, reads);
+    return true;
+}
+
 
 //  ----------------------------------------------------------------------------
 template<typename ScoreValidator>
@@ -675,6 +904,314 @@ void serialize_vec(const string& file_name, str_sv_type& vec)
 }
 
 
+/*!
+ *  This function searches list of terms in vec using sparse_vector_scanner.
+ *
+ *  @param[in] vec  string vector to search in
+ *
+ *  @param[in] scanner  sparse_vector_scanner to use for the search
+ *
+ *  @param[in] term  list of terms to search
+ *
+ *  @return index of found term or -1
+ *
+ */
+static
+int s_search_terms(str_sv_type& vec, bm::sparse_vector_scanner<str_sv_type>& scanner, const vector<string>& terms)
+{
+    auto sz = terms.size();
+    if (sz == 0)
+        return -1;
+    bm::sparse_vector_scanner<str_sv_type>::pipeline<bm::agg_opt_only_counts> pipe(vec);
+    pipe.options().batch_size = 0;
+    for (const auto& term : terms)
+        pipe.add(term.c_str());
+    pipe.complete();
+    scanner.find_eq_str(pipe); // run the search pipeline
+    auto& cnt_vect = pipe.get_bv_count_vector();
+    for (size_t i = 0; i < sz; ++i) {
+        if (cnt_vect[i] > 1) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*!
+ *  Adds the number of occurrences of each term in vec to counts
+ *
+ *  @param[in] vec  string vector to search in, may be remapped
+ *
+ *  @param[in] scanner  sparse_vector_scanner to use for the search
+ *
+ *  @param[in] terms  list of terms to search
+ *
+ *  @param[in,out] counts  occurrences of each term so far
+ *
+ */
+static
+void s_count_terms(const str_sv_type& vec, bm::sparse_vector_scanner<str_sv_type>& scanner, const vector<string>& terms, vector<size_t>& counts)
+{
+    auto sz = terms.size();
+    if (sz == 0 || vec.empty())
+        return;
+    bm::sparse_vector_scanner<str_sv_type>::pipeline<bm::agg_opt_only_counts> pipe(vec);
+    pipe.options().batch_size = 0;
+    for (const auto& term : terms)
+        pipe.add(term.c_str());
+    pipe.complete();
+    scanner.find_eq_str(pipe);
+    auto& cnt_vect = pipe.get_bv_count_vector();
+    for (size_t i = 0; i < sz; ++i)
+        counts[i] += cnt_vect[i];
+}
+
+
+//  ----------------------------------------------------------------------------
+/**
+ * @brief Incremental collation check
+ *
+ * The parse loop hands the spot names over in batches, a background thread
+ * distributes them into shards by hash. Each shard has its own probabilistic
+ * filter (spot_name_check) and its own str_sparse_vector of names.
+ * Every cNamesPerSegment names a shard's vector is remapped and optimized
+ * into a read-only segment and a new vector is started.
+ * Names the filter has seen before are confirmed against all segments of
+ * their shard in batches with a sparse_vector_scanner.
+ * The queue between the threads is bounded, so the parser waits rather than
+ * buffering names. The names themselves are still all kept: memory grows
+ * with the number of spots, in the compressed (remapped) form.
+ */
+class spot_name_stream_check
+{
+public:
+    spot_name_stream_check(size_t num_shards = 4)
+        : m_shards(num_shards)
+    {
+        m_batch.reserve(cBatchSize);
+        m_thread = thread(&spot_name_stream_check::run, this);
+    }
+
+    ~spot_name_stream_check()
+    {
+        {
+            // parsing failed, the names still queued don't matter
+            lock_guard<mutex> lock(m_mutex);
+            m_queue.clear();
+        }
+        stop();
+    }
+
+    /**
+     * @brief Add next spot name
+     *
+     * Throws the error found on the background thread, if any
+     */
+    void add(const string& name)
+    {
+        m_batch.push_back(name);
+        if (m_batch.size() == cBatchSize)
+            push_batch();
+    }
+
+    /**
+     * @brief Check the remaining names, wait for the background thread
+     *
+     * Throws fastq_error 170 for the earliest duplicate found
+     */
+    void finish()
+    {
+        push_batch();
+        stop();
+        if (m_error)
+            rethrow_exception(m_error);
+    }
+
+    size_t size() const { return m_total + m_batch.size(); }
+
+private:
+    static const size_t cBatchSize = 100000;     ///< Names per batch from the parser
+    static const size_t cMaxQueued = 4;          ///< Batches waiting for the background thread
+    static const size_t cMaxCandidates = 10000;  ///< Candidates per shard before confirmation
+    static const size_t cNamesPerSegment = 10000000; ///< Names per shard before the vector is remapped
+
+    struct shard
+    {
+        shard() : filter(0) { new_segment(); }
+
+        /// Start a new, empty vector for the names to come
+        void new_segment()
+        {
+            names_bi.reset();
+            names.reset(new str_sv_type);
+            names_bi.reset(new str_sv_type::back_insert_iterator(names.get()));
+            names_count = 0;
+        }
+
+        /// Move the current names into a remapped, read-only segment
+        void freeze_segment()
+        {
+            names_bi->flush();
+            unique_ptr<str_sv_type> segment(new str_sv_type);
+            segment->remap_from(*names);
+            segment->optimize();
+            segments.push_back(move(segment));
+            new_segment();
+        }
+
+        vector<unique_ptr<str_sv_type>> segments; ///< Remapped read-only names
+        unique_ptr<str_sv_type> names;            ///< Names since the last freeze
+        unique_ptr<str_sv_type::back_insert_iterator> names_bi;
+        size_t names_count{0};
+        spot_name_check filter;
+        vector<string> candidates;
+        vector<size_t> candidate_index;   ///< Position of each candidate in the input
+    };
+
+    void push_batch()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        if (m_error)
+            rethrow_exception(m_error);
+        if (m_batch.empty())
+            return;
+        m_total += m_batch.size();
+        m_can_push.wait(lock, [this]{ return m_queue.size() < cMaxQueued || m_error; });
+        if (m_error)
+            rethrow_exception(m_error);
+        m_queue.push_back(move(m_batch));
+        m_batch.clear();
+        m_batch.reserve(cBatchSize);
+        m_can_pop.notify_one();
+    }
+
+    void stop()
+    {
+        if (!m_thread.joinable())
+            return;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_done = true;
+        }
+        m_can_pop.notify_one();
+        m_thread.join();
+    }
+
+    void set_error(exception_ptr error)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (!m_error)
+            m_error = error;
+        m_can_push.notify_all();
+    }
+
+    /**
+     * @brief Search the shard's candidates among all the shard's names
+     *
+     * @param[in]  sh
+     * @param[out] name   first confirmed duplicate
+     * @param[out] index  its position in the input
+     * @return true if a duplicate was confirmed
+     */
+    bool confirm(shard& sh, string& name, size_t& index)
+    {
+        bool found = false;
+        if (sh.candidates.empty())
+            return found;
+        sh.names_bi->flush();
+        vector<size_t> counts(sh.candidates.size(), 0);
+        for (const auto& segment : sh.segments)
+            s_count_terms(*segment, m_scanner, sh.candidates, counts);
+        s_count_terms(*sh.names, m_scanner, sh.candidates, counts);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (counts[i] > 1) {
+                name = sh.candidates[i];
+                index = sh.candidate_index[i];
+                found = true;
+                break;
+            }
+        }
+        sh.candidates.clear();
+        sh.candidate_index.clear();
+        return found;
+    }
+
+    void run()
+    {
+        try {
+            size_t index = 0;
+            size_t num_shards = m_shards.size();
+            while (true) {
+                vector<string> batch;
+                {
+                    unique_lock<mutex> lock(m_mutex);
+                    m_can_pop.wait(lock, [this]{ return !m_queue.empty() || m_done; });
+                    if (m_queue.empty())
+                        break;
+                    batch = move(m_queue.front());
+                    m_queue.pop_front();
+                }
+                m_can_push.notify_one();
+
+                for (const auto& name : batch) {
+                    auto& sh = m_shards[hash<string>{}(name) % num_shards];
+                    *sh.names_bi = name;
+                    if (++sh.names_count == cNamesPerSegment)
+                        sh.freeze_segment();
+                    if (sh.filter.seen_before(name.c_str(), name.size())) {
+                        sh.candidates.push_back(name);
+                        sh.candidate_index.push_back(index);
+                        if (sh.candidates.size() == cMaxCandidates) {
+                            string dup_name;
+                            size_t dup_index;
+                            if (confirm(sh, dup_name, dup_index))
+                                throw fastq_error(170, "Collation check. Duplicate spot '{}' at index {}", dup_name, dup_index);
+                        }
+                    }
+                    ++index;
+                }
+            }
+            // report the earliest duplicate across the shards
+            string first_name;
+            size_t first_index = numeric_limits<size_t>::max();
+            for (auto& sh : m_shards) {
+                string dup_name;
+                size_t dup_index;
+                if (confirm(sh, dup_name, dup_index) && dup_index < first_index) {
+                    first_name = dup_name;
+                    first_index = dup_index;
+                }
+            }
+            if (first_index != numeric_limits<size_t>::max())
+                throw fastq_error(170, "Collation check. Duplicate spot '{}' at index {}", first_name, first_index);
+        } catch (...) {
+            set_error(current_exception());
+        }
+    }
+
+    vector<shard>           m_shards;
+    bm::sparse_vector_scanner<str_sv_type> m_scanner;
+    vector<string>          m_batch;         ///< Batch being filled by the parser
+    deque<vector<string>>   m_queue;         ///< Batches waiting for the background thread
+    size_t                  m_total{0};      ///< Names added
+    bool                    m_done{false};
+    exception_ptr           m_error;
+    mutex                   m_mutex;
+    condition_variable      m_can_push;
+    condition_variable      m_can_pop;
+    thread                  m_thread;
+};
+
+template<typename TWriter>
+void fastq_parser<TWriter>::set_incremental_collation_check(bool incremental)
+{
+    if (incremental)
+        m_stream_check = make_shared<spot_name_stream_check>();
+    else
+        m_stream_check.reset();
+}
+
+
 /**
  * gets top spot spot name for each reader
  * and retrieves next reads belonging to the same spot from other readers
@@ -734,7 +1271,10 @@ void fastq_parser<TWriter>::parse(ErrorChecker&& error_checker)
                     throw fastq_error(210, "Spot {} has more than 4 reads", assembled_spot.front().Spot());
                 } else {
                     m_writer->write_spot(assembled_spot);
-                    spot_names_bi = assembled_spot.front().Spot();
+                    if (m_stream_check)
+                        m_stream_check->add(assembled_spot.front().Spot());
+                    else
+                        spot_names_bi = assembled_spot.front().Spot();
                     update_telemetry(assembled_spot);
                     ++spotCount;
                     if (currCount >= 10e6) {
@@ -800,44 +1340,17 @@ void fastq_parser<TWriter>::update_telemetry(const vector<CFastqRead>& reads)
         ++telemetry.number_of_spots_with_orphans;
 }
 
-/*!
- *  This function searches list of terms in vec using sparse_vector_scanner.
- *
- *  @param[in] vec  string vector to search in
- *
- *  @param[in] scanner  sparse_vector_scanner to use for the search
- *
- *  @param[in] term  list of terms to search
- *
- *  @return index of found term or -1
- *
- */
-static
-int s_search_terms(str_sv_type& vec, bm::sparse_vector_scanner<str_sv_type>& scanner, const vector<string>& terms)
-{
-    auto sz = terms.size();
-    if (sz == 0)
-        return -1;
-    bm::sparse_vector_scanner<str_sv_type>::pipeline<bm::agg_opt_only_counts> pipe(vec);
-    pipe.options().batch_size = 0;
-    for (const auto& term : terms)
-        pipe.add(term.c_str());
-    pipe.complete();
-    scanner.find_eq_str(pipe); // run the search pipeline
-    auto& cnt_vect = pipe.get_bv_count_vector();
-    for (size_t i = 0; i < sz; ++i) {
-        if (cnt_vect[i] > 1) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-
 //  ----------------------------------------------------------------------------
 template<typename TWriter>
 void fastq_parser<TWriter>::check_duplicates()
 {
+    if (m_stream_check) {
+        spdlog::stopwatch sw;
+        spdlog::info("spot_name check: {} spots", m_stream_check->size());
+        m_stream_check->finish();
+        spdlog::debug("spot_name check time:{}", sw);
+        return;
+    }
     spdlog::stopwatch sw;
     spdlog::info("spot_name check: {} spots", m_spot_names.size());
     str_sv_type sv;
@@ -975,7 +1488,7 @@ static string s_join(const T& b, const T& e, const string& delimiter = ", ")
 
 
 //  ----------------------------------------------------------------------------
-void fastq_reader::cluster_files(const vector<string>& files, vector<vector<string>>& batches)
+void fastq_reader::cluster_files(const vector<string>& files, vector<vector<string>>& batches, opened_streams* streams)
 {
     batches.clear();
     if (files.empty())
@@ -986,25 +1499,61 @@ void fastq_reader::cluster_files(const vector<string>& files, vector<vector<stri
         return;
     }
 
+    // open the files and read their first spots concurrently,
+    // the failures are reported in the order the files would have been read one by one:
+    // all the files are opened first, then the first spot of every file is read
     vector<CFastqRead> reads;
-    vector<fastq_reader> readers;
-    vector<char> readTypes;
-    for (const auto& fn : files)
-        readers.emplace_back(fn, s_OpenStream(fn, 1024*1024), readTypes, 0, true);
+    vector<unique_ptr<fastq_reader>> readers(files.size());
+    vector<shared_ptr<rewindable_istream>> rewindable(files.size());
+    vector<exception_ptr> open_errors(files.size());
+    vector<exception_ptr> read_errors(files.size());
+    vector<uint8_t> has_spot(files.size(), 0);
+    size_t max_kept = rewindable_istream::max_kept(files.size());
+    s_RunOrdered(files.size(), [&](size_t i, const atomic<bool>&) {
+        const auto& fn = files[i];
+        shared_ptr<istream> stream;
+        try {
+            stream = s_OpenStream(fn, 1024*1024);
+        } catch (...) {
+            open_errors[i] = current_exception();
+            return;
+        }
+        if (streams) {
+            rewindable[i] = make_shared<rewindable_istream>(stream, max_kept);
+            stream = rewindable[i];
+        }
+        vector<char> readTypes;
+        readers[i].reset(new fastq_reader(fn, stream, readTypes, 0, true));
+        try {
+            has_spot[i] = readers[i]->prefetch_spot<>();
+        } catch (...) {
+            read_errors[i] = current_exception();
+        }
+    }, [](size_t) {});
+    for (auto& e : open_errors) {
+        if (e)
+            rethrow_exception(e);
+    }
+    if (!has_spot[0] && !read_errors[0])
+        throw fastq_error(50 , "File '{}' has no reads", readers[0]->file_name());
+    for (auto& e : read_errors) {
+        if (e)
+            rethrow_exception(e);
+    }
     vector<uint8_t> placed(files.size(), 0);
 
     for (size_t i = 0; i < files.size(); ++i) {
         if (placed[i]) continue;
         placed[i] = 1;
         string spot;
-        if (!readers[i].get_next_spot<>(spot, reads))
-            throw fastq_error(50 , "File '{}' has no reads", readers[i].file_name());
-        vector<string> batch{readers[i].file_name()};
+        if (!readers[i]->get_next_spot<>(spot, reads))
+            throw fastq_error(50 , "File '{}' has no reads", readers[i]->file_name());
+        vector<string> batch{readers[i]->file_name()};
         for (size_t j = 0; j < files.size(); ++j) {
             if (placed[j]) continue;
-            if (readers[j].get_spot<>(spot, reads)) {
+            if (readers[j]->get_spot<>(spot, reads)) {
                 placed[j] = 1;
-                batch.push_back(readers[j].file_name());
+                batch.push_back(readers[j]->file_name());
             }
         }
         if (!batches.empty() && batches.front().size() != batch.size()) {
@@ -1015,6 +1564,12 @@ void fastq_reader::cluster_files(const vector<string>& files, vector<vector<stri
         spdlog::info("File group: {}", s_join(batch.begin(), batch.end()));
         batches.push_back(move(batch));
     }
+    if (streams) {
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (rewindable[i]->can_rewind())
+                (*streams)[files[i]] = rewindable[i];
+        }
+    }
 }
 
 
@@ -1096,20 +1651,207 @@ void check_hash_file(const string& hash_file)
     //bm::SaveBVector(collisions_file.c_str(), bv_collisions);
 }
 
+/**
+ * @brief Digest data of one input file, see get_digest
+ */
+struct file_digest
+{
+    json f;                                 ///< File digest data
+    int max_reads = 0;                      ///< Maximum number of reads per spot
+    size_t estimated_spots = 0;             ///< Number of spots estimated from the file size
+    vector<fastq_error> errors;             ///< Errors passed to the error checker, in the order they were found
+    exception_ptr failure;                  ///< Error that stopped the digest
+    shared_ptr<rewindable_istream> stream;  ///< Stream kept to be rewound for the main parse
+};
+
+/**
+ * @brief Generate digest data of one file
+ *
+ * @param[in] fn file name
+ * @param[in] p_num_reads_to_check
+ * @param[in] error_checker lambda invoked on fastq_error
+ * @param[in] cancelled flag to stop early, the digest is not used then
+ * @param[in] max_kept if not 0, the stream is opened rewindable keeping up to max_kept bytes
+ * @param[in,out] digest digest data, the stream is used if already set
+ */
+template<typename ErrorChecker>
+void s_DigestFile(const string& fn, int p_num_reads_to_check, ErrorChecker&& error_checker, const atomic<bool>& cancelled, size_t max_kept, file_digest& digest)
+{
+    CFastqRead read;
+    json& f = digest.f;
+    size_t reads_processed = 0;
+    size_t spots_processed = 0;
+    size_t spot_name_sz = 0;
+    set<string> deflines_types;
+    set<int> platforms;
+
+    f["file_path"] = fn;
+    auto file_size = fs::file_size(fn);
+    f["file_size"] = file_size;
+
+    shared_ptr<istream> stream = digest.stream;
+    if (!stream) {
+        if (max_kept > 0) {
+            digest.stream = make_shared<rewindable_istream>(s_OpenStream(fn, 1024 * 1024), max_kept);
+            stream = digest.stream;
+        } else {
+            stream = s_OpenStream(fn, 1024 * 4);
+        }
+    }
+    fastq_reader reader(fn, stream, {}, 0, true);
+    vector<CFastqRead> reads;
+    int max_reads = 0;
+    bool has_orphans = false;
+    string spot_name;
+    set<string> read_names;
+    bool has_reads = false;
+    int num_reads_to_check = p_num_reads_to_check;
+
+    while (has_reads == false && num_reads_to_check > 0) {
+        if (cancelled)
+            return;
+        // a spot that throws counts as checked, too
+        --num_reads_to_check;
+        try {
+            has_reads = reader.get_next_spot<>(spot_name, reads);
+        } catch (fastq_error& e) {
+            error_checker(e);
+        }
+    }
+    if (!has_reads)
+        throw fastq_error(50 , "File '{}' has no reads", fn);
+
+    f["is_compressed"] = reader.is_compressed();
+    max_reads = reads.size();
+    reads_processed += reads.size();
+    ++spots_processed;
+    qual_score_params params;
+    for (const auto& read : reads) {
+        if (!read.ReadNum().empty())
+            read_names.insert(read.ReadNum());
+        try {
+            s_check_qual_score(read, params);
+        } catch (fastq_error& e) {
+            e.set_file(fn, read.LineNumber());
+            error_checker(e);
+        }
+    }
+    string suffix = reads.empty() ? "" : reads.front().Suffix();
+    spot_name += suffix;
+    f["first_name"] = spot_name;
+    spot_name_sz += spot_name.size();
+
+    while (true) {
+        if (cancelled)
+            return;
+        auto def_it = deflines_types.insert(reader.defline_type());
+        if (def_it.second)
+            f["defline_type"].push_back(reader.defline_type());
+        auto platform_it = platforms.insert(reader.platform());
+        if (platform_it.second)
+            f["platform_code"].push_back(reader.platform());
+        if (num_reads_to_check != -1) {
+            --num_reads_to_check;
+            if (num_reads_to_check <=0)
+                break;
+        }
+        reads.clear();
+        try {
+            if (!reader.get_next_spot<>(spot_name, reads))
+                break;
+        } catch(fastq_error& e) {
+            error_checker(e);
+        }
+        ++spots_processed;
+        reads_processed += reads.size();
+        if (max_reads > (int)reads.size()) {
+            has_orphans = true;
+        }
+        string suffix = reads.empty() ? "" : reads.front().Suffix();
+        spot_name_sz += spot_name.size() + suffix.size();
+        max_reads = max<int>(max_reads, reads.size());
+        for (const auto& read : reads) {
+            if (!read.ReadNum().empty())
+                read_names.insert(read.ReadNum());
+            try {
+                s_check_qual_score(read, params);
+            } catch (fastq_error& e) {
+                e.set_file(fn, read.LineNumber());
+                error_checker(e);
+            }
+        }
+        //if (platform != reader.platform())
+        //    throw fastq_error(70, "Input files have deflines from different platforms {} != {}", platform, reader.platform());
+    }
+    if (params.space_delimited) {
+        f["quality_encoding"] = 0;
+    } else if (params.min_score >= 64 && params.max_score > 78) {
+        f["quality_encoding"] = 64;
+    } else if (params.min_score >= 33 /*&& params.max_score <= 78*/) {
+        f["quality_encoding"] = 33;
+    } else {
+        fastq_error e("Invaid quality encoding (min: {}, max: {}), {}:{}", params.min_score, params.max_score, fn, read.LineNumber());
+        e.set_file(fn, read.LineNumber());
+        throw e;
+
+    }
+
+    f["readNums"] = read_names;
+    digest.max_reads = max_reads;
+    f["max_reads"] = max_reads;
+    f["has_orphans"] = has_orphans;
+    f["reads_processed"] = reads_processed;
+    f["spots_processed"] = spots_processed;
+    f["lines_processed"] = reader.line_number();
+    double bytes_read = reader.tellg();
+    if (bytes_read && spots_processed) {
+        double fsize = file_size;
+        double bytes_per_spot = bytes_read/spots_processed;
+        digest.estimated_spots = fsize/bytes_per_spot;
+        f["name_size_avg"] = spot_name_sz/spots_processed;
+    }
+}
+
 /**
  * @brief Generate digest data
  *
+ * The files are digested concurrently, the errors and the results are collected
+ * in the input order, the same way as if the files were read one after another
+ *
  * @param[in,out] j digest data
  * @param[in] input_batches input group pf files
  * @param[in] num_reads_to_check
+ * @param[in,out] streams if not null, the streams are rewound instead of reopening the files,
+ *                        the streams that can still be rewound are put back for the main parse
+ * @param[in] max_errors if not 0, the digest of a file stops after collecting that many errors,
+ *                       error_checker has to throw on the max_errors-th error at the latest
  */
 template<typename ErrorChecker>
-void get_digest(json& j, const vector<vector<string>>& input_batches, ErrorChecker&& error_checker, int p_num_reads_to_check = 250000)
+void get_digest(json& j, const vector<vector<string>>& input_batches, ErrorChecker&& error_checker, int p_num_reads_to_check = 250000, opened_streams* streams = nullptr, size_t max_errors = 0)
 {
     assert(!input_batches.empty());
     // Run first num_reads_to_check to check for consistency
     // and setup read_types and platform if needed
-    CFastqRead read;
+    vector<string> files;
+    vector<size_t> group_end;
+    for (auto& batch : input_batches) {
+        files.insert(files.end(), batch.begin(), batch.end());
+        group_end.push_back(files.size());
+    }
+    vector<file_digest> digests(files.size());
+    size_t max_kept = 0;
+    if (streams) {
+        max_kept = rewindable_istream::max_kept(files.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            auto it = streams->find(files[i]);
+            if (it == streams->end())
+                continue;
+            if (it->second->rewind())
+                digests[i].stream = it->second;
+            streams->erase(it);
+        }
+    }
+
     // 10x pattern
     re2::RE2 re_10x_I("[_|-]I\\d+[\\._]");
     assert(re_10x_I.ok());
@@ -1118,143 +1860,56 @@ void get_digest(json& j, const vector<vector<string>>& input_batches, ErrorCheck
     bool has_I_file = false;
     bool has_R_file = false;
     bool has_non_10x_files = false;
-    for (auto& files : input_batches) {
-        json group_j;
-        size_t estimated_spots = 0;
-        int group_reads = 0;
-        for (const auto& fn  : files) {
-            json f;
-            size_t reads_processed = 0;
-            size_t spots_processed = 0;
-            size_t spot_name_sz = 0;
-            set<string> deflines_types;
-            set<int> platforms;
-
-            f["file_path"] = fn;
-            auto file_size = fs::file_size(fn);
-            f["file_size"] = file_size;
-            if (re2::RE2::PartialMatch(fn, re_10x_I))
-                has_I_file = true;
-            else if (re2::RE2::PartialMatch(fn, re_10x_R))
-                has_R_file = true;
-            else
-                has_non_10x_files = true;
-
-            fastq_reader reader(fn, s_OpenStream(fn, 1024 * 4), {}, 0, true);
-            vector<CFastqRead> reads;
-            int max_reads = 0;
-            bool has_orphans = false;
-            string spot_name;
-            set<string> read_names;
-            bool has_reads = false;
-            int num_reads_to_check = p_num_reads_to_check;
-
-            while (has_reads == false && num_reads_to_check > 0) {
-                try {
-                    has_reads = reader.get_next_spot<>(spot_name, reads);
-                    --num_reads_to_check;
-                } catch (fastq_error& e) {
-                    error_checker(e);
-                }
-            }
-            if (!has_reads)
-                throw fastq_error(50 , "File '{}' has no reads", fn);
-
-            f["is_compressed"] = reader.is_compressed();
-            max_reads = reads.size();
-            reads_processed += reads.size();
-            ++spots_processed;
-            qual_score_params params;
-            for (const auto& read : reads) {
-                if (!read.ReadNum().empty())
-                    read_names.insert(read.ReadNum());
-                try {
-                    s_check_qual_score(read, params);
-                } catch (fastq_error& e) {
-                    e.set_file(fn, read.LineNumber());
-                    error_checker(e);
-                }
-            }
-            string suffix = reads.empty() ? "" : reads.front().Suffix();
-            spot_name += suffix;
-            f["first_name"] = spot_name;
-            spot_name_sz += spot_name.size();
+    json group_j;
+    size_t estimated_spots = 0;
+    int group_reads = 0;
+    size_t group = 0;
 
-            while (true) {
-                auto def_it = deflines_types.insert(reader.defline_type());
-                if (def_it.second)
-                    f["defline_type"].push_back(reader.defline_type());
-                auto platform_it = platforms.insert(reader.platform());
-                if (platform_it.second)
-                    f["platform_code"].push_back(reader.platform());
-                if (num_reads_to_check != -1) {
-                    --num_reads_to_check;
-                    if (num_reads_to_check <=0)
-                        break;
-                }
-                reads.clear();
-                try {
-                    if (!reader.get_next_spot<>(spot_name, reads))
-                        break;
-                } catch(fastq_error& e) {
-                    error_checker(e);
-                }
-                ++spots_processed;
-                reads_processed += reads.size();
-                if (max_reads > (int)reads.size()) {
-                    has_orphans = true;
-                }
-                string suffix = reads.empty() ? "" : reads.front().Suffix();
-                spot_name_sz += spot_name.size() + suffix.size();
-                max_reads = max<int>(max_reads, reads.size());
-                for (const auto& read : reads) {
-                    if (!read.ReadNum().empty())
-                        read_names.insert(read.ReadNum());
-                    try {
-                        s_check_qual_score(read, params);
-                    } catch (fastq_error& e) {
-                        e.set_file(fn, read.LineNumber());
-                        error_checker(e);
-                    }
-                }
-                //if (platform != reader.platform())
-                //    throw fastq_error(70, "Input files have deflines from different platforms {} != {}", platform, reader.platform());
-            }
-            if (params.space_delimited) {
-                f["quality_encoding"] = 0;
-            } else if (params.min_score >= 64 && params.max_score > 78) {
-                f["quality_encoding"] = 64;
-            } else if (params.min_score >= 33 /*&& params.max_score <= 78*/) {
-                f["quality_encoding"] = 33;
-            } else {
-                fastq_error e("Invaid quality encoding (min: {}, max: {}), {}:{}", params.min_score, params.max_score, fn, read.LineNumber());
-                e.set_file(fn, read.LineNumber());
-                throw e;
-
-            }
-
-            f["readNums"] = read_names;
-            group_reads += max_reads;
-            f["max_reads"] = max_reads;
-            f["has_orphans"] = has_orphans;
-            f["reads_processed"] = reads_processed;
-            f["spots_processed"] = spots_processed;
-            f["lines_processed"] = reader.line_number();
-            double bytes_read = reader.tellg();
-            if (bytes_read && spots_processed) {
-                double fsize = file_size;
-                double bytes_per_spot = bytes_read/spots_processed;
-                estimated_spots = max<size_t>(fsize/bytes_per_spot, estimated_spots);
-                f["name_size_avg"] = spot_name_sz/spots_processed;
-            }
-            group_j["files"].push_back(f);
+    s_RunOrdered(files.size(), [&](size_t i, const atomic<bool>& cancelled) {
+        auto& digest = digests[i];
+        try {
+            // the errors are only collected here and passed to error_checker in order,
+            // once there are as many as it accepts the rest of the file doesn't matter
+            s_DigestFile(files[i], p_num_reads_to_check, [&digest, max_errors](fastq_error& e) {
+                digest.errors.push_back(e);
+                if (max_errors != 0 && digest.errors.size() >= max_errors)
+                    throw e;
+            }, cancelled, max_kept, digest);
+        } catch (...) {
+            digest.failure = current_exception();
         }
-        group_j["is_10x"] = group_reads >= 3 && has_I_file && has_R_file;
-        if (has_non_10x_files && group_j["is_10x"])
-            throw fastq_error(80);// "Inconsistent submission: 10x submissions are mixed with different types.");
-        group_j["estimated_spots"] = estimated_spots;
-        j["groups"].push_back(group_j);
-    }
+    }, [&](size_t i) {
+        const auto& fn = files[i];
+        auto& digest = digests[i];
+        for (auto& e : digest.errors)
+            error_checker(e);
+        if (digest.failure)
+            rethrow_exception(digest.failure);
+        if (re2::RE2::PartialMatch(fn, re_10x_I))
+            has_I_file = true;
+        else if (re2::RE2::PartialMatch(fn, re_10x_R))
+            has_R_file = true;
+        else
+            has_non_10x_files = true;
+        group_reads += digest.max_reads;
+        estimated_spots = max<size_t>(digest.estimated_spots, estimated_spots);
+        group_j["files"].push_back(move(digest.f));
+        if (digest.stream && digest.stream->can_rewind())
+            (*streams)[fn] = digest.stream;
+        digest = file_digest();
+
+        while (group < group_end.size() && group_end[group] == i + 1) {
+            group_j["is_10x"] = group_reads >= 3 && has_I_file && has_R_file;
+            if (has_non_10x_files && group_j["is_10x"])
+                throw fastq_error(80);// "Inconsistent submission: 10x submissions are mixed with different types.");
+            group_j["estimated_spots"] = estimated_spots;
+            j["groups"].push_back(move(group_j));
+            group_j = json();
+            estimated_spots = 0;
+            group_reads = 0;
+            ++group;
+        }
+    });
 }
 
 template<typename TWriter>
@@ -1285,14 +1940,25 @@ void fastq_parser<TWriter>::set_telemetry(const json& group)
 
 
 template<typename TWriter>
-void fastq_parser<TWriter>::set_readers(json& group)
+void fastq_parser<TWriter>::set_readers(json& group, opened_streams* streams)
 {
     m_readers.clear();
     if (group["files"].empty())
         return;
     for (auto& data : group["files"]) {
         const string& name = data["file_path"];
-        m_readers.emplace_back(name, s_OpenStream(name, (1024 * 1024) * 10), data["readType"], data["platform_code"].front());
+        shared_ptr<istream> stream;
+        if (streams) {
+            auto it = streams->find(name);
+            if (it != streams->end()) {
+                if (it->second->rewind(false))
+                    stream = it->second;
+                streams->erase(it);
+            }
+        }
+        if (!stream)
+            stream = s_OpenStream(name, (1024 * 1024) * 10);
+        m_readers.emplace_back(name, stream, data["readType"], data["platform_code"].front());
     }
     set_telemetry(group);
 }
@@ -98,6 +98,10 @@ struct BufferedPairColWriter
     /* for non-mapping writers - new=>old ord */
     uint32_t *ord;
 
+    /* for non-mapping writers copying concurrently -
+       private replacement of the shared source ids */
+    int64_t *priv_ids;
+
     size_t num_items;   /* total number of items              */
     size_t cur_item;    /* index of currently available item  */
     size_t num_immed;   /* number of immediate items written  */
@@ -112,6 +116,9 @@ void BufferedPairColWriterWhack ( BufferedPairColWriter *self, const ctx_t *ctx
 {
     FUNC_ENTRY ( ctx );
 
+    if ( self -> priv_ids != NULL )
+        MemFree ( ctx, self -> priv_ids, sizeof self -> priv_ids [ 0 ] * self -> num_items );
+
     MapFileRelease ( self -> idx, ctx );
     MemBankRelease ( self -> mbank, ctx );
     if(self -> vocab_key2id) KBTreeRelease  ( self -> vocab_key2id );
@@ -458,6 +465,20 @@ void BufferedPairColWriterWriteUnmapped ( BufferedPairColWriter *self, const ctx
             return;
         }
 
+        /* the source ids are overwritten with cell data below,
+           which is only allowed while no other column reads them */
+        if ( self -> tbl -> dad . concurrent )
+        {
+            ON_FAIL ( self -> priv_ids = MemAlloc ( ctx, sizeof self -> priv_ids [ 0 ] * self -> num_items, false ) )
+            {
+                self -> u . ids = NULL;
+                self -> ord = NULL;
+                self -> num_items = 0;
+                return;
+            }
+            self -> u . ids = self -> priv_ids;
+        }
+
         /* require elem_bits to be constant for column */
         self -> elem_bits = elem_bits;
 
@@ -524,6 +545,11 @@ void BufferedPairColWriterWriteUnmapped ( BufferedPairColWriter *self, const ctx
             }
 
             /* forget about map */
+            if ( self -> priv_ids != NULL )
+            {
+                MemFree ( ctx, self -> priv_ids, sizeof self -> priv_ids [ 0 ] * self -> num_items );
+                self -> priv_ids = NULL;
+            }
             self -> u . ids = NULL;
             self -> ord = NULL;
             self -> cur_item = self -> num_items = self -> num_immed = 0;
@@ -655,6 +681,11 @@ void BufferedPairColWriterWriteUnmapped ( BufferedPairColWriter *self, const ctx
             self -> mbank = NULL;
 
             /* forget about map */
+            if ( self -> priv_ids != NULL )
+            {
+                MemFree ( ctx, self -> priv_ids, sizeof self -> priv_ids [ 0 ] * self -> num_items );
+                self -> priv_ids = NULL;
+            }
             self -> u . ids = NULL;
             self -> ord = NULL;
             self -> cur_item = self -> num_items = self -> num_immed = 0;
@@ -740,6 +771,9 @@ ColumnWriter *cSRATblPairMakeBufferedColumnWriter ( cSRATblPair *self,
                    cannot duplicate without creating cycle */
                 buff -> tbl = self;
 
+                buff -> dad . concurrent = writer -> concurrent;
+                buff -> dad . buffered = true;
+
                 return & buff -> dad;
             }
         }
@@ -779,6 +813,12 @@ ColumnWriter *cSRATblPairMakeBufferedIdRemapColumnWriter ( cSRATblPair *self,
                     /* preserve boolean in one of Dad's align bytes */
                     buff -> dad . align [ 0 ] = assign_ids;
 
+                    if ( idx == NULL )
+                    {
+                        buff -> dad . concurrent = writer -> concurrent;
+                        buff -> dad . buffered = true;
+                    }
+
                     return & buff -> dad;
                 }
 
@@ -82,6 +82,7 @@ void CapsInit ( Caps *caps, const ctx_t *ctx )
                         else
                         {
                             caps -> tool = orig -> tool;
+                            caps -> sort_threads = orig -> sort_threads;
                         }
                     }
                 }
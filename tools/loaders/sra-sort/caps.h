@@ -53,6 +53,10 @@ struct Caps
     struct KDBManager *kdb;
     struct VDBManager *vdb;
     struct Tool const *tool;
+
+    /* threads a radix sort may start, 0 for tool -> num_threads;
+       smaller on the threads that copy columns concurrently */
+    uint32_t sort_threads;
 };
 
 
@@ -204,6 +204,7 @@ ColumnReader *TablePairMakeColumnReader ( TablePair *self, const ctx_t *ctx,
                 TRY ( col = MemAlloc ( ctx, sizeof * col + full_spec_size, false ) )
                 {
                     ColumnReaderInit ( & col -> dad, ctx, & SimpleColumnReader_vt );
+                    col -> dad . concurrent = opt_curs == NULL;
                     col -> curs = curs;
                     col -> idx = idx;
                     col -> full_spec_size = ( uint32_t ) full_spec_size;
@@ -296,6 +297,7 @@ void ColumnReaderInit ( ColumnReader *self, const ctx_t *ctx, const ColumnReader
         self -> vt = vt;
         KRefcountInit ( & self -> refcount, 1, "ColumnReader", "init", "" );
         self -> presorted = false;
+        self -> concurrent = false;
         memset ( self -> align, 0, sizeof self -> align );
     }
 }
@@ -491,6 +493,7 @@ ColumnWriter *TablePairMakeColumnWriter ( TablePair *self, const ctx_t *ctx,
                 TRY ( col = MemAlloc ( ctx, sizeof * col + full_spec_size, false ) )
                 {
                     ColumnWriterInit ( & col -> dad, ctx, & SimpleColumnWriter_vt, false );
+                    col -> dad . concurrent = opt_curs == NULL;
                     col -> curs = curs;
                     col -> idx = idx;
 
@@ -583,6 +586,8 @@ void ColumnWriterInit ( ColumnWriter *self, const ctx_t *ctx, const ColumnWriter
         self -> vt = vt;
         KRefcountInit ( & self -> refcount, 1, "ColumnWriter", "init", "" );
         self -> mapped = mapped;
+        self -> concurrent = false;
+        self -> buffered = false;
         memset ( self -> align, 0, sizeof self -> align );
     }
 }
@@ -634,6 +639,9 @@ ColumnPair *TablePairMakeColumnPair ( TablePair *self, const ctx_t *ctx,
                 col -> presorted = reader -> presorted;
                 col -> large = large;
 
+                /* mapped writers share the row-set's IdxMapping */
+                col -> concurrent = reader -> concurrent && writer -> concurrent && ! writer -> mapped;
+
                 rc = string_printf ( col -> full_spec, full_spec_size + 1, NULL,
                     "%s.%s", self -> full_spec, colspec );
                 if ( rc == 0 )
@@ -664,7 +672,10 @@ ColumnPair *TablePairMakeStaticColumnPair ( TablePair *self, const ctx_t *ctx,
     TRY ( col = TablePairMakeColumnPair ( self, ctx, reader, writer, colspec, false ) )
     {
         if ( col != NULL )
+        {
             col -> is_static = true;
+            col -> concurrent = false;
+        }
     }
 
     return col;
@@ -749,44 +760,56 @@ void ColumnPairCopy ( ColumnPair *self, const ctx_t *ctx, RowSet *rs )
 {
     FUNC_ENTRY ( ctx );
 
+    TRY ( RowSetReset ( rs, ctx, self -> is_static ) )
+    {
+        ColumnPairCopyRows ( self, ctx, rs );
+    }
+}
+
+
+/* CopyRows
+ *  copy from source to destination column
+ *  without resetting "rs"
+ */
+void ColumnPairCopyRows ( ColumnPair *self, const ctx_t *ctx, RowSet *rs )
+{
+    FUNC_ENTRY ( ctx );
+
     STATUS ( 3, "copying column '%s'", self -> full_spec );
 
-    TRY ( RowSetReset ( rs, ctx, self -> is_static ) )
+    TRY ( ColumnPairPreCopy ( self, ctx ) )
     {
-        TRY ( ColumnPairPreCopy ( self, ctx ) )
+        while ( ! FAILED () )
         {
-            while ( ! FAILED () )
-            {
-                rc_t rc;
-                size_t i, count;
-                int64_t row_ids [ 8 * 1024 ];
+            rc_t rc;
+            size_t i, count;
+            int64_t row_ids [ 8 * 1024 ];
 
-                ON_FAIL ( count = RowSetNext ( rs, ctx, row_ids, sizeof row_ids / sizeof row_ids [ 0 ] ) )
-                    break;
-                if ( count == 0 )
-                    break;
+            ON_FAIL ( count = RowSetNext ( rs, ctx, row_ids, sizeof row_ids / sizeof row_ids [ 0 ] ) )
+                break;
+            if ( count == 0 )
+                break;
 
-                rc = Quitting ();
-                if ( rc != 0 )
-                {
-                    INFO_ERROR ( rc, "quitting" );
-                    break;
-                }
+            rc = Quitting ();
+            if ( rc != 0 )
+            {
+                INFO_ERROR ( rc, "quitting" );
+                break;
+            }
+
+            for ( i = 0; ! FAILED () && i < count; ++ i )
+            {
+                const void *base;
+                uint32_t elem_bits, boff, row_len;
 
-                for ( i = 0; ! FAILED () && i < count; ++ i )
+                TRY ( base = ColumnReaderRead ( self -> reader, ctx, row_ids [ i ], & elem_bits, & boff, & row_len ) )
                 {
-                    const void *base;
-                    uint32_t elem_bits, boff, row_len;
-                    
-                    TRY ( base = ColumnReaderRead ( self -> reader, ctx, row_ids [ i ], & elem_bits, & boff, & row_len ) )
-                    {
-                        ColumnWriterWrite ( self -> writer, ctx, elem_bits, base, boff, row_len );
-                    }
+                    ColumnWriterWrite ( self -> writer, ctx, elem_bits, base, boff, row_len );
                 }
             }
-
-            ColumnPairPostCopy ( self, ctx );
         }
+
+        ColumnPairPostCopy ( self, ctx );
     }
 }
 
@@ -56,7 +56,11 @@ struct ColumnReader
     const ColumnReader_vt *vt;
     KRefcount refcount;
     bool presorted;
-    uint8_t align [ 3 ];
+
+    /* true if the reader has no state shared with other columns
+       and may be used on its own thread */
+    bool concurrent;
+    uint8_t align [ 2 ];
 };
 
 #ifndef COLREADER_IMPL
@@ -156,7 +160,15 @@ struct ColumnWriter
     const ColumnWriter_vt *vt;
     KRefcount refcount;
     bool mapped;
-    uint8_t align [ 3 ];
+
+    /* true if the writer has no state shared with other columns
+       and may be used on its own thread */
+    bool concurrent;
+
+    /* true if the writer buffers a whole row-set,
+       needing a private id array of that size when concurrent */
+    bool buffered;
+    uint8_t align [ 1 ];
 };
 
 #ifndef COLWRITER_IMPL
@@ -275,6 +287,9 @@ struct ColumnPair
 
     bool large;
 
+    /* may be copied on its own thread together with other such columns */
+    bool concurrent;
+
     char full_spec [ 1 ];
 };
 
@@ -314,6 +329,13 @@ void ColumnPairPostCopy ( const ColumnPair *self, const ctx_t *ctx );
 void ColumnPairCopy ( ColumnPair *self, const ctx_t *ctx, struct RowSet *rs );
 
 
+/* CopyRows
+ *  copy from source to destination column
+ *  without resetting "rs", which is expected to be a private clone
+ */
+void ColumnPairCopyRows ( ColumnPair *self, const ctx_t *ctx, struct RowSet *rs );
+
+
 /* CopyStatic
  *  copy static column from source to destination
  */
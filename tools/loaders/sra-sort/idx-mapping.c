@@ -25,9 +25,16 @@
  */
 
 #include "idx-mapping.h"
+#include "radix-sort.h"
 #include "ctx.h"
+#include "caps.h"
+#include "except.h"
+#include "status.h"
+#include "mem.h"
+#include "sra-sort.h"
 
 #include <klib/sort.h>
+#include <stddef.h>
 
 FILE_ENTRY ( idx-mapping );
 
@@ -64,6 +71,9 @@ int64_t CC IdxMappingCmpNew ( const void *a, const void *b, void *data )
 
 void IdxMappingSortOld ( IdxMapping *self, const ctx_t *ctx, size_t count )
 {
+    if ( RadixSortIds ( ctx, self, count, sizeof * self, offsetof ( IdxMapping, old_id ), true ) )
+        return;
+
 #define CMP( a, b ) \
     ( ( T ( a ) -> old_id < T ( b ) -> old_id ) ? -1 : ( T ( a ) -> old_id > T ( b ) -> old_id ) )
 
@@ -74,6 +84,9 @@ void IdxMappingSortOld ( IdxMapping *self, const ctx_t *ctx, size_t count )
 
 void IdxMappingSortNew ( IdxMapping *self, const ctx_t *ctx, size_t count )
 {
+    if ( RadixSortIds ( ctx, self, count, sizeof * self, offsetof ( IdxMapping, new_id ), true ) )
+        return;
+
 #define CMP( a, b ) \
     ( ( T ( a ) -> new_id < T ( b ) -> new_id ) ? -1 : ( T ( a ) -> new_id > T ( b ) -> new_id ) )
 
@@ -86,3 +99,45 @@ void IdxMappingSortNew ( IdxMapping *self, const ctx_t *ctx, size_t count )
 #undef SWAP
 
 #endif /* USE_OLD_KSORT */
+
+
+/* RadixSortIds
+ */
+#define RADIX_SORT_MIN_IDS ( 64 * 1024 )
+
+bool RadixSortIds ( const ctx_t *ctx, void *recs, size_t count,
+    size_t rec_size, size_t key_off, bool key_signed )
+{
+    FUNC_ENTRY ( ctx );
+
+    void *scratch;
+    size_t in_use, quota;
+    size_t bytes = count * rec_size;
+    const Tool *tp = ctx -> caps -> tool;
+    uint32_t num_threads = ctx -> caps -> sort_threads != 0 ?
+        ctx -> caps -> sort_threads : tp -> num_threads;
+
+    if ( count < RADIX_SORT_MIN_IDS )
+        return false;
+
+    /* the scratch buffer doubles the memory of the sort */
+    in_use = MemInUse ( ctx, & quota );
+    if ( ( quota + 1 ) != 0 && ( in_use >= quota || quota - in_use < bytes ) )
+    {
+        STATUS ( 3, "not enough memory within quota for radix sort of %,zu records", count );
+        return false;
+    }
+
+    ON_FAIL ( scratch = MemAlloc ( ctx, bytes, false ) )
+    {
+        /* the caller's in-place sort still works */
+        CLEAR ();
+        return false;
+    }
+
+    STATUS ( 4, "radix sorting %,zu records on %u threads", count, num_threads );
+    RadixSort64 ( recs, scratch, count, rec_size, key_off, key_signed, num_threads );
+
+    MemFree ( ctx, scratch, bytes );
+    return true;
+}
@@ -50,10 +50,24 @@ int64_t CC IdxMappingCmpNew ( const void *a, const void *b, void *data );
 
 #else
 
-/* ksort_inlines */
+/* ksort_inlines
+ *  large arrays go through RadixSortIds
+ */
 void IdxMappingSortOld ( IdxMapping *self, const ctx_t *ctx, size_t count );
 void IdxMappingSortNew ( IdxMapping *self, const ctx_t *ctx, size_t count );
 
 #endif
 
+
+/* RadixSortIds
+ *  stable sort of 8 or 16 byte records on a 64-bit key at "key_off"
+ *  using the tool's threads and a scratch buffer within the memory quota
+ *
+ *  returns false without touching "recs" when the array is too small
+ *  to benefit or the scratch buffer would exceed the quota,
+ *  in which case the caller is expected to sort by other means
+ */
+bool RadixSortIds ( const ctx_t *ctx, void *recs, size_t count,
+    size_t rec_size, size_t key_off, bool key_signed );
+
 #endif /* _h_sra_sort_idx_mapping_ */
@@ -146,18 +146,23 @@ size_t MappingRowSetNextPhys ( MappingRowSet *self, const ctx_t *ctx,
 static
 void MappingRowSetReset ( MappingRowSet *self, const ctx_t *ctx, bool for_static );
 
+static
+RowSet *MappingRowSetClone ( const MappingRowSet *self, const ctx_t *ctx );
+
 static RowSet_vt MappingRowSetPhys_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextPhys,
-    MappingRowSetReset
+    MappingRowSetReset,
+    MappingRowSetClone
 };
 
 static RowSet_vt MappingRowSetStat_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextStat,
-    MappingRowSetReset
+    MappingRowSetReset,
+    MappingRowSetClone
 };
 
 static
@@ -202,14 +207,16 @@ static RowSet_vt MapFileMappingRowSetPhys_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextPhys,
-    MapFileMappingRowSetReset
+    MapFileMappingRowSetReset,
+    MappingRowSetClone
 };
 
 static RowSet_vt MapFileMappingRowSetStat_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextStat,
-    MapFileMappingRowSetReset
+    MapFileMappingRowSetReset,
+    MappingRowSetClone
 };
 
 static
@@ -245,6 +252,27 @@ void MapFileMappingRowSetReset ( MappingRowSet *self, const ctx_t *ctx, bool for
 }
 
 
+static
+RowSet *MappingRowSetIteratorMakeTheRowSet ( MappingRowSetIterator *self, const ctx_t *ctx, const RowSet_vt *vt );
+
+static
+RowSet *MappingRowSetClone ( const MappingRowSet *self, const ctx_t *ctx )
+{
+    FUNC_ENTRY ( ctx );
+
+    MappingRowSet *rs;
+
+    /* share the map of "self" in its current state, physical or static */
+    TRY ( rs = ( MappingRowSet* ) MappingRowSetIteratorMakeTheRowSet ( self -> iter, ctx, self -> dad . vt ) )
+    {
+        rs -> num_elems = self -> num_elems;
+        return & rs -> dad;
+    }
+
+    return NULL;
+}
+
+
 /*--------------------------------------------------------------------------
  * MappingRowSetIterator
  *  interface to iterate RowSets
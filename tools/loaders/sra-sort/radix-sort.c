@@ -0,0 +1,261 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+
+#include "radix-sort.h"
+
+#include <kproc/thread.h>
+#include <klib/rc.h>
+
+#include <string.h>
+#include <assert.h>
+
+
+/*--------------------------------------------------------------------------
+ * RadixSort64
+ *  one byte per pass, least significant first
+ */
+#define RADIX_BITS 8
+#define RADIX_SIZE ( 1 << RADIX_BITS )
+#define RADIX_MASK ( RADIX_SIZE - 1 )
+
+/* fewer records than this per thread are not worth a thread */
+#define RADIX_MIN_PART ( 1024 * 1024 )
+
+#define RADIX_MAX_THREADS 64
+
+typedef enum RadixPhase RadixPhase;
+enum RadixPhase
+{
+    rpDiff,         /* gather the key bits that are not common to all records */
+    rpCount,        /* histogram of current digit */
+    rpScatter,      /* move records to their bucket */
+    rpCopy          /* move sorted records back from scratch */
+};
+
+typedef struct RadixJob RadixJob;
+struct RadixJob
+{
+    const uint8_t *src;
+    uint8_t *dst;
+    size_t rec_size;
+    size_t key_off;
+    uint64_t key_flip;
+    uint64_t first_key;
+    uint32_t shift;
+    RadixPhase phase;
+};
+
+typedef struct RadixPart RadixPart;
+struct RadixPart
+{
+    const RadixJob *job;
+
+    /* range of records handled */
+    size_t start, end;
+
+    /* OR of ( key ^ first_key ) over range */
+    uint64_t diff;
+
+    /* counts, then destination of next record per bucket */
+    size_t bucket [ RADIX_SIZE ];
+};
+
+static
+uint64_t RadixKey ( const RadixJob *job, const uint8_t *rec )
+{
+    uint64_t key;
+    memmove ( & key, rec + job -> key_off, sizeof key );
+    return key ^ job -> key_flip;
+}
+
+static
+void RadixPartRun ( RadixPart *self )
+{
+    const RadixJob *job = self -> job;
+    const size_t rec_size = job -> rec_size;
+    const uint32_t shift = job -> shift;
+    const uint8_t *rec = job -> src + self -> start * rec_size;
+    const uint8_t *end = job -> src + self -> end * rec_size;
+
+    switch ( job -> phase )
+    {
+    case rpDiff:
+    {
+        uint64_t diff = 0;
+        for ( ; rec < end; rec += rec_size )
+            diff |= RadixKey ( job, rec ) ^ job -> first_key;
+        self -> diff = diff;
+        break;
+    }
+    case rpCount:
+        memset ( self -> bucket, 0, sizeof self -> bucket );
+        for ( ; rec < end; rec += rec_size )
+            ++ self -> bucket [ ( RadixKey ( job, rec ) >> shift ) & RADIX_MASK ];
+        break;
+    case rpScatter:
+        if ( rec_size == sizeof ( uint64_t ) )
+        {
+            uint64_t *dst = ( uint64_t* ) job -> dst;
+            for ( ; rec < end; rec += rec_size )
+            {
+                size_t to = self -> bucket [ ( RadixKey ( job, rec ) >> shift ) & RADIX_MASK ] ++;
+                dst [ to ] = * ( const uint64_t* ) rec;
+            }
+        }
+        else
+        {
+            uint8_t *dst = job -> dst;
+            for ( ; rec < end; rec += rec_size )
+            {
+                size_t to = self -> bucket [ ( RadixKey ( job, rec ) >> shift ) & RADIX_MASK ] ++;
+                memmove ( & dst [ to * rec_size ], rec, rec_size );
+            }
+        }
+        break;
+    case rpCopy:
+        memmove ( job -> dst + self -> start * rec_size, rec, ( self -> end - self -> start ) * rec_size );
+        break;
+    }
+}
+
+static
+rc_t CC RadixPartThread ( const KThread *self, void *data )
+{
+    RadixPartRun ( data );
+    return 0;
+}
+
+static
+void RadixRunPhase ( RadixPart *parts, uint32_t num_parts )
+{
+    uint32_t i;
+    KThread *t [ RADIX_MAX_THREADS ];
+
+    /* part 0 is always handled by calling thread */
+    for ( i = 1; i < num_parts; ++ i )
+    {
+        if ( KThreadMake ( & t [ i ], RadixPartThread, & parts [ i ] ) != 0 )
+        {
+            t [ i ] = NULL;
+            RadixPartRun ( & parts [ i ] );
+        }
+    }
+
+    RadixPartRun ( & parts [ 0 ] );
+
+    for ( i = 1; i < num_parts; ++ i )
+    {
+        if ( t [ i ] != NULL )
+        {
+            KThreadWait ( t [ i ], NULL );
+            KThreadRelease ( t [ i ] );
+        }
+    }
+}
+
+void RadixSort64 ( void *recs, void *scratch, size_t count,
+    size_t rec_size, size_t key_off, bool key_signed, uint32_t num_threads )
+{
+    RadixJob job;
+    uint64_t diff;
+    uint32_t i, num_parts;
+    RadixPart parts [ RADIX_MAX_THREADS ];
+
+    assert ( rec_size == 8 || rec_size == 16 );
+    assert ( key_off + sizeof ( uint64_t ) <= rec_size );
+
+    if ( count < 2 )
+        return;
+
+    /* decide upon parallelism */
+    num_parts = num_threads;
+    if ( num_parts > RADIX_MAX_THREADS )
+        num_parts = RADIX_MAX_THREADS;
+    if ( ( size_t ) num_parts > count / RADIX_MIN_PART )
+        num_parts = ( uint32_t ) ( count / RADIX_MIN_PART );
+    if ( num_parts == 0 )
+        num_parts = 1;
+
+    memset ( & job, 0, sizeof job );
+    job . rec_size = rec_size;
+    job . key_off = key_off;
+
+    /* flipping the sign bit orders signed keys as unsigned */
+    job . key_flip = key_signed ? ( uint64_t ) 1 << 63 : 0;
+
+    for ( i = 0; i < num_parts; ++ i )
+    {
+        parts [ i ] . job = & job;
+        parts [ i ] . start = count / num_parts * i;
+        parts [ i ] . end = ( i + 1 == num_parts ) ? count : count / num_parts * ( i + 1 );
+    }
+
+    /* find the digits that actually vary */
+    job . src = recs;
+    job . first_key = RadixKey ( & job, recs );
+    job . phase = rpDiff;
+    RadixRunPhase ( parts, num_parts );
+    for ( diff = 0, i = 0; i < num_parts; ++ i )
+        diff |= parts [ i ] . diff;
+
+    for ( job . shift = 0; job . shift < 64 && ( diff >> job . shift ) != 0; job . shift += RADIX_BITS )
+    {
+        size_t b, to;
+
+        if ( ( ( diff >> job . shift ) & RADIX_MASK ) == 0 )
+            continue;
+
+        job . phase = rpCount;
+        RadixRunPhase ( parts, num_parts );
+
+        /* bucket-major, part-minor offsets keep the sort stable */
+        for ( to = 0, b = 0; b < RADIX_SIZE; ++ b )
+        {
+            for ( i = 0; i < num_parts; ++ i )
+            {
+                size_t n = parts [ i ] . bucket [ b ];
+                parts [ i ] . bucket [ b ] = to;
+                to += n;
+            }
+        }
+        assert ( to == count );
+
+        job . dst = ( job . src == recs ) ? scratch : recs;
+        job . phase = rpScatter;
+        RadixRunPhase ( parts, num_parts );
+
+        job . src = job . dst;
+    }
+
+    /* an odd number of passes leaves records in scratch */
+    if ( job . src != recs )
+    {
+        job . dst = recs;
+        job . phase = rpCopy;
+        RadixRunPhase ( parts, num_parts );
+    }
+}
@@ -0,0 +1,63 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+
+#ifndef _h_sra_sort_radix_sort_
+#define _h_sra_sort_radix_sort_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * RadixSort64
+ *  stable LSD radix sort of "count" records of "rec_size" bytes ( 8 or 16 )
+ *  on the 64-bit key found at byte offset "key_off" within each record
+ *
+ *  "key_signed" [ IN ] - true to order keys as int64_t, false as uint64_t
+ *
+ *  "scratch" [ IN ] - a buffer of "count" records, contents are destroyed
+ *
+ *  "num_threads" [ IN ] - every pass is split across up to this many threads
+ *  the sort is completed on the calling thread if threads cannot be created
+ *
+ *  byte positions where all keys agree are skipped,
+ *  so row-ids from a narrow range need only a few passes
+ */
+void RadixSort64 ( void *recs, void *scratch, size_t count,
+    size_t rec_size, size_t key_off, bool key_signed, uint32_t num_threads );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_sra_sort_radix_sort_ */
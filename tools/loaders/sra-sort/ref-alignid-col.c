@@ -46,6 +46,7 @@ struct AlignIdColReader;
 #include <klib/rc.h>
 
 #include <string.h>
+#include <stddef.h>
 #include <assert.h>
 
 FILE_ENTRY ( ref-alignid-col );
@@ -444,7 +445,8 @@ const void *AlignIdColReaderRead ( AlignIdColReader *self, const ctx_t *ctx,
 #if USE_OLD_KSORT
             ksort ( self -> u . ids, self -> num_elems, sizeof self -> u . ids [ 0 ], cmp_int64_t, ( void* ) ctx );
 #else
-            ksort_int64_t ( self -> u . ids, self -> num_elems );
+            if ( ! RadixSortIds ( ctx, self -> u . ids, self -> num_elems, sizeof self -> u . ids [ 0 ], 0, true ) )
+                ksort_int64_t ( self -> u . ids, self -> num_elems );
 #endif
 
             /* transform from ids to id_poslen */
@@ -479,7 +481,13 @@ const void *AlignIdColReaderRead ( AlignIdColReader *self, const ctx_t *ctx,
 #if USE_OLD_KSORT
         ksort ( self -> u . id_poslen, self -> num_elems, sizeof self -> u . id_poslen [ 0 ], IdPosLenCmpPos, ( void* ) ctx );
 #else
-        ksort_IdPosLen_pos ( self -> u . id_poslen, self -> num_elems );
+        /* the ids are in ascending order here, so a stable sort
+           on poslen alone yields the same order as the full compare */
+        if ( ! RadixSortIds ( ctx, self -> u . id_poslen, self -> num_elems,
+                 sizeof self -> u . id_poslen [ 0 ], offsetof ( IdPosLen, poslen ), false ) )
+        {
+            ksort_IdPosLen_pos ( self -> u . id_poslen, self -> num_elems );
+        }
 #endif
 
         /* write poslen to temp column */
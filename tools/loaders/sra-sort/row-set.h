@@ -74,6 +74,9 @@ struct RowSet_vt
     /* reset iterator to initial state */
     void ( * reset ) ( ROWSET_IMPL *self, const ctx_t *ctx,
         bool for_static );
+
+    /* create a new RowSet on the same ids with its own position */
+    RowSet* ( * clone ) ( const ROWSET_IMPL *self, const ctx_t *ctx );
 };
 
 
@@ -102,6 +105,16 @@ RowSet *RowSetDuplicate ( const RowSet *self, const ctx_t *ctx );
     POLY_DISPATCH_VOID ( reset, self, ROWSET_IMPL, ctx, for_static )
 
 
+/* Clone
+ *  create a RowSet that generates the same ids from the beginning
+ *  sharing the data of "self", which must have been Reset
+ *  and must not be Reset while the clone is in use.
+ *  used to let several threads walk the same RowSet
+ */
+#define RowSetClone( self, ctx ) \
+    POLY_DISPATCH_PTR ( clone, self, const ROWSET_IMPL, ctx )
+
+
 /* Init
  */
 void RowSetInit ( RowSet *self, const ctx_t *ctx, const RowSet_vt *vt );
@@ -87,11 +87,15 @@ void SimpleRowSetReset ( SimpleRowSet *self, const ctx_t *ctx, bool for_static )
     self -> row_id = self -> first;
 }
 
+static
+RowSet *SimpleRowSetClone ( const SimpleRowSet *self, const ctx_t *ctx );
+
 static RowSet_vt SimpleRowSet_vt =
 {
     SimpleRowSetWhack,
     SimpleRowSetNext,
-    SimpleRowSetReset
+    SimpleRowSetReset,
+    SimpleRowSetClone
 };
 
 
@@ -114,6 +118,15 @@ RowSet *SimpleRowSetMake ( const ctx_t *ctx, int64_t first, int64_t last_excl )
     return NULL;
 }
 
+/* Clone
+ */
+static
+RowSet *SimpleRowSetClone ( const SimpleRowSet *self, const ctx_t *ctx )
+{
+    FUNC_ENTRY ( ctx );
+    return SimpleRowSetMake ( ctx, self -> first, self -> last_excl );
+}
+
 
 /*--------------------------------------------------------------------------
  * SimpleRowSetIterator
@@ -151,18 +151,23 @@ size_t SortingRowSetNextPhys ( SortingRowSet *self, const ctx_t *ctx,
 static
 void SortingRowSetReset ( SortingRowSet *self, const ctx_t *ctx, bool for_static );
 
+static
+RowSet *SortingRowSetClone ( const SortingRowSet *self, const ctx_t *ctx );
+
 static RowSet_vt SortingRowSetPhys_vt =
 {
     SortingRowSetWhack,
     SortingRowSetNextPhys,
-    SortingRowSetReset
+    SortingRowSetReset,
+    SortingRowSetClone
 };
 
 static RowSet_vt SortingRowSetStat_vt =
 {
     SortingRowSetWhack,
     SortingRowSetNextStat,
-    SortingRowSetReset
+    SortingRowSetReset,
+    SortingRowSetClone
 };
 
 static
@@ -214,6 +219,27 @@ void SortingRowSetReset ( SortingRowSet *self, const ctx_t *ctx, bool for_static
 }
 
 
+static
+RowSet *SortingRowSetIteratorMakeTheRowSet ( SortingRowSetIterator *self, const ctx_t *ctx, const RowSet_vt *vt );
+
+static
+RowSet *SortingRowSetClone ( const SortingRowSet *self, const ctx_t *ctx )
+{
+    FUNC_ENTRY ( ctx );
+
+    SortingRowSet *rs;
+
+    /* share the src_ids of "self" in its current state, physical or static */
+    TRY ( rs = ( SortingRowSet* ) SortingRowSetIteratorMakeTheRowSet ( self -> iter, ctx, self -> dad . vt ) )
+    {
+        rs -> num_elems = self -> num_elems;
+        return & rs -> dad;
+    }
+
+    return NULL;
+}
+
+
 /*--------------------------------------------------------------------------
  * SortingRowSetIterator
  *  interface to iterate RowSets
@@ -48,6 +48,7 @@ typedef struct TablePair StdTblPair;
 #include <klib/namelist.h>
 #include <klib/rc.h>
 #include <kproc/thread.h> /* KThreadWait */
+#include <kproc/lock.h>
 
 #include <string.h>
 
@@ -392,6 +393,287 @@ void TablePairCopyMappedColumns ( TablePair *self, const ctx_t *ctx )
     }
 }
 
+/* ConcurrentColumns
+ *  the columns sharing one RowSet, handed out to several threads
+ */
+typedef struct ConcurrentColumns ConcurrentColumns;
+struct ConcurrentColumns
+{
+    const Vector *cols;
+    const RowSet *rs;
+    KLock *lock;
+    uint32_t next;
+    bool failed;
+};
+
+typedef struct ConcurrentColumnsThreadData ConcurrentColumnsThreadData;
+struct ConcurrentColumnsThreadData
+{
+    Caps caps;
+    ConcurrentColumns *cc;
+    KThread *t;
+};
+
+static
+ColumnPair *ConcurrentColumnsNext ( ConcurrentColumns *self, const ctx_t *ctx )
+{
+    FUNC_ENTRY ( ctx );
+
+    ColumnPair *col = NULL;
+
+    rc_t rc = KLockAcquire ( self -> lock );
+    if ( rc != 0 )
+        SYSTEM_ERROR ( rc, "failed to acquire lock" );
+    else
+    {
+        /* stop handing out columns once any thread has failed */
+        uint32_t count = VectorLength ( self -> cols );
+        while ( ! self -> failed && self -> next < count )
+        {
+            col = VectorGet ( self -> cols, self -> next ++ );
+            assert ( col != NULL );
+            if ( col -> concurrent )
+                break;
+            col = NULL;
+        }
+
+        KLockUnlock ( self -> lock );
+    }
+
+    return col;
+}
+
+/* tell the other threads to stop, "failed" is read by ConcurrentColumnsNext */
+static
+void ConcurrentColumnsFail ( ConcurrentColumns *self )
+{
+    if ( KLockAcquire ( self -> lock ) == 0 )
+    {
+        self -> failed = true;
+        KLockUnlock ( self -> lock );
+    }
+}
+
+static
+void ConcurrentColumnsCopy ( ConcurrentColumns *self, const ctx_t *ctx )
+{
+    FUNC_ENTRY ( ctx );
+
+    while ( ! FAILED () )
+    {
+        RowSet *rs;
+        ColumnPair *col;
+
+        ON_FAIL ( col = ConcurrentColumnsNext ( self, ctx ) )
+            break;
+        if ( col == NULL )
+            break;
+
+        /* each thread walks its own clone of the shared ids */
+        TRY ( rs = RowSetClone ( self -> rs, ctx ) )
+        {
+            ColumnPairCopyRows ( col, ctx, rs );
+            RowSetRelease ( rs, ctx );
+        }
+    }
+
+    if ( FAILED () )
+        ConcurrentColumnsFail ( self );
+}
+
+static
+rc_t CC ConcurrentColumnsRun ( const KThread *self, void *data )
+{
+    ConcurrentColumnsThreadData *td = data;
+
+    DECLARE_CTX_INFO ();
+    ctx_t thread_ctx = { & td -> caps, NULL, & ctx_info };
+    const ctx_t *ctx = & thread_ctx;
+
+    ConcurrentColumnsCopy ( td -> cc, ctx );
+
+    return ctx -> rc;
+}
+
+
+/* ConcurrentThreads
+ *  the number of threads to copy the concurrent columns of "cols"
+ *  limited by what the threads may hold at once under a quota
+ */
+static
+uint32_t TablePairConcurrentThreads ( const TablePair *self, const ctx_t *ctx, const Vector *cols, bool large )
+{
+    FUNC_ENTRY ( ctx );
+
+    const Tool *tp = ctx -> caps -> tool;
+    uint32_t i, num_threads, concurrent, buffered;
+    uint32_t count = VectorLength ( cols );
+
+    for ( i = concurrent = buffered = 0; i < count; ++ i )
+    {
+        const ColumnPair *col = VectorGet ( cols, i );
+        assert ( col != NULL );
+        if ( col -> concurrent )
+        {
+            ++ concurrent;
+            if ( col -> writer -> buffered )
+                ++ buffered;
+        }
+    }
+
+    num_threads = tp -> num_threads;
+    if ( num_threads > concurrent )
+        num_threads = concurrent;
+
+    if ( num_threads > 1 )
+    {
+        size_t in_use, quota;
+
+        in_use = MemInUse ( ctx, & quota );
+        if ( ( quota + 1 ) != 0 )
+        {
+            /* a thread copying a buffered column holds a private copy
+               of the ids plus cell data of at least that size, any other
+               thread the batch of ids it reads. with "n" threads
+               at most min ( n, buffered ) of them copy buffered columns */
+            size_t avail = quota > in_use ? quota - in_use : 0;
+            uint64_t ids = self -> last_excl - self -> first_id;
+            size_t max_ids = large ? tp -> max_large_idx_ids : tp -> max_idx_ids;
+            size_t buffered_bytes, other_bytes;
+            uint32_t limit;
+
+            if ( ids > ( uint64_t ) max_ids )
+                ids = max_ids;
+
+            buffered_bytes = ( size_t ) ids * sizeof ( int64_t ) * 2;
+            other_bytes = sizeof ( int64_t ) * 8 * 1024;
+
+            for ( limit = num_threads; limit > 1; -- limit )
+            {
+                uint32_t b = limit < buffered ? limit : buffered;
+                if ( b * buffered_bytes + ( limit - b ) * other_bytes <= avail )
+                    break;
+            }
+
+            if ( limit < num_threads )
+            {
+                STATUS ( 2, "limiting '%s' to %u column threads within memory quota", self -> full_spec, limit );
+                num_threads = limit;
+            }
+        }
+    }
+
+    return num_threads;
+}
+
+
+/* CopyColumns
+ *  copy all columns of "cols" from one RowSet
+ *  those that are concurrent are spread across "num_threads" threads
+ *  while the others are copied first on this one
+ */
+static
+void TablePairCopyColumns ( TablePair *self, const ctx_t *ctx, const Vector *cols, RowSet *rs, uint32_t num_threads )
+{
+    FUNC_ENTRY ( ctx );
+
+    rc_t rc;
+    ConcurrentColumns cc;
+    ConcurrentColumnsThreadData *td;
+    uint32_t i, started, sort_threads, count = VectorLength ( cols );
+
+    for ( i = 0; i < count; ++ i )
+    {
+        ColumnPair *col = VectorGet ( cols, i );
+        assert ( col != NULL );
+        if ( num_threads < 2 || ! col -> concurrent )
+        {
+            ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
+                return;
+        }
+    }
+
+    if ( num_threads < 2 )
+        return;
+
+    /* load the ids once for all threads */
+    ON_FAIL ( RowSetReset ( rs, ctx, false ) )
+        return;
+
+    rc = KLockMake ( & cc . lock );
+    if ( rc != 0 )
+    {
+        SYSTEM_ERROR ( rc, "failed to create lock" );
+        return;
+    }
+
+    cc . cols = cols;
+    cc . rs = rs;
+    cc . next = 0;
+    cc . failed = false;
+
+    /* the columns may radix sort their ids at the same time:
+       share the threads of the tool among them */
+    sort_threads = ctx -> caps -> tool -> num_threads / num_threads;
+    if ( sort_threads == 0 )
+        sort_threads = 1;
+
+    TRY ( td = MemAlloc ( ctx, sizeof td [ 0 ] * ( num_threads - 1 ), true ) )
+    {
+        STATUS ( 3, "copying '%s' columns on %u threads", self -> full_spec, num_threads );
+        self -> concurrent = true;
+
+        for ( started = 0; started < num_threads - 1; ++ started )
+        {
+            td [ started ] . cc = & cc;
+            ON_FAIL ( CapsInit ( & td [ started ] . caps, ctx ) )
+            {
+                /* release whatever was duplicated before the failure */
+                CapsWhack ( & td [ started ] . caps, ctx );
+                break;
+            }
+            td [ started ] . caps . sort_threads = sort_threads;
+
+            rc = KThreadMake ( & td [ started ] . t, ConcurrentColumnsRun, & td [ started ] );
+            if ( rc != 0 )
+            {
+                SYSTEM_ERROR ( rc, "failed to create column copy thread" );
+                CapsWhack ( & td [ started ] . caps, ctx );
+                break;
+            }
+        }
+
+        /* take a share of the columns, unless already failed
+           in which case any started threads copy the rest */
+        if ( ! FAILED () )
+        {
+            /* this thread's share under the same limit */
+            Caps share_caps = * ctx -> caps;
+            ctx_t share_ctx = { & share_caps, ctx, & ctx_info };
+            share_caps . sort_threads = sort_threads;
+            ConcurrentColumnsCopy ( & cc, & share_ctx );
+        }
+
+        for ( i = 0; i < started; ++ i )
+        {
+            rc_t status = 0;
+            rc = KThreadWait ( td [ i ] . t, & status );
+            if ( rc != 0 )
+                SYSTEM_ERROR ( rc, "failed to wait for column copy thread 0x%p", td [ i ] . t );
+            else if ( status != 0 )
+                ERROR ( status, "column copy thread 0x%p failed", td [ i ] . t );
+
+            KThreadRelease ( td [ i ] . t );
+            CapsWhack ( & td [ i ] . caps, ctx );
+        }
+
+        self -> concurrent = false;
+        MemFree ( ctx, td, sizeof td [ 0 ] * ( num_threads - 1 ) );
+    }
+
+    KLockRelease ( cc . lock );
+}
+
 static
 void TablePairCopyLargeColumns ( TablePair *self, const ctx_t *ctx )
 {
@@ -406,25 +688,20 @@ void TablePairCopyLargeColumns ( TablePair *self, const ctx_t *ctx )
         const bool is_large = true;
         TRY ( rsi = TablePairGetRowSetIterator ( self, ctx, is_mapped, is_large ) )
         {
+            uint32_t num_threads;
+
             STATUS ( 2, "copying '%s' large columns", self -> full_spec );
 
+            num_threads = TablePairConcurrentThreads ( self, ctx, & self -> large_cols, is_large );
             while ( ! FAILED () )
             {
-                uint32_t i;
-
                 RowSet *rs;
                 ON_FAIL ( rs = RowSetIteratorNext ( rsi, ctx ) )
                     break;
                 if ( rs == NULL )
                     break;
 
-                for ( i = 0; i < count; ++ i )
-                {
-                    ColumnPair *col = VectorGet ( & self -> large_cols, i );
-                    assert ( col != NULL );
-                    ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
-                        break;
-                }
+                TablePairCopyColumns ( self, ctx, & self -> large_cols, rs, num_threads );
 
                 RowSetRelease ( rs, ctx );
             }
@@ -512,25 +789,20 @@ void TablePairCopyNormalColumns ( TablePair *self, const ctx_t *ctx )
         const bool is_large = false;
         TRY ( rsi = TablePairGetRowSetIterator ( self, ctx, is_mapped, is_large ) )
         {
+            uint32_t num_threads;
+
             STATUS ( 2, "copying '%s' columns", self -> full_spec );
 
+            num_threads = TablePairConcurrentThreads ( self, ctx, & self -> normal_cols, is_large );
             while ( ! FAILED () )
             {
-                uint32_t i;
-
                 RowSet *rs;
                 ON_FAIL ( rs = RowSetIteratorNext ( rsi, ctx ) )
                     break;
                 if ( rs == NULL )
                     break;
 
-                for ( i = 0; i < count; ++ i )
-                {
-                    ColumnPair *col = VectorGet ( & self -> normal_cols, i );
-                    assert ( col != NULL );
-                    ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
-                        break;
-                }
+                TablePairCopyColumns ( self, ctx, & self -> normal_cols, rs, num_threads );
 
                 RowSetRelease ( rs, ctx );
             }
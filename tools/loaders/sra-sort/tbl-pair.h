@@ -113,7 +113,10 @@ struct TablePair
     /* Thread launched by TablePairPostCopy [ to do consistency-check ] */
     struct KThread * thread;
 
-    uint8_t align [ 2 ];
+    /* true while columns are being copied on several threads */
+    bool concurrent;
+
+    uint8_t align [ 1 ];
 };
 
 #ifndef TBLPAIR_IMPL